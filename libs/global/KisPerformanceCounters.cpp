@@ -0,0 +1,205 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "KisPerformanceCounters.h"
+
+#include <algorithm>
+
+#include <QElapsedTimer>
+#include <QGlobalStatic>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QStandardPaths>
+#include <QStringList>
+
+namespace {
+std::atomic<int> s_lastShard {0};
+thread_local int s_currentShard = -1;
+}
+
+KisPerformanceCounter::KisPerformanceCounter(const char *name, Type type)
+    : m_name(name),
+      m_type(type)
+{
+    if (KisPerformanceCounters *registry = KisPerformanceCounters::instance()) {
+        registry->registerCounter(this);
+    }
+}
+
+KisPerformanceCounter::~KisPerformanceCounter()
+{
+    if (KisPerformanceCounters *registry = KisPerformanceCounters::instance()) {
+        registry->unregisterCounter(this);
+    }
+}
+
+int KisPerformanceCounter::currentShard()
+{
+    // the threads are assigned to the shards in a round-robin manner
+    if (s_currentShard < 0) {
+        s_currentShard = s_lastShard++ % numShards;
+    }
+
+    return s_currentShard;
+}
+
+qint64 KisPerformanceCounter::value() const
+{
+    qint64 result = 0;
+
+    for (int i = 0; i < numShards; i++) {
+        result += m_shards[i].value.load(std::memory_order_relaxed);
+    }
+
+    return result;
+}
+
+
+struct KisPerformanceCounters::Private
+{
+    QElapsedTimer timer;
+
+    mutable QMutex mutex;
+    QVector<KisPerformanceCounter*> counters;
+
+    QVector<Snapshot> history;
+    int historySize = 600;
+};
+
+Q_GLOBAL_STATIC(KisPerformanceCounters, s_instance)
+
+KisPerformanceCounters::KisPerformanceCounters()
+    : m_d(new Private)
+{
+    m_d->timer.start();
+}
+
+KisPerformanceCounters::~KisPerformanceCounters()
+{
+}
+
+KisPerformanceCounters *KisPerformanceCounters::instance()
+{
+    return !s_instance.isDestroyed() ? s_instance : nullptr;
+}
+
+void KisPerformanceCounters::registerCounter(KisPerformanceCounter *counter)
+{
+    QMutexLocker l(&m_d->mutex);
+    m_d->counters.append(counter);
+}
+
+void KisPerformanceCounters::unregisterCounter(KisPerformanceCounter *counter)
+{
+    QMutexLocker l(&m_d->mutex);
+    m_d->counters.removeOne(counter);
+}
+
+KisPerformanceCounters::Snapshot KisPerformanceCounters::takeSnapshot() const
+{
+    Snapshot snapshot;
+
+    {
+        QMutexLocker l(&m_d->mutex);
+
+        snapshot.timestamp = m_d->timer.nsecsElapsed();
+        snapshot.samples.reserve(m_d->counters.size());
+
+        Q_FOREACH (KisPerformanceCounter *counter, m_d->counters) {
+            Sample sample;
+            sample.name = QString::fromLatin1(counter->name());
+            sample.type = counter->type();
+            sample.value = counter->value();
+            snapshot.samples.append(sample);
+        }
+    }
+
+    std::sort(snapshot.samples.begin(), snapshot.samples.end(),
+              [] (const Sample &lhs, const Sample &rhs) {
+                  return lhs.name < rhs.name;
+              });
+
+    return snapshot;
+}
+
+KisPerformanceCounters::Snapshot KisPerformanceCounters::sample()
+{
+    const Snapshot snapshot = takeSnapshot();
+
+    QMutexLocker l(&m_d->mutex);
+
+    m_d->history.append(snapshot);
+    if (m_d->history.size() > m_d->historySize) {
+        m_d->history.remove(0, m_d->history.size() - m_d->historySize);
+    }
+
+    return snapshot;
+}
+
+QVector<KisPerformanceCounters::Snapshot> KisPerformanceCounters::history() const
+{
+    QMutexLocker l(&m_d->mutex);
+    return m_d->history;
+}
+
+int KisPerformanceCounters::historySize() const
+{
+    QMutexLocker l(&m_d->mutex);
+    return m_d->historySize;
+}
+
+void KisPerformanceCounters::setHistorySize(int value)
+{
+    KIS_SAFE_ASSERT_RECOVER_RETURN(value > 0);
+
+    QMutexLocker l(&m_d->mutex);
+    m_d->historySize = value;
+
+    if (m_d->history.size() > m_d->historySize) {
+        m_d->history.remove(0, m_d->history.size() - m_d->historySize);
+    }
+}
+
+QMap<QString, qreal> KisPerformanceCounters::rates(const Snapshot &previous, const Snapshot &current)
+{
+    QMap<QString, qint64> previousValues;
+    Q_FOREACH (const Sample &sample, previous.samples) {
+        previousValues.insert(sample.name, sample.value);
+    }
+
+    const qreal seconds = qreal(current.timestamp - previous.timestamp) / 1e9;
+
+    QMap<QString, qreal> result;
+
+    Q_FOREACH (const Sample &sample, current.samples) {
+        if (sample.type == KisPerformanceCounter::Gauge) {
+            result.insert(sample.name, sample.value);
+        } else if (seconds > 0.0) {
+            result.insert(sample.name, (sample.value - previousValues.value(sample.name, 0)) / seconds);
+        } else {
+            result.insert(sample.name, 0.0);
+        }
+    }
+
+    return result;
+}
+
+QString KisPerformanceCounters::formatSnapshot(const Snapshot &previous, const Snapshot &current)
+{
+    const QMap<QString, qreal> values = rates(previous, current);
+
+    QStringList result;
+    for (auto it = values.constBegin(); it != values.constEnd(); ++it) {
+        result << QString("%1=%2").arg(it.key()).arg(it.value(), 0, 'f', 1);
+    }
+
+    return result.join(' ');
+}
+
+QString KisPerformanceCounters::defaultLogFilePath()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::GenericDataLocation) + "/krita-counters.log";
+}
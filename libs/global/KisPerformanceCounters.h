@@ -0,0 +1,187 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KISPERFORMANCECOUNTERS_H
+#define KISPERFORMANCECOUNTERS_H
+
+#include "kritaglobal_export.h"
+#include "kis_assert.h"
+
+#include <atomic>
+
+#include <QtGlobal>
+#include <QMap>
+#include <QScopedPointer>
+#include <QString>
+#include <QVector>
+
+/**
+ * KisPerformanceCounter is a named value describing the behavior of
+ * some internal machinery, e.g. the number of the tiles swapped out
+ * or the time the stroke jobs spent in the queue. The counters are
+ * meant to be always on, so that one could tell whether the slowness
+ * reported by the user is caused by the merger, the swap or by the
+ * jobs waiting for each other.
+ *
+ * The counter is split into a few cache-line-aligned shards, every
+ * thread updates its own shard with a relaxed atomic operation, so
+ * updating a counter never makes the threads fight for a cache line.
+ *
+ * The counters should have static storage duration, they register
+ * themselves in KisPerformanceCounters on construction:
+ *
+ * \code{.cpp}
+ * namespace {
+ * KisPerformanceCounter s_tilesSwappedOut("swap/tiles_out");
+ * }
+ *
+ * void KisSomeClass::swapOut()
+ * {
+ *     // ...
+ *     s_tilesSwappedOut.increment();
+ * }
+ * \endcode
+ *
+ * NOTE: the name of the counter is not copied, so it must be a string
+ *       literal
+ */
+class KRITAGLOBAL_EXPORT KisPerformanceCounter
+{
+public:
+    enum Type {
+        Counter, ///< grows monotonically, the consumers are interested in its rate
+        Gauge    ///< represents the current state, e.g. the length of a queue
+    };
+
+public:
+    KisPerformanceCounter(const char *name, Type type = Counter);
+    ~KisPerformanceCounter();
+
+    inline void add(qint64 value) {
+        m_shards[m_type == Gauge ? 0 : currentShard()].value.fetch_add(value, std::memory_order_relaxed);
+    }
+
+    inline void increment() {
+        add(1);
+    }
+
+    /**
+     * Sets the value of a gauge. Should not be used for the counters,
+     * since other threads may have their own shards.
+     */
+    inline void set(qint64 value) {
+        KIS_SAFE_ASSERT_RECOVER_RETURN(m_type == Gauge);
+        m_shards[0].value.store(value, std::memory_order_relaxed);
+    }
+
+    qint64 value() const;
+
+    const char* name() const {
+        return m_name;
+    }
+
+    Type type() const {
+        return m_type;
+    }
+
+private:
+    Q_DISABLE_COPY(KisPerformanceCounter)
+
+    static int currentShard();
+
+    static const int numShards = 16;
+
+    struct alignas(64) Shard {
+        std::atomic<qint64> value {0};
+    };
+
+    Shard m_shards[numShards];
+    const char *m_name;
+    const Type m_type;
+};
+
+
+/**
+ * The registry of all the performance counters of the application
+ */
+class KRITAGLOBAL_EXPORT KisPerformanceCounters
+{
+public:
+    struct Sample {
+        QString name;
+        KisPerformanceCounter::Type type = KisPerformanceCounter::Counter;
+        qint64 value = 0;
+    };
+
+    struct Snapshot {
+        /// the number of nanoseconds since the registry has been created
+        qint64 timestamp = 0;
+
+        /// the samples sorted by the name of the counter
+        QVector<Sample> samples;
+    };
+
+public:
+    KisPerformanceCounters();
+    ~KisPerformanceCounters();
+
+    /**
+     * \return the global registry or null if the application
+     *         is shutting down
+     */
+    static KisPerformanceCounters* instance();
+
+    /**
+     * \return the values of all the counters at the current moment
+     */
+    Snapshot takeSnapshot() const;
+
+    /**
+     * Takes a snapshot and puts it into the history. It is called
+     * periodically by KisPart.
+     */
+    Snapshot sample();
+
+    /**
+     * \return the snapshots taken with sample(), the oldest first,
+     *         only the latest historySize() snapshots are kept
+     */
+    QVector<Snapshot> history() const;
+
+    int historySize() const;
+    void setHistorySize(int value);
+
+    /**
+     * \return per second rates of the counters and the values of the
+     *         gauges in \p current, \p previous should be taken earlier
+     */
+    static QMap<QString, qreal> rates(const Snapshot &previous, const Snapshot &current);
+
+    /**
+     * \return rates() of \p current in a compact single-line form,
+     *         suitable for logging
+     */
+    static QString formatSnapshot(const Snapshot &previous, const Snapshot &current);
+
+    /**
+     * \return the path of the file the snapshots are logged into
+     *         when KisConfig::logPerformanceCounters() is on
+     */
+    static QString defaultLogFilePath();
+
+private:
+    friend class KisPerformanceCounter;
+    void registerCounter(KisPerformanceCounter *counter);
+    void unregisterCounter(KisPerformanceCounter *counter);
+
+private:
+    Q_DISABLE_COPY(KisPerformanceCounters)
+
+    struct Private;
+    const QScopedPointer<Private> m_d;
+};
+
+#endif // KISPERFORMANCECOUNTERS_H
@@ -0,0 +1,267 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "KisPerformanceTracer.h"
+
+#include <algorithm>
+#include <iterator>
+
+#include <QByteArray>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QGlobalStatic>
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QString>
+#include <QThread>
+#include <QVector>
+
+#include "kis_assert.h"
+
+namespace {
+
+struct TraceEvent {
+    const char *category = nullptr;
+    const char *name = nullptr;
+    qint64 startTime = 0;
+    qint64 duration = -1; // -1 means an instant event
+    int threadId = 0;
+};
+
+/**
+ * Chrome trace expects small integer thread ids, so we just number
+ * the threads in the order they report their first event
+ */
+std::atomic<int> s_lastThreadId {0};
+thread_local int s_currentThreadId = 0;
+
+}
+
+struct KisPerformanceTracer::Private
+{
+    QElapsedTimer timer;
+
+    mutable QMutex mutex;
+    QVector<TraceEvent> events;
+    int capacity = 65536;
+    int nextEvent = 0;
+    bool isWrapped = false;
+
+    QHash<int, QString> threadNames;
+
+    void addEvent(const TraceEvent &event);
+    int currentThreadId();
+};
+
+int KisPerformanceTracer::Private::currentThreadId()
+{
+    if (!s_currentThreadId) {
+        s_currentThreadId = ++s_lastThreadId;
+
+        QThread *thread = QThread::currentThread();
+        QString name = thread->objectName();
+
+        if (QCoreApplication::instance() && QCoreApplication::instance()->thread() == thread) {
+            name = "GUI thread";
+        } else if (name.isEmpty()) {
+            name = QString("Thread %1").arg(s_currentThreadId);
+        }
+
+        QMutexLocker l(&mutex);
+        threadNames.insert(s_currentThreadId, name);
+    }
+
+    return s_currentThreadId;
+}
+
+void KisPerformanceTracer::Private::addEvent(const TraceEvent &event)
+{
+    QMutexLocker l(&mutex);
+
+    if (events.size() < capacity) {
+        events.append(event);
+    } else {
+        events[nextEvent] = event;
+    }
+
+    nextEvent++;
+    if (nextEvent >= capacity) {
+        nextEvent = 0;
+        isWrapped = true;
+    }
+}
+
+Q_GLOBAL_STATIC(KisPerformanceTracer, s_instance)
+
+KisPerformanceTracer::KisPerformanceTracer()
+    : m_isEnabled(false),
+      m_d(new Private)
+{
+    m_d->timer.start();
+}
+
+KisPerformanceTracer::~KisPerformanceTracer()
+{
+}
+
+KisPerformanceTracer *KisPerformanceTracer::instance()
+{
+    return !s_instance.isDestroyed() ? s_instance : nullptr;
+}
+
+void KisPerformanceTracer::setEnabled(bool value)
+{
+    if (value == isEnabled()) return;
+
+    if (value) {
+        clear();
+    }
+
+    m_isEnabled.store(value, std::memory_order_relaxed);
+}
+
+qint64 KisPerformanceTracer::timestamp() const
+{
+    return m_d->timer.nsecsElapsed();
+}
+
+void KisPerformanceTracer::addSpan(const char *category, const char *name, qint64 startTime, qint64 endTime)
+{
+    if (!isEnabled()) return;
+
+    TraceEvent event;
+    event.category = category;
+    event.name = name;
+    event.startTime = startTime;
+    event.duration = qMax(qint64(0), endTime - startTime);
+    event.threadId = m_d->currentThreadId();
+
+    m_d->addEvent(event);
+}
+
+void KisPerformanceTracer::addInstantEvent(const char *category, const char *name)
+{
+    if (!isEnabled()) return;
+
+    TraceEvent event;
+    event.category = category;
+    event.name = name;
+    event.startTime = timestamp();
+    event.threadId = m_d->currentThreadId();
+
+    m_d->addEvent(event);
+}
+
+int KisPerformanceTracer::capacity() const
+{
+    QMutexLocker l(&m_d->mutex);
+    return m_d->capacity;
+}
+
+void KisPerformanceTracer::setCapacity(int value)
+{
+    KIS_SAFE_ASSERT_RECOVER_RETURN(value > 0);
+
+    QMutexLocker l(&m_d->mutex);
+    m_d->capacity = value;
+    m_d->events.clear();
+    m_d->nextEvent = 0;
+    m_d->isWrapped = false;
+}
+
+int KisPerformanceTracer::numEvents() const
+{
+    QMutexLocker l(&m_d->mutex);
+    return m_d->events.size();
+}
+
+void KisPerformanceTracer::clear()
+{
+    QMutexLocker l(&m_d->mutex);
+    m_d->events.clear();
+    m_d->nextEvent = 0;
+    m_d->isWrapped = false;
+}
+
+QByteArray KisPerformanceTracer::toChromeTrace() const
+{
+    QVector<TraceEvent> events;
+    QHash<int, QString> threadNames;
+
+    {
+        QMutexLocker l(&m_d->mutex);
+
+        // put the events in chronological order
+        if (m_d->isWrapped) {
+            events.reserve(m_d->events.size());
+            std::copy(m_d->events.begin() + m_d->nextEvent, m_d->events.end(), std::back_inserter(events));
+            std::copy(m_d->events.begin(), m_d->events.begin() + m_d->nextEvent, std::back_inserter(events));
+        } else {
+            events = m_d->events;
+        }
+
+        threadNames = m_d->threadNames;
+    }
+
+    const qint64 pid = QCoreApplication::applicationPid();
+
+    QJsonArray traceEvents;
+
+    for (auto it = threadNames.constBegin(); it != threadNames.constEnd(); ++it) {
+        QJsonObject event;
+        event["name"] = "thread_name";
+        event["ph"] = "M";
+        event["pid"] = pid;
+        event["tid"] = it.key();
+        event["args"] = QJsonObject({{"name", it.value()}});
+        traceEvents.append(event);
+    }
+
+    Q_FOREACH (const TraceEvent &traceEvent, events) {
+        QJsonObject event;
+        event["name"] = QString::fromLatin1(traceEvent.name);
+        event["cat"] = QString::fromLatin1(traceEvent.category);
+        event["pid"] = pid;
+        event["tid"] = traceEvent.threadId;
+        event["ts"] = qreal(traceEvent.startTime) / 1000.0;
+
+        if (traceEvent.duration >= 0) {
+            event["ph"] = "X";
+            event["dur"] = qreal(traceEvent.duration) / 1000.0;
+        } else {
+            event["ph"] = "i";
+            event["s"] = "t";
+        }
+
+        traceEvents.append(event);
+    }
+
+    QJsonObject root;
+    root["traceEvents"] = traceEvents;
+    root["displayTimeUnit"] = "ms";
+
+    return QJsonDocument(root).toJson(QJsonDocument::Compact);
+}
+
+bool KisPerformanceTracer::saveChromeTrace(const QString &filePath) const
+{
+    QSaveFile file(filePath);
+    if (!file.open(QFile::WriteOnly)) return false;
+
+    file.write(toChromeTrace());
+    return file.commit();
+}
+
+QString KisPerformanceTracer::defaultTraceFilePath()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::GenericDataLocation) + "/krita-trace.json";
+}
@@ -0,0 +1,179 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KISPERFORMANCETRACER_H
+#define KISPERFORMANCETRACER_H
+
+#include "kritaglobal_export.h"
+
+#include <atomic>
+
+#include <QtGlobal>
+#include <QScopedPointer>
+
+class QString;
+class QByteArray;
+
+/**
+ * KisPerformanceTracer records timestamped spans of the work done by
+ * different parts of the rendering pipeline: from the input events,
+ * through the stroke and merge jobs, down to the texture uploads and
+ * the canvas painting. It lets one see where the time goes between
+ * a tablet event and the pixels on screen on a release build.
+ *
+ * The spans are stored in a ring buffer of a fixed capacity, so the
+ * tracer keeps only the latest events and never grows. The collected
+ * events can be saved in the Chrome trace format, which can be viewed
+ * in chrome://tracing or in Perfetto.
+ *
+ * The tracer is disabled by default. When it is disabled, recording
+ * a span costs just a check of an atomic flag.
+ *
+ * \code{.cpp}
+ * void KisSomeClass::doSomeWork()
+ * {
+ *     KIS_TRACE_SCOPE("category", "KisSomeClass::doSomeWork");
+ *
+ *     // ...
+ * }
+ * \endcode
+ *
+ * NOTE: the category and the name of a span are not copied, so they
+ *       must be string literals or have a static storage duration
+ */
+class KRITAGLOBAL_EXPORT KisPerformanceTracer
+{
+public:
+    /**
+     * Records a span lasting from the construction of the object
+     * till its destruction
+     */
+    class Scope
+    {
+    public:
+        Scope(const char *category, const char *name)
+            : m_category(category),
+              m_name(name),
+              m_startTime(-1)
+        {
+            KisPerformanceTracer *tracer = KisPerformanceTracer::instance();
+            if (tracer && tracer->isEnabled()) {
+                m_startTime = tracer->timestamp();
+            }
+        }
+
+        ~Scope()
+        {
+            KisPerformanceTracer *tracer = KisPerformanceTracer::instance();
+            if (m_startTime >= 0 && tracer) {
+                tracer->addSpan(m_category, m_name, m_startTime, tracer->timestamp());
+            }
+        }
+
+    private:
+        Q_DISABLE_COPY(Scope)
+
+        const char *m_category;
+        const char *m_name;
+        qint64 m_startTime;
+    };
+
+public:
+    KisPerformanceTracer();
+    ~KisPerformanceTracer();
+
+    /**
+     * \return the global tracer or null if the application
+     *         is shutting down
+     */
+    static KisPerformanceTracer* instance();
+
+    /**
+     * \return true if the events are being recorded. Can be called
+     *         from any thread.
+     */
+    inline bool isEnabled() const {
+        return m_isEnabled.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * Starts or stops recording of the events. Starting the recording
+     * drops all the events collected before.
+     */
+    void setEnabled(bool value);
+
+    /**
+     * \return the number of nanoseconds passed since the tracer
+     *         has been created
+     */
+    qint64 timestamp() const;
+
+    /**
+     * Records a span of work done by the current thread between
+     * \p startTime and \p endTime, fetched with timestamp(). Can be
+     * called from any thread.
+     */
+    void addSpan(const char *category, const char *name, qint64 startTime, qint64 endTime);
+
+    /**
+     * Records a zero-length event happened in the current thread
+     * right now. Can be called from any thread.
+     */
+    void addInstantEvent(const char *category, const char *name);
+
+    /**
+     * \return the maximum number of the events kept by the tracer
+     */
+    int capacity() const;
+
+    /**
+     * Sets the maximum number of the events kept by the tracer,
+     * dropping all the collected events
+     */
+    void setCapacity(int value);
+
+    /**
+     * \return the number of the currently collected events
+     */
+    int numEvents() const;
+
+    void clear();
+
+    /**
+     * \return the collected events in the Chrome trace JSON format
+     */
+    QByteArray toChromeTrace() const;
+
+    /**
+     * Saves the collected events into \p filePath in the Chrome
+     * trace JSON format
+     */
+    bool saveChromeTrace(const QString &filePath) const;
+
+    /**
+     * \return the file the trace is saved into when the user
+     *         switches the tracing off, it is placed next to the
+     *         Krita usage log
+     */
+    static QString defaultTraceFilePath();
+
+private:
+    Q_DISABLE_COPY(KisPerformanceTracer)
+
+    std::atomic<bool> m_isEnabled;
+
+    struct Private;
+    const QScopedPointer<Private> m_d;
+};
+
+/**
+ * Records a span of the work done in the current scope. Only one
+ * span can be recorded per scope.
+ */
+#define KIS_TRACE_SCOPE(category, name) \
+    KisPerformanceTracer::Scope __kisTraceScope(category, name)
+
+#endif // KISPERFORMANCETRACER_H
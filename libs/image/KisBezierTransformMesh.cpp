@@ -11,6 +11,104 @@
 #include <KisSampleRectIterator.h>
 #include <KisBezierPatchParamToSourceSampler.h>
 #include "kis_debug.h"
+#include "KisConcurrentRangeUtils.h"
+
+#include <QMutex>
+#include <QMutexLocker>
+
+namespace {
+
+struct SampledPatchGrid
+{
+    KisBezierPatch patch;
+    QSize gridSize;
+    QVector<QPointF> originalPoints;
+    QVector<QPointF> transformedPoints;
+};
+
+bool patchesEqual(const KisBezierPatch &lhs, const KisBezierPatch &rhs)
+{
+    return lhs.originalRect == rhs.originalRect && lhs.points == rhs.points;
+}
+
+SampledPatchGrid samplePatch(const KisBezierPatch &patch)
+{
+    SampledPatchGrid grid;
+    grid.patch = patch;
+    patch.sampleRegularGrid(grid.gridSize,
+                            grid.originalPoints,
+                            grid.transformedPoints,
+                            QPointF(8,8));
+    return grid;
+}
+
+template <typename PolygonOp>
+void rasterizePatchGrid(PolygonOp &polygonOp, const SampledPatchGrid &grid)
+{
+    GridIterationTools::RegularGridIndexesOp indexesOp(grid.gridSize);
+    GridIterationTools::iterateThroughGrid
+            <GridIterationTools::AlwaysCompletePolygonPolicy>(polygonOp, indexesOp,
+                                                              grid.gridSize,
+                                                              grid.originalPoints,
+                                                              grid.transformedPoints);
+}
+
+}
+
+/**
+ * Sampling a patch into a regular grid is the most expensive part of the
+ * mesh transformation. When the user drags a single control point of the
+ * mesh, only the patches adjacent to this point change, so we keep the
+ * grids of the previous update and reuse them for all the patches that
+ * have not changed since then. The patches are stored by their index
+ * in the mesh, so the lookup is just a comparison with the previous
+ * state of the same patch.
+ */
+struct KisBezierTransformMesh::SampledGridCache
+{
+    QMutex mutex;
+    QVector<SampledPatchGrid> grids;
+};
+
+namespace {
+
+QVector<SampledPatchGrid> sampleMeshPatches(const QVector<KisBezierPatch> &patches,
+                                            KisBezierTransformMesh::SampledGridCacheSP cache)
+{
+    QVector<SampledPatchGrid> prevGrids;
+
+    if (cache) {
+        QMutexLocker l(&cache->mutex);
+        prevGrids = cache->grids;
+    }
+
+    QVector<SampledPatchGrid> grids(patches.size());
+
+    KritaUtils::processRangeConcurrently(patches.size(), 1,
+        [&patches, &grids, &prevGrids] (int begin, int end) {
+            for (int i = begin; i < end; i++) {
+                if (i < prevGrids.size() && patchesEqual(prevGrids[i].patch, patches[i])) {
+                    grids[i] = prevGrids[i];
+                } else {
+                    grids[i] = samplePatch(patches[i]);
+                }
+            }
+        });
+
+    if (cache) {
+        QMutexLocker l(&cache->mutex);
+        cache->grids = grids;
+    }
+
+    return grids;
+}
+
+}
+
+KisBezierTransformMesh::SampledGridCacheSP KisBezierTransformMesh::createSampledGridCache()
+{
+    return SampledGridCacheSP(new SampledGridCache());
+}
 
 KisBezierTransformMesh::patch_const_iterator
 KisBezierTransformMesh::hitTestPatchImpl(const QPointF &pt, QPointF *localPointResult) const
@@ -73,59 +171,58 @@ QRect KisBezierTransformMesh::hitTestPatchInSourceSpace(const QRectF &rect) cons
 
 void KisBezierTransformMesh::transformPatch(const KisBezierPatch &patch, const QPoint &srcQImageOffset, const QImage &srcImage, const QPoint &dstQImageOffset, QImage *dstImage)
 {
-    QVector<QPointF> originalPointsLocal;
-    QVector<QPointF> transformedPointsLocal;
-    QSize gridSize;
-
-    patch.sampleRegularGrid(gridSize, originalPointsLocal, transformedPointsLocal, QPointF(8,8));
-
     const QRect dstBoundsI = patch.dstBoundingRect().toAlignedRect();
     const QRect imageSize = QRect(dstQImageOffset, dstImage->size());
     KIS_SAFE_ASSERT_RECOVER_NOOP(imageSize.contains(dstBoundsI));
 
-    {
-        GridIterationTools::QImagePolygonOp polygonOp(srcImage, *dstImage, srcQImageOffset, dstQImageOffset);
-
-        GridIterationTools::RegularGridIndexesOp indexesOp(gridSize);
-        GridIterationTools::iterateThroughGrid
-                <GridIterationTools::AlwaysCompletePolygonPolicy>(polygonOp, indexesOp,
-                                                                  gridSize,
-                                                                  originalPointsLocal,
-                                                                  transformedPointsLocal);
-    }
+    GridIterationTools::QImagePolygonOp polygonOp(srcImage, *dstImage, srcQImageOffset, dstQImageOffset);
+    rasterizePatchGrid(polygonOp, samplePatch(patch));
 }
 
 void KisBezierTransformMesh::transformPatch(const KisBezierPatch &patch, KisPaintDeviceSP srcDevice, KisPaintDeviceSP dstDevice)
 {
-    QVector<QPointF> originalPointsLocal;
-    QVector<QPointF> transformedPointsLocal;
-    QSize gridSize;
-
-    patch.sampleRegularGrid(gridSize, originalPointsLocal, transformedPointsLocal, QPointF(8,8));
-
-    {
-        GridIterationTools::PaintDevicePolygonOp polygonOp(srcDevice, dstDevice);
-
-        GridIterationTools::RegularGridIndexesOp indexesOp(gridSize);
-        GridIterationTools::iterateThroughGrid
-                <GridIterationTools::AlwaysCompletePolygonPolicy>(polygonOp, indexesOp,
-                                                                  gridSize,
-                                                                  originalPointsLocal,
-                                                                  transformedPointsLocal);
-    }
+    GridIterationTools::PaintDevicePolygonOp polygonOp(srcDevice, dstDevice);
+    rasterizePatchGrid(polygonOp, samplePatch(patch));
 }
 
-void KisBezierTransformMesh::transformMesh(const QPoint &srcQImageOffset, const QImage &srcImage, const QPoint &dstQImageOffset, QImage *dstImage) const
+void KisBezierTransformMesh::transformMesh(const QPoint &srcQImageOffset, const QImage &srcImage, const QPoint &dstQImageOffset, QImage *dstImage, SampledGridCacheSP cache) const
 {
+    const QRect imageSize = QRect(dstQImageOffset, dstImage->size());
+
+    QVector<KisBezierPatch> patches;
     for (auto it = beginPatches(); it != endPatches(); ++it) {
-        transformPatch(*it, srcQImageOffset, srcImage, dstQImageOffset, dstImage);
+        const QRect dstBoundsI = it->dstBoundingRect().toAlignedRect();
+        KIS_SAFE_ASSERT_RECOVER_NOOP(imageSize.contains(dstBoundsI));
+
+        patches << *it;
+    }
+
+    const QVector<SampledPatchGrid> grids = sampleMeshPatches(patches, cache);
+
+    /**
+     * The destination polygons of the patches may overlap, so the
+     * rasterization itself should happen sequentially
+     */
+    GridIterationTools::QImagePolygonOp polygonOp(srcImage, *dstImage, srcQImageOffset, dstQImageOffset);
+
+    for (const SampledPatchGrid &grid : grids) {
+        rasterizePatchGrid(polygonOp, grid);
     }
 }
 
-void KisBezierTransformMesh::transformMesh(KisPaintDeviceSP srcDevice, KisPaintDeviceSP dstDevice) const
+void KisBezierTransformMesh::transformMesh(KisPaintDeviceSP srcDevice, KisPaintDeviceSP dstDevice, SampledGridCacheSP cache) const
 {
+    QVector<KisBezierPatch> patches;
     for (auto it = beginPatches(); it != endPatches(); ++it) {
-        transformPatch(*it, srcDevice, dstDevice);
+        patches << *it;
+    }
+
+    const QVector<SampledPatchGrid> grids = sampleMeshPatches(patches, cache);
+
+    GridIterationTools::PaintDevicePolygonOp polygonOp(srcDevice, dstDevice);
+
+    for (const SampledPatchGrid &grid : grids) {
+        rasterizePatchGrid(polygonOp, grid);
     }
 }
 
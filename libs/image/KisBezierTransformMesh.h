@@ -12,6 +12,8 @@
 
 #include "kis_types.h"
 
+#include <QSharedPointer>
+
 namespace KisBezierTransformMeshDetail {
 
 class KRITAIMAGE_EXPORT KisBezierTransformMesh : public KisBezierMesh
@@ -25,6 +27,17 @@ public:
     {
     }
 
+    /**
+     * The grids of the patches sampled during the previous call to
+     * transformMesh(). The owner of the cache (e.g. the preview of the
+     * tool) may pass it into every update of the same transformation,
+     * so that only the changed patches would be sampled again.
+     */
+    struct SampledGridCache;
+    using SampledGridCacheSP = QSharedPointer<SampledGridCache>;
+
+    static SampledGridCacheSP createSampledGridCache();
+
     PatchIndex hitTestPatch(const QPointF &pt, QPointF *localPointResult = 0) const;
 
     static void transformPatch(const KisBezierPatch &patch,
@@ -41,10 +54,12 @@ public:
     void transformMesh(const QPoint &srcQImageOffset,
                        const QImage &srcImage,
                        const QPoint &dstQImageOffset,
-                       QImage *dstImage) const;
+                       QImage *dstImage,
+                       SampledGridCacheSP cache = SampledGridCacheSP()) const;
 
     void transformMesh(KisPaintDeviceSP srcDevice,
-                       KisPaintDeviceSP dstDevice) const;
+                       KisPaintDeviceSP dstDevice,
+                       SampledGridCacheSP cache = SampledGridCacheSP()) const;
 
     QRect approxNeedRect(const QRect &rc) const;
     QRect approxChangeRect(const QRect &rc) const;
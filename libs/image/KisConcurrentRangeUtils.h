@@ -0,0 +1,64 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KISCONCURRENTRANGEUTILS_H
+#define KISCONCURRENTRANGEUTILS_H
+
+#include <QVector>
+#include <QPair>
+#include <QThreadPool>
+#include <QtConcurrentMap>
+
+namespace KritaUtils {
+
+/**
+ * Splits the index range [0, size) into a set of contiguous chunks and
+ * calls \p func(begin, end) for each of them on the global thread pool.
+ * The call blocks until all the chunks are processed. The calling thread
+ * takes part in the processing, so it is safe to call the function from
+ * inside a thread pool job.
+ *
+ * The chunks are never smaller than \p minChunkSize, so the function can be
+ * safely used for ranges of any size: small ranges are processed in the
+ * calling thread without any threading overhead.
+ *
+ * NOTE: \p func must be thread-safe and must not write into the data
+ *       shared between the chunks.
+ */
+template <typename Func>
+void processRangeConcurrently(int size, int minChunkSize, Func func)
+{
+    if (size <= 0) return;
+
+    const int numThreads = qMax(1, QThreadPool::globalInstance()->maxThreadCount());
+
+    /**
+     * Generate a few chunks per thread to let the pool balance
+     * the load when some of the chunks are heavier than the others
+     */
+    const int chunkSize = qMax(qMax(1, minChunkSize), (size + 4 * numThreads - 1) / (4 * numThreads));
+
+    if (numThreads == 1 || size <= chunkSize) {
+        func(0, size);
+        return;
+    }
+
+    QVector<QPair<int, int>> chunks;
+    chunks.reserve(size / chunkSize + 1);
+
+    for (int i = 0; i < size; i += chunkSize) {
+        chunks.append(qMakePair(i, qMin(size, i + chunkSize)));
+    }
+
+    QtConcurrent::blockingMap(chunks,
+        [&func] (const QPair<int, int> &chunk) {
+            func(chunk.first, chunk.second);
+        });
+}
+
+}
+
+#endif // KISCONCURRENTRANGEUTILS_H
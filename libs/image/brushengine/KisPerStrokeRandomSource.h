@@ -18,6 +18,7 @@ class KRITAIMAGE_EXPORT KisPerStrokeRandomSource : public KisShared
 {
 public:
     KisPerStrokeRandomSource();
+    KisPerStrokeRandomSource(int seed);
     KisPerStrokeRandomSource(const KisPerStrokeRandomSource &rhs);
 
     ~KisPerStrokeRandomSource();
@@ -32,6 +33,12 @@ public:
      */
     qreal generateNormalized(const QString &key) const;
 
+    /**
+     * The seed the source has been created with. A source created
+     * with the same seed generates the same numbers for every key.
+     */
+    int seed() const;
+
 private:
     struct Private;
     const QScopedPointer<Private> m_d;
@@ -6,6 +6,7 @@
 
 #include <brushengine/kis_paint_information.h>
 
+#include <QDataStream>
 #include <QDomElement>
 #include <boost/optional.hpp>
 
@@ -332,6 +333,62 @@ KisPaintInformation KisPaintInformation::fromXML(const QDomElement& e)
                                rotation, tangentialPressure, perspective, time, speed);
 }
 
+void KisPaintInformation::toDataStream(QDataStream &stream) const
+{
+    // hovering mode infos are not supposed to be saved
+    KIS_ASSERT_RECOVER_NOOP(!d->isHoveringMode);
+
+    stream << d->pos
+           << d->pressure
+           << d->xTilt
+           << d->yTilt
+           << d->rotation
+           << d->tangentialPressure
+           << d->perspective
+           << d->time
+           << d->speed
+           << d->canvasRotation
+           << d->canvasMirroredH
+           << d->canvasMirroredV;
+}
+
+KisPaintInformation KisPaintInformation::fromDataStream(QDataStream &stream)
+{
+    QPointF pos;
+    qreal pressure = PRESSURE_DEFAULT;
+    qreal xTilt = 0.0;
+    qreal yTilt = 0.0;
+    qreal rotation = 0.0;
+    qreal tangentialPressure = 0.0;
+    qreal perspective = 1.0;
+    qreal time = 0.0;
+    qreal speed = 0.0;
+    qreal canvasRotation = 0.0;
+    bool canvasMirroredH = false;
+    bool canvasMirroredV = false;
+
+    stream >> pos
+           >> pressure
+           >> xTilt
+           >> yTilt
+           >> rotation
+           >> tangentialPressure
+           >> perspective
+           >> time
+           >> speed
+           >> canvasRotation
+           >> canvasMirroredH
+           >> canvasMirroredV;
+
+    KisPaintInformation info(pos, pressure, xTilt, yTilt,
+                             rotation, tangentialPressure, perspective, time, speed);
+    info.setCanvasRotation(canvasRotation);
+    info.setCanvasMirroredH(canvasMirroredH);
+    info.setCanvasMirroredV(canvasMirroredV);
+
+    return info;
+}
+
 const QPointF& KisPaintInformation::pos() const
 {
     return d->pos;
@@ -21,6 +21,7 @@
 
 class QDomDocument;
 class QDomElement;
+class QDataStream;
 class KisDistanceInformation;
 
 
@@ -288,6 +289,14 @@ public:
 
     static KisPaintInformation fromXML(const QDomElement&);
 
+    /**
+     * Binary counterparts of toXML() and fromXML(), used for storing
+     * long sequences of paint information objects, e.g. in the stroke
+     * recordings. The canvas rotation and mirroring are saved as well.
+     */
+    void toDataStream(QDataStream &stream) const;
+    static KisPaintInformation fromDataStream(QDataStream &stream);
+
     // TODO: Refactor the static mix functions to non-static in-place mutation
     //       versions like mixOtherOnlyPosition and mixOtherWithoutTime.
     // Heap allocation on Windows is awfully slow and will fragment the memory
@@ -6,18 +6,24 @@
 
 #include "kis_stroke_random_source.h"
 
+#include <QRandomGenerator>
+
 struct KisStrokeRandomSource::Private
 {
-    Private()
+    Private(int _seed, int _perStrokeSeed)
         : levelOfDetail(0),
-          lod0RandomSource(new KisRandomSource()),
+          seed(_seed),
+          perStrokeSeed(_perStrokeSeed),
+          lod0RandomSource(new KisRandomSource(seed)),
           lodNRandomSource(new KisRandomSource(*lod0RandomSource)),
-          lod0PerStrokeRandomSource(new KisPerStrokeRandomSource()),
+          lod0PerStrokeRandomSource(new KisPerStrokeRandomSource(perStrokeSeed)),
           lodNPerStrokeRandomSource(new KisPerStrokeRandomSource(*lod0PerStrokeRandomSource))
     {
     }
 
     int levelOfDetail;
+    int seed;
+    int perStrokeSeed;
     KisRandomSourceSP lod0RandomSource;
     KisRandomSourceSP lodNRandomSource;
 
@@ -27,7 +33,13 @@ struct KisStrokeRandomSource::Private
 
 
 KisStrokeRandomSource::KisStrokeRandomSource()
-    : m_d(new Private)
+    : m_d(new Private(QRandomGenerator::global()->generate(),
+                      QRandomGenerator::global()->generate()))
+{
+}
+
+KisStrokeRandomSource::KisStrokeRandomSource(int seed, int perStrokeSeed)
+    : m_d(new Private(seed, perStrokeSeed))
 {
 }
 
@@ -60,6 +72,16 @@ KisPerStrokeRandomSourceSP KisStrokeRandomSource::perStrokeSource() const
 }
 
 
+int KisStrokeRandomSource::seed() const
+{
+    return m_d->seed;
+}
+
+int KisStrokeRandomSource::perStrokeSeed() const
+{
+    return m_d->perStrokeSeed;
+}
+
 int KisStrokeRandomSource::levelOfDetail() const
 {
     return m_d->levelOfDetail;
@@ -25,6 +25,13 @@ class KRITAIMAGE_EXPORT  KisStrokeRandomSource
 {
 public:
     KisStrokeRandomSource();
+
+    /**
+     * Creates the random sources with the specified seeds, so that
+     * a stroke could be repeated with exactly the same dabs
+     */
+    KisStrokeRandomSource(int seed, int perStrokeSeed);
+
     KisStrokeRandomSource(const KisStrokeRandomSource &rhs);
     KisStrokeRandomSource& operator=(const KisStrokeRandomSource &rhs);
 
@@ -33,6 +40,9 @@ public:
     KisRandomSourceSP source() const;
     KisPerStrokeRandomSourceSP perStrokeSource() const;
 
+    int seed() const;
+    int perStrokeSeed() const;
+
     int levelOfDetail() const;
     void setLevelOfDetail(int value);
 
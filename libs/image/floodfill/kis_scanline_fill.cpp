@@ -19,7 +19,9 @@
 #include "kis_fill_sanity_checks.h"
 #include <KisColorSelectionPolicies.h>
 #include "kis_gap_map.h"
+#include <KisConcurrentRangeUtils.h>
 #include <queue>
+#include <numeric>
 
 #define MEASURE_FILL_TIME 0
 #if MEASURE_FILL_TIME
@@ -272,6 +274,81 @@ private:
     KisRandomAccessorSP m_groupMapIt;
 };
 
+/**
+ * A contiguous horizontal run of selectable pixels inside a patch
+ * of the parallel fill. \p start and \p end are inclusive absolute
+ * x-coordinates.
+ */
+struct FillRun
+{
+    int start;
+    int end;
+    int label;
+};
+
+/**
+ * The result of a local connected components labeling of a single patch.
+ * Only the runs are stored, so the memory footprint is proportional to the
+ * complexity of the image, not to its size.
+ */
+struct FillPatch
+{
+    QRect rect;
+    QVector<int> rowOffsets; ///< runs of row `i` are stored in [rowOffsets[i], rowOffsets[i + 1])
+    QVector<FillRun> runs;
+    int numLabels = 0;
+    int labelBase = 0;
+
+    inline const FillRun* rowBegin(int row) const {
+        return runs.constData() + rowOffsets[row - rect.top()];
+    }
+
+    inline const FillRun* rowEnd(int row) const {
+        return runs.constData() + rowOffsets[row - rect.top() + 1];
+    }
+};
+
+inline int findLabelRoot(QVector<int> &parent, int label)
+{
+    while (parent[label] != label) {
+        parent[label] = parent[parent[label]];
+        label = parent[label];
+    }
+    return label;
+}
+
+inline void uniteLabels(QVector<int> &parent, int a, int b)
+{
+    a = findLabelRoot(parent, a);
+    b = findLabelRoot(parent, b);
+
+    if (a != b) {
+        parent[qMax(a, b)] = qMin(a, b);
+    }
+}
+
+/**
+ * Unites all the overlapping runs of two neighbouring rows. The runs
+ * are sorted by their x-coordinate, so we can use a two-pointer sweep.
+ */
+template <typename LabelFunc>
+inline void uniteOverlappingRuns(const FillRun *topIt, const FillRun *topEnd,
+                                 const FillRun *bottomIt, const FillRun *bottomEnd,
+                                 LabelFunc labelFunc)
+{
+    while (topIt != topEnd && bottomIt != bottomEnd) {
+        if (topIt->start <= bottomIt->end && bottomIt->start <= topIt->end) {
+            labelFunc(*topIt, *bottomIt);
+        }
+
+        if (topIt->end < bottomIt->end) {
+            ++topIt;
+        } else {
+            ++bottomIt;
+        }
+    }
+}
+
 } // anonymous namespace
 
 struct Q_DECL_HIDDEN KisScanlineFill::Private
@@ -291,6 +368,31 @@ struct Q_DECL_HIDDEN KisScanlineFill::Private
 
     QRect fillExtent;
 
+    /**
+     * The selection fill starts with the scanline algorithm, which is
+     * proportional to the size of the filled region. When the number of
+     * filled pixels exceeds the budget, the scanline fill is stopped and
+     * the region is filled by the parallel algorithm, which processes the
+     * whole bounding rect. Negative budget means no limit.
+     */
+    qint64 pixelBudget = -1;
+    bool pixelBudgetExceeded = false;
+
+    inline void startPixelBudget() {
+        pixelBudgetExceeded = false;
+        pixelBudget = closeGap > 0 ? -1 : 4 * 256 * 256;
+    }
+
+    inline void consumePixelBudget(qint64 numPixels) {
+        if (pixelBudget < 0) return;
+
+        pixelBudget -= numPixels;
+        if (pixelBudget < 0) {
+            pixelBudgetExceeded = true;
+            pixelBudget = -1;
+        }
+    }
+
     // The priority queue is required to correctly handle the fill "expansion" case
     // (starting in a corner and filling towards open areas, where distance is DISTANCE_INFINITE).
     // Holds the next pixel to consider for filling, among with the contextual information.
@@ -434,6 +536,7 @@ void KisScanlineFill::extendedPass(KisFillInterval *currentInterval, int srcRow,
             *intervalBorder = x;
             *backwardIntervalBorder = x;
             pixelAccessPolicy.fillPixel(pixelPtr, opacity, x, srcRow);
+            m_d->consumePixelBudget(1);
             if (extendRight) {
                 m_d->fillExtent.setRight(qMax(m_d->fillExtent.right(), x));
             } else {
@@ -498,6 +601,7 @@ void KisScanlineFill::processLine(KisFillInterval interval, const int rowIncreme
             }
 
             pixelAccessPolicy.fillPixel(pixelPtr, opacity, x, row);
+            m_d->consumePixelBudget(1);
             m_d->fillExtent = m_d->fillExtent.united(QRect(x, row, 1, 1));
 
             if (x == firstX) {
@@ -690,7 +794,17 @@ void KisScanlineFill::runImpl(DifferencePolicy &differencePolicy,
                 }
 
                 processLine(interval, m_d->rowIncrement, differencePolicy, selectionPolicy, pixelAccessPolicy);
+
+                if (m_d->pixelBudgetExceeded) {
+                    m_d->forwardStack.clear();
+                }
             }
+
+            if (m_d->pixelBudgetExceeded) {
+                m_d->backwardMap.clear();
+                break;
+            }
+
             m_d->swapDirection();
 
             if (firstPass) {
@@ -840,6 +954,8 @@ void KisScanlineFill::fillSelection(KisPixelSelectionSP pixelSelection, KisPaint
 
     using namespace KisColorSelectionPolicies;
 
+    m_d->startPixelBudget();
+
     CopyToSelectionPixelAccessPolicy pap(m_d->device, pixelSelection);
 
     if (m_d->closeGap > 0) {
@@ -857,6 +973,11 @@ void KisScanlineFill::fillSelection(KisPixelSelectionSP pixelSelection, KisPaint
         selectDifferencePolicyAndRun<OptimizedDifferencePolicy, SlowDifferencePolicy>
                                     (srcColor, sp, pap);
     }
+
+    // a large region is finished by the parallel fill
+    tryRunParallelSelectionFill<OptimizedDifferencePolicy, SlowDifferencePolicy,
+                                HardSelectionPolicy, SoftSelectionPolicy>
+                               (srcColor, boundarySelection, pixelSelection);
 }
 
 void KisScanlineFill::fillSelection(KisPixelSelectionSP pixelSelection)
@@ -866,6 +987,8 @@ void KisScanlineFill::fillSelection(KisPixelSelectionSP pixelSelection)
     const int softness = 100 - m_d->opacitySpread;
 
     using namespace KisColorSelectionPolicies;
+
+    m_d->startPixelBudget();
     
     CopyToSelectionPixelAccessPolicy pap(m_d->device, pixelSelection);
 
@@ -882,6 +1005,11 @@ void KisScanlineFill::fillSelection(KisPixelSelectionSP pixelSelection)
         selectDifferencePolicyAndRun<OptimizedDifferencePolicy, SlowDifferencePolicy>
                                     (srcColor, sp, pap);
     }
+
+    // a large region is finished by the parallel fill
+    tryRunParallelSelectionFill<OptimizedDifferencePolicy, SlowDifferencePolicy,
+                                HardSelectionPolicy, SoftSelectionPolicy>
+                               (srcColor, KisPaintDeviceSP(), pixelSelection);
 }
 
 void KisScanlineFill::fillSelectionUntilColor(KisPixelSelectionSP pixelSelection, const KoColor &boundaryColor, KisPaintDeviceSP boundarySelection)
@@ -892,6 +1020,8 @@ void KisScanlineFill::fillSelectionUntilColor(KisPixelSelectionSP pixelSelection
     const int softness = 100 - m_d->opacitySpread;
 
     using namespace KisColorSelectionPolicies;
+
+    m_d->startPixelBudget();
     
     CopyToSelectionPixelAccessPolicy pap(m_d->device, pixelSelection);
 
@@ -910,6 +1040,11 @@ void KisScanlineFill::fillSelectionUntilColor(KisPixelSelectionSP pixelSelection
         selectDifferencePolicyAndRun<OptimizedDifferencePolicy, SlowDifferencePolicy>
                                     (srcColor, sp, pap);
     }
+
+    // a large region is finished by the parallel fill
+    tryRunParallelSelectionFill<OptimizedDifferencePolicy, SlowDifferencePolicy,
+                                SelectAllUntilColorHardSelectionPolicy, SelectAllUntilColorSoftSelectionPolicy>
+                               (srcColor, boundarySelection, pixelSelection);
 }
 
 void KisScanlineFill::fillSelectionUntilColor(KisPixelSelectionSP pixelSelection, const KoColor &boundaryColor)
@@ -920,6 +1055,8 @@ void KisScanlineFill::fillSelectionUntilColor(KisPixelSelectionSP pixelSelection
     const int softness = 100 - m_d->opacitySpread;
 
     using namespace KisColorSelectionPolicies;
+
+    m_d->startPixelBudget();
     
     CopyToSelectionPixelAccessPolicy pap(m_d->device, pixelSelection);
 
@@ -938,6 +1075,11 @@ void KisScanlineFill::fillSelectionUntilColor(KisPixelSelectionSP pixelSelection
         selectDifferencePolicyAndRun<OptimizedDifferencePolicy, SlowDifferencePolicy>
                                     (srcColor, sp, pap);
     }
+
+    // a large region is finished by the parallel fill
+    tryRunParallelSelectionFill<OptimizedDifferencePolicy, SlowDifferencePolicy,
+                                SelectAllUntilColorHardSelectionPolicy, SelectAllUntilColorSoftSelectionPolicy>
+                               (srcColor, KisPaintDeviceSP(), pixelSelection);
 }
 
 void KisScanlineFill::fillSelectionUntilColorOrTransparent(KisPixelSelectionSP pixelSelection, const KoColor &boundaryColor, KisPaintDeviceSP boundarySelection)
@@ -948,6 +1090,8 @@ void KisScanlineFill::fillSelectionUntilColorOrTransparent(KisPixelSelectionSP p
     const int softness = 100 - m_d->opacitySpread;
 
     using namespace KisColorSelectionPolicies;
+
+    m_d->startPixelBudget();
     
     CopyToSelectionPixelAccessPolicy pap(m_d->device, pixelSelection);
 
@@ -968,6 +1112,11 @@ void KisScanlineFill::fillSelectionUntilColorOrTransparent(KisPixelSelectionSP p
                                      SlowColorOrTransparentDifferencePolicy>
                                     (srcColor, sp, pap);
     }
+
+    // a large region is finished by the parallel fill
+    tryRunParallelSelectionFill<OptimizedColorOrTransparentDifferencePolicy, SlowColorOrTransparentDifferencePolicy,
+                                SelectAllUntilColorHardSelectionPolicy, SelectAllUntilColorSoftSelectionPolicy>
+                               (srcColor, boundarySelection, pixelSelection);
 }
 
 void KisScanlineFill::fillSelectionUntilColorOrTransparent(KisPixelSelectionSP pixelSelection, const KoColor &boundaryColor)
@@ -978,6 +1127,8 @@ void KisScanlineFill::fillSelectionUntilColorOrTransparent(KisPixelSelectionSP p
     const int softness = 100 - m_d->opacitySpread;
 
     using namespace KisColorSelectionPolicies;
+
+    m_d->startPixelBudget();
     
     CopyToSelectionPixelAccessPolicy pap(m_d->device, pixelSelection);
 
@@ -998,6 +1149,11 @@ void KisScanlineFill::fillSelectionUntilColorOrTransparent(KisPixelSelectionSP p
                                      SlowColorOrTransparentDifferencePolicy>
                                     (srcColor, sp, pap);
     }
+
+    // a large region is finished by the parallel fill
+    tryRunParallelSelectionFill<OptimizedColorOrTransparentDifferencePolicy, SlowColorOrTransparentDifferencePolicy,
+                                SelectAllUntilColorHardSelectionPolicy, SelectAllUntilColorSoftSelectionPolicy>
+                               (srcColor, KisPaintDeviceSP(), pixelSelection);
 }
 
 void KisScanlineFill::clearNonZeroComponent()
@@ -1048,6 +1204,334 @@ void KisScanlineFill::fillContiguousGroup(KisPaintDeviceSP groupMapDevice, qint3
     runImpl(dp, sp, pap);
 }
 
+/**
+ * A tile-parallel version of the selection fill. It is used when no gap
+ * closing is requested and the scanline fill finds out that the region
+ * is large. It produces exactly the same result as the scanline fill
+ * (the region is 4-connected in both cases):
+ *
+ * 1) The fill bounds are split into patches and every patch is labeled
+ *    concurrently. The source device is read into a row buffer with
+ *    readBytes(), so no random accessor calls happen per pixel.
+ *
+ * 2) The labels of the neighbouring patches are merged sequentially
+ *    along the patch borders using a union-find structure.
+ *
+ * 3) The pixels of the component containing the start point are written
+ *    into the selection, again concurrently, patch by patch.
+ */
+template <typename DifferencePolicy, typename SelectionPolicy>
+void KisScanlineFill::runParallelSelectionFill(const DifferencePolicy &differencePolicy,
+                                               const SelectionPolicy &selectionPolicy,
+                                               KisPaintDeviceSP boundarySelection,
+                                               KisPixelSelectionSP pixelSelection)
+{
+    m_d->fillExtent = QRect();
+
+    const QRect bounds = m_d->boundingRect;
+    if (bounds.isEmpty() || !bounds.contains(m_d->startPoint)) return;
+
+    const int pixelSize = m_d->device->pixelSize();
+    const int patchSize = 256;
+
+    const int numColumns = (bounds.width() + patchSize - 1) / patchSize;
+    const int numRows = (bounds.height() + patchSize - 1) / patchSize;
+
+    QVector<FillPatch> patches(numColumns * numRows);
+
+    for (int row = 0; row < numRows; row++) {
+        for (int col = 0; col < numColumns; col++) {
+            const QRect rect(bounds.x() + col * patchSize,
+                             bounds.y() + row * patchSize,
+                             patchSize, patchSize);
+
+            patches[row * numColumns + col].rect = rect & bounds;
+        }
+    }
+
+    auto calculateOpacities =
+        [this, pixelSize, &differencePolicy, &selectionPolicy, boundarySelection]
+        (const QRect &rect, QVector<quint8> &opacities) {
+
+        const int numPixels = rect.width() * rect.height();
+
+        QVector<quint8> srcBuffer(numPixels * pixelSize);
+        m_d->device->readBytes(srcBuffer.data(), rect);
+
+        QVector<quint8> maskBuffer;
+        if (boundarySelection) {
+            maskBuffer.resize(numPixels);
+            boundarySelection->readBytes(maskBuffer.data(), rect);
+        }
+
+        // the difference policies cache the results internally,
+        // so every thread should have its own copy of them
+        DifferencePolicy dp(differencePolicy);
+        SelectionPolicy sp(selectionPolicy);
+
+        opacities.resize(numPixels);
+
+        const quint8 *srcPtr = srcBuffer.constData();
+        for (int i = 0; i < numPixels; i++, srcPtr += pixelSize) {
+            opacities[i] =
+                !maskBuffer.isEmpty() && maskBuffer[i] == MIN_SELECTED ?
+                MIN_SELECTED :
+                sp.opacityFromDifference(dp.difference(srcPtr));
+        }
+    };
+
+    // 1) label every patch locally
+
+    KritaUtils::processRangeConcurrently(patches.size(), 1,
+        [&patches, &calculateOpacities] (int begin, int end) {
+            QVector<quint8> opacities;
+            QVector<int> parent;
+
+            for (int i = begin; i < end; i++) {
+                FillPatch &patch = patches[i];
+                const QRect &rect = patch.rect;
+
+                calculateOpacities(rect, opacities);
+
+                patch.rowOffsets.resize(rect.height() + 1);
+                patch.runs.clear();
+
+                const quint8 *opacityPtr = opacities.constData();
+
+                for (int y = 0; y < rect.height(); y++) {
+                    patch.rowOffsets[y] = patch.runs.size();
+
+                    int runStart = -1;
+                    for (int x = 0; x < rect.width(); x++, opacityPtr++) {
+                        if (*opacityPtr) {
+                            if (runStart < 0) runStart = x;
+                        } else if (runStart >= 0) {
+                            patch.runs.append({rect.x() + runStart, rect.x() + x - 1, patch.runs.size()});
+                            runStart = -1;
+                        }
+                    }
+
+                    if (runStart >= 0) {
+                        patch.runs.append({rect.x() + runStart, rect.right(), patch.runs.size()});
+                    }
+                }
+                patch.rowOffsets[rect.height()] = patch.runs.size();
+
+                parent.resize(patch.runs.size());
+                std::iota(parent.begin(), parent.end(), 0);
+
+                for (int y = rect.top() + 1; y <= rect.bottom(); y++) {
+                    uniteOverlappingRuns(patch.rowBegin(y - 1), patch.rowEnd(y - 1),
+                                         patch.rowBegin(y), patch.rowEnd(y),
+                                         [&parent] (const FillRun &a, const FillRun &b) {
+                                             uniteLabels(parent, a.label, b.label);
+                                         });
+                }
+
+                // compact the labels to make the global union-find smaller
+                QVector<int> compactLabels(patch.runs.size(), -1);
+                int numLabels = 0;
+
+                for (FillRun &run : patch.runs) {
+                    const int root = findLabelRoot(parent, run.label);
+                    if (compactLabels[root] < 0) {
+                        compactLabels[root] = numLabels++;
+                    }
+                    run.label = compactLabels[root];
+                }
+
+                patch.numLabels = numLabels;
+            }
+        });
+
+    // 2) merge the labels along the patch borders
+
+    int totalLabels = 0;
+    for (FillPatch &patch : patches) {
+        patch.labelBase = totalLabels;
+        totalLabels += patch.numLabels;
+    }
+
+    QVector<int> parent(totalLabels);
+    std::iota(parent.begin(), parent.end(), 0);
+
+    for (int row = 0; row < numRows; row++) {
+        for (int col = 0; col < numColumns; col++) {
+            const FillPatch &patch = patches[row * numColumns + col];
+            const QRect &rect = patch.rect;
+
+            if (col + 1 < numColumns) {
+                const FillPatch &rightPatch = patches[row * numColumns + col + 1];
+
+                for (int y = rect.top(); y <= rect.bottom(); y++) {
+                    if (patch.rowBegin(y) == patch.rowEnd(y) ||
+                        rightPatch.rowBegin(y) == rightPatch.rowEnd(y)) continue;
+
+                    const FillRun &leftRun = *(patch.rowEnd(y) - 1);
+                    const FillRun &rightRun = *rightPatch.rowBegin(y);
+
+                    if (leftRun.end == rect.right() &&
+                        rightRun.start == rightPatch.rect.left()) {
+
+                        uniteLabels(parent,
+                                    patch.labelBase + leftRun.label,
+                                    rightPatch.labelBase + rightRun.label);
+                    }
+                }
+            }
+
+            if (row + 1 < numRows) {
+                const FillPatch &bottomPatch = patches[(row + 1) * numColumns + col];
+
+                uniteOverlappingRuns(patch.rowBegin(rect.bottom()), patch.rowEnd(rect.bottom()),
+                                     bottomPatch.rowBegin(bottomPatch.rect.top()),
+                                     bottomPatch.rowEnd(bottomPatch.rect.top()),
+                                     [&] (const FillRun &a, const FillRun &b) {
+                                         uniteLabels(parent,
+                                                     patch.labelBase + a.label,
+                                                     bottomPatch.labelBase + b.label);
+                                     });
+            }
+        }
+    }
+
+    // 3) find the component of the start point and write it into the selection
+
+    const QPoint startPoint = m_d->startPoint;
+    const int startColumn = (startPoint.x() - bounds.x()) / patchSize;
+    const int startRow = (startPoint.y() - bounds.y()) / patchSize;
+    const FillPatch &startPatch = patches[startRow * numColumns + startColumn];
+
+    int seedRoot = -1;
+    for (auto it = startPatch.rowBegin(startPoint.y()); it != startPatch.rowEnd(startPoint.y()); ++it) {
+        if (it->start <= startPoint.x() && startPoint.x() <= it->end) {
+            seedRoot = findLabelRoot(parent, startPatch.labelBase + it->label);
+            break;
+        }
+    }
+
+    if (seedRoot < 0) return;
+
+    QVector<bool> selectedLabels(totalLabels);
+    for (int i = 0; i < totalLabels; i++) {
+        selectedLabels[i] = findLabelRoot(parent, i) == seedRoot;
+    }
+
+    QVector<QRect> filledRects(patches.size());
+
+    KritaUtils::processRangeConcurrently(patches.size(), 1,
+        [&] (int begin, int end) {
+            QVector<quint8> opacities;
+            QVector<quint8> dstBuffer;
+
+            for (int i = begin; i < end; i++) {
+                const FillPatch &patch = patches[i];
+
+                QRect filledRect;
+                for (int y = patch.rect.top(); y <= patch.rect.bottom(); y++) {
+                    for (auto it = patch.rowBegin(y); it != patch.rowEnd(y); ++it) {
+                        if (selectedLabels[patch.labelBase + it->label]) {
+                            filledRect |= QRect(it->start, y, it->end - it->start + 1, 1);
+                        }
+                    }
+                }
+
+                if (filledRect.isEmpty()) continue;
+
+                calculateOpacities(filledRect, opacities);
+
+                dstBuffer.resize(filledRect.width() * filledRect.height());
+                pixelSelection->readBytes(dstBuffer.data(), filledRect);
+
+                for (int y = filledRect.top(); y <= filledRect.bottom(); y++) {
+                    const int rowOffset = (y - filledRect.top()) * filledRect.width() - filledRect.left();
+
+                    for (auto it = patch.rowBegin(y); it != patch.rowEnd(y); ++it) {
+                        if (!selectedLabels[patch.labelBase + it->label]) continue;
+
+                        for (int x = it->start; x <= it->end; x++) {
+                            dstBuffer[rowOffset + x] = opacities[rowOffset + x];
+                        }
+                    }
+                }
+
+                pixelSelection->writeBytes(dstBuffer.constData(), filledRect);
+                filledRects[i] = filledRect;
+            }
+        });
+
+    for (const QRect &rc : filledRects) {
+        m_d->fillExtent |= rc;
+    }
+}
+
+template <template <typename SrcPixelType> typename OptimizedDifferencePolicy,
+          typename SlowDifferencePolicy,
+          typename SelectionPolicy>
+void KisScanlineFill::selectDifferencePolicyAndRunParallel(const KoColor &srcColor,
+                                                           const SelectionPolicy &selectionPolicy,
+                                                           KisPaintDeviceSP boundarySelection,
+                                                           KisPixelSelectionSP pixelSelection)
+{
+    const int pixelSize = srcColor.colorSpace()->pixelSize();
+
+    if (pixelSize == 1) {
+        OptimizedDifferencePolicy<quint8> dp(srcColor, m_d->threshold);
+        runParallelSelectionFill(dp, selectionPolicy, boundarySelection, pixelSelection);
+    } else if (pixelSize == 2) {
+        OptimizedDifferencePolicy<quint16> dp(srcColor, m_d->threshold);
+        runParallelSelectionFill(dp, selectionPolicy, boundarySelection, pixelSelection);
+    } else if (pixelSize == 4) {
+        OptimizedDifferencePolicy<quint32> dp(srcColor, m_d->threshold);
+        runParallelSelectionFill(dp, selectionPolicy, boundarySelection, pixelSelection);
+    } else if (pixelSize == 8) {
+        OptimizedDifferencePolicy<quint64> dp(srcColor, m_d->threshold);
+        runParallelSelectionFill(dp, selectionPolicy, boundarySelection, pixelSelection);
+    } else {
+        SlowDifferencePolicy dp(srcColor, m_d->threshold);
+        runParallelSelectionFill(dp, selectionPolicy, boundarySelection, pixelSelection);
+    }
+}
+
+/**
+ * Finishes the selection fill with the parallel algorithm if the scanline
+ * fill has run out of its pixel budget. The pixels already filled by the
+ * scanline fill get exactly the same values, so they are just overwritten.
+ *
+ * The gap closing fill is a sequential priority-driven process, so
+ * the budget is never limited when the gaps should be closed.
+ * Returns false if the scanline fill has completed the region itself.
+ */
+template <template <typename SrcPixelType> typename OptimizedDifferencePolicy,
+          typename SlowDifferencePolicy,
+          typename HardSelectionPolicy,
+          typename SoftSelectionPolicy>
+bool KisScanlineFill::tryRunParallelSelectionFill(const KoColor &srcColor,
+                                                  KisPaintDeviceSP boundarySelection,
+                                                  KisPixelSelectionSP pixelSelection)
+{
+    const bool budgetExceeded = m_d->pixelBudgetExceeded;
+
+    m_d->pixelBudget = -1;
+    m_d->pixelBudgetExceeded = false;
+
+    if (!budgetExceeded) return false;
+
+    KIS_SAFE_ASSERT_RECOVER_RETURN_VALUE(m_d->closeGap == 0, false);
+
+    const int softness = 100 - m_d->opacitySpread;
+
+    if (softness == 0) {
+        selectDifferencePolicyAndRunParallel<OptimizedDifferencePolicy, SlowDifferencePolicy>
+            (srcColor, HardSelectionPolicy(m_d->threshold), boundarySelection, pixelSelection);
+    } else {
+        selectDifferencePolicyAndRunParallel<OptimizedDifferencePolicy, SlowDifferencePolicy>
+            (srcColor, SoftSelectionPolicy(m_d->threshold, softness), boundarySelection, pixelSelection);
+    }
+
+    return true;
+}
+
 /**
  * This opacity-only fill is used by KisGapMap.
  *
@@ -179,6 +179,28 @@ private:
 
     inline bool tryPushingCloseGapSeed(int x, int y, bool allowExpand);
 
+    template <typename DifferencePolicy, typename SelectionPolicy>
+    void runParallelSelectionFill(const DifferencePolicy &differencePolicy,
+                                  const SelectionPolicy &selectionPolicy,
+                                  KisPaintDeviceSP boundarySelection,
+                                  KisPixelSelectionSP pixelSelection);
+
+    template <template <typename SrcPixelType> typename OptimizedDifferencePolicy,
+              typename SlowDifferencePolicy,
+              typename SelectionPolicy>
+    void selectDifferencePolicyAndRunParallel(const KoColor &srcColor,
+                                              const SelectionPolicy &selectionPolicy,
+                                              KisPaintDeviceSP boundarySelection,
+                                              KisPixelSelectionSP pixelSelection);
+
+    template <template <typename SrcPixelType> typename OptimizedDifferencePolicy,
+              typename SlowDifferencePolicy,
+              typename HardSelectionPolicy,
+              typename SoftSelectionPolicy>
+    bool tryRunParallelSelectionFill(const KoColor &srcColor,
+                                     KisPaintDeviceSP boundarySelection,
+                                     KisPixelSelectionSP pixelSelection);
+
 private:
     void testingProcessLine(const KisFillInterval &processInterval);
     QVector<KisFillInterval> testingGetForwardIntervals() const;
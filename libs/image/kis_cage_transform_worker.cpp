@@ -18,6 +18,97 @@
 #include "krita_utils.h"
 
 #include <qnumeric.h>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QSharedPointer>
+
+namespace {
+
+/**
+ * Precalculating Green coordinates for every point of the grid is the
+ * most expensive part of the cage transformation. The coordinates depend
+ * on the source bounds, the original cage and the precision only, so they
+ * stay valid while the user drags the handles of the transformed cage.
+ */
+struct PrecalculatedGrid
+{
+    QRect srcBounds;
+    QVector<QPointF> origCage;
+    int pixelPrecision = 8;
+
+    QVector<int> allToValidPointsMap;
+    QVector<QPointF> validPoints;
+
+    /**
+     * Contains all points fo the grid including non-defined
+     * points (the ones which are placed outside the cage).
+     */
+    QVector<QPointF> allSrcPoints;
+
+    /**
+     * KisGreenCoordinatesMath keeps the normals of the transformed
+     * cage internally, so the grid cannot be used by two workers
+     * concurrently
+     */
+    QMutex mutex;
+    KisGreenCoordinatesMath cage;
+
+    QSize gridSize;
+
+    bool matches(const QRect &_srcBounds, const QVector<QPointF> &_origCage, int _pixelPrecision) const {
+        return srcBounds == _srcBounds &&
+            pixelPrecision == _pixelPrecision &&
+            origCage == _origCage;
+    }
+};
+
+typedef QSharedPointer<PrecalculatedGrid> PrecalculatedGridSP;
+
+}
+
+struct KisCageTransformWorker::GridCache
+{
+    PrecalculatedGridSP fetch(const QRect &srcBounds, const QVector<QPointF> &origCage, int pixelPrecision) {
+        QMutexLocker l(&m_mutex);
+
+        for (auto it = m_grids.begin(); it != m_grids.end(); ++it) {
+            if ((*it)->matches(srcBounds, origCage, pixelPrecision)) {
+                PrecalculatedGridSP grid = *it;
+                m_grids.erase(it);
+                m_grids.prepend(grid);
+                return grid;
+            }
+        }
+
+        return PrecalculatedGridSP();
+    }
+
+    void put(PrecalculatedGridSP grid) {
+        QMutexLocker l(&m_mutex);
+
+        m_grids.prepend(grid);
+        while (m_grids.size() > maxCachedGrids) {
+            m_grids.removeLast();
+        }
+    }
+
+    void clear() {
+        QMutexLocker l(&m_mutex);
+        m_grids.clear();
+    }
+
+private:
+    /**
+     * Only the preview uses the cache, the final transformation
+     * calculates its own grid. Keep one more grid than needed, so that
+     * going back to the previous original cage or preview precision
+     * (e.g. undo of an edit of the original cage) is still cheap.
+     */
+    static const int maxCachedGrids = 2;
+
+    QMutex m_mutex;
+    QList<PrecalculatedGridSP> m_grids;
+};
 
 struct Q_DECL_HIDDEN KisCageTransformWorker::Private
 {
@@ -40,21 +131,11 @@ struct Q_DECL_HIDDEN KisCageTransformWorker::Private
     KoUpdater *progress;
     int pixelPrecision;
 
-    QVector<int> allToValidPointsMap;
-    QVector<QPointF> validPoints;
-
-    /**
-     * Contains all points fo the grid including non-defined
-     * points (the ones which are placed outside the cage).
-     */
-    QVector<QPointF> allSrcPoints;
-
-    KisGreenCoordinatesMath cage;
-
-    QSize gridSize;
+    KisCageTransformWorker::GridCacheSP gridCache;
+    PrecalculatedGridSP grid;
 
     bool isGridEmpty() const {
-        return allSrcPoints.isEmpty();
+        return !grid || grid->allSrcPoints.isEmpty();
     }
 
 
@@ -93,6 +174,22 @@ KisCageTransformWorker::~KisCageTransformWorker()
 {
 }
 
+KisCageTransformWorker::GridCacheSP KisCageTransformWorker::createGridCache()
+{
+    return GridCacheSP(new GridCache());
+}
+
+void KisCageTransformWorker::clearGridCache(GridCacheSP cache)
+{
+    KIS_SAFE_ASSERT_RECOVER_RETURN(cache);
+    cache->clear();
+}
+
+void KisCageTransformWorker::setGridCache(GridCacheSP cache)
+{
+    m_d->gridCache = cache;
+}
+
 void KisCageTransformWorker::setTransformedCage(const QVector<QPointF> &transformedCage)
 {
     m_d->transfCage = transformedCage;
@@ -151,18 +248,29 @@ void KisCageTransformWorker::prepareTransform()
 
     // no need to process empty devices
     if (srcBounds.isEmpty()) return;
-    m_d->gridSize =
+
+    if (m_d->gridCache) {
+        m_d->grid = m_d->gridCache->fetch(srcBounds, m_d->origCage, m_d->pixelPrecision);
+        if (m_d->grid) return;
+    }
+
+    PrecalculatedGridSP grid(new PrecalculatedGrid());
+    grid->srcBounds = srcBounds;
+    grid->origCage = m_d->origCage;
+    grid->pixelPrecision = m_d->pixelPrecision;
+
+    grid->gridSize =
         GridIterationTools::calcGridSize(srcBounds, m_d->pixelPrecision);
 
     PointsFetcherOp pointsOp(srcPolygon);
     GridIterationTools::processGrid(pointsOp, srcBounds, m_d->pixelPrecision);
 
     const int numPoints = pointsOp.m_points.size();
-    KIS_ASSERT_RECOVER_RETURN(numPoints == m_d->gridSize.width() * m_d->gridSize.height());
+    KIS_ASSERT_RECOVER_RETURN(numPoints == grid->gridSize.width() * grid->gridSize.height());
 
-    m_d->allSrcPoints = pointsOp.m_points;
-    m_d->allToValidPointsMap.resize(pointsOp.m_points.size());
-    m_d->validPoints.resize(pointsOp.m_numValidPoints);
+    grid->allSrcPoints = pointsOp.m_points;
+    grid->allToValidPointsMap.resize(pointsOp.m_points.size());
+    grid->validPoints.resize(pointsOp.m_numValidPoints);
 
     {
         int validIdx = 0;
@@ -171,29 +279,37 @@ void KisCageTransformWorker::prepareTransform()
             const bool pointValid = pointsOp.m_pointValid[i];
 
             if (pointValid) {
-                m_d->validPoints[validIdx] = pt;
-                m_d->allToValidPointsMap[i] = validIdx;
+                grid->validPoints[validIdx] = pt;
+                grid->allToValidPointsMap[i] = validIdx;
                 validIdx++;
             } else {
-                m_d->allToValidPointsMap[i] = -1;
+                grid->allToValidPointsMap[i] = -1;
             }
         }
-        KIS_ASSERT_RECOVER_NOOP(validIdx == m_d->validPoints.size());
+        KIS_ASSERT_RECOVER_NOOP(validIdx == grid->validPoints.size());
     }
 
-    m_d->cage.precalculateGreenCoordinates(m_d->origCage, m_d->validPoints);
+    grid->cage.precalculateGreenCoordinates(m_d->origCage, grid->validPoints);
+
+    if (m_d->gridCache) {
+        m_d->gridCache->put(grid);
+    }
+    m_d->grid = grid;
 }
 
 QVector<QPointF> KisCageTransformWorker::Private::calculateTransformedPoints()
 {
-    cage.generateTransformedCageNormals(transfCage);
+    QVector<QPointF> transformedPoints;
 
+    {
+        QMutexLocker l(&grid->mutex);
+        transformedPoints = grid->cage.transformedPoints(transfCage);
+    }
+
+    const QVector<QPointF> &validPoints = grid->validPoints;
     const int numValidPoints = validPoints.size();
-    QVector<QPointF> transformedPoints(numValidPoints);
 
     for (int i = 0; i < numValidPoints; i++) {
-        transformedPoints[i] = cage.transformedPoint(i, transfCage);
-
         if (qIsNaN(transformedPoints[i].x()) ||
             qIsNaN(transformedPoints[i].y())) {
             warnKrita << "WARNING: One grid point has been removed from consideration" << validPoints[i];
@@ -211,10 +327,10 @@ calculateMappedIndexes(int col, int row,
 {
     *numExistingPoints = 0;
     QVector<int> cellIndexes =
-        GridIterationTools::calculateCellIndexes(col, row, gridSize);
+        GridIterationTools::calculateCellIndexes(col, row, grid->gridSize);
 
     for (int i = 0; i < 4; i++) {
-        cellIndexes[i] = allToValidPointsMap[cellIndexes[i]];
+        cellIndexes[i] = grid->allToValidPointsMap[cellIndexes[i]];
         *numExistingPoints += cellIndexes[i] >= 0;
     }
 
@@ -229,10 +345,10 @@ tryGetValidIndex(const QPoint &cellPt)
     int index = -1;
     if (cellPt.x() >= 0 &&
         cellPt.y() >= 0 &&
-        cellPt.x() < gridSize.width() - 1 &&
-        cellPt.y() < gridSize.height() - 1) {
+        cellPt.x() < grid->gridSize.width() - 1 &&
+        cellPt.y() < grid->gridSize.height() - 1) {
 
-        index = allToValidPointsMap[GridIterationTools::pointToIndex(cellPt, gridSize)];
+        index = grid->allToValidPointsMap[GridIterationTools::pointToIndex(cellPt, grid->gridSize)];
     }
 
     return index;
@@ -258,7 +374,7 @@ struct KisCageTransformWorker::Private::MapIndexesOp {
     }
 
     inline QPointF getSrcPointForce(const QPoint &cellPt) const {
-        return m_d->allSrcPoints[GridIterationTools::pointToIndex(cellPt, m_d->gridSize)];
+        return m_d->grid->allSrcPoints[GridIterationTools::pointToIndex(cellPt, m_d->grid->gridSize)];
     }
 
     inline const QPolygonF srcCropPolygon() const {
@@ -358,8 +474,8 @@ void KisCageTransformWorker::run(KisPaintDeviceSP srcDevice, KisPaintDeviceSP ds
     Private::MapIndexesOp indexesOp(m_d.data());
     GridIterationTools::iterateThroughGrid
         <GridIterationTools::IncompletePolygonPolicy>(polygonOp, indexesOp,
-                                                      m_d->gridSize,
-                                                      m_d->validPoints,
+                                                      m_d->grid->gridSize,
+                                                      m_d->grid->validPoints,
                                                       transformedPoints);
 
     QRect rect = tempDevice->extent();
@@ -420,8 +536,8 @@ QImage KisCageTransformWorker::runOnQImage(QPointF *newOffset)
     Private::MapIndexesOp indexesOp(m_d.data());
     GridIterationTools::iterateThroughGrid
         <GridIterationTools::IncompletePolygonPolicy>(polygonOp, indexesOp,
-                                                      m_d->gridSize,
-                                                      m_d->validPoints,
+                                                      m_d->grid->gridSize,
+                                                      m_d->grid->validPoints,
                                                       transformedPoints);
 
     {
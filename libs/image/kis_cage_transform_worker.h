@@ -8,6 +8,7 @@
 #define __KIS_CAGE_TRANSFORM_WORKER_H
 
 #include <QScopedPointer>
+#include <QSharedPointer>
 #include <kritaimage_export.h>
 #include <kis_types.h>
 
@@ -29,6 +30,21 @@ public:
 
     ~KisCageTransformWorker();
 
+    /**
+     * The cache of the precalculated Green coordinates. The coordinates
+     * depend on the original cage only, so the owner of the cache (e.g.
+     * the preview of the tool) may reuse them while the user drags the
+     * handles of the cage. The owner should clear the cache as soon as
+     * the transformation is finished, the grids are quite big.
+     */
+    struct GridCache;
+    typedef QSharedPointer<GridCache> GridCacheSP;
+
+    static GridCacheSP createGridCache();
+    static void clearGridCache(GridCacheSP cache);
+
+    void setGridCache(GridCacheSP cache);
+
     void prepareTransform();
     void setTransformedCage(const QVector<QPointF> &transformedCage);
     void run(KisPaintDeviceSP srcDevice, KisPaintDeviceSP dstDevice);
@@ -9,6 +9,7 @@
 #include <cmath>
 #include <kis_global.h>
 #include <kis_algebra_2d.h>
+#include <KisConcurrentRangeUtils.h>
 using namespace KisAlgebra2D;
 
 
@@ -139,15 +140,22 @@ void KisGreenCoordinatesMath::precalculateGreenCoordinates(const QVector<QPointF
 
     m_d->precalculatedCoords.resize(numPoints);
 
-    for (int i = 0; i < numPoints; i++) {
-        m_d->precalculatedCoords[i].psi.resize(numCagePoints);
-        m_d->precalculatedCoords[i].phi.resize(numCagePoints);
-
-        m_d->precalculateOnePoint(originalCage,
-                                  &m_d->precalculatedCoords[i],
-                                  points[i],
-                                  cageDirection);
-    }
+    /**
+     * Every point is calculated independently, so we can easily
+     * split the calculation between all the available cores
+     */
+    KritaUtils::processRangeConcurrently(numPoints, 256,
+        [this, &originalCage, &points, numCagePoints, cageDirection] (int begin, int end) {
+            for (int i = begin; i < end; i++) {
+                m_d->precalculatedCoords[i].psi.resize(numCagePoints);
+                m_d->precalculatedCoords[i].phi.resize(numCagePoints);
+
+                m_d->precalculateOnePoint(originalCage,
+                                          &m_d->precalculatedCoords[i],
+                                          points[i],
+                                          cageDirection);
+            }
+        });
 }
 
 void KisGreenCoordinatesMath::generateTransformedCageNormals(const QVector<QPointF> &transformedCage)
@@ -189,3 +197,20 @@ QPointF KisGreenCoordinatesMath::transformedPoint(int pointIndex, const QVector<
     return result;
 }
 
+
+QVector<QPointF> KisGreenCoordinatesMath::transformedPoints(const QVector<QPointF> &transformedCage)
+{
+    generateTransformedCageNormals(transformedCage);
+
+    const int numPoints = m_d->precalculatedCoords.size();
+    QVector<QPointF> result(numPoints);
+
+    KritaUtils::processRangeConcurrently(numPoints, 1024,
+        [this, &transformedCage, &result] (int begin, int end) {
+            for (int i = begin; i < end; i++) {
+                result[i] = transformedPoint(i, transformedCage);
+            }
+        });
+
+    return result;
+}
@@ -39,6 +39,13 @@ public:
      */
     QPointF transformedPoint(int pointIndex, const QVector<QPointF> &transformedCage);
 
+    /**
+     * Transform all the precalculated points according to the
+     * \p transformedCage. The points are processed concurrently.
+     * Implicitly calls generateTransformedCageNormals().
+     */
+    QVector<QPointF> transformedPoints(const QVector<QPointF> &transformedCage);
+
 private:
     struct Private;
     const QScopedPointer<Private> m_d;
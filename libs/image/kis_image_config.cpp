@@ -561,6 +561,51 @@ void KisImageConfig::setUseLodForColorizeMask(bool value)
     m_config.writeEntry("useLodForColorizeMask", value);
 }
 
+bool KisImageConfig::useMultiResolutionColorizeMask(bool requestDefault) const
+{
+    return !requestDefault ?
+        m_config.readEntry("useMultiResolutionColorizeMask", false) : false;
+}
+
+void KisImageConfig::setUseMultiResolutionColorizeMask(bool value)
+{
+    m_config.writeEntry("useMultiResolutionColorizeMask", value);
+}
+
+int KisImageConfig::multiResolutionColorizeMaskMinPixels(bool requestDefault) const
+{
+    const int defaultValue = 4 * 1024 * 1024;
+    return !requestDefault ?
+        m_config.readEntry("multiResolutionColorizeMaskMinPixels", defaultValue) : defaultValue;
+}
+
+void KisImageConfig::setMultiResolutionColorizeMaskMinPixels(int value)
+{
+    m_config.writeEntry("multiResolutionColorizeMaskMinPixels", value);
+}
+
+bool KisImageConfig::useParallelKraLoading(bool requestDefault) const
+{
+    return !requestDefault ?
+        m_config.readEntry("useParallelKraLoading", true) : true;
+}
+
+void KisImageConfig::setUseParallelKraLoading(bool value)
+{
+    m_config.writeEntry("useParallelKraLoading", value);
+}
+
+bool KisImageConfig::lazyTileLoading(bool requestDefault) const
+{
+    return !requestDefault ?
+        m_config.readEntry("lazyTileLoading", false) : false;
+}
+
+void KisImageConfig::setLazyTileLoading(bool value)
+{
+    m_config.writeEntry("lazyTileLoading", value);
+}
+
 int KisImageConfig::maxNumberOfThreads(bool defaultValue) const
 {
     return (defaultValue ? QThread::idealThreadCount() : m_config.readEntry("maxNumberOfThreads", QThread::idealThreadCount()));
@@ -597,6 +642,17 @@ void KisImageConfig::setFrameRenderingTimeout(int value)
     m_config.writeEntry("frameRenderingTimeout", value);
 }
 
+int KisImageConfig::frameEncodingMemoryLimit(bool defaultValue) const
+{
+    const int defaultLimit = 1024; // MiB
+    return defaultValue ? defaultLimit : m_config.readEntry("frameEncodingMemoryLimit", defaultLimit);
+}
+
+void KisImageConfig::setFrameEncodingMemoryLimit(int value)
+{
+    m_config.writeEntry("frameEncodingMemoryLimit", value);
+}
+
 int KisImageConfig::fpsLimit(bool defaultValue) const
 {
     int limit = defaultValue ? 100 : m_config.readEntry("fpsLimit", 100);
@@ -668,6 +724,56 @@ void KisImageConfig::setAnimationCacheRegionOfInterestMargin(qreal value)
     m_config.writeEntry("animationCacheRegionOfInterestMargin", value);
 }
 
+bool KisImageConfig::useAnimationCacheCompression(bool defaultValue) const
+{
+    return defaultValue ? true : m_config.readEntry("useAnimationCacheCompression", true);
+}
+
+void KisImageConfig::setUseAnimationCacheCompression(bool value)
+{
+    m_config.writeEntry("useAnimationCacheCompression", value);
+}
+
+bool KisImageConfig::usePersistentAnimationCache(bool defaultValue) const
+{
+    return defaultValue ? false : m_config.readEntry("usePersistentAnimationCache", false);
+}
+
+void KisImageConfig::setUsePersistentAnimationCache(bool value)
+{
+    m_config.writeEntry("usePersistentAnimationCache", value);
+}
+
+int KisImageConfig::persistentAnimationCacheSize(bool defaultValue) const
+{
+    return defaultValue ? 1024 : m_config.readEntry("persistentAnimationCacheSize", 1024);
+}
+
+void KisImageConfig::setPersistentAnimationCacheSize(int value)
+{
+    m_config.writeEntry("persistentAnimationCacheSize", value);
+}
+
+int KisImageConfig::animationCacheMemoryLimit(bool defaultValue) const
+{
+    return defaultValue ? 0 : m_config.readEntry("animationCacheMemoryLimit", 0);
+}
+
+void KisImageConfig::setAnimationCacheMemoryLimit(int value)
+{
+    m_config.writeEntry("animationCacheMemoryLimit", value);
+}
+
+int KisImageConfig::layerStyleMaskCacheSize(bool defaultValue) const
+{
+    return defaultValue ? 256 : m_config.readEntry("layerStyleMaskCacheSize", 256);
+}
+
+void KisImageConfig::setLayerStyleMaskCacheSize(int value)
+{
+    m_config.writeEntry("layerStyleMaskCacheSize", value);
+}
+
 qreal KisImageConfig::selectionOutlineOpacity(bool defaultValue) const
 {
     return defaultValue ? 1.0 : m_config.readEntry("selectionOutlineOpacity", 1.0);
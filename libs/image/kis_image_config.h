@@ -102,6 +102,18 @@ public:
     bool useLodForColorizeMask(bool requestDefault = false) const;
     void setUseLodForColorizeMask(bool value);
 
+    bool useMultiResolutionColorizeMask(bool requestDefault = false) const;
+    void setUseMultiResolutionColorizeMask(bool value);
+
+    int multiResolutionColorizeMaskMinPixels(bool requestDefault = false) const;
+    void setMultiResolutionColorizeMaskMinPixels(int value);
+
+    bool useParallelKraLoading(bool requestDefault = false) const;
+    void setUseParallelKraLoading(bool value);
+
+    bool lazyTileLoading(bool requestDefault = false) const;
+    void setLazyTileLoading(bool value);
+
     int maxNumberOfThreads(bool defaultValue = false) const;
     void setMaxNumberOfThreads(int value);
 
@@ -111,6 +123,14 @@ public:
     int frameRenderingTimeout(bool defaultValue = false) const;
     void setFrameRenderingTimeout(int value);
 
+    /**
+     * The amount of memory (in MiB) that the rendered frames waiting
+     * for being encoded may occupy during the export of an animation.
+     * Zero means the frames are encoded right in the rendering threads.
+     */
+    int frameEncodingMemoryLimit(bool defaultValue = false) const;
+    void setFrameEncodingMemoryLimit(int value);
+
     int fpsLimit(bool defaultValue = false) const;
     void setFpsLimit(int value);
 
@@ -132,6 +152,45 @@ public:
     qreal animationCacheRegionOfInterestMargin(bool defaultValue = false) const;
     void setAnimationCacheRegionOfInterestMargin(qreal value);
 
+    /**
+     * When disabled, the frames swapped out to disk are stored without
+     * compression, which is faster, but takes more disk space.
+     */
+    bool useAnimationCacheCompression(bool defaultValue = false) const;
+    void setUseAnimationCacheCompression(bool value);
+
+    /**
+     * When enabled, the animation cache of an unmodified document is
+     * kept on disk after the document is closed and is reused when the
+     * same version of the file is opened again.
+     */
+    bool usePersistentAnimationCache(bool defaultValue = false) const;
+    void setUsePersistentAnimationCache(bool value);
+
+    /**
+     * The amount of disk space (in MiB) the kept animation caches of
+     * all the documents may occupy. The caches of the documents that
+     * have been opened least recently are removed first.
+     */
+    int persistentAnimationCacheSize(bool defaultValue = false) const;
+    void setPersistentAnimationCacheSize(int value);
+
+    /**
+     * The amount of memory (in MiB) the animation cache may occupy.
+     * When the limit is reached, the frames farthest from the playhead
+     * are dropped first. Zero means the cache is not limited.
+     */
+    int animationCacheMemoryLimit(bool defaultValue = false) const;
+    void setAnimationCacheMemoryLimit(int value);
+
+    /**
+     * The amount of memory (in MiB) the cached intermediate masks of the
+     * layer styles of all the open images may occupy. The masks that have
+     * been used least recently are dropped first.
+     */
+    int layerStyleMaskCacheSize(bool defaultValue = false) const;
+    void setLayerStyleMaskCacheSize(int value);
+
     qreal selectionOutlineOpacity(bool defaultValue = false) const;
     void setSelectionOutlineOpacity(qreal value);
 
@@ -2201,6 +2201,23 @@ namespace Private {
             });
     }
 
+    void purgeAllLodData(KisNodeSP root)
+    {
+        KisPaintDeviceList devices;
+
+        recursiveApplyNodes(root,
+            [&devices] (KisNodeSP node) {
+                devices << node->getLodCapableDevices();
+            });
+
+        KritaUtils::makeContainerUnique(devices);
+
+        Q_FOREACH (KisPaintDeviceSP device, devices) {
+            if (!device) continue;
+            device->purgeLodData();
+        }
+    }
+
     void forceAllHiddenOriginalsUpdate(KisNodeSP root)
     {
         KisLayerUtils::recursiveApplyNodes(root,
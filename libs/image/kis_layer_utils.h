@@ -54,6 +54,17 @@ namespace KisLayerUtils
     KRITAIMAGE_EXPORT void forceAllDelayedNodesUpdate(KisNodeSP root);
     KRITAIMAGE_EXPORT bool hasDelayedNodeWithUpdates(KisNodeSP root);
 
+    /**
+     * Drops the level-of-detail planes of all the devices in the
+     * subtree of \p root. Should be used only for the images that
+     * are not shown on canvas, e.g. for the clones made for saving.
+     * The pixel data of such clones is shared with the source image
+     * via copy-on-write, so the LoD planes are the only part of the
+     * clone that is not needed for saving and still pins the tiles
+     * the source image replaces while the document is being saved.
+     */
+    KRITAIMAGE_EXPORT void purgeAllLodData(KisNodeSP root);
+
     KRITAIMAGE_EXPORT void forceAllHiddenOriginalsUpdate(KisNodeSP root);
 
     KRITAIMAGE_EXPORT KisNodeList sortAndFilterMergeableInternalNodes(KisNodeList nodes, bool allowMasks = false);
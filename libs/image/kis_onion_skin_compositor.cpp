@@ -6,6 +6,8 @@
 
 #include "kis_onion_skin_compositor.h"
 
+#include <algorithm>
+
 #include "kis_paint_device.h"
 #include "kis_painter.h"
 #include "KoColor.h"
@@ -14,9 +16,68 @@
 #include "KoColorSpaceConstants.h"
 #include "kis_image_config.h"
 #include "kis_raster_keyframe_channel.h"
+#include "kis_paint_device_frames_interface.h"
+#include "KoCompositeOp.h"
+#include "krita_utils.h"
 
 Q_GLOBAL_STATIC(KisOnionSkinCompositor, s_instance)
 
+namespace {
+
+/**
+ * The skins are composited patch by patch, the size
+ * of a patch is equal to the size of a tile
+ */
+const int fusedPatchSize = 64;
+
+/**
+ * The maximum amount of memory (in bytes) the tinted
+ * frames of a single layer may occupy
+ */
+const qint64 maxTintedFramesBytes = 256 * 1024 * 1024;
+
+}
+
+struct KisOnionSkinCompositor::TintedFramesCache::Private
+{
+    struct Entry {
+        /**
+         * The revisions are unique among all the data managers,
+         * so the revision identifies the content of the frame
+         */
+        quint64 contentRevision = 0;
+        QPoint offset;
+        QColor tintColor;
+        int tintFactor = 0;
+        const KoColorSpace *colorSpace = 0;
+
+        QRect tintedRect;
+        bool hasOpaqueDefaultPixel = false;
+        KisPaintDeviceSP device;
+
+        qint64 bytes() const {
+            return qint64(tintedRect.width()) * tintedRect.height() * device->pixelSize();
+        }
+    };
+
+    // the most recently used entries go first
+    QList<Entry> entries;
+};
+
+KisOnionSkinCompositor::TintedFramesCache::TintedFramesCache()
+    : m_d(new Private)
+{
+}
+
+KisOnionSkinCompositor::TintedFramesCache::~TintedFramesCache()
+{
+}
+
+void KisOnionSkinCompositor::TintedFramesCache::clear()
+{
+    m_d->entries.clear();
+}
+
 struct KisOnionSkinCompositor::Private
 {
     int numberOfSkins = 0;
@@ -60,17 +121,28 @@ struct KisOnionSkinCompositor::Private
         return channel->keyframeAt<KisRasterKeyframe>(outFrame);
     }
 
-    void tryCompositeFrame(KisRasterKeyframeSP keyframe, KisPainter &gcFrame, KisPainter &gcDest, KisPaintDeviceSP tintSource, int opacity, const QRect &rect)
+    struct Skin {
+        KisPaintDeviceSP device;
+        QRect rect;
+        quint8 opacity;
+    };
+
+    void tryAddSkin(QVector<Skin> &skins, KisPaintDeviceSP sourceDevice, KisRasterKeyframeSP keyframe,
+                    const QColor &tintColor, int opacity, const QRect &rect, TintedFramesCache *cache)
     {
         if (keyframe.isNull() || opacity == OPACITY_TRANSPARENT_U8) return;
 
-        keyframe->writeFrameToDevice(gcFrame.device());
+        Skin skin;
+        skin.device = tintedFrame(sourceDevice, keyframe, tintColor, rect, cache, &skin.rect);
+        skin.opacity = opacity;
+        skins.append(skin);
+    }
 
-        gcFrame.bitBlt(rect.topLeft(), tintSource, rect);
+    KisPaintDeviceSP tintedFrame(KisPaintDeviceSP sourceDevice, KisRasterKeyframeSP keyframe,
+                                 const QColor &tintColor, const QRect &rect,
+                                 TintedFramesCache *cache, QRect *tintedRect);
 
-        gcDest.setOpacity(opacity);
-        gcDest.bitBlt(rect.topLeft(), gcFrame.device(), rect);
-    }
+    void compositeSkins(const QVector<Skin> &skins, KisPaintDeviceSP targetDevice, const QRect &rect);
 
     void refreshConfig()
     {
@@ -133,46 +205,166 @@ QSet<int> KisOnionSkinCompositor::colorLabelFilter()
     return m_d->colorLabelFilter;
 }
 
-void KisOnionSkinCompositor::composite(const KisPaintDeviceSP sourceDevice, KisPaintDeviceSP targetDevice, const QRect& rect)
+void KisOnionSkinCompositor::composite(const KisPaintDeviceSP sourceDevice, KisPaintDeviceSP targetDevice, const QRect& rect,
+                                       TintedFramesCache *tintedFrames)
 {
     KisRasterKeyframeChannel *keyframes = sourceDevice->keyframeChannel();
 
-    KisPaintDeviceSP frameDevice = new KisPaintDevice(sourceDevice->colorSpace());
-    KisPainter gcFrame(frameDevice);
-    QBitArray channelFlags = sourceDevice->colorSpace()->channelFlags(true, false);
-    gcFrame.setChannelFlags(channelFlags);
-    gcFrame.setOpacity(m_d->tintFactor);
-
-    KisPaintDeviceSP backwardTintDevice = m_d->setUpTintDevice(m_d->backwardTintColor, sourceDevice->colorSpace());
-    KisPaintDeviceSP forwardTintDevice = m_d->setUpTintDevice(m_d->forwardTintColor, sourceDevice->colorSpace());
-
-    KisPainter gcDest(targetDevice);
-    gcDest.setCompositeOpId(sourceDevice->colorSpace()->compositeOp(COMPOSITE_BEHIND));
+    if (!keyframes) { // it happens when you try to show onion skins on non-animated layer with opacity keyframes
+        return;
+    }
 
     int keyframeTimeBck;
     int keyframeTimeFwd;
 
-    int time = sourceDevice->defaultBounds()->currentTime();
+    const bool hasVisibleSkins =
+        std::any_of(m_d->backwardOpacities.begin(), m_d->backwardOpacities.end(), [] (int opacity) { return opacity > 0; }) ||
+        std::any_of(m_d->forwardOpacities.begin(), m_d->forwardOpacities.end(), [] (int opacity) { return opacity > 0; });
 
-    if (!keyframes) { // it happens when you try to show onion skins on non-animated layer with opacity keyframes
+    // the onion skins are switched off, don't keep the tinted frames around
+    if (!hasVisibleSkins) {
+        if (tintedFrames) {
+            tintedFrames->clear();
+        }
         return;
     }
 
+    int time = sourceDevice->defaultBounds()->currentTime();
+
     keyframeTimeBck = keyframeTimeFwd = keyframes->activeKeyframeTime(time);
 
+    QVector<Private::Skin> skins;
+
     for (int offset = 1; offset <= m_d->numberOfSkins; offset++) {
         KisRasterKeyframeSP backKeyframe = m_d->getNextFrameToComposite(keyframes, keyframeTimeBck, true);
         KisRasterKeyframeSP forwardKeyframe = m_d->getNextFrameToComposite(keyframes, keyframeTimeFwd, false);
 
-        if (!backKeyframe.isNull()) {
-            m_d->tryCompositeFrame(backKeyframe, gcFrame, gcDest, backwardTintDevice, m_d->skinOpacity(-offset), rect);
+        m_d->tryAddSkin(skins, sourceDevice, backKeyframe, m_d->backwardTintColor, m_d->skinOpacity(-offset), rect, tintedFrames);
+        m_d->tryAddSkin(skins, sourceDevice, forwardKeyframe, m_d->forwardTintColor, m_d->skinOpacity(offset), rect, tintedFrames);
+    }
+
+    m_d->compositeSkins(skins, targetDevice, rect);
+}
+
+KisPaintDeviceSP KisOnionSkinCompositor::Private::tintedFrame(KisPaintDeviceSP sourceDevice, KisRasterKeyframeSP keyframe,
+                                                              const QColor &tintColor, const QRect &rect,
+                                                              TintedFramesCache *cache, QRect *tintedRect)
+{
+    typedef TintedFramesCache::Private::Entry Entry;
+
+    KisPaintDeviceFramesInterface *frames = sourceDevice->framesInterface();
+    const KoColorSpace *colorSpace = sourceDevice->colorSpace();
+    const int frameId = keyframe->frameID();
+
+    Entry entry;
+    entry.contentRevision = frames->frameContentRevision(frameId);
+    entry.offset = frames->frameOffset(frameId);
+    entry.tintColor = tintColor;
+    entry.tintFactor = tintFactor;
+    entry.colorSpace = colorSpace;
+
+    if (cache) {
+        QList<Entry> &entries = cache->m_d->entries;
+
+        for (int i = 0; i < entries.size(); i++) {
+            const Entry &cached = entries[i];
+
+            if (cached.contentRevision == entry.contentRevision &&
+                cached.offset == entry.offset &&
+                cached.tintColor == entry.tintColor &&
+                cached.tintFactor == entry.tintFactor &&
+                *cached.colorSpace == *entry.colorSpace &&
+                (!cached.hasOpaqueDefaultPixel || cached.tintedRect.contains(rect))) {
+
+                entries.move(i, 0);
+                *tintedRect = entries.first().tintedRect;
+                return entries.first().device;
+            }
         }
+    }
+
+    entry.device = new KisPaintDevice(colorSpace);
+    keyframe->writeFrameToDevice(entry.device);
+
+    /**
+     * The pixels outside the extent of the frame are fully
+     * transparent in most of the cases, so they don't need
+     * any tinting. Otherwise only the requested rect is valid.
+     */
+    entry.hasOpaqueDefaultPixel = entry.device->defaultPixel().opacityU8() != OPACITY_TRANSPARENT_U8;
+    entry.tintedRect = entry.hasOpaqueDefaultPixel ? rect | entry.device->extent() : entry.device->extent();
+
+    KisPainter gcFrame(entry.device);
+    gcFrame.setChannelFlags(colorSpace->channelFlags(true, false));
+    gcFrame.setOpacity(tintFactor);
+    gcFrame.bitBlt(entry.tintedRect.topLeft(), setUpTintDevice(tintColor, colorSpace), entry.tintedRect);
+
+    *tintedRect = entry.tintedRect;
+
+    if (cache) {
+        QList<Entry> &entries = cache->m_d->entries;
+        entries.prepend(entry);
+
+        // keep the skins of the neighbouring frames as well
+        const int maxEntries = 2 * (numberOfSkins + 1);
 
-        if (!forwardKeyframe.isNull()) {
-            m_d->tryCompositeFrame(forwardKeyframe, gcFrame, gcDest, forwardTintDevice, m_d->skinOpacity(offset), rect);
+        qint64 totalBytes = 0;
+        for (int i = 0; i < entries.size(); i++) {
+            totalBytes += entries[i].bytes();
+
+            if (i > 0 && (i >= maxEntries || totalBytes > maxTintedFramesBytes)) {
+                entries.erase(entries.begin() + i, entries.end());
+                break;
+            }
         }
     }
 
+    return entry.device;
+}
+
+void KisOnionSkinCompositor::Private::compositeSkins(const QVector<Skin> &skins, KisPaintDeviceSP targetDevice, const QRect &rect)
+{
+    if (skins.isEmpty()) return;
+
+    const KoColorSpace *colorSpace = skins.first().device->colorSpace();
+    KIS_SAFE_ASSERT_RECOVER_RETURN(*targetDevice->colorSpace() == *colorSpace);
+
+    const KoCompositeOp *op = colorSpace->compositeOp(COMPOSITE_BEHIND);
+    const int pixelSize = colorSpace->pixelSize();
+
+    QVector<quint8> dstBuffer;
+    QVector<quint8> srcBuffer;
+
+    /**
+     * All the skins are composited into the patch of the target device
+     * at once, so the target is read and written only once
+     */
+    Q_FOREACH (const QRect &patch, KritaUtils::splitRectIntoPatches(rect, QSize(fusedPatchSize, fusedPatchSize))) {
+        const bool hasSkins =
+            std::any_of(skins.begin(), skins.end(),
+                        [patch] (const Skin &skin) { return skin.rect.intersects(patch); });
+
+        if (!hasSkins) continue;
+
+        const int rowStride = patch.width() * pixelSize;
+        dstBuffer.resize(rowStride * patch.height());
+        srcBuffer.resize(rowStride * patch.height());
+
+        targetDevice->readBytes(dstBuffer.data(), patch);
+
+        Q_FOREACH (const Skin &skin, skins) {
+            if (!skin.rect.intersects(patch)) continue;
+
+            skin.device->readBytes(srcBuffer.data(), patch);
+            op->composite(dstBuffer.data(), rowStride,
+                          srcBuffer.data(), rowStride,
+                          0, 0,
+                          patch.height(), patch.width(),
+                          skin.opacity);
+        }
+
+        targetDevice->writeBytes(dstBuffer.data(), patch);
+    }
 }
 
 QRect KisOnionSkinCompositor::calculateFullExtent(const KisPaintDeviceSP device)
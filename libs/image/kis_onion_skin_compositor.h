@@ -19,7 +19,38 @@ public:
     ~KisOnionSkinCompositor() override;
     static KisOnionSkinCompositor *instance();
 
-    void composite(const KisPaintDeviceSP sourceDevice, KisPaintDeviceSP targetDevice, const QRect &rect);
+    /**
+     * Keeps the tinted versions of the frames used as onion skins, so
+     * that they could be reused when the current time is moved to a
+     * neighbouring frame. A tinted frame is valid until the content of
+     * the frame, its tint color or the tint factor is changed. The
+     * number of the frames and the memory they take are limited, the
+     * least recently used frames are dropped first. The cache is cleared
+     * when the onion skins are switched off.
+     *
+     * The cache is not thread-safe, the caller should guard it.
+     */
+    class KRITAIMAGE_EXPORT TintedFramesCache
+    {
+    public:
+        TintedFramesCache();
+        ~TintedFramesCache();
+
+        void clear();
+
+    private:
+        friend class KisOnionSkinCompositor;
+        struct Private;
+        const QScopedPointer<Private> m_d;
+    };
+
+    /**
+     * Composites the onion skins of \p sourceDevice into \p targetDevice.
+     * When \p tintedFrames is passed, the tinted frames are fetched from
+     * it and the newly tinted ones are added into it.
+     */
+    void composite(const KisPaintDeviceSP sourceDevice, KisPaintDeviceSP targetDevice, const QRect &rect,
+                   TintedFramesCache *tintedFrames = nullptr);
 
     QRect calculateFullExtent(const KisPaintDeviceSP device);
     QRect calculateExtent(const KisPaintDeviceSP device, int time);
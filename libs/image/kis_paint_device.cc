@@ -1185,6 +1185,11 @@ int KisPaintDevice::sequenceNumber() const
     return m_d->cache()->sequenceNumber();
 }
 
+quint64 KisPaintDevice::contentRevision() const
+{
+    return m_d->dataManager()->revision();
+}
+
 void KisPaintDevice::estimateMemoryStats(qint64 &imageData, qint64 &temporaryData, qint64 &lodData) const
 {
     m_d->estimateMemoryStats(imageData, temporaryData, lodData);
@@ -2169,6 +2174,12 @@ void KisPaintDevice::generateLodCloneDevice(KisPaintDeviceSP dst, const QRect &o
     m_d->generateLodCloneDevice(dst, originalRect, lod);
 }
 
+void KisPaintDevice::purgeLodData()
+{
+    QMutexLocker l(&m_d->m_dataSwitchLock);
+    m_d->m_lodData.reset();
+}
+
 void KisPaintDevice::setSupportsWraparoundMode(bool value)
 {
     m_d->supportsWrapAroundMode = value;
@@ -2312,6 +2323,11 @@ void KisPaintDeviceFramesInterface::invalidateFrameCache(int frameId)
     return q->m_d->invalidateFrameCache(frameId);
 }
 
+quint64 KisPaintDeviceFramesInterface::frameContentRevision(int frameId) const
+{
+    return frameDataManager(frameId)->revision();
+}
+
 void KisPaintDeviceFramesInterface::setFrameOffset(int frameId, const QPoint &offset)
 {
     KIS_ASSERT_RECOVER_RETURN(frameId >= 0);
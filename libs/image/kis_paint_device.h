@@ -824,6 +824,16 @@ public:
      */
     int sequenceNumber() const;
 
+    /**
+     * \return the revision of the pixel data of the current frame of
+     *         the device. Unlike sequenceNumber(), it changes on every
+     *         write into the pixel data, including writeBytes(), bitBlt
+     *         and undo/redo, and it is unique among all paint devices.
+     *
+     * \see KisTiledDataManager::revision()
+     */
+    quint64 contentRevision() const;
+
 
     void estimateMemoryStats(qint64 &imageData, qint64 &temporaryData, qint64 &lodData) const;
 
@@ -924,6 +934,18 @@ public:
 
     void generateLodCloneDevice(KisPaintDeviceSP dst, const QRect &originalRect, int lod);
 
+    /**
+     * Drops the level-of-detail plane of the device. The plane is
+     * recreated on the next access in LoD mode and gets filled by the
+     * next LoD sync, so the function is only useful for the devices
+     * that will never be used in LoD mode again, e.g. the devices of
+     * an image cloned for saving. Otherwise the clone keeps the LoD
+     * tiles of the source alive after the source regenerates them.
+     *
+     * NOTE: the device must not be accessed in LoD mode concurrently
+     */
+    void purgeLodData();
+
     void setSupportsWraparoundMode(bool value);
     bool supportsWraproundMode() const;
 
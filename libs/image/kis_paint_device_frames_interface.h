@@ -117,6 +117,12 @@ public:
      */
     void invalidateFrameCache(int frameId);
 
+    /**
+     * Returns the revision of the pixel data of \p frameId, which is
+     * changed on every write into the frame (see KisTiledDataManager::revision())
+     */
+    quint64 frameContentRevision(int frameId) const;
+
     /**
      * Sets the offset for \p frameId.
      * Should be used by Undo framework only!
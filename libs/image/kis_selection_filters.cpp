@@ -8,19 +8,270 @@
 #include "kis_selection_filters.h"
 
 #include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <numeric>
 
 #include <klocalizedstring.h>
 
 #include <KoColorSpace.h>
-#include "kis_convolution_painter.h"
-#include "kis_convolution_kernel.h"
+#include <KoColorSpaceRegistry.h>
+#include <kis_global.h>
+#include <kis_assert.h>
 #include "kis_pixel_selection.h"
 #include <kis_sequential_iterator.h>
+#include "KisConcurrentRangeUtils.h"
 
 #define MAX(a, b) ((a) > (b) ? (a) : (b))
 #define MIN(a, b) ((a) < (b) ? (a) : (b))
 #define RINT(x) floor ((x) + 0.5)
 
+namespace {
+
+const float infiniteDistance = std::numeric_limits<float>::max();
+
+/**
+ * The distance-based filters process the rect in strips, so that the size
+ * of the temporary buffers doesn't depend on the size of the selection nor
+ * on the radius of the filter. The passes over the columns use full-height
+ * column strips, the passes over the rows use full-width row strips, and
+ * the intermediate result is kept in a temporary float device.
+ */
+const int stripBufferSize = 1 << 22; // in pixels
+
+template <typename Func>
+void processColumnStrips(const QRect &rect, Func func)
+{
+    const int stripWidth = qMax(1, stripBufferSize / qMax(1, rect.height()));
+
+    for (int x = rect.left(); x <= rect.right(); x += stripWidth) {
+        func(QRect(x, rect.top(), qMin(stripWidth, rect.right() - x + 1), rect.height()));
+    }
+}
+
+template <typename Func>
+void processRowStrips(const QRect &rect, Func func)
+{
+    const int stripHeight = qMax(1, stripBufferSize / qMax(1, rect.width()));
+
+    for (int y = rect.top(); y <= rect.bottom(); y += stripHeight) {
+        func(QRect(rect.left(), y, rect.width(), qMin(stripHeight, rect.bottom() - y + 1)));
+    }
+}
+
+KisPaintDeviceSP createFloatDevice()
+{
+    return new KisPaintDevice(KoColorSpaceRegistry::instance()->alpha32f());
+}
+
+/**
+ * Computes the exact squared (weighted) Euclidean distance from every pixel
+ * of \p rect to the nearest seed pixel:
+ *
+ *     dist(p) = min_q (xWeight * (p.x - q.x)^2 + yWeight * (p.y - q.y)^2)
+ *
+ * The seeds are the pixels of \p rect in the 8-bit \p device, for which
+ * \p isSeed(value) returns true. If \p outerSeeds is true, the pixels
+ * adjacent to the rect from the outside are considered seeds as well.
+ *
+ * The implementation follows the linear-time algorithm by Felzenszwalb and
+ * Huttenlocher: the columns are processed with a simple two-pass scan, then
+ * the rows are processed by building the lower envelope of the parabolas.
+ * The cost doesn't depend on the distance, both the passes are parallelized.
+ *
+ * The result is passed to \p writeRows(stripRect, distance) strip by strip.
+ * The pixels that have no seeds get infiniteDistance. The device is not
+ * read after the first call to \p writeRows, so the result can be written
+ * into it directly.
+ */
+template <typename IsSeedFunc, typename WriteRowsFunc>
+void squaredDistanceTransform(KisPaintDeviceSP device, const QRect &rect,
+                              qreal xWeight, qreal yWeight, bool outerSeeds,
+                              IsSeedFunc isSeed, WriteRowsFunc writeRows)
+{
+    const int noSeed = std::numeric_limits<int>::min();
+    KisPaintDeviceSP columnDistance = createFloatDevice();
+
+    processColumnStrips(rect, [&] (const QRect &stripRect) {
+        const int width = stripRect.width();
+        const int height = stripRect.height();
+
+        QVector<quint8> buf(width * height);
+        device->readBytes(buf.data(), stripRect);
+
+        QVector<float> distance(width * height);
+        float *dist = distance.data();
+        const quint8 *src = buf.constData();
+
+        KritaUtils::processRangeConcurrently(width, 64, [&] (int begin, int end) {
+            const int numColumns = end - begin;
+            QVector<int> lastSeed(numColumns, outerSeeds ? -1 : noSeed);
+
+            for (int y = 0; y < height; y++) {
+                const quint8 *srcPtr = src + y * width + begin;
+                float *dstPtr = dist + y * width + begin;
+
+                for (int i = 0; i < numColumns; i++) {
+                    if (isSeed(srcPtr[i])) {
+                        lastSeed[i] = y;
+                    }
+                    dstPtr[i] = lastSeed[i] != noSeed ? y - lastSeed[i] : infiniteDistance;
+                }
+            }
+
+            lastSeed.fill(outerSeeds ? height : noSeed);
+
+            for (int y = height - 1; y >= 0; y--) {
+                float *dstPtr = dist + y * width + begin;
+
+                for (int i = 0; i < numColumns; i++) {
+                    if (dstPtr[i] == 0.0f) {
+                        lastSeed[i] = y;
+                    } else if (lastSeed[i] != noSeed) {
+                        dstPtr[i] = qMin(dstPtr[i], float(lastSeed[i] - y));
+                    }
+
+                    if (dstPtr[i] != infiniteDistance) {
+                        dstPtr[i] = yWeight * pow2(dstPtr[i]);
+                    }
+                }
+            }
+        });
+
+        columnDistance->writeBytes(reinterpret_cast<const quint8*>(distance.constData()), stripRect);
+    });
+
+    processRowStrips(rect, [&] (const QRect &stripRect) {
+        const int width = stripRect.width();
+
+        QVector<float> distance(width * stripRect.height());
+        columnDistance->readBytes(reinterpret_cast<quint8*>(distance.data()), stripRect);
+        float *dist = distance.data();
+
+        // the outer seeds are the columns at -1 and width
+        const int offset = outerSeeds ? 1 : 0;
+        const int size = width + 2 * offset;
+
+        KritaUtils::processRangeConcurrently(stripRect.height(), 16, [&] (int begin, int end) {
+            QVector<float> f(size, 0.0f);
+            QVector<int> v(size);
+            QVector<qreal> z(size + 1);
+
+            for (int y = begin; y < end; y++) {
+                float *row = dist + y * width;
+                std::copy(row, row + width, f.begin() + offset);
+
+                int k = -1;
+
+                for (int q = 0; q < size; q++) {
+                    if (f[q] == infiniteDistance) continue;
+
+                    qreal s = 0.0;
+                    while (k >= 0) {
+                        const int p = v[k];
+                        s = ((f[q] + xWeight * pow2(q)) - (f[p] + xWeight * pow2(p))) / (2.0 * xWeight * (q - p));
+                        if (s > z[k]) break;
+                        k--;
+                    }
+
+                    k++;
+                    v[k] = q;
+                    z[k] = k > 0 ? s : -std::numeric_limits<qreal>::infinity();
+                }
+
+                if (k < 0) {
+                    std::fill(row, row + width, infiniteDistance);
+                    continue;
+                }
+
+                z[k + 1] = std::numeric_limits<qreal>::infinity();
+
+                for (int x = 0, j = 0; x < width; x++) {
+                    const int q = x + offset;
+                    while (z[j + 1] < q) j++;
+                    row[x] = xWeight * pow2(q - v[j]) + f[v[j]];
+                }
+            }
+        });
+
+        writeRows(stripRect, distance.constData());
+    });
+}
+
+bool isBinarySelection(KisPaintDeviceSP device, const QRect &rect)
+{
+    KisSequentialConstIterator it(device, rect);
+    while (it.nextPixel()) {
+        const quint8 value = *it.rawDataConst();
+        if (value != 0 && value != 255) return false;
+    }
+    return true;
+}
+
+/**
+ * The feathering kernel is a gaussian with sigma equal to the radius,
+ * truncated at one sigma. It is approximated by three passes of a box
+ * blur with the same variance (see W. Kovesi, "Fast Almost-Gaussian
+ * Filtering"), which has the cost independent of the radius.
+ */
+const int featherNumPasses = 3;
+
+std::array<int, featherNumPasses> featherBoxRadii(int radius)
+{
+    qreal weightSum = 0.0;
+    qreal varianceSum = 0.0;
+
+    for (int x = -radius; x <= radius; x++) {
+        const qreal weight = std::exp(-pow2(x) / (2.0 * pow2(radius)));
+        weightSum += weight;
+        varianceSum += weight * pow2(x);
+    }
+
+    const qreal variance = varianceSum / weightSum;
+    const int n = featherNumPasses;
+
+    int lowerWidth = int(std::sqrt(12.0 * variance / n + 1.0));
+    if (lowerWidth % 2 == 0) lowerWidth--;
+    const int upperWidth = lowerWidth + 2;
+
+    const int numLowerPasses =
+        qBound(0,
+               qRound((12.0 * variance - n * pow2(lowerWidth) - 4 * n * lowerWidth - 3 * n) /
+                      (-4.0 * lowerWidth - 4.0)),
+               n);
+
+    std::array<int, featherNumPasses> radii;
+    for (int i = 0; i < n; i++) {
+        radii[i] = ((i < numLowerPasses ? lowerWidth : upperWidth) - 1) / 2;
+    }
+    return radii;
+}
+
+int featherBorder(int radius)
+{
+    const std::array<int, featherNumPasses> radii = featherBoxRadii(radius);
+    return std::accumulate(radii.begin(), radii.end(), 0);
+}
+
+void boxBlurLine(const float *src, float *dst, int size, int stride, int radius)
+{
+    const qreal norm = 1.0 / (2 * radius + 1);
+
+    qreal sum = 0.0;
+    for (int i = -radius; i <= radius; i++) {
+        sum += src[qBound(0, i, size - 1) * stride];
+    }
+
+    for (int i = 0; i < size; i++) {
+        dst[i * stride] = sum * norm;
+        sum += src[qMin(i + radius + 1, size - 1) * stride] -
+               src[qMax(i - radius, 0) * stride];
+    }
+}
+
+}
+
 KisSelectionFilter::~KisSelectionFilter()
 {
 }
@@ -266,10 +517,6 @@ void KisBorderSelectionFilter::process(KisPixelSelectionSP pixelSelection, const
 {
     if (m_xRadius <= 0 || m_yRadius <= 0) return;
 
-    quint8  *buf[3];
-    quint8 **density;
-    quint8 **transition;
-
     if (m_xRadius == 1 && m_yRadius == 1) {
         // optimize this case specifically
         quint8* source[3];
@@ -305,190 +552,82 @@ void KisBorderSelectionFilter::process(KisPixelSelectionSP pixelSelection, const
         return;
     }
 
-    qint32* max = new qint32[rect.width() + 2 * m_xRadius];
-    for (qint32 i = 0; i < (rect.width() + 2 * m_xRadius); i++)
-        max[i] = m_yRadius + 2;
-    max += m_xRadius;
-
-    for (qint32 i = 0; i < 3; i++)
-        buf[i] = new quint8[rect.width()];
-
-    transition = new quint8*[m_yRadius + 1];
-    for (qint32 i = 0; i < m_yRadius + 1; i++) {
-        transition[i] = new quint8[rect.width() + 2 * m_xRadius];
-        memset(transition[i], 0, rect.width() + 2 * m_xRadius);
-        transition[i] += m_xRadius;
-    }
-    quint8* out = new quint8[rect.width()];
-    density = new quint8*[2 * m_xRadius + 1];
-    density += m_xRadius;
-
-    for (qint32 x = 0; x < (m_xRadius + 1); x++) { // allocate density[][]
-        density[ x]  = new quint8[2 * m_yRadius + 1];
-        density[ x] += m_yRadius;
-        density[-x]  = density[x];
-    }
+    const qreal xWeight = m_antialiasing ? 1.0 : 1.0 / pow2(m_xRadius + 0.5);
+    const qreal yWeight = m_antialiasing ? 1.0 : 1.0 / pow2(m_yRadius + 0.5);
 
-    // compute density[][]
     if (m_antialiasing) {
         KIS_SAFE_ASSERT_RECOVER_NOOP(m_xRadius == m_yRadius && "anisotropic fading is not implemented");
-        const qreal maxRadius = 0.5 * (m_xRadius + m_yRadius);
-        const qreal minRadius = maxRadius - 1.0;
-
-        for (qint32 x = 0; x < (m_xRadius + 1); x++) {
-            double dist;
-            quint8 a;
-
-            for (qint32 y = 0; y < (m_yRadius + 1); y++) {
-
-                dist = sqrt(pow2(x) + pow2(y));
-
-                if (dist > maxRadius) {
-                    a = 0;
-                } else if (dist > minRadius) {
-                    a = qRound((1.0 - dist + minRadius) * 255.0);
-                } else {
-                    a = 255;
-                }
-
-                density[ x][ y] = a;
-                density[ x][-y] = a;
-                density[-x][ y] = a;
-                density[-x][-y] = a;
-            }
-        }
-
-    } else {
-        for (qint32 x = 0; x < (m_xRadius + 1); x++) {
-            double tmpx, tmpy, dist;
-            quint8 a;
-
-            tmpx = x > 0.0 ? x - 0.5 : 0.0;
-
-            for (qint32 y = 0; y < (m_yRadius + 1); y++) {
-                tmpy = y > 0.0 ? y - 0.5 : 0.0;
-
-                dist = (pow2(tmpy) / pow2(m_yRadius) +
-                        pow2(tmpx) / pow2(m_xRadius));
-
-                a = dist <= 1.0 ? 255 : 0;
-
-                density[ x][ y] = a;
-                density[ x][-y] = a;
-                density[-x][ y] = a;
-                density[-x][-y] = a;
-            }
-        }
     }
 
-    pixelSelection->readBytes(buf[0], rect.x(), rect.y(), rect.width(), 1);
-    memcpy(buf[1], buf[0], rect.width());
-    if (rect.height() > 1)
-        pixelSelection->readBytes(buf[2], rect.x(), rect.y() + 1, rect.width(), 1);
-    else
-        memcpy(buf[2], buf[1], rect.width());
-    computeTransition(transition[1], buf, rect.width());
-
-    for (qint32 y = 1; y < m_yRadius && y + 1 < rect.height(); y++) { // set up top of image
-        rotatePointers(buf, 3);
-        pixelSelection->readBytes(buf[2], rect.x(), rect.y() + y + 1, rect.width(), 1);
-        computeTransition(transition[y + 1], buf, rect.width());
-    }
-    for (qint32 x = 0; x < rect.width(); x++) { // set up max[] for top of image
-        max[x] = -(m_yRadius + 7);
-        for (qint32 j = 1; j < m_yRadius + 1; j++)
-            if (transition[j][x]) {
-                max[x] = j;
-                break;
+    KisPaintDeviceSP transition = new KisPaintDevice(KoColorSpaceRegistry::instance()->alpha8());
+
+    processRowStrips(rect, [&] (const QRect &stripRect) {
+        /**
+         * The transition is computed with one more row on each side, unless
+         * we are at the edge of the rect, where the edge row is repeated.
+         */
+        const QRect srcRect = stripRect.adjusted(0, -1, 0, 1) & rect;
+
+        const int width = stripRect.width();
+        const int height = stripRect.height();
+        const int srcOffset = stripRect.top() - srcRect.top();
+        const int maxRow = srcRect.height() - 1;
+
+        QVector<quint8> buf(width * srcRect.height());
+        pixelSelection->readBytes(buf.data(), srcRect);
+
+        QVector<quint8> result(width * height);
+
+        KritaUtils::processRangeConcurrently(height, 64, [&] (int begin, int end) {
+            for (int y = begin; y < end; y++) {
+                const int row = y + srcOffset;
+                quint8 *rows[3] = {
+                    buf.data() + qMax(0, row - 1) * width,
+                    buf.data() + row * width,
+                    buf.data() + qMin(maxRow, row + 1) * width
+                };
+                computeTransition(result.data() + y * width, rows, width);
             }
-    }
-    for (qint32 y = 0; y < rect.height(); y++) { // main calculation loop
-        rotatePointers(buf, 3);
-        rotatePointers(transition, m_yRadius + 1);
-        if (y < rect.height() - (m_yRadius + 1)) {
-            pixelSelection->readBytes(buf[2], rect.x(), rect.y() + y + m_yRadius + 1, rect.width(), 1);
-            computeTransition(transition[m_yRadius], buf, rect.width());
-        } else
-            memcpy(transition[m_yRadius], transition[m_yRadius - 1], rect.width());
-
-        for (qint32 x = 0; x < rect.width(); x++) { // update max array
-            if (max[x] < 1) {
-                if (max[x] <= -m_yRadius) {
-                    if (transition[m_yRadius][x])
-                        max[x] = m_yRadius;
-                    else
-                        max[x]--;
-                } else if (transition[-max[x]][x])
-                    max[x] = -max[x];
-                else if (transition[-max[x] + 1][x])
-                    max[x] = -max[x] + 1;
-                else
-                    max[x]--;
-            } else
-                max[x]--;
-            if (max[x] < -m_yRadius - 1)
-                max[x] = -m_yRadius - 1;
-        }
-        quint8 last_max =  max[0][density[-1]];
-        qint32 last_index = 1;
-        for (qint32 x = 0 ; x < rect.width(); x++) { // render scan line
-            last_index--;
-            if (last_index >= 0) {
-                last_max = 0;
-                for (qint32 i = m_xRadius; i >= 0; i--)
-                    if (max[x + i] <= m_yRadius && max[x + i] >= -m_yRadius && density[i][max[x+i]] > last_max) {
-                        last_max = density[i][max[x + i]];
-                        last_index = i;
+        });
+
+        transition->writeBytes(result.constData(), stripRect);
+    });
+
+    const bool antialiasing = m_antialiasing;
+    const qreal maxRadius = 0.5 * (m_xRadius + m_yRadius);
+    const qreal minRadius = maxRadius - 1.0;
+
+    squaredDistanceTransform(transition, rect, xWeight, yWeight, false,
+        [] (quint8 value) {
+            return value != 0;
+        },
+        [&] (const QRect &stripRect, const float *distPtr) {
+            const int size = stripRect.width() * stripRect.height();
+            QVector<quint8> result(size);
+            quint8 *dstPtr = result.data();
+
+            if (antialiasing) {
+                for (int i = 0; i < size; i++) {
+                    const qreal dist = distPtr[i] != infiniteDistance ? std::sqrt(distPtr[i]) : maxRadius + 1.0;
+
+                    if (dist > maxRadius) {
+                        dstPtr[i] = 0;
+                    } else if (dist > minRadius) {
+                        dstPtr[i] = qRound((1.0 - dist + minRadius) * 255.0);
+                    } else {
+                        dstPtr[i] = 255;
                     }
-                out[x] = last_max;
-            } else {
-                last_max = 0;
-                for (qint32 i = m_xRadius; i >= -m_xRadius; i--)
-                    if (max[x + i] <= m_yRadius && max[x + i] >= -m_yRadius && density[i][max[x + i]] > last_max) {
-                        last_max = density[i][max[x + i]];
-                        last_index = i;
-                    }
-                out[x] = last_max;
-            }
-            if (last_max == 0) {
-                qint32 i;
-                for (i = x + 1; i < rect.width(); i++) {
-                    if (max[i] >= -m_yRadius)
-                        break;
                 }
-                if (i - x > m_xRadius) {
-                    for (; x < i - m_xRadius; x++)
-                        out[x] = 0;
-                    x--;
+            } else {
+                for (int i = 0; i < size; i++) {
+                    dstPtr[i] = distPtr[i] <= 1.0f ? 255 : 0;
                 }
-                last_index = m_xRadius;
             }
-        }
-        pixelSelection->writeBytes(out, rect.x(), rect.y() + y, rect.width(), 1);
-    }
-    delete [] out;
-
-    for (qint32 i = 0; i < 3; i++)
-        delete[] buf[i];
-
-    max -= m_xRadius;
-    delete[] max;
-
-    for (qint32 i = 0; i < m_yRadius + 1; i++) {
-        transition[i] -= m_xRadius;
-        delete transition[i];
-    }
-    delete[] transition;
 
-    for (qint32 i = 0; i < m_xRadius + 1 ; i++) {
-        density[i] -= m_yRadius;
-        delete density[i];
-    }
-    density -= m_xRadius;
-    delete[] density;
+            pixelSelection->writeBytes(dstPtr, stripRect);
+        });
 }
 
-
 KisFeatherSelectionFilter::KisFeatherSelectionFilter(qint32 radius)
     : m_radius(radius)
 {
@@ -503,39 +642,90 @@ QRect KisFeatherSelectionFilter::changeRect(const QRect& rect, KisDefaultBoundsB
 {
     Q_UNUSED(defaultBounds);
 
-    return rect.adjusted(-m_radius, -m_radius,
-                         m_radius, m_radius);
+    const int radius = qMax(m_radius, featherBorder(m_radius));
+    return rect.adjusted(-radius, -radius, radius, radius);
 }
 
 void KisFeatherSelectionFilter::process(KisPixelSelectionSP pixelSelection, const QRect& rect)
 {
-    // compute horizontal kernel
-    const uint kernelSize = m_radius * 2 + 1;
-    Eigen::Matrix<qreal, Eigen::Dynamic, Eigen::Dynamic> gaussianMatrix(1, kernelSize);
+    if (m_radius <= 0) return;
 
-    const qreal multiplicand = 1.0 / (2.0 * M_PI * m_radius * m_radius);
-    const qreal exponentMultiplicand = 1.0 / (2.0 * m_radius * m_radius);
+    const std::array<int, featherNumPasses> boxRadii = featherBoxRadii(m_radius);
+    const int border = featherBorder(m_radius);
 
-    for (uint x = 0; x < kernelSize; x++) {
-        uint xDistance = qAbs((int)m_radius - (int)x);
-        gaussianMatrix(0, x) = multiplicand * exp( -(qreal)((xDistance * xDistance) + (m_radius * m_radius)) * exponentMultiplicand );
-    }
+    /**
+     * The rows are blurred first, including the rows of the border, then
+     * the columns are blurred in the area of the rect only.
+     */
+    const QRect rowsRect = rect.adjusted(0, -border, 0, border);
+    KisPaintDeviceSP rowsBlurred = createFloatDevice();
+
+    processRowStrips(rowsRect, [&] (const QRect &stripRect) {
+        const QRect srcRect = stripRect.adjusted(-border, 0, border, 0);
+        const int width = srcRect.width();
+        const int height = srcRect.height();
+
+        QVector<quint8> buf(width * height);
+        pixelSelection->readBytes(buf.data(), srcRect);
 
-    KisConvolutionKernelSP kernelHoriz = KisConvolutionKernel::fromMatrix(gaussianMatrix, 0, gaussianMatrix.sum());
-    KisConvolutionKernelSP kernelVertical = KisConvolutionKernel::fromMatrix(gaussianMatrix.transpose(), 0, gaussianMatrix.sum());
+        QVector<float> data(buf.size());
+        std::copy(buf.begin(), buf.end(), data.begin());
+        QVector<float> tmp(buf.size());
 
-    KisPaintDeviceSP interm = new KisPaintDevice(pixelSelection->colorSpace());
-    interm->prepareClone(pixelSelection);
+        float *dataPtr = data.data();
+        float *tmpPtr = tmp.data();
 
-    KisConvolutionPainter horizPainter(interm);
-    horizPainter.setChannelFlags(interm->colorSpace()->channelFlags(false, true));
-    horizPainter.applyMatrix(kernelHoriz, pixelSelection, rect.topLeft(), rect.topLeft(), rect.size(), BORDER_REPEAT);
-    horizPainter.end();
+        QVector<float> result(stripRect.width() * height);
+
+        KritaUtils::processRangeConcurrently(height, 16, [&] (int begin, int end) {
+            for (int y = begin; y < end; y++) {
+                float *line = dataPtr + y * width;
+                float *tmpLine = tmpPtr + y * width;
+
+                for (int i = 0; i < featherNumPasses; i++) {
+                    boxBlurLine(line, tmpLine, width, 1, boxRadii[i]);
+                    std::swap(line, tmpLine);
+                }
 
-    KisConvolutionPainter verticalPainter(pixelSelection);
-    verticalPainter.setChannelFlags(pixelSelection->colorSpace()->channelFlags(false, true));
-    verticalPainter.applyMatrix(kernelVertical, interm, rect.topLeft(), rect.topLeft(), rect.size(), BORDER_REPEAT);
-    verticalPainter.end();
+                std::copy(line + border, line + border + stripRect.width(),
+                          result.begin() + y * stripRect.width());
+            }
+        });
+
+        rowsBlurred->writeBytes(reinterpret_cast<const quint8*>(result.constData()), stripRect);
+    });
+
+    processColumnStrips(rowsRect, [&] (const QRect &stripRect) {
+        const int width = stripRect.width();
+        const int height = stripRect.height();
+
+        QVector<float> data(width * height);
+        rowsBlurred->readBytes(reinterpret_cast<quint8*>(data.data()), stripRect);
+        QVector<float> tmp(data.size());
+
+        float *dataPtr = data.data();
+        float *tmpPtr = tmp.data();
+
+        QVector<quint8> result(width * rect.height());
+
+        KritaUtils::processRangeConcurrently(width, 16, [&] (int begin, int end) {
+            for (int x = begin; x < end; x++) {
+                float *line = dataPtr + x;
+                float *tmpLine = tmpPtr + x;
+
+                for (int i = 0; i < featherNumPasses; i++) {
+                    boxBlurLine(line, tmpLine, height, width, boxRadii[i]);
+                    std::swap(line, tmpLine);
+                }
+
+                for (int y = 0; y < rect.height(); y++) {
+                    result[y * width + x] = quint8(qBound(0, qRound(line[(y + border) * width]), 255));
+                }
+            }
+        });
+
+        pixelSelection->writeBytes(result.constData(), QRect(stripRect.x(), rect.y(), width, rect.height()));
+    });
 }
 
 
@@ -561,6 +751,32 @@ void KisGrowSelectionFilter::process(KisPixelSelectionSP pixelSelection, const Q
 {
     if (m_xRadius <= 0 || m_yRadius <= 0) return;
 
+    if (!isBinarySelection(pixelSelection, rect)) {
+        processSoftSelection(pixelSelection, rect);
+        return;
+    }
+
+    const qreal xWeight = 1.0 / pow2(m_xRadius + 0.5);
+    const qreal yWeight = 1.0 / pow2(m_yRadius + 0.5);
+
+    squaredDistanceTransform(pixelSelection, rect, xWeight, yWeight, false,
+        [] (quint8 value) {
+            return value != 0;
+        },
+        [&] (const QRect &stripRect, const float *distPtr) {
+            const int size = stripRect.width() * stripRect.height();
+            QVector<quint8> result(size);
+
+            for (int i = 0; i < size; i++) {
+                result[i] = distPtr[i] <= 1.0f ? 255 : 0;
+            }
+
+            pixelSelection->writeBytes(result.constData(), stripRect);
+        });
+}
+
+void KisGrowSelectionFilter::processSoftSelection(KisPixelSelectionSP pixelSelection, const QRect& rect)
+{
     /**
         * Much code resembles Shrink filter, so please fix bugs
         * in both filters
@@ -688,6 +904,44 @@ void KisShrinkSelectionFilter::process(KisPixelSelectionSP pixelSelection, const
 {
     if (m_xRadius <= 0 || m_yRadius <= 0) return;
 
+    if (!isBinarySelection(pixelSelection, rect)) {
+        processSoftSelection(pixelSelection, rect);
+        return;
+    }
+
+    /**
+     * If edge lock is true we assume that pixels outside the region
+     * we are passed are identical to the edge pixels. If edge lock is
+     * false, we assume that pixels outside the region are 0.
+     *
+     * The pixels adjacent to the rect are passed to the distance
+     * transform as outer seeds in the latter case.
+     */
+
+    const qreal xWeight = 1.0 / pow2(m_xRadius + 0.5);
+    const qreal yWeight = 1.0 / pow2(m_yRadius + 0.5);
+
+    squaredDistanceTransform(pixelSelection, rect, xWeight, yWeight, !m_edgeLock,
+        [] (quint8 value) {
+            return value == 0;
+        },
+        [&] (const QRect &stripRect, const float *distPtr) {
+            const int size = stripRect.width() * stripRect.height();
+            QVector<quint8> result(size);
+            pixelSelection->readBytes(result.data(), stripRect);
+
+            for (int i = 0; i < size; i++) {
+                if (distPtr[i] <= 1.0f) {
+                    result[i] = 0;
+                }
+            }
+
+            pixelSelection->writeBytes(result.constData(), stripRect);
+        });
+}
+
+void KisShrinkSelectionFilter::processSoftSelection(KisPixelSelectionSP pixelSelection, const QRect& rect)
+{
     /*
         pretty much the same as fatten_region only different
         blame all bugs in this function on jaycox@gimp.org
@@ -101,6 +101,14 @@ public:
     void process(KisPixelSelectionSP pixelSelection, const QRect &rect) override;
 
 private:
+    /**
+     * The distance transform can process only binary masks, the soft
+     * (antialiased) selections are processed with a classic scanline
+     * algorithm that preserves the fractional coverage of the pixels.
+     * Its cost still grows linearly with the radius.
+     */
+    void processSoftSelection(KisPixelSelectionSP pixelSelection, const QRect &rect);
+
     qint32 m_xRadius;
     qint32 m_yRadius;
 };
@@ -117,6 +125,9 @@ public:
     void process(KisPixelSelectionSP pixelSelection, const QRect &rect) override;
 
 private:
+    /// see KisGrowSelectionFilter::processSoftSelection()
+    void processSoftSelection(KisPixelSelectionSP pixelSelection, const QRect &rect);
+
     qint32 m_xRadius;
     qint32 m_yRadius;
     qint32 m_edgeLock;
@@ -9,6 +9,8 @@
 #include <QMutexLocker>
 #include <QVector>
 
+#include <KisPerformanceCounters.h>
+
 #include "kis_image_config.h"
 #include "kis_full_refresh_walker.h"
 #include "kis_spontaneous_job.h"
@@ -40,6 +42,12 @@
     #define ACCUMULATOR_DEBUG()
 #endif /* ENABLE_ACCUMULATOR */
 
+namespace {
+KisPerformanceCounter s_queueDepth("updates/queue_depth", KisPerformanceCounter::Gauge);
+KisPerformanceCounter s_updateRequests("updates/requests");
+KisPerformanceCounter s_mergedUpdateRequests("updates/merged_requests");
+}
+
 
 KisSimpleUpdateQueue::KisSimpleUpdateQueue()
     : m_overrideLevelOfDetail(-1)
@@ -51,6 +59,8 @@ KisSimpleUpdateQueue::~KisSimpleUpdateQueue()
 {
     QMutexLocker locker(&m_lock);
 
+    s_queueDepth.add(-(m_updatesList.size() + m_spontaneousJobsList.size()));
+
     while (!m_spontaneousJobsList.isEmpty()) {
         delete m_spontaneousJobsList.takeLast();
     }
@@ -111,6 +121,7 @@ bool KisSimpleUpdateQueue::processOneJob(KisUpdaterContext &updaterContext)
 
             updaterContext.addMergeJob(item);
             iter.remove();
+            s_queueDepth.add(-1);
             jobAdded = true;
             break;
         }
@@ -139,6 +150,7 @@ bool KisSimpleUpdateQueue::processOneJob(KisUpdaterContext &updaterContext)
 
             updaterContext.addSpontaneousJob(job);
             m_spontaneousJobsList.removeFirst();
+            s_queueDepth.add(-1);
             jobAdded = true;
         }
     }
@@ -194,7 +206,13 @@ void KisSimpleUpdateQueue::addJob(KisNodeSP node, const QVector<QRect> &rects,
         KisBaseRectsWalkerSP walker;
 
         if(trySplitJob(node, rc, cropRect, levelOfDetail, type)) continue;
-        if(tryMergeJob(node, rc, cropRect, levelOfDetail, type)) continue;
+
+        s_updateRequests.increment();
+
+        if(tryMergeJob(node, rc, cropRect, levelOfDetail, type)) {
+            s_mergedUpdateRequests.increment();
+            continue;
+        }
 
         if (type == KisBaseRectsWalker::UPDATE) {
             walker = new KisMergeWalker(cropRect, KisMergeWalker::DEFAULT);
@@ -217,6 +235,7 @@ void KisSimpleUpdateQueue::addJob(KisNodeSP node, const QVector<QRect> &rects,
     if (!walkers.isEmpty()) {
         m_lock.lock();
         m_updatesList.append(walkers);
+        s_queueDepth.add(walkers.size());
         m_lock.unlock();
     }
 }
@@ -236,10 +255,12 @@ void KisSimpleUpdateQueue::addSpontaneousJob(KisSpontaneousJob *spontaneousJob)
         if (spontaneousJob->overrides(item)) {
             iter.remove();
             delete item;
+            s_queueDepth.add(-1);
         }
     }
 
     m_spontaneousJobsList.append(spontaneousJob);
+    s_queueDepth.add(1);
 }
 
 bool KisSimpleUpdateQueue::isEmpty() const
@@ -357,6 +378,7 @@ void KisSimpleUpdateQueue::collectJobs(KisBaseRectsWalkerSP &baseWalker,
 
         if(joinRects(baseRect, item->requestedRect(), maxAlpha)) {
             iter.remove();
+            s_queueDepth.add(-1);
         }
     }
 
@@ -6,8 +6,13 @@
 
 #include "kis_stroke.h"
 
+#include <KisPerformanceCounters.h>
+
 #include "kis_stroke_strategy.h"
 
+namespace {
+KisPerformanceCounter s_queuedJobs("strokes/queued_jobs", KisPerformanceCounter::Gauge);
+}
 
 KisStroke::KisStroke(KisStrokeStrategy *strokeStrategy, Type type, int levelOfDetail)
     : m_strokeStrategy(strokeStrategy),
@@ -95,6 +100,8 @@ void KisStroke::addMutatedJobs(const QVector<KisStrokeJobData *> list)
         it = m_jobsQueue.insert(it, new KisStrokeJob(m_dabStrategy.data(), data, worksOnLevelOfDetail(), true));
         ++it;
     }
+
+    s_queuedJobs.add(list.size());
 }
 
 KisStrokeJob* KisStroke::popOneJob()
@@ -218,6 +225,7 @@ void KisStroke::clearQueueOnCancel()
         if ((*it)->isCancellable()) {
             delete (*it);
             it = m_jobsQueue.erase(it);
+            s_queuedJobs.add(-1);
         } else {
             ++it;
         }
@@ -296,6 +304,7 @@ void KisStroke::enqueue(KisStrokeJobStrategy *strategy,
     }
 
     m_jobsQueue.enqueue(new KisStrokeJob(strategy, data, worksOnLevelOfDetail(), true));
+    s_queuedJobs.add(1);
 }
 
 void KisStroke::prepend(KisStrokeJobStrategy *strategy,
@@ -313,11 +322,15 @@ void KisStroke::prepend(KisStrokeJobStrategy *strategy,
     Q_UNUSED(levelOfDetail);
 
     m_jobsQueue.prepend(new KisStrokeJob(strategy, data, worksOnLevelOfDetail(), isOwnJob));
+    s_queuedJobs.add(1);
 }
 
 KisStrokeJob* KisStroke::dequeue()
 {
-    return !m_jobsQueue.isEmpty() ? m_jobsQueue.dequeue() : 0;
+    if (m_jobsQueue.isEmpty()) return 0;
+
+    s_queuedJobs.add(-1);
+    return m_jobsQueue.dequeue();
 }
 
 void KisStroke::setLodBuddy(KisStrokeSP buddy)
@@ -7,6 +7,8 @@
 #ifndef __KIS_STROKE_JOB_H
 #define __KIS_STROKE_JOB_H
 
+#include <chrono>
+
 #include "kis_runnable_with_debug_name.h"
 #include "kis_stroke_job_strategy.h"
 
@@ -20,7 +22,8 @@ public:
         : m_dabStrategy(strategy),
           m_dabData(data),
           m_levelOfDetail(levelOfDetail),
-          m_isOwnJob(isOwnJob)
+          m_isOwnJob(isOwnJob),
+          m_enqueueTime(std::chrono::steady_clock::now())
     {
     }
 
@@ -69,6 +72,15 @@ public:
         return m_dabStrategy->debugId();
     }
 
+    /**
+     * \return the number of microseconds the job has been waiting
+     *         in the queue since its creation
+     */
+    qint64 waitTime() const {
+        return std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - m_enqueueTime).count();
+    }
+
 private:
     // for testing use only, do not use in real code
     friend QString getJobName(KisStrokeJob *job);
@@ -92,6 +104,8 @@ private:
 
     int m_levelOfDetail;
     bool m_isOwnJob;
+
+    std::chrono::steady_clock::time_point m_enqueueTime;
 };
 
 #endif /* __KIS_STROKE_JOB_H */
@@ -16,10 +16,18 @@
 #include "kis_undo_stores.h"
 #include "kis_post_execution_undo_adapter.h"
 #include "KisCppQuirks.h"
+#include <KisPerformanceCounters.h>
 
 typedef QQueue<KisStrokeSP> StrokesQueue;
 typedef QQueue<KisStrokeSP>::iterator StrokesQueueIterator;
 
+namespace {
+KisPerformanceCounter s_startedJobs("strokes/started_jobs");
+KisPerformanceCounter s_jobWaitTime("strokes/job_wait_time_us");
+KisPerformanceCounter s_sequentialStalls("strokes/sequential_stalls");
+KisPerformanceCounter s_barrierStalls("strokes/barrier_stalls");
+}
+
 #include "kis_image_interfaces.h"
 class KisStrokesQueue::LodNUndoStrokesFacade : public KisStrokesFacade
 {
@@ -758,7 +766,14 @@ bool KisStrokesQueue::processOneJob(KisUpdaterContext &updaterContext,
        checkSequentialProperty(snapshot, externalJobsPending)) {
 
         KisStrokeSP stroke = m_d->strokesQueue.head();
-        updaterContext.addStrokeJob(stroke->popOneJob());
+        KisStrokeJob *job = stroke->popOneJob();
+
+        if (job) {
+            s_startedJobs.increment();
+            s_jobWaitTime.add(job->waitTime());
+        }
+
+        updaterContext.addStrokeJob(job);
         result = true;
     }
 
@@ -880,6 +895,8 @@ bool KisStrokesQueue::checkSequentialProperty(KisUpdaterContextSnapshotEx snapsh
 
     if (snapshot & HasSequentialJob ||
         snapshot & HasBarrierJob) {
+
+        s_sequentialStalls.increment();
         return false;
     }
 
@@ -905,6 +922,7 @@ bool KisStrokesQueue::checkSequentialProperty(KisUpdaterContextSnapshotEx snapsh
          snapshot & HasMergeJob ||
          externalJobsPending)) {
 
+        s_barrierStalls.increment();
         return false;
     }
 
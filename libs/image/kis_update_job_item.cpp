@@ -6,6 +6,45 @@
 
 #include "kis_update_job_item.h"
 
+#include <KisPerformanceCounters.h>
+
 /**
  * This cpp-file is for QObject support mostly
  */
+
+namespace {
+KisPerformanceCounter s_mergeJobs("updater/merge_jobs");
+KisPerformanceCounter s_strokeJobs("updater/stroke_jobs");
+KisPerformanceCounter s_spontaneousJobs("updater/spontaneous_jobs");
+
+/**
+ * The rate of a busy-time counter is the average number of
+ * threads busy with the corresponding type of jobs
+ */
+KisPerformanceCounter s_mergeTime("updater/merge_time_us");
+KisPerformanceCounter s_strokeTime("updater/stroke_time_us");
+KisPerformanceCounter s_spontaneousTime("updater/spontaneous_time_us");
+KisPerformanceCounter s_exclusiveLockWaitTime("updater/exclusive_lock_wait_us");
+}
+
+void KisUpdateJobItem::reportJobStatistics(Type type, qint64 lockWaitTime, qint64 runTime)
+{
+    s_exclusiveLockWaitTime.add(lockWaitTime);
+
+    switch (type) {
+    case Type::MERGE:
+        s_mergeJobs.increment();
+        s_mergeTime.add(runTime);
+        break;
+    case Type::STROKE:
+        s_strokeJobs.increment();
+        s_strokeTime.add(runTime);
+        break;
+    case Type::SPONTANEOUS:
+        s_spontaneousJobs.increment();
+        s_spontaneousTime.add(runTime);
+        break;
+    default:
+        break;
+    }
+}
@@ -8,6 +8,7 @@
 #define __KIS_UPDATE_JOB_ITEM_H
 
 #include <atomic>
+#include <chrono>
 
 #include <QRunnable>
 #include <QReadWriteLock>
@@ -18,6 +19,7 @@
 #include "kis_async_merger.h"
 #include "kis_updater_context.h"
 #include <KoAlwaysInline.h>
+#include <KisPerformanceTracer.h>
 
 //#define DEBUG_JOBS_SEQUENCE
 
@@ -74,12 +76,17 @@ private:
         while (1) {
             KIS_SAFE_ASSERT_RECOVER_RETURN(isRunning());
 
+            const Type jobType = m_atomicType;
+            const auto lockStartTime = std::chrono::steady_clock::now();
+
             if(m_exclusive) {
                 m_updaterContext->m_exclusiveJobLock.lockForWrite();
             } else {
                 m_updaterContext->m_exclusiveJobLock.lockForRead();
             }
 
+            const auto jobStartTime = std::chrono::steady_clock::now();
+
             if(m_atomicType == Type::MERGE) {
                 runMergeJob();
             } else {
@@ -97,12 +104,21 @@ private:
                     }
 #endif
 
+                    KIS_TRACE_SCOPE("image",
+                                    m_atomicType == Type::STROKE ?
+                                        "KisUpdateJobItem::runStrokeJob" :
+                                        "KisUpdateJobItem::runSpontaneousJob");
+
                     m_runnableJob->run();
                 }
             }
 
             setDone();
 
+            reportJobStatistics(jobType,
+                                std::chrono::duration_cast<std::chrono::microseconds>(jobStartTime - lockStartTime).count(),
+                                std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - jobStartTime).count());
+
             m_updaterContext->doSomeUsefulWork();
 
             // may flip the current state from Waiting -> Running again
@@ -124,6 +140,8 @@ public:
     inline void runMergeJob() {
         KIS_SAFE_ASSERT_RECOVER_RETURN(m_atomicType == Type::MERGE);
         KIS_SAFE_ASSERT_RECOVER_RETURN(m_walker);
+        KIS_TRACE_SCOPE("image", "KisUpdateJobItem::runMergeJob");
+
         // dbgKrita << "Executing merge job" << m_walker->changeRect()
         //          << "on thread" << QThread::currentThreadId();
 
@@ -189,6 +207,12 @@ public:
         m_atomicType = Type::WAITING;
     }
 
+    /**
+     * Updates the performance counters of the updater threads,
+     * the times are in microseconds
+     */
+    void reportJobStatistics(Type type, qint64 lockWaitTime, qint64 runTime);
+
     inline bool isRunning() const {
         return m_atomicType >= Type::MERGE;
     }
@@ -9,9 +9,15 @@
 #include <QThread>
 #include <QThreadPool>
 
+#include <KisPerformanceCounters.h>
+
 #include "kis_update_job_item.h"
 #include "kis_stroke_job.h"
 
+namespace {
+KisPerformanceCounter s_updaterThreads("updater/threads", KisPerformanceCounter::Gauge);
+}
+
 const int KisUpdaterContext::useIdealThreadCountTag = -1;
 
 KisUpdaterContext::KisUpdaterContext(qint32 threadCount, KisUpdateScheduler *parent)
@@ -33,6 +39,7 @@ KisUpdaterContext::~KisUpdaterContext()
         clear();
     }
 
+    s_updaterThreads.add(-m_jobs.size());
     qDeleteAll(m_jobs);
 }
 
@@ -258,6 +265,9 @@ void KisUpdaterContext::setThreadsLimit(int value)
         delete m_jobs[i];
     }
 
+    // there may be several images open, each with its own context
+    s_updaterThreads.add(value - m_jobs.size());
+
     m_jobs.resize(value);
 
     for(qint32 i = 0; i < m_jobs.size(); i++) {
@@ -22,6 +22,7 @@
 #include <math.h>
 
 #include "kis_grid_interpolation_tools.h"
+#include "KisConcurrentRangeUtils.h"
 
 QPointF KisWarpTransformWorker::affineTransformMath(QPointF v, QVector<QPointF> p, QVector<QPointF> q, qreal alpha)
 {
@@ -220,6 +221,64 @@ struct KisWarpTransformWorker::FunctionTransformOp
     qreal m_alpha;
 };
 
+namespace {
+
+struct GridPointsFetcherOp
+{
+    inline void processPoint(int col, int row,
+                             int prevCol, int prevRow,
+                             int colIndex, int rowIndex) {
+
+        Q_UNUSED(prevCol);
+        Q_UNUSED(prevRow);
+        Q_UNUSED(colIndex);
+        Q_UNUSED(rowIndex);
+
+        m_points << QPointF(col, row);
+    }
+
+    inline void nextLine() {
+    }
+
+    QVector<QPointF> m_points;
+};
+
+/**
+ * Moving Least Squares math is calculated for every node of the grid
+ * against all the control points, which is the most expensive part
+ * of the transformation. The nodes do not depend on each other, so we
+ * map them concurrently first and only then rasterize the polygons
+ * (which write into the shared destination device) sequentially.
+ */
+template <class ForwardTransform>
+void calculateForwardMappingGrid(const QRect &srcBounds,
+                                 int pixelPrecision,
+                                 const ForwardTransform &transformOp,
+                                 QSize *gridSize,
+                                 QVector<QPointF> *origPoints,
+                                 QVector<QPointF> *transfPoints)
+{
+    *gridSize = GridIterationTools::calcGridSize(srcBounds, pixelPrecision);
+
+    GridPointsFetcherOp pointsOp;
+    GridIterationTools::processGrid(pointsOp, srcBounds, pixelPrecision);
+    *origPoints = pointsOp.m_points;
+
+    const int numPoints = origPoints->size();
+    KIS_SAFE_ASSERT_RECOVER_NOOP(numPoints == gridSize->width() * gridSize->height());
+
+    transfPoints->resize(numPoints);
+
+    KritaUtils::processRangeConcurrently(numPoints, 64,
+        [&] (int begin, int end) {
+            for (int i = begin; i < end; i++) {
+                (*transfPoints)[i] = transformOp((*origPoints)[i]);
+            }
+        });
+}
+
+}
+
 void KisWarpTransformWorker::run(KisPaintDeviceSP srcDev, KisPaintDeviceSP dstDev)
 {
     KIS_SAFE_ASSERT_RECOVER_RETURN(*srcDev->colorSpace() == *dstDev->colorSpace());
@@ -242,12 +301,25 @@ void KisWarpTransformWorker::run(KisPaintDeviceSP srcDev, KisPaintDeviceSP dstDe
 
     dstDev->clear();
 
+    if (srcBounds.isEmpty()) return;
+
     const int pixelPrecision = 8;
 
     FunctionTransformOp functionOp(m_warpMathFunction, m_origPoint, m_transfPoint, m_alpha);
+
+    QSize gridSize;
+    QVector<QPointF> origPoints;
+    QVector<QPointF> transfPoints;
+    calculateForwardMappingGrid(srcBounds, pixelPrecision, functionOp,
+                                &gridSize, &origPoints, &transfPoints);
+
     GridIterationTools::PaintDevicePolygonOp polygonOp(srcDev, dstDev);
-    GridIterationTools::processGrid(polygonOp, functionOp,
-                                    srcBounds, pixelPrecision);
+    GridIterationTools::RegularGridIndexesOp indexesOp(gridSize);
+    GridIterationTools::iterateThroughGrid
+            <GridIterationTools::AlwaysCompletePolygonPolicy>(polygonOp, indexesOp,
+                                                              gridSize,
+                                                              origPoints,
+                                                              transfPoints);
 }
 
 #include "krita_utils.h"
@@ -346,8 +418,20 @@ QImage KisWarpTransformWorker::transformQImage(WarpType warpType,
     dstImage.fill(0);
 
     const int pixelPrecision = 32;
+
+    QSize gridSize;
+    QVector<QPointF> origPoints;
+    QVector<QPointF> transfPoints;
+    calculateForwardMappingGrid(srcBounds.toAlignedRect(), pixelPrecision, functionOp,
+                                &gridSize, &origPoints, &transfPoints);
+
     GridIterationTools::QImagePolygonOp polygonOp(srcImage, dstImage, srcQImageOffset, dstQImageOffset);
-    GridIterationTools::processGrid(polygonOp, functionOp, srcBounds.toAlignedRect(), pixelPrecision);
+    GridIterationTools::RegularGridIndexesOp indexesOp(gridSize);
+    GridIterationTools::iterateThroughGrid
+            <GridIterationTools::AlwaysCompletePolygonPolicy>(polygonOp, indexesOp,
+                                                              gridSize,
+                                                              origPoints,
+                                                              transfPoints);
 
     return dstImage;
 }
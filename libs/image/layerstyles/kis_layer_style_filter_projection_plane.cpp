@@ -69,6 +69,9 @@ void KisLayerStyleFilterProjectionPlane::setStyle(KisLayerStyleFilter *filter, K
 {
     m_d->filter.reset(filter);
     m_d->style = style;
+
+    // the cached masks depend on the parameters of the old style
+    m_d->projection.freeCachedMasks();
 }
 
 QRect KisLayerStyleFilterProjectionPlane::recalculate(const QRect& rect, KisNodeSP filthyNode, KisRenderPassFlags flags)
@@ -108,16 +108,13 @@ struct ShadowRectsData
     QRect spreadNeedRect;
 };
 
-void KisLsDropShadowFilter::applyDropShadow(KisPaintDeviceSP srcDevice,
-                                            KisMultipleProjection *dst,
-                                            const QRect &applyRect,
-                                            const psd_layer_effects_context *context,
-                                            const psd_layer_effects_shadow_base *shadow,
-                                            KisResourcesInterfaceSP resourcesInterface,
-                                            KisLayerStyleFilterEnvironment *env) const
+void KisLsDropShadowFilter::calculateShadowMask(KisPaintDeviceSP srcDevice,
+                                                KisPixelSelectionSP dstMask,
+                                                const QRect &applyRect,
+                                                const psd_layer_effects_context *context,
+                                                const psd_layer_effects_shadow_base *shadow,
+                                                KisLayerStyleFilterEnvironment *env) const
 {
-    if (applyRect.isEmpty()) return;
-
     ShadowRectsData d(applyRect, context, shadow, ShadowRectsData::NEED_RECT);
 
     KisCachedSelection::Guard s1(*env->cachedSelection());
@@ -220,6 +217,49 @@ void KisLsDropShadowFilter::applyDropShadow(KisPaintDeviceSP srcDevice,
     }
     //selection->convertToQImage(0, QRect(0,0,300,300)).save("5_selection_knockout.png");
 
+    KisPainter::copyAreaOptimized(d.dstRect.topLeft(), selection, dstMask, d.dstRect);
+}
+
+
+void KisLsDropShadowFilter::applyDropShadow(KisPaintDeviceSP srcDevice,
+                                            KisMultipleProjection *dst,
+                                            const QRect &applyRect,
+                                            const psd_layer_effects_context *context,
+                                            const psd_layer_effects_shadow_base *shadow,
+                                            KisResourcesInterfaceSP resourcesInterface,
+                                            KisLayerStyleFilterEnvironment *env) const
+{
+    if (applyRect.isEmpty()) return;
+
+    ShadowRectsData d(applyRect, context, shadow, ShadowRectsData::NEED_RECT);
+
+    const psd_layer_effects_inner_glow *iglow =
+        dynamic_cast<const psd_layer_effects_inner_glow *>(shadow);
+
+    uint paramsHash = qHash(int(m_mode));
+    paramsHash = qHash(iglow ? int(iglow->source()) : -1, paramsHash);
+    paramsHash = KisLsUtils::shadowMaskParamsHash(shadow, context, paramsHash);
+
+    KisCachedSelection::Guard s1(*env->cachedSelection());
+    KisSelectionSP baseSelection = s1.selection();
+
+    /**
+     * The blurred shadow mask is expensive to calculate, so it is cached
+     * and only the area affected by the actually changed pixels of the
+     * source is recalculated
+     */
+    dst->fetchCachedMask("shadow_mask", env->currentLevelOfDetail(), paramsHash, srcDevice, applyRect,
+        [context, shadow] (const QRect &rc) {
+            return ShadowRectsData(rc, context, shadow, ShadowRectsData::NEED_RECT).finalNeedRect();
+        },
+        [context, shadow] (const QRect &rc) {
+            return ShadowRectsData(rc, context, shadow, ShadowRectsData::CHANGE_RECT).finalChangeRect();
+        },
+        [this, srcDevice, context, shadow, env] (const QRect &rc, KisPixelSelectionSP dstMask) {
+            calculateShadowMask(srcDevice, dstMask, rc, context, shadow, env);
+        },
+        baseSelection->pixelSelection());
+
     KisLsUtils::applyFinalSelection(KisMultipleProjection::defaultProjectionId(),
                                     baseSelection,
                                     srcDevice,
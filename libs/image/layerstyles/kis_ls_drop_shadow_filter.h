@@ -51,6 +51,13 @@ private:
                          const psd_layer_effects_shadow_base *shadow, KisResourcesInterfaceSP resourcesInterface,
                          KisLayerStyleFilterEnvironment *env) const;
 
+    void calculateShadowMask(KisPaintDeviceSP srcDevice,
+                             KisPixelSelectionSP dstMask,
+                             const QRect &applyRect,
+                             const psd_layer_effects_context *context,
+                             const psd_layer_effects_shadow_base *shadow,
+                             KisLayerStyleFilterEnvironment *env) const;
+
 private:
     const Mode m_mode;
 };
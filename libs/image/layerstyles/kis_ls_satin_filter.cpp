@@ -118,25 +118,18 @@ void blendAndOffsetSatinSelection(KisPixelSelectionSP dstSelection,
     }
 }
 
-//#include "kis_paint_device_debug_utils.h"
-
-void KisLsSatinFilter::applySatin(KisPaintDeviceSP srcDevice,
-                                  KisMultipleProjection *dst,
-                                  const QRect &applyRect,
-                                  const psd_layer_effects_context *context,
-                                  const psd_layer_effects_satin *config,
-                                  KisResourcesInterfaceSP resourcesInterface,
-                                  KisLayerStyleFilterEnvironment *env) const
+void calculateSatinMask(KisPaintDeviceSP srcDevice,
+                        KisPixelSelectionSP dstMask,
+                        const QRect &applyRect,
+                        const psd_layer_effects_context *context,
+                        const psd_layer_effects_satin *config,
+                        KisLayerStyleFilterEnvironment *env)
 {
-    if (applyRect.isEmpty()) return;
-
     SatinRectsData d(applyRect, context, config, SatinRectsData::NEED_RECT);
 
     KisCachedSelection::Guard s1(*env->cachedSelection());
-    KisSelectionSP baseSelection = s1.selection();
-    KisLsUtils::selectionFromAlphaChannel(srcDevice, baseSelection, d.blurNeedRect);
-
-    KisPixelSelectionSP selection = baseSelection->pixelSelection();
+    KisPixelSelectionSP selection = s1.selection()->pixelSelection();
+    KisLsUtils::selectionFromAlphaChannel(srcDevice, s1.selection(), d.blurNeedRect);
 
     KisCachedSelection::Guard s2(*env->cachedSelection());
     KisPixelSelectionSP tempSelection = s2.selection()->pixelSelection();
@@ -159,13 +152,46 @@ void KisLsSatinFilter::applySatin(KisPaintDeviceSP srcDevice,
 
     //KIS_DUMP_DEVICE_2(tempSelection, QRect(0,0,64,64), "02_contour", "dd");
 
-    blendAndOffsetSatinSelection(selection,
+    blendAndOffsetSatinSelection(dstMask,
                                  tempSelection,
                                  config->invert(),
                                  d.offset,
                                  d.dstRect);
+}
+
+//#include "kis_paint_device_debug_utils.h"
+
+void KisLsSatinFilter::applySatin(KisPaintDeviceSP srcDevice,
+                                  KisMultipleProjection *dst,
+                                  const QRect &applyRect,
+                                  const psd_layer_effects_context *context,
+                                  const psd_layer_effects_satin *config,
+                                  KisResourcesInterfaceSP resourcesInterface,
+                                  KisLayerStyleFilterEnvironment *env) const
+{
+    if (applyRect.isEmpty()) return;
+
+    SatinRectsData d(applyRect, context, config, SatinRectsData::NEED_RECT);
+
+    const uint paramsHash =
+        KisLsUtils::shadowMaskParamsHash(config, context, qHash(int(config->invert())));
+
+    KisCachedSelection::Guard s1(*env->cachedSelection());
+    KisSelectionSP baseSelection = s1.selection();
 
-    //KIS_DUMP_DEVICE_2(selection, QRect(0,0,64,64), "03_blended", "dd");
+    dst->fetchCachedMask("satin_mask", env->currentLevelOfDetail(), paramsHash, srcDevice, applyRect,
+        [context, config] (const QRect &rc) {
+            return SatinRectsData(rc, context, config, SatinRectsData::NEED_RECT).finalNeedRect();
+        },
+        [context, config] (const QRect &rc) {
+            return SatinRectsData(rc, context, config, SatinRectsData::CHANGE_RECT).finalChangeRect();
+        },
+        [srcDevice, context, config, env] (const QRect &rc, KisPixelSelectionSP dstMask) {
+            calculateSatinMask(srcDevice, dstMask, rc, context, config, env);
+        },
+        baseSelection->pixelSelection());
+
+    //KIS_DUMP_DEVICE_2(baseSelection->pixelSelection(), QRect(0,0,64,64), "03_blended", "dd");
 
     KisLsUtils::applyFinalSelection(KisMultipleProjection::defaultProjectionId(),
                                     baseSelection,
@@ -60,6 +60,42 @@ int borderSize(psd_stroke_position position, int size)
     return border;
 }
 
+void calculateStrokeMask(KisPaintDeviceSP srcDevice,
+                         KisPixelSelectionSP dstMask,
+                         const QRect &applyRect,
+                         int border,
+                         const psd_layer_effects_stroke *config,
+                         KisLayerStyleFilterEnvironment *env)
+{
+    const QRect needRect = kisGrowRect(applyRect, border);
+
+    KisCachedSelection::Guard s1(*env->cachedSelection());
+    KisPixelSelectionSP dilatedSelection = s1.selection()->pixelSelection();
+    KisLsUtils::selectionFromAlphaChannel(srcDevice, s1.selection(), needRect);
+
+    KisCachedSelection::Guard s2(*env->cachedSelection());
+    KisPixelSelectionSP erodedSelection = s2.selection()->pixelSelection();
+    erodedSelection->makeCloneFromRough(dilatedSelection, needRect);
+
+    if (config->position() == psd_stroke_outside) {
+        KisGaussianKernel::applyDilate(dilatedSelection, needRect, config->size(), QBitArray(), 0, true);
+    } else if (config->position() == psd_stroke_inside) {
+        KisGaussianKernel::applyErodeU8(erodedSelection, needRect, config->size(), QBitArray(), 0, true);
+    } else if (config->position() == psd_stroke_center) {
+        KisGaussianKernel::applyDilate(dilatedSelection, needRect, 0.5 * config->size(), QBitArray(), 0, true);
+        KisGaussianKernel::applyErodeU8(erodedSelection, needRect, 0.5 * config->size(), QBitArray(), 0, true);
+    }
+
+    KisPainter gc(dstMask);
+
+    gc.setCompositeOpId(COMPOSITE_COPY);
+    gc.bitBlt(applyRect.topLeft(), dilatedSelection, applyRect);
+
+    gc.setCompositeOpId(COMPOSITE_ERASE);
+    gc.bitBlt(applyRect.topLeft(), erodedSelection, applyRect);
+    gc.end();
+}
+
 }
 
 
@@ -88,38 +124,24 @@ void KisLsStrokeFilter::applyStroke(KisPaintDeviceSP srcDevice,
 {
     if (applyRect.isEmpty()) return;
 
-    const QRect needRect = kisGrowRect(applyRect, borderSize(config->position(), config->size()));
-
     KisSelectionSP baseSelection = blower->knockoutSelectionLazy();
-    KisPixelSelectionSP selection = baseSelection->pixelSelection();
-
-    KisCachedSelection::Guard s1(*env->cachedSelection());
-    KisPixelSelectionSP dilatedSelection = s1.selection()->pixelSelection();
-    KisLsUtils::selectionFromAlphaChannel(srcDevice, s1.selection(), needRect);
 
-    {
-        KisCachedSelection::Guard s2(*env->cachedSelection());
-        KisPixelSelectionSP erodedSelection = s2.selection()->pixelSelection();
-        erodedSelection->makeCloneFromRough(dilatedSelection, needRect);
-
-        if (config->position() == psd_stroke_outside) {
-            KisGaussianKernel::applyDilate(dilatedSelection, needRect, config->size(), QBitArray(), 0, true);
-        } else if (config->position() == psd_stroke_inside) {
-            KisGaussianKernel::applyErodeU8(erodedSelection, needRect, config->size(), QBitArray(), 0, true);
-        } else if (config->position() == psd_stroke_center) {
-            KisGaussianKernel::applyDilate(dilatedSelection, needRect, 0.5 * config->size(), QBitArray(), 0, true);
-            KisGaussianKernel::applyErodeU8(erodedSelection, needRect, 0.5 * config->size(), QBitArray(), 0, true);
-        }
-
-        KisPainter gc(selection);
-
-        gc.setCompositeOpId(COMPOSITE_COPY);
-        gc.bitBlt(applyRect.topLeft(), dilatedSelection, applyRect);
-
-        gc.setCompositeOpId(COMPOSITE_ERASE);
-        gc.bitBlt(applyRect.topLeft(), erodedSelection, applyRect);
-        gc.end();
-    }
+    const int border = borderSize(config->position(), config->size());
+
+    uint paramsHash = qHash(int(config->position()));
+    paramsHash = qHash(config->size(), paramsHash);
+
+    dst->fetchCachedMask("stroke_mask", env->currentLevelOfDetail(), paramsHash, srcDevice, applyRect,
+        [border] (const QRect &rc) {
+            return kisGrowRect(rc, border);
+        },
+        [border] (const QRect &rc) {
+            return kisGrowRect(rc, border);
+        },
+        [srcDevice, config, env, border] (const QRect &rc, KisPixelSelectionSP dstMask) {
+            calculateStrokeMask(srcDevice, dstMask, rc, border, config, env);
+        },
+        baseSelection->pixelSelection());
 
     const QString compositeOp = config->blendMode();
     const quint8 opacityU8 = quint8(qRound(255.0 / 100.0 * config->opacity()));
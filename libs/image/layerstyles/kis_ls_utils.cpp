@@ -589,4 +589,27 @@ namespace KisLsUtils
 
         return result;
     }
+
+    uint shadowMaskParamsHash(const psd_layer_effects_shadow_base *config,
+                              const psd_layer_effects_context *context,
+                              uint seed)
+    {
+        const QPoint offset = config->calculateOffset(context);
+
+        uint hash = seed;
+        hash = qHash(config->size(), hash);
+        hash = qHash(config->spread(), hash);
+        hash = qHash(offset.x(), hash);
+        hash = qHash(offset.y(), hash);
+        hash = qHash(config->noise(), hash);
+        hash = qHash(int(config->invertsSelection()), hash);
+        hash = qHash(int(config->knocksOut()), hash);
+        hash = qHash(int(config->technique()), hash);
+        hash = qHash(config->range(), hash);
+        hash = qHash(int(config->antiAliased()), hash);
+        hash = qHash(int(config->edgeHidden()), hash);
+        hash = qHashBits(config->contourLookupTable(), PSD_LOOKUP_TABLE_SIZE, hash);
+
+        return hash;
+    }
 }
@@ -88,6 +88,17 @@ namespace KisLsUtils
 
     bool checkEffectEnabled(const psd_layer_effects_shadow_base *config, KisMultipleProjection *dst);
 
+    /**
+     * Calculates a hash of the parameters of a shadow-like effect that
+     * its intermediate mask depends on. The color, the opacity and the
+     * blending mode of the effect are not included. The level of detail
+     * is not included either, the masks of different levels of detail are
+     * cached separately (see KisMultipleProjection::fetchCachedMask()).
+     */
+    uint shadowMaskParamsHash(const psd_layer_effects_shadow_base *config,
+                              const psd_layer_effects_context *context,
+                              uint seed = 0);
+
     template<class ConfigStruct>
     struct LodWrapper
     {
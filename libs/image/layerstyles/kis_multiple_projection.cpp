@@ -7,13 +7,21 @@
 #include "kis_multiple_projection.h"
 
 #include <QMap>
+#include <QMutex>
 #include <QReadWriteLock>
+#include <QRegion>
+#include <QSharedPointer>
+#include <QWeakPointer>
+#include <QGlobalStatic>
 
 
 #include <KoColorSpace.h>
 
 #include "kis_painter.h"
 #include "kis_paint_device.h"
+#include "kis_pixel_selection.h"
+#include "kis_sequential_iterator.h"
+#include "kis_image_config.h"
 #include "kis_layer_style_filter_environment.h"
 
 
@@ -26,10 +34,137 @@ struct ProjectionStruct {
 
 typedef QMap<QString, ProjectionStruct> PlanesMap;
 
+struct CachedMaskStruct {
+    /// guards all the fields below, the map of the masks has its own lock
+    QMutex lock;
+
+    uint paramsHash = 0;
+
+    /// alpha channel of the source the mask has been calculated from
+    KisPixelSelectionSP sourceAlpha = new KisPixelSelection();
+
+    KisPixelSelectionSP mask = new KisPixelSelection();
+
+    /// the area where the mask is up-to-date
+    QRegion validRegion;
+
+    /// the area of the source that has been fetched into the cache
+    QRect cachedRect;
+
+    /// incremented every time a part of the valid region is dropped
+    int invalidationSeqNo = 0;
+
+    void reset() {
+        sourceAlpha = new KisPixelSelection();
+        mask = new KisPixelSelection();
+        validRegion = QRegion();
+        cachedRect = QRect();
+        invalidationSeqNo++;
+    }
+
+    qint64 memoryFootprint() const {
+        // both the source alpha and the mask are 8-bit
+        return 2 * qint64(cachedRect.width()) * cachedRect.height();
+    }
+};
+
+typedef QSharedPointer<CachedMaskStruct> CachedMaskStructSP;
+
+/// the masks are cached per effect id and level of detail
+typedef QPair<QString, int> CachedMaskKey;
+typedef QMap<CachedMaskKey, CachedMaskStructSP> CachedMasksMap;
+
+/**
+ * The cached masks of all the layers share a process-wide memory budget
+ * (KisImageConfig::layerStyleMaskCacheSize()). When it is exceeded, the
+ * least recently used masks are dropped. The budget keeps only weak
+ * references, so the masks of the deleted layers need no unregistering.
+ */
+class CachedMasksBudget
+{
+public:
+    CachedMasksBudget()
+        : m_maxBytes(qint64(KisImageConfig(true).layerStyleMaskCacheSize()) * 1024 * 1024)
+    {
+    }
+
+    qint64 maxBytes() const {
+        return m_maxBytes;
+    }
+
+    /**
+     * Marks \p cache as the most recently used mask and updates its size.
+     * Must not be called while holding the lock of any cached mask.
+     */
+    void touch(CachedMaskStructSP cache, qint64 bytes) {
+        QVector<CachedMaskStructSP> victims;
+
+        {
+            QMutexLocker locker(&m_lock);
+
+            for (auto it = m_records.begin(); it != m_records.end();) {
+                if (it->entry.isNull() || it->entry == cache) {
+                    m_totalBytes -= it->bytes;
+                    it = m_records.erase(it);
+                } else {
+                    ++it;
+                }
+            }
+
+            m_records.append({cache.toWeakRef(), bytes});
+            m_totalBytes += bytes;
+
+            while (m_totalBytes > m_maxBytes && m_records.size() > 1) {
+                const Record record = m_records.takeFirst();
+                m_totalBytes -= record.bytes;
+
+                CachedMaskStructSP victim = record.entry.toStrongRef();
+                if (victim) {
+                    victims.append(victim);
+                }
+            }
+        }
+
+        for (CachedMaskStructSP victim : victims) {
+            QMutexLocker locker(&victim->lock);
+            victim->reset();
+        }
+    }
+
+private:
+    struct Record {
+        QWeakPointer<CachedMaskStruct> entry;
+        qint64 bytes = 0;
+    };
+
+    QMutex m_lock;
+    QList<Record> m_records;
+    qint64 m_totalBytes = 0;
+    const qint64 m_maxBytes;
+};
+
+Q_GLOBAL_STATIC(CachedMasksBudget, s_cachedMasksBudget)
+
+/**
+ * When the valid region of the mask becomes too fragmented, it is reduced
+ * to the last calculated rect
+ */
+static const int maxValidRegionRects = 256;
+
+/**
+ * When the cached area of the source grows above this limit, the cache
+ * is restarted from the currently requested rect. The requests that are
+ * bigger than the limit are not cached at all.
+ */
+static const qint64 maxCachedMaskPixels = 8192 * 8192;
+
 struct KisMultipleProjection::Private
 {
     QReadWriteLock lock;
     PlanesMap planes;
+
+    QMutex masksLock;
+    CachedMasksMap masks;
 };
 
 
@@ -118,8 +253,12 @@ void KisMultipleProjection::freeProjection(const QString &id)
 
 void KisMultipleProjection::freeAllProjections()
 {
-    QWriteLocker writeLocker(&m_d->lock);
-    m_d->planes.clear();
+    {
+        QWriteLocker writeLocker(&m_d->lock);
+        m_d->planes.clear();
+    }
+
+    freeCachedMasks();
 }
 
 void KisMultipleProjection::clear(const QRect &rc)
@@ -164,6 +303,150 @@ KisPaintDeviceList KisMultipleProjection::getLodCapableDevices() const
     return list;
 }
 
+void KisMultipleProjection::fetchCachedMask(const QString &id,
+                                            int levelOfDetail,
+                                            uint paramsHash,
+                                            KisPaintDeviceSP srcDevice,
+                                            const QRect &applyRect,
+                                            RectMapper needRect,
+                                            RectMapper changeRect,
+                                            MaskCalculator calculator,
+                                            KisPixelSelectionSP dstMask)
+{
+    if (applyRect.isEmpty()) return;
+
+    const QRect srcRect = needRect(applyRect);
+
+    auto area = [] (const QRect &rc) { return qint64(rc.width()) * rc.height(); };
+
+    const qint64 maxCachedPixels =
+        qMin(maxCachedMaskPixels, s_cachedMasksBudget->maxBytes() / 2);
+
+    if (area(srcRect) > maxCachedPixels) {
+        calculator(applyRect, dstMask);
+        return;
+    }
+
+    const int srcWidth = srcRect.width();
+
+    QVector<quint8> srcAlpha(srcWidth * srcRect.height());
+
+    {
+        const KoColorSpace *cs = srcDevice->colorSpace();
+        KisSequentialConstIterator srcIt(srcDevice, srcRect);
+        quint8 *dstPtr = srcAlpha.data();
+
+        while (srcIt.nextPixel()) {
+            *dstPtr++ = cs->opacityU8(srcIt.rawDataConst());
+        }
+    }
+
+    /**
+     * The cache is updated under the lock, but the mask itself is
+     * calculated outside of it, so the concurrent updates of the same
+     * effect don't wait for each other
+     */
+    const CachedMaskKey key(id, levelOfDetail);
+    CachedMaskStructSP cache;
+    QRect dirtyRect;
+    int invalidationSeqNo = 0;
+    qint64 cacheBytes = 0;
+
+    {
+        QMutexLocker locker(&m_d->masksLock);
+
+        cache = m_d->masks.value(key);
+
+        if (!cache || cache->paramsHash != paramsHash) {
+            cache.reset(new CachedMaskStruct());
+            cache->paramsHash = paramsHash;
+            m_d->masks.insert(key, cache);
+        }
+    }
+
+    {
+        QMutexLocker locker(&cache->lock);
+
+        if (area(cache->cachedRect | srcRect) > maxCachedPixels) {
+            cache->reset();
+        }
+
+        /**
+         * The areas of the source that have never been fetched are considered
+         * transparent. It is safe, because the valid region of the mask never
+         * depends on them.
+         */
+        QVector<quint8> cachedAlpha(srcAlpha.size());
+        cache->sourceAlpha->readBytes(cachedAlpha.data(), srcRect);
+
+        QRect changedRect;
+
+        for (int y = 0; y < srcRect.height(); y++) {
+            const quint8 *srcRow = srcAlpha.constData() + y * srcWidth;
+            const quint8 *cachedRow = cachedAlpha.constData() + y * srcWidth;
+
+            if (!memcmp(srcRow, cachedRow, srcWidth)) continue;
+
+            int left = 0;
+            while (srcRow[left] == cachedRow[left]) left++;
+
+            int right = srcWidth - 1;
+            while (srcRow[right] == cachedRow[right]) right--;
+
+            changedRect |= QRect(srcRect.x() + left, srcRect.y() + y, right - left + 1, 1);
+        }
+
+        if (!changedRect.isEmpty()) {
+            cache->validRegion -= changeRect(changedRect);
+            cache->invalidationSeqNo++;
+            cache->sourceAlpha->writeBytes(srcAlpha.constData(), srcRect);
+        }
+
+        cache->cachedRect |= srcRect;
+
+        dirtyRect = (QRegion(applyRect) - cache->validRegion).boundingRect();
+        invalidationSeqNo = cache->invalidationSeqNo;
+
+        KisPainter::copyAreaOptimized(applyRect.topLeft(), cache->mask, dstMask, applyRect);
+
+        cacheBytes = cache->memoryFootprint();
+    }
+
+    s_cachedMasksBudget->touch(cache, cacheBytes);
+
+    if (dirtyRect.isEmpty()) return;
+
+    KisPixelSelectionSP freshMask = new KisPixelSelection();
+    calculator(dirtyRect, freshMask);
+
+    KisPainter::copyAreaOptimized(dirtyRect.topLeft(), freshMask, dstMask, dirtyRect);
+
+    QMutexLocker locker(&m_d->masksLock);
+
+    /**
+     * If the cache has been replaced, reset or invalidated while we were
+     * calculating the mask, our result might be outdated, so don't store it
+     */
+    if (m_d->masks.value(key) != cache) return;
+
+    QMutexLocker cacheLocker(&cache->lock);
+
+    if (cache->invalidationSeqNo != invalidationSeqNo) return;
+
+    KisPainter::copyAreaOptimized(dirtyRect.topLeft(), freshMask, cache->mask, dirtyRect);
+
+    cache->validRegion += dirtyRect;
+    if (cache->validRegion.rectCount() > maxValidRegionRects) {
+        cache->validRegion = applyRect;
+    }
+}
+
+void KisMultipleProjection::freeCachedMasks()
+{
+    QMutexLocker locker(&m_d->masksLock);
+    m_d->masks.clear();
+}
+
 bool KisMultipleProjection::isEmpty() const
 {
     return m_d->planes.isEmpty();
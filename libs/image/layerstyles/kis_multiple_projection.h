@@ -8,6 +8,7 @@
 #define __KIS_MULTIPLE_PROJECTION_H
 
 #include <QScopedPointer>
+#include <functional>
 #include "kis_types.h"
 #include "kritaimage_export.h"
 
@@ -32,6 +33,58 @@ public:
 
     KisPaintDeviceList getLodCapableDevices() const;
 
+    /**
+     * Calculates the intermediate mask of an effect in the passed rect and
+     * writes it into the passed selection. The function must not modify the
+     * selection outside the rect.
+     */
+    using MaskCalculator = std::function<void(const QRect &rect, KisPixelSelectionSP dstMask)>;
+
+    /**
+     * Maps a rect into another one, e.g. needRect() or changeRect() of an effect
+     */
+    using RectMapper = std::function<QRect(const QRect &rect)>;
+
+    /**
+     * Writes the intermediate mask of effect \p id in \p applyRect into \p dstMask.
+     *
+     * The mask is cached together with the alpha channel of \p srcDevice it
+     * has been calculated from. On every call the current alpha channel is
+     * compared to the cached one and only the part of the mask affected by
+     * the actually changed pixels is recalculated with \p calculator.
+     *
+     * The masks are cached separately for every level of detail, so
+     * switching between the instant preview and the full resolution
+     * doesn't drop them. The cache is dropped when \p paramsHash changes,
+     * so the hash must cover all the other parameters of the effect the
+     * mask depends on.
+     *
+     * The mask is calculated outside the cache lock, so the concurrent
+     * calls may run \p calculator in parallel. The memory of the masks
+     * cached by all the layers is limited by
+     * KisImageConfig::layerStyleMaskCacheSize(), the least recently used
+     * masks are dropped first. The requests that don't fit into the cache
+     * are calculated directly.
+     *
+     * @param needRect maps a rect of the mask into the rect of the source it depends on
+     * @param changeRect maps a changed rect of the source into the affected rect of the mask
+     */
+    void fetchCachedMask(const QString &id,
+                         int levelOfDetail,
+                         uint paramsHash,
+                         KisPaintDeviceSP srcDevice,
+                         const QRect &applyRect,
+                         RectMapper needRect,
+                         RectMapper changeRect,
+                         MaskCalculator calculator,
+                         KisPixelSelectionSP dstMask);
+
+    /**
+     * Drops all the cached masks, must be called when the style of the
+     * layer is changed. freeAllProjections() drops the masks as well.
+     */
+    void freeCachedMasks();
+
     bool isEmpty() const;
 
 private:
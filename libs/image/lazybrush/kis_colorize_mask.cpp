@@ -125,6 +125,9 @@ struct KisColorizeMask::Private
 
     bool limitToDeviceBounds = false;
 
+    KisColorizeStrokeStrategy::MultiResolutionCacheSP multiResolutionCache =
+        KisColorizeStrokeStrategy::createMultiResolutionCache();
+
     bool filteredSourceValid(KisPaintDeviceSP parentDevice) {
         return !filteringDirty && originalSequenceNumber == parentDevice->sequenceNumber();
     }
@@ -355,6 +358,7 @@ void KisColorizeMask::slotUpdateRegenerateFilling(bool prefilterOnly)
                                           prefilterOnly);
 
         strategy->setFilteringOptions(m_d->filteringOptions);
+        strategy->setMultiResolutionCache(m_d->multiResolutionCache);
 
         Q_FOREACH (const KeyStroke &stroke, m_d->keyStrokes) {
             const KoColor color =
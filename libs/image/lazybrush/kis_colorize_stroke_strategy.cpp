@@ -6,7 +6,13 @@
 
 #include "kis_colorize_stroke_strategy.h"
 
+#include <atomic>
+
 #include <QBitArray>
+#include <QtMath>
+
+#include <KoUpdater.h>
+#include <KoColorSpaceRegistry.h>
 
 #include "krita_utils.h"
 #include "kis_paint_device.h"
@@ -21,6 +27,8 @@
 #include "kis_processing_visitor.h"
 
 #include "kis_transaction.h"
+#include "kis_algebra_2d.h"
+#include "kis_pointer_utils.h"
 
 #include <KisRunnableStrokeJobData.h>
 #include <KisRunnableStrokeJobUtils.h>
@@ -28,6 +36,112 @@
 
 using namespace KisLazyFillTools;
 
+struct KisColorizeStrokeStrategy::MultiResolutionCache
+{
+    QRect boundingRect;
+    int scale = 0;
+    qreal cleanUpAmount = 0.0;
+    QVector<QByteArray> strokeColors;
+
+    /**
+     * Hashes of the seeds used for refinement of every patch, the patches
+     * are ordered the same way as returned by splitRectIntoPatches(). Zero
+     * hash means the patch has not been refined at all.
+     */
+    QVector<uint> patchHashes;
+    KisPaintDeviceSP refinedColoring;
+
+    void reset() {
+        boundingRect = QRect();
+        scale = 0;
+        cleanUpAmount = 0.0;
+        strokeColors.clear();
+        patchHashes.clear();
+        refinedColoring = 0;
+    }
+};
+
+namespace {
+
+/**
+ * The size of the patches the multi-resolution solver refines
+ * independently. It must be divisible by all the possible scales.
+ */
+const int multiResolutionPatchSize = 256;
+
+/**
+ * The maximum size of the coarse level, which is solved by a single
+ * (sequential) watershed pass.
+ */
+const qint64 multiResolutionMaxCoarsePixels = 2 * 1024 * 1024;
+
+/**
+ * The key strokes may have the same (or transparent) colors, so the coarse
+ * level is solved with synthetic colors that encode the index of the stroke
+ */
+KoColor labelToSyntheticColor(int label, const KoColorSpace *cs)
+{
+    KoColor color(Qt::transparent, cs);
+    quint8 *data = color.data();
+
+    const quint32 value = label + 1;
+    data[0] = value & 0xff;
+    data[1] = (value >> 8) & 0xff;
+    data[2] = (value >> 16) & 0xff;
+    data[3] = 0xff;
+
+    return color;
+}
+
+inline int syntheticColorToLabel(const quint8 *data)
+{
+    return data[3] ? int(data[0] | (data[1] << 8) | (data[2] << 16)) - 1 : -1;
+}
+
+inline QRect coarseRectForRect(const QRect &rc, int scale)
+{
+    return QRect(QPoint(KisAlgebra2D::divideFloor(rc.left(), scale),
+                        KisAlgebra2D::divideFloor(rc.top(), scale)),
+                 QPoint(KisAlgebra2D::divideFloor(rc.right(), scale),
+                        KisAlgebra2D::divideFloor(rc.bottom(), scale)));
+}
+
+struct MultiResolutionSharedState
+{
+    QRect boundingRect;
+    QVector<QRect> patches;
+    int scale = 1;
+    QRect coarseRect;
+    qreal cleanUpAmount = 0.0;
+
+    KisPaintDeviceSP coarseHeightMap;
+    QVector<KisPaintDeviceSP> coarseKeyStrokes;
+
+    /// stroke label of every pixel of coarseRect, -1 means "unfilled"
+    QVector<qint32> coarseLabels;
+
+    /// non-zero for the coarse pixels lying near the borders of the labels
+    QVector<quint8> coarseBand;
+
+    QVector<QByteArray> strokeColors;
+    QVector<uint> patchHashes;
+
+    KisColorizeStrokeStrategy::MultiResolutionCacheSP cache;
+    bool cacheValid = false;
+
+    KoUpdater *updater = 0;
+
+    /// set by the concurrent refinement jobs, so it should be atomic
+    std::atomic<bool> cancelled {false};
+
+    inline int coarseIndex(int x, int y) const {
+        return (KisAlgebra2D::divideFloor(y, scale) - coarseRect.y()) * coarseRect.width() +
+               (KisAlgebra2D::divideFloor(x, scale) - coarseRect.x());
+    }
+};
+
+}
+
 struct KisColorizeStrokeStrategy::Private
 {
     Private() : filteredSourceValid(false) {}
@@ -62,8 +176,337 @@ struct KisColorizeStrokeStrategy::Private
 
     // default values: disabled
     FilteringOptions filteringOptions;
+
+    // the cache is never shared with the LoD clones
+    MultiResolutionCacheSP multiResolutionCache;
+
+    int chooseMultiResolutionScale() const;
+    void addMultiResolutionJobs(QVector<KisRunnableStrokeJobData*> &jobs, bool heightMapChanged);
 };
 
+int KisColorizeStrokeStrategy::Private::chooseMultiResolutionScale() const
+{
+    if (prefilterOnly || levelOfDetail > 0 || keyStrokes.isEmpty()) return 1;
+
+    KisImageConfig cfg(true);
+    if (!cfg.useMultiResolutionColorizeMask()) return 1;
+
+    const qint64 numPixels = qint64(boundingRect.width()) * boundingRect.height();
+    if (numPixels < cfg.multiResolutionColorizeMaskMinPixels()) return 1;
+
+    int scale = 2;
+    while (scale < 16 && numPixels / (scale * scale) > multiResolutionMaxCoarsePixels) {
+        scale *= 2;
+    }
+
+    return scale;
+}
+
+/**
+ * The multi-resolution solver works in three stages:
+ *
+ * 1) The height map and the key strokes are downscaled by max-pooling,
+ *    so that thin line art and tiny strokes are not lost on the coarse
+ *    level.
+ *
+ * 2) The coarse level is solved with a single watershed pass. All the
+ *    coarse pixels lying far from the borders of the labels are
+ *    considered final.
+ *
+ * 3) The band around the borders is refined on the full resolution,
+ *    concurrently, patch by patch. The refinement of every patch uses
+ *    the final coarse labels and the original key strokes as seeds, so
+ *    the patch can be solved independently from the others. When the
+ *    seeds of a patch have not changed since the previous update, the
+ *    refined pixels are just copied from the cache.
+ */
+void KisColorizeStrokeStrategy::Private::addMultiResolutionJobs(QVector<KisRunnableStrokeJobData*> &jobs, bool heightMapChanged)
+{
+    using namespace KritaUtils;
+
+    QSharedPointer<MultiResolutionSharedState> state(new MultiResolutionSharedState());
+    state->boundingRect = boundingRect;
+    state->patches = splitRectIntoPatches(boundingRect, QSize(multiResolutionPatchSize, multiResolutionPatchSize));
+    state->scale = chooseMultiResolutionScale();
+    state->coarseRect = coarseRectForRect(boundingRect, state->scale);
+    state->cleanUpAmount = filteringOptions.cleanUpAmount;
+    state->cache = multiResolutionCache;
+
+    const KoColorSpace *alpha8 = KoColorSpaceRegistry::instance()->alpha8();
+
+    state->coarseHeightMap = new KisPaintDevice(alpha8);
+
+    Q_FOREACH (const KeyStroke &stroke, keyStrokes) {
+        state->coarseKeyStrokes << new KisPaintDevice(alpha8);
+
+        const KoColor color =
+            !stroke.isTransparent ?
+            stroke.color : KoColor::createTransparent(dst->colorSpace());
+
+        state->strokeColors << QByteArray(reinterpret_cast<const char*>(color.data()),
+                                          color.colorSpace()->pixelSize());
+    }
+
+    state->patchHashes.fill(0, state->patches.size());
+
+    if (state->cache) {
+        state->cacheValid =
+            !heightMapChanged &&
+            state->cache->refinedColoring &&
+            state->cache->boundingRect == state->boundingRect &&
+            state->cache->scale == state->scale &&
+            qFuzzyCompare(state->cache->cleanUpAmount + 1.0, state->cleanUpAmount + 1.0) &&
+            state->cache->strokeColors == state->strokeColors &&
+            state->cache->patchHashes.size() == state->patches.size();
+
+        if (!state->cacheValid) {
+            state->cache->reset();
+        }
+    }
+
+    /**
+     * Stage 1: downscale the height map and the key strokes
+     */
+    Q_FOREACH (const QRect &patch, state->patches) {
+        addJobConcurrent(jobs, [this, state, patch] () {
+            const QRect coarsePatch = coarseRectForRect(patch, state->scale);
+            const QRect srcRect(coarsePatch.topLeft() * state->scale,
+                                coarsePatch.size() * state->scale);
+            const QRect validRect = srcRect & state->boundingRect;
+
+            QVector<quint8> srcBuf(srcRect.width() * srcRect.height());
+            QVector<quint8> dstBuf(coarsePatch.width() * coarsePatch.height());
+
+            auto downscale = [&] (KisPaintDeviceSP srcDevice, KisPaintDeviceSP dstDevice, bool binarize) {
+                srcDevice->readBytes(srcBuf.data(), srcRect);
+                dstBuf.fill(0);
+
+                for (int y = validRect.top(); y <= validRect.bottom(); y++) {
+                    const quint8 *srcPtr = srcBuf.constData() +
+                        (y - srcRect.y()) * srcRect.width() + (validRect.x() - srcRect.x());
+                    quint8 *dstRow = dstBuf.data() +
+                        (KisAlgebra2D::divideFloor(y, state->scale) - coarsePatch.y()) * coarsePatch.width();
+
+                    for (int x = validRect.left(); x <= validRect.right(); x++, srcPtr++) {
+                        quint8 &dstValue = dstRow[KisAlgebra2D::divideFloor(x, state->scale) - coarsePatch.x()];
+                        dstValue = qMax(dstValue, *srcPtr);
+                    }
+                }
+
+                if (binarize) {
+                    for (auto it = dstBuf.begin(); it != dstBuf.end(); ++it) {
+                        *it = *it ? 255 : 0;
+                    }
+                }
+
+                dstDevice->writeBytes(dstBuf.constData(), coarsePatch);
+            };
+
+            downscale(heightMap, state->coarseHeightMap, false);
+
+            for (int i = 0; i < keyStrokes.size(); i++) {
+                downscale(keyStrokes[i].dev, state->coarseKeyStrokes[i], true);
+            }
+        });
+    }
+
+    /**
+     * Stage 2: solve the coarse level and find the band around
+     *          the borders of the labels
+     */
+    addJobSequential(jobs, [this, state] () {
+        progressHelper.reset(new KisProcessingVisitor::ProgressHelper(progressNode));
+        state->updater = progressHelper->updater();
+
+        const KoColorSpace *rgb8 = KoColorSpaceRegistry::instance()->rgb8();
+        KisPaintDeviceSP coarseColoring = new KisPaintDevice(rgb8);
+
+        {
+            KisWatershedWorker worker(state->coarseHeightMap, coarseColoring, state->coarseRect, state->updater);
+            for (int i = 0; i < state->coarseKeyStrokes.size(); i++) {
+                worker.addKeyStroke(state->coarseKeyStrokes[i], labelToSyntheticColor(i, rgb8));
+            }
+            worker.run(state->cleanUpAmount);
+        }
+
+        if (state->updater->interrupted()) {
+            state->cancelled = true;
+            return;
+        }
+
+        const QRect &rc = state->coarseRect;
+        const int numPixels = rc.width() * rc.height();
+        const int pixelSize = rgb8->pixelSize();
+
+        QVector<quint8> coloring(numPixels * pixelSize);
+        coarseColoring->readBytes(coloring.data(), rc);
+
+        state->coarseLabels.resize(numPixels);
+        for (int i = 0; i < numPixels; i++) {
+            state->coarseLabels[i] = syntheticColorToLabel(coloring.constData() + i * pixelSize);
+        }
+
+        QVector<quint8> borders(numPixels, 0);
+
+        for (int y = 0; y < rc.height(); y++) {
+            for (int x = 0; x < rc.width(); x++) {
+                const int index = y * rc.width() + x;
+                const qint32 label = state->coarseLabels[index];
+
+                if ((x > 0 && state->coarseLabels[index - 1] != label) ||
+                    (x < rc.width() - 1 && state->coarseLabels[index + 1] != label) ||
+                    (y > 0 && state->coarseLabels[index - rc.width()] != label) ||
+                    (y < rc.height() - 1 && state->coarseLabels[index + rc.width()] != label)) {
+
+                    borders[index] = 1;
+                }
+            }
+        }
+
+        // the max-pooled line art may shift the border by one coarse pixel
+        state->coarseBand.fill(0, numPixels);
+
+        for (int y = 0; y < rc.height(); y++) {
+            for (int x = 0; x < rc.width(); x++) {
+                if (!borders[y * rc.width() + x]) continue;
+
+                for (int dy = qMax(0, y - 1); dy <= qMin(rc.height() - 1, y + 1); dy++) {
+                    for (int dx = qMax(0, x - 1); dx <= qMin(rc.width() - 1, x + 1); dx++) {
+                        state->coarseBand[dy * rc.width() + dx] = 1;
+                    }
+                }
+            }
+        }
+    });
+
+    /**
+     * Stage 3: upscale the coarse labels and refine the band
+     */
+    for (int patchIndex = 0; patchIndex < state->patches.size(); patchIndex++) {
+        addJobConcurrent(jobs, [this, state, patchIndex] () {
+            if (state->cancelled || state->updater->interrupted()) {
+                state->cancelled = true;
+                return;
+            }
+
+            const QRect patch = state->patches[patchIndex];
+            const int pixelSize = dst->pixelSize();
+            const int numLabels = state->strokeColors.size();
+
+            QVector<quint8> patchColoring(patch.width() * patch.height() * pixelSize, 0);
+            bool hasBandPixels = false;
+
+            {
+                quint8 *dstPtr = patchColoring.data();
+
+                for (int y = patch.top(); y <= patch.bottom(); y++) {
+                    for (int x = patch.left(); x <= patch.right(); x++, dstPtr += pixelSize) {
+                        const int index = state->coarseIndex(x, y);
+                        const qint32 label = state->coarseLabels[index];
+                        hasBandPixels |= bool(state->coarseBand[index]);
+
+                        if (label >= 0) {
+                            memcpy(dstPtr, state->strokeColors[label].constData(), pixelSize);
+                        }
+                    }
+                }
+            }
+
+            if (hasBandPixels) {
+                const int margin = 2 * state->scale;
+                const QRect workRect = patch.adjusted(-margin, -margin, margin, margin) & state->boundingRect;
+                const int workPixels = workRect.width() * workRect.height();
+
+                QVector<QVector<quint8>> seeds(numLabels);
+                for (int i = 0; i < numLabels; i++) {
+                    seeds[i].resize(workPixels);
+                    keyStrokes[i].dev->readBytes(seeds[i].data(), workRect);
+                }
+
+                int pixelIndex = 0;
+                for (int y = workRect.top(); y <= workRect.bottom(); y++) {
+                    for (int x = workRect.left(); x <= workRect.right(); x++, pixelIndex++) {
+                        const int index = state->coarseIndex(x, y);
+                        const qint32 label = state->coarseLabels[index];
+
+                        if (label >= 0 && !state->coarseBand[index]) {
+                            seeds[label][pixelIndex] = 255;
+                        }
+                    }
+                }
+
+                uint hash = 0;
+                for (int i = 0; i < numLabels; i++) {
+                    hash = qHashBits(seeds[i].constData(), seeds[i].size(), hash);
+                }
+
+                // zero hash is reserved for "not refined" patches
+                hash = qMax(1u, hash);
+                state->patchHashes[patchIndex] = hash;
+
+                if (state->cacheValid && state->cache->patchHashes[patchIndex] == hash) {
+                    /**
+                     * The seeds are the same, so both, the coarse labels and the
+                     * refined band of the patch are the same as the cached ones
+                     */
+                    state->cache->refinedColoring->readBytes(patchColoring.data(), patch);
+                } else {
+                    KisPaintDeviceSP refined = new KisPaintDevice(dst->colorSpace());
+
+                    {
+                        KisWatershedWorker worker(heightMap, refined, workRect);
+
+                        for (int i = 0; i < numLabels; i++) {
+                            KisPaintDeviceSP seedDevice = new KisPaintDevice(KoColorSpaceRegistry::instance()->alpha8());
+                            seedDevice->writeBytes(seeds[i].constData(), workRect);
+
+                            KoColor color(dst->colorSpace());
+                            memcpy(color.data(), state->strokeColors[i].constData(), pixelSize);
+                            worker.addKeyStroke(seedDevice, color);
+                        }
+
+                        worker.run(state->cleanUpAmount);
+                    }
+
+                    QVector<quint8> refinedColoring(patchColoring.size());
+                    refined->readBytes(refinedColoring.data(), patch);
+
+                    const quint8 *srcPtr = refinedColoring.constData();
+                    quint8 *dstPtr = patchColoring.data();
+
+                    for (int y = patch.top(); y <= patch.bottom(); y++) {
+                        for (int x = patch.left(); x <= patch.right(); x++, srcPtr += pixelSize, dstPtr += pixelSize) {
+                            if (state->coarseBand[state->coarseIndex(x, y)]) {
+                                memcpy(dstPtr, srcPtr, pixelSize);
+                            }
+                        }
+                    }
+                }
+            }
+
+            dst->writeBytes(patchColoring.constData(), patch);
+        });
+    }
+
+    addJobSequential(jobs, [this, state] () {
+        progressHelper.reset();
+
+        if (!state->cache) return;
+
+        if (state->cancelled) {
+            state->cache->reset();
+            return;
+        }
+
+        state->cache->boundingRect = state->boundingRect;
+        state->cache->scale = state->scale;
+        state->cache->cleanUpAmount = state->cleanUpAmount;
+        state->cache->strokeColors = state->strokeColors;
+        state->cache->patchHashes = state->patchHashes;
+        state->cache->refinedColoring = new KisPaintDevice(*dst);
+    });
+}
+
 KisColorizeStrokeStrategy::KisColorizeStrokeStrategy(KisPaintDeviceSP src,
                                                      KisPaintDeviceSP dst,
                                                      KisPaintDeviceSP filteredSource,
@@ -103,6 +546,16 @@ KisColorizeStrokeStrategy::~KisColorizeStrokeStrategy()
 {
 }
 
+KisColorizeStrokeStrategy::MultiResolutionCacheSP KisColorizeStrokeStrategy::createMultiResolutionCache()
+{
+    return toQShared(new MultiResolutionCache());
+}
+
+void KisColorizeStrokeStrategy::setMultiResolutionCache(MultiResolutionCacheSP cache)
+{
+    m_d->multiResolutionCache = cache;
+}
+
 void KisColorizeStrokeStrategy::setFilteringOptions(const FilteringOptions &value)
 {
     m_d->filteringOptions = value;
@@ -127,6 +580,8 @@ void KisColorizeStrokeStrategy::initStrokeCallback()
 
     QVector<KisRunnableStrokeJobData*> jobs;
 
+    const bool heightMapChanged = !m_d->filteredSourceValid;
+
     const QVector<QRect> patchRects =
         splitRectIntoPatches(m_d->boundingRect, optimalPatchSize());
 
@@ -237,20 +692,24 @@ void KisColorizeStrokeStrategy::initStrokeCallback()
             });
         }
 
-        addJobSequential(jobs, [this] () {
-            m_d->progressHelper.reset(new KisProcessingVisitor::ProgressHelper(m_d->progressNode));
-
-            KisWatershedWorker worker(m_d->heightMap, m_d->dst, m_d->boundingRect, m_d->progressHelper->updater());
-            Q_FOREACH (const KeyStroke &stroke, m_d->keyStrokes) {
-                KoColor color =
-                    !stroke.isTransparent ?
-                    stroke.color : KoColor::createTransparent(m_d->dst->colorSpace());
-
-                worker.addKeyStroke(stroke.dev, color);
-            }
-            worker.run(m_d->filteringOptions.cleanUpAmount);
-            m_d->progressHelper.reset();
-        });
+        if (m_d->chooseMultiResolutionScale() > 1) {
+            m_d->addMultiResolutionJobs(jobs, heightMapChanged);
+        } else {
+            addJobSequential(jobs, [this] () {
+                m_d->progressHelper.reset(new KisProcessingVisitor::ProgressHelper(m_d->progressNode));
+
+                KisWatershedWorker worker(m_d->heightMap, m_d->dst, m_d->boundingRect, m_d->progressHelper->updater());
+                Q_FOREACH (const KeyStroke &stroke, m_d->keyStrokes) {
+                    KoColor color =
+                        !stroke.isTransparent ?
+                        stroke.color : KoColor::createTransparent(m_d->dst->colorSpace());
+
+                    worker.addKeyStroke(stroke.dev, color);
+                }
+                worker.run(m_d->filteringOptions.cleanUpAmount);
+                m_d->progressHelper.reset();
+            });
+        }
     }
 
     addJobSequential(jobs, [this] () {
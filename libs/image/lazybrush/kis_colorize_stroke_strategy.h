@@ -8,6 +8,7 @@
 #define __KIS_COLORIZE_STROKE_STRATEGY_H
 
 #include <QScopedPointer>
+#include <QSharedPointer>
 #include <QObject>
 
 #include "kis_types.h"
@@ -24,6 +25,18 @@ class KisColorizeStrokeStrategy : public QObject, public KisRunnableBasedStrokeS
 {
     Q_OBJECT
 
+public:
+    /**
+     * The state of the multi-resolution solver, which is kept by the
+     * colorize mask between the updates. It lets the solver skip the
+     * refinement of the patches that have not changed since the
+     * previous update.
+     */
+    struct MultiResolutionCache;
+    using MultiResolutionCacheSP = QSharedPointer<MultiResolutionCache>;
+
+    static MultiResolutionCacheSP createMultiResolutionCache();
+
 public:
     KisColorizeStrokeStrategy(KisPaintDeviceSP src,
                               KisPaintDeviceSP dst,
@@ -40,6 +53,8 @@ public:
 
     void addKeyStroke(KisPaintDeviceSP dev, const KoColor &color);
 
+    void setMultiResolutionCache(MultiResolutionCacheSP cache);
+
     void initStrokeCallback() override;
     void cancelStrokeCallback() override;
     void tryCancelCurrentStrokeJobAsync() override;
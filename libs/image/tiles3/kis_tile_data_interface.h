@@ -93,6 +93,13 @@ public:
 private:
     KisTileData(const KisTileData& rhs, bool checkFreeMemory = true);
 
+    /**
+     * Creates a tile data without any memory allocated. The data
+     * should be put into the swapped store right after creation.
+     * Used by KisTileDataStore::createSwappedTileData() only.
+     */
+    KisTileData(qint32 pixelSize, KisTileDataStore *store);
+
 public:
     ~KisTileData();
 
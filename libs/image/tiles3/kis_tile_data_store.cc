@@ -171,6 +171,22 @@ KisTileData *KisTileDataStore::allocTileData(qint32 pixelSize, const quint8 *def
     return td;
 }
 
+KisTileData *KisTileDataStore::createSwappedTileData(qint32 pixelSize, const quint8 *data, qint32 size)
+{
+    KisTileData *td = new KisTileData(pixelSize, this);
+
+    /**
+     * Swapped tile data objects are not registered in the
+     * store, they are registered when swapped in
+     */
+    if (!m_swappedStore.tryStoreCompressedTileData(td, data, size)) {
+        delete td;
+        return 0;
+    }
+
+    return td;
+}
+
 KisTileData *KisTileDataStore::duplicateTileData(KisTileData *rhs)
 {
     KisTileData *td = 0;
@@ -91,6 +91,17 @@ public:
         return allocTileData(pixelSize, defPixel);
     }
 
+    /**
+     * Creates a tile data whose content is stored in the swap file in
+     * the compressed form \p data, so that it is decompressed only when
+     * the tile is accessed for the first time (see
+     * KisSwappedDataStore::tryStoreCompressedTileData()).
+     *
+     * \return the new tile data or null if the swap file cannot take
+     * the data
+     */
+    KisTileData* createSwappedTileData(qint32 pixelSize, const quint8 *data, qint32 size);
+
     // Called by The Memento Manager after every commit
     inline void kickPooler()
     {
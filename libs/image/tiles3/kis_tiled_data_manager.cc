@@ -20,6 +20,39 @@
 #include "kis_paint_device_writer.h"
 
 #include "kis_global.h"
+#include "kis_image_config.h"
+#include "KisConcurrentRangeUtils.h"
+
+namespace {
+
+/**
+ * Collects the output of a tile compressor in memory, so that the
+ * tiles could be compressed in parallel and written into the real
+ * store sequentially afterwards
+ */
+struct BufferPaintDeviceWriter : public KisPaintDeviceWriter {
+    bool write(const QByteArray &data) override {
+        buffer.append(data);
+        return true;
+    }
+
+    bool write(const char* data, qint64 length) override {
+        buffer.append(data, int(length));
+        return true;
+    }
+
+    QByteArray buffer;
+};
+
+/**
+ * The number of tiles compressed in one go. It limits the amount
+ * of memory taken by the compressed data waiting for being written.
+ */
+const int tilesCompressionBatchSize = 1024;
+
+std::atomic<quint64> lastDataManagerRevision {0};
+
+}
 
 
 /* The data area is divided into tiles each say 64x64 pixels (defined at compiletime)
@@ -95,6 +128,7 @@ void KisTiledDataManager::setDefaultPixelImpl(const quint8 *defaultPixel)
     m_mementoManager->setDefaultTileData(td);
 
     memcpy(m_defaultPixel, defaultPixel, pixelSize());
+    markContentChanged();
 }
 
 bool KisTiledDataManager::write(KisPaintDeviceWriter &store)
@@ -116,18 +150,46 @@ bool KisTiledDataManager::write(KisPaintDeviceWriter &store)
     KisTileHashTableConstIterator iter(m_hashTable);
     KisTileSP tile;
 
-    KisAbstractTileCompressorSP compressor =
-        KisTileCompressorFactory::create(CURRENT_VERSION);
+    QVector<KisTileSP> tiles;
+    tiles.reserve(m_hashTable->numTiles());
 
     while ((tile = iter.tile())) {
-        retval = compressor->writeTile(tile, store);
-        if (!retval) {
-            warnFile << "Failed to write tile";
-            break;
-        }
+        tiles.append(tile);
         iter.next();
     }
 
+    /**
+     * Compressors keep their own work buffers, so every chunk of
+     * tiles gets a separate one. The compressed tiles are written
+     * into the store in the original order.
+     */
+    QVector<QByteArray> compressedTiles;
+
+    for (int batchStart = 0; retval && batchStart < tiles.size(); batchStart += tilesCompressionBatchSize) {
+        const int batchSize = qMin(tilesCompressionBatchSize, tiles.size() - batchStart);
+        compressedTiles.resize(batchSize);
+
+        KritaUtils::processRangeConcurrently(batchSize, 16,
+            [&] (int begin, int end) {
+                KisAbstractTileCompressorSP compressor =
+                    KisTileCompressorFactory::create(CURRENT_VERSION);
+
+                for (int i = begin; i < end; i++) {
+                    BufferPaintDeviceWriter writer;
+                    compressor->writeTile(tiles[batchStart + i], writer);
+                    compressedTiles[i] = writer.buffer;
+                }
+            });
+
+        for (int i = 0; i < batchSize; i++) {
+            retval = store.write(compressedTiles[i]);
+            if (!retval) {
+                warnFile << "Failed to write tile";
+                break;
+            }
+        }
+    }
+
     return retval;
 }
 bool KisTiledDataManager::read(QIODevice *stream)
@@ -164,8 +226,10 @@ bool KisTiledDataManager::read(QIODevice *stream)
         numTiles = line.toUInt();
     }
 
+    const bool lazyLoading = KisImageConfig(true).lazyTileLoading();
+
     KisAbstractTileCompressorSP compressor =
-        KisTileCompressorFactory::create(tilesVersion);
+        KisTileCompressorFactory::create(tilesVersion, lazyLoading);
 
     bool readSuccess = true;
     for (quint32 i = 0; i < numTiles; i++) {
@@ -206,6 +270,17 @@ bool KisTiledDataManager::writeTilesHeader(KisPaintDeviceWriter &store, quint32
     } while(0)                                                  \
 
 
+void KisTiledDataManager::replaceTile(qint32 col, qint32 row, KisTileData *td)
+{
+    if (m_hashTable->deleteTile(col, row)) {
+        m_extentManager.notifyTileRemoved(col, row);
+    }
+
+    KisTileSP tile = KisTileSP(new KisTile(col, row, td, m_mementoManager));
+    m_hashTable->addTile(tile);
+    m_extentManager.notifyTileAdded(col, row);
+}
+
 bool KisTiledDataManager::processTilesHeader(QIODevice *stream, quint32 &numTiles)
 {
     /**
@@ -314,6 +389,8 @@ void KisTiledDataManager::clear(QRect clearRect, const quint8 *clearPixel)
     if (clearRect.isEmpty())
         return;
 
+    markContentChanged();
+
     const qint32 pixelSize = this->pixelSize();
 
     bool pixelBytesAreDefault = !memcmp(clearPixel, m_defaultPixel, pixelSize);
@@ -424,6 +501,7 @@ void KisTiledDataManager::clear(qint32 x, qint32 y, qint32 w, qint32 h, quint8 c
 
 void KisTiledDataManager::clear()
 {
+    markContentChanged();
     m_hashTable->clear();
     m_extentManager.clear();
 }
@@ -434,6 +512,8 @@ void KisTiledDataManager::bitBltImpl(KisTiledDataManager *srcDM, const QRect &re
 {
     if (rect.isEmpty()) return;
 
+    markContentChanged();
+
     const qint32 pixelSize = this->pixelSize();
     const bool defaultPixelsCoincide =
         !memcmp(srcDM->defaultPixel(), m_defaultPixel, pixelSize);
@@ -511,6 +591,8 @@ void KisTiledDataManager::bitBltRoughImpl(KisTiledDataManager *srcDM, const QRec
 {
     if (rect.isEmpty()) return;
 
+    markContentChanged();
+
     const qint32 pixelSize = this->pixelSize();
     const bool defaultPixelsCoincide =
         !memcmp(srcDM->defaultPixel(), m_defaultPixel, pixelSize);
@@ -591,6 +673,8 @@ void KisTiledDataManager::setExtent(QRect newRect)
     // that is handled by the autoextending automatically
     if (newRect.contains(oldRect)) return;
 
+    markContentChanged();
+
     KisTileSP tile;
     QRect tileRect;
     {
@@ -776,6 +860,17 @@ qint32 KisTiledDataManager::rowStride(qint32 x, qint32 y) const
     return KisTileData::WIDTH * pixelSize();
 }
 
+quint64 KisTiledDataManager::revision() const
+{
+    QMutexLocker locker(&m_revisionLock);
+
+    if (m_contentChanged.fetchAndStoreOrdered(0)) {
+        m_revision = ++lastDataManagerRevision;
+    }
+
+    return m_revision;
+}
+
 void KisTiledDataManager::releaseInternalPools()
 {
     KisTileData::releaseInternalPools();
@@ -8,9 +8,13 @@
 #define KIS_TILEDDATAMANAGER_H_
 
 #include <QtGlobal>
+#include <QAtomicInt>
+#include <QMutex>
 #include <QVector>
 #include <KisRegion.h>
 
+#include <atomic>
+
 #include <kis_shared.h>
 #include <kis_shared_ptr.h>
 #include "config-hash-table-implementation.h"
@@ -104,6 +108,8 @@ public:
 
     inline KisTileSP getTile(qint32 col, qint32 row, bool writable) {
         if (writable) {
+            markContentChanged();
+
             bool newTile;
             KisTileSP tile = m_hashTable->getTileLazy(col, row, newTile);
             if (newTile) {
@@ -117,6 +123,13 @@ public:
         }
     }
 
+    /**
+     * Replaces the tile at \p col, \p row with a new tile that
+     * uses \p td. Used by the tile compressors for loading the
+     * tiles lazily (see KisTileDataStore::createSwappedTileData()).
+     */
+    void replaceTile(qint32 col, qint32 row, KisTileData *td);
+
     inline KisTileSP getReadOnlyTileLazy(qint32 col, qint32 row, bool &existingTile) {
         return m_hashTable->getReadOnlyTileLazy(col, row, existingTile);
     }
@@ -156,6 +169,7 @@ public:
         commit();
 
         QWriteLocker locker(&m_lock);
+        markContentChanged();
         m_mementoManager->rollback(m_hashTable, memento);
         const quint8 *defaultPixel = memento->oldDefaultPixel();
         if(memcmp(m_defaultPixel, defaultPixel, m_pixelSize)) {
@@ -167,6 +181,7 @@ public:
         commit();
 
         QWriteLocker locker(&m_lock);
+        markContentChanged();
         m_mementoManager->rollforward(m_hashTable, memento);
         const quint8 *defaultPixel = memento->newDefaultPixel();
         if(memcmp(m_defaultPixel, defaultPixel, m_pixelSize)) {
@@ -190,6 +205,19 @@ public:
         m_mementoManager->purgeHistory(oldestMemento);
     }
 
+    /**
+     * Returns the revision of the pixel data. The revision changes on
+     * every write access to the tiles, including undo/redo and changes
+     * of the default pixel. The revisions are unique among all the data
+     * managers, so two equal revisions always mean the same content,
+     * even when the data manager has been recreated at the same address.
+     *
+     * NOTE: the revision changes when a tile is fetched for writing,
+     * not when the writing is finished, so it should be read while the
+     * data manager is not being written into, e.g. under the image lock.
+     */
+    quint64 revision() const;
+
     static void releaseInternalPools();
 
 protected:
@@ -340,6 +368,17 @@ private:
 
     mutable QReadWriteLock m_lock;
 
+    /**
+     * The new revision is generated lazily, on the first request
+     * after the content has been changed, so that writing into the
+     * tiles would not touch the global revision counter. The revision
+     * is generated under m_revisionLock, so that a concurrent request
+     * could not return the old revision in the meantime.
+     */
+    mutable QAtomicInt m_contentChanged {1};
+    mutable QMutex m_revisionLock;
+    mutable quint64 m_revision {0};
+
 private:
     // Allow compression routines to calculate (col,row) coordinates
     // and pixel size
@@ -355,6 +394,16 @@ private:
     }
 
 private:
+    inline void markContentChanged() {
+        /**
+         * Avoid writing into the shared cache line when the flag
+         * is already set, which is the common case for painting
+         */
+        if (!m_contentChanged.loadRelaxed()) {
+            m_contentChanged.storeRelease(1);
+        }
+    }
+
     void setDefaultPixelImpl(const quint8 *defPixel);
 
     bool writeTilesHeader(KisPaintDeviceWriter &store, quint32 numTiles);
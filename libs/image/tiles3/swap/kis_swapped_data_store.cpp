@@ -11,13 +11,27 @@
 
 #include "kis_tile_compressor_2.h"
 
+#include <KisPerformanceCounters.h>
+#include <KisUsageLogger.h>
+
 //#define COMPRESSOR_VERSION 2
 
+namespace {
+KisPerformanceCounter s_tilesSwappedOut("swap/tiles_out");
+KisPerformanceCounter s_tilesSwappedIn("swap/tiles_in");
+KisPerformanceCounter s_bytesSwappedOut("swap/bytes_out");
+KisPerformanceCounter s_bytesSwappedIn("swap/bytes_in");
+KisPerformanceCounter s_swapUsed("swap/used_bytes", KisPerformanceCounter::Gauge);
+KisPerformanceCounter s_tilesFailed("swap/failed_tiles");
+}
+
 KisSwappedDataStore::KisSwappedDataStore()
-    : m_totalSwapMemoryUsed(0)
+    : m_totalSwapMemoryUsed(0),
+      m_hasFailedTiles(false)
 {
     KisImageConfig config(true);
     const quint64 maxSwapSize = config.maxSwapSize() * MiB;
+    m_maxSwapSize = maxSwapSize;
     const quint64 swapSlabSize = config.swapSlabSize() * MiB;
     const quint64 swapWindowSize = config.swapWindowSize() * MiB;
 
@@ -30,6 +44,8 @@ KisSwappedDataStore::KisSwappedDataStore()
 
 KisSwappedDataStore::~KisSwappedDataStore()
 {
+    s_swapUsed.add(-m_totalSwapMemoryUsed);
+
     delete m_compressor;
     delete m_swapSpace;
     delete m_allocator;
@@ -74,6 +90,10 @@ bool KisSwappedDataStore::trySwapOutTileData(KisTileData *td)
 
     m_totalSwapMemoryUsed += chunk.size();
 
+    s_tilesSwappedOut.increment();
+    s_bytesSwappedOut.add(chunk.size());
+    s_swapUsed.add(chunk.size());
+
     return true;
 }
 
@@ -92,8 +112,61 @@ void KisSwappedDataStore::swapInTileData(KisTileData *td)
 
     quint8 *ptr = m_swapSpace->getReadChunkPtr(chunk);
     Q_ASSERT(ptr);
-    m_compressor->decompressTileData(ptr, chunk.size(), td);
+    const bool result = m_compressor->decompressTileData(ptr, chunk.size(), td);
     m_allocator->freeChunk(chunk);
+
+    if (!result) {
+        /**
+         * The data in the chunk is broken (it may come from a damaged
+         * file loaded lazily). The tile data doesn't know the default
+         * pixel of its owner, so fill it with zeroes, which is a
+         * transparent pixel in most of the color spaces, instead of
+         * letting the uninitialized memory appear on the canvas.
+         */
+        memset(td->data(), 0, td->pixelSize() * KisTileData::WIDTH * KisTileData::HEIGHT);
+
+        qWarning() << "swap in of tile failed: the compressed tile data is corrupted,"
+                   << "the tile has been cleared";
+
+        if (!m_hasFailedTiles) {
+            m_hasFailedTiles = true;
+            KisUsageLogger::log("WARNING: failed to decompress the tile data from the swap file, the image contains cleared tiles");
+        }
+        s_tilesFailed.increment();
+    }
+
+    s_tilesSwappedIn.increment();
+    s_bytesSwappedIn.add(chunk.size());
+    s_swapUsed.add(-qint64(chunk.size()));
+}
+
+bool KisSwappedDataStore::tryStoreCompressedTileData(KisTileData *td, const quint8 *data, qint32 size)
+{
+    Q_ASSERT(!td->data());
+    QMutexLocker locker(&m_lock);
+
+    /**
+     * The allocator cannot recover from running out of the swap
+     * space, so leave enough room for the swapper
+     */
+    if (m_totalSwapMemoryUsed + size > m_maxSwapSize / 2) {
+        return false;
+    }
+
+    KisChunk chunk = m_allocator->getChunk(size);
+    quint8 *ptr = m_swapSpace->getWriteChunkPtr(chunk);
+    if (!ptr) {
+        m_allocator->freeChunk(chunk);
+        return false;
+    }
+    memcpy(ptr, data, size);
+
+    td->setSwapChunk(chunk);
+
+    m_totalSwapMemoryUsed += chunk.size();
+    s_swapUsed.add(chunk.size());
+
+    return true;
 }
 
 void KisSwappedDataStore::forgetTileData(KisTileData *td)
@@ -101,6 +174,7 @@ void KisSwappedDataStore::forgetTileData(KisTileData *td)
     QMutexLocker locker(&m_lock);
 
     m_totalSwapMemoryUsed -= td->swapChunk().size();
+    s_swapUsed.add(-qint64(td->swapChunk().size()));
 
     m_allocator->freeChunk(td->swapChunk());
     td->setSwapChunk(KisChunk());
@@ -40,12 +40,30 @@ public:
 
     /**
      * Restore the data of a \a td basing on information
-     * stored in the swap file.
+     * stored in the swap file. If the stored data cannot be
+     * decompressed, the tile is filled with zeroes and the
+     * failure is reported to the log and the "swap/failed_tiles"
+     * counter.
      * LOCKING: the lock on the tile data should be taken
      *          by the caller before making a call.
      */
     void swapInTileData(KisTileData *td);
 
+    /**
+     * Puts the already compressed data of \a td into the swap file,
+     * so that the data is decompressed only when the tile data is
+     * accessed for the first time. \a td must have no memory
+     * allocated. The data should be in the format produced by
+     * the swap compressor (KisTileCompressor2).
+     *
+     * The store refuses to take the data when the swap file is more
+     * than half full, leaving the rest of it for the swapper.
+     *
+     * \return false if the data hasn't been stored, in which case
+     * the caller should decompress the data itself
+     */
+    bool tryStoreCompressedTileData(KisTileData *td, const quint8 *data, qint32 size);
+
     /**
      * Forget all the information linked with the tile data.
      * This should be done before deleting of the tile data,
@@ -74,6 +92,8 @@ private:
     QMutex m_lock;
 
     qint64 m_totalSwapMemoryUsed;
+    qint64 m_maxSwapSize;
+    bool m_hasFailedTiles;
 };
 
 #endif /* __KIS_SWAPPED_DATA_STORE_H */
@@ -13,7 +13,8 @@
 const QString KisTileCompressor2::m_compressionName = "LZF";
 
 
-KisTileCompressor2::KisTileCompressor2()
+KisTileCompressor2::KisTileCompressor2(bool lazyLoading)
+    : m_lazyLoading(lazyLoading)
 {
     m_compression = new KisLzfCompression();
 }
@@ -68,9 +69,19 @@ bool KisTileCompressor2::readTile(QIODevice *stream, KisTiledDataManager *dm)
         qint32 row = yToRow(dm, y);
         qint32 col = xToCol(dm, x);
 
-        KisTileSP tile = dm->getTile(col, row, true);
+        if (dataSize <= 0 || dataSize > m_streamingBuffer.size()) {
+            return false;
+        }
 
-        stream->read(m_streamingBuffer.data(), dataSize);
+        if (stream->read(m_streamingBuffer.data(), dataSize) != dataSize) {
+            return false;
+        }
+
+        if (m_lazyLoading && tryReadTileLazily(dm, col, row, dataSize, tileDataSize)) {
+            return true;
+        }
+
+        KisTileSP tile = dm->getTile(col, row, true);
 
         tile->lockForWrite();
         bool res = decompressTileData((quint8*)m_streamingBuffer.data(), dataSize, tile->tileData());
@@ -80,6 +91,30 @@ bool KisTileCompressor2::readTile(QIODevice *stream, KisTiledDataManager *dm)
     return false;
 }
 
+bool KisTileCompressor2::tryReadTileLazily(KisTiledDataManager *dm, qint32 col, qint32 row,
+                                           qint32 dataSize, qint32 tileDataSize)
+{
+    const quint8 *data = (const quint8*)m_streamingBuffer.constData();
+
+    /**
+     * The data cannot be validated without decompressing it, so
+     * check at least the things that would crash the swapper
+     */
+    const bool isValid =
+        (data[0] == COMPRESSED_DATA_FLAG && dataSize > 1) ||
+        (data[0] == RAW_DATA_FLAG && dataSize == tileDataSize + 1);
+
+    if (!isValid) return false;
+
+    KisTileData *td =
+        KisTileDataStore::instance()->createSwappedTileData(pixelSize(dm), data, dataSize);
+
+    if (!td) return false;
+
+    dm->replaceTile(col, row, td);
+    return true;
+}
+
 void KisTileCompressor2::prepareStreamingBuffer(qint32 tileDataSize)
 {
     /**
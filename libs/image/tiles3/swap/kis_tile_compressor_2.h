@@ -14,7 +14,14 @@ class KisAbstractCompression;
 class KRITAIMAGE_EXPORT KisTileCompressor2 : public KisAbstractTileCompressor
 {
 public:
-    KisTileCompressor2();
+    /**
+     * \param lazyLoading if true, readTile() doesn't decompress the
+     *        tiles, but moves their compressed data directly into the
+     *        swap file. The tiles are decompressed on the first access,
+     *        just like the tiles that have been swapped out. The data
+     *        format of the tiles is the same in both cases.
+     */
+    explicit KisTileCompressor2(bool lazyLoading = false);
     ~KisTileCompressor2() override;
 
     bool writeTile(KisTileSP tile, KisPaintDeviceWriter &store) override;
@@ -37,6 +44,9 @@ private:
     void prepareWorkBuffers(qint32 tileDataSize);
     void prepareStreamingBuffer(qint32 tileDataSize);
 
+    bool tryReadTileLazily(KisTiledDataManager *dm, qint32 col, qint32 row,
+                           qint32 dataSize, qint32 tileDataSize);
+
 private:
     static const qint8 RAW_DATA_FLAG = 0;
     static const qint8 COMPRESSED_DATA_FLAG = 1;
@@ -46,6 +56,7 @@ private:
     QByteArray m_compressionBuffer;
     QByteArray m_streamingBuffer;
     KisAbstractCompression *m_compression;
+    bool m_lazyLoading;
     static const QString m_compressionName;
 };
 
@@ -13,13 +13,18 @@
 class KRITAIMAGE_EXPORT KisTileCompressorFactory
 {
 public:
-    static KisAbstractTileCompressorSP create(qint32 version) {
+    /**
+     * \param lazyLoading if true, the compressor may keep the tiles it
+     *        reads compressed until they are accessed (supported by
+     *        version 2 only, see KisTileCompressor2)
+     */
+    static KisAbstractTileCompressorSP create(qint32 version, bool lazyLoading = false) {
         switch(version) {
         case 1:
             return KisAbstractTileCompressorSP(new KisLegacyTileCompressor());
             break;
         case 2:
-            return KisAbstractTileCompressorSP(new KisTileCompressor2());
+            return KisAbstractTileCompressorSP(new KisTileCompressor2(lazyLoading));
             break;
         default:
             qFatal("Unknown version of the tiles");
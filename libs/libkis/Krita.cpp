@@ -43,6 +43,7 @@
 #include <KisBrushServerProvider.h>
 #include <kis_action_registry.h>
 #include <kis_icon_utils.h>
+#include <KisPerformanceCounters.h>
 
 #include <KisResourceModel.h>
 #include <KisGlobalResourcesInterface.h>
@@ -389,6 +390,40 @@ QString Krita::readSetting(const QString &group, const QString &name, const QStr
     return grp.readEntry(name, defaultValue);
 }
 
+QMap<QString, QVariant> Krita::performanceCounters() const
+{
+    QMap<QString, QVariant> result;
+
+    KisPerformanceCounters *counters = KisPerformanceCounters::instance();
+    if (!counters) return result;
+
+    Q_FOREACH (const KisPerformanceCounters::Sample &sample, counters->takeSnapshot().samples) {
+        result.insert(sample.name, sample.value);
+    }
+
+    return result;
+}
+
+QMap<QString, QVariant> Krita::performanceCounterRates() const
+{
+    QMap<QString, QVariant> result;
+
+    KisPerformanceCounters *counters = KisPerformanceCounters::instance();
+    if (!counters) return result;
+
+    const QVector<KisPerformanceCounters::Snapshot> history = counters->history();
+    if (history.size() < 2) return result;
+
+    const QMap<QString, qreal> rates =
+        KisPerformanceCounters::rates(history[history.size() - 2], history.last());
+
+    for (auto it = rates.constBegin(); it != rates.constEnd(); ++it) {
+        result.insert(it.key(), it.value());
+    }
+
+    return result;
+}
+
 QIcon Krita::icon(QString &iconName) const
 {
     return KisIconUtils::loadIcon(iconName);
@@ -304,6 +304,27 @@ add_document_to_window()
      */
     QString readSetting(const QString &group, const QString &name, const QString &defaultValue);
 
+    /**
+     * @brief performanceCounters read the current values of the internal performance
+     * counters of Krita, e.g. the number of updates waiting in the queue or the number
+     * of tiles swapped out.
+     *
+     * Usage: print(Application.performanceCounters()["swap/tiles_out"])
+     *
+     * @return a map of the counter names to their values
+     */
+    QMap<QString, QVariant> performanceCounters() const;
+
+    /**
+     * @brief performanceCounterRates read the performance counters sampled during the
+     * last second. The counters are reported per second, the values that describe
+     * the current state, like the length of a queue, are reported as they are.
+     *
+     * @return a map of the counter names to their rates, empty if no samples have
+     * been collected yet
+     */
+    QMap<QString, QVariant> performanceCounterRates() const;
+
     /**
      * @brief icon
      * This allows you to get icons from Krita's internal icons.
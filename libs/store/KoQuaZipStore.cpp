@@ -19,15 +19,175 @@
 #include <QTextCodec>
 #include <QByteArray>
 #include <QBuffer>
+#include <QQueue>
+#include <QFuture>
+#include <QThread>
+#include <QThreadPool>
+#include <QtConcurrentRun>
 
 #include <KConfig>
 #include <KSharedConfig>
 #include <KConfigGroup>
 
+#include <limits>
+
+namespace {
+
+/**
+ * The result of compressing a single zip entry on a worker thread. The data
+ * is a raw deflate stream (no zlib header), exactly what the zip container
+ * stores, so it can be passed to QuaZipFile in raw mode as is.
+ */
+struct CompressedEntry {
+    QByteArray data;
+    quint32 crc {0};
+    qint64 uncompressedSize {0};
+    bool success {false};
+};
+
+/**
+ * zlib's sizes are 32-bit, so huge entries (a single layer of a
+ * multi-gigabyte image) are fed to it in chunks
+ */
+const qint64 zlibChunkSize = 1 << 30;
+
+CompressedEntry compressEntry(const QByteArray &src, int level)
+{
+    CompressedEntry entry;
+    entry.uncompressedSize = src.size();
+
+    uLong crc = crc32(0L, Z_NULL, 0);
+    for (qint64 pos = 0; pos < src.size(); pos += zlibChunkSize) {
+        const uInt length = uInt(qMin(zlibChunkSize, src.size() - pos));
+        crc = crc32(crc, reinterpret_cast<const Bytef*>(src.constData() + pos), length);
+    }
+    entry.crc = quint32(crc);
+
+    z_stream stream;
+    memset(&stream, 0, sizeof(stream));
+
+    // the same parameters QuaZipFile uses for its own deflate streams
+    if (deflateInit2(&stream, level, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+        return entry;
+    }
+
+    const int outputChunkSize = 1 << 20;
+    qint64 inputPos = 0;
+    int result = Z_OK;
+
+    entry.data.reserve(int(qMin(qint64(src.size() / 2 + outputChunkSize), zlibChunkSize)));
+
+    while (result == Z_OK) {
+        if (stream.avail_in == 0 && inputPos < src.size()) {
+            const qint64 length = qMin(zlibChunkSize, src.size() - inputPos);
+            stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(src.constData() + inputPos));
+            stream.avail_in = uInt(length);
+            inputPos += length;
+        }
+
+        const int flush = inputPos < src.size() ? Z_NO_FLUSH : Z_FINISH;
+
+        const int oldSize = entry.data.size();
+        entry.data.resize(oldSize + outputChunkSize);
+        stream.next_out = reinterpret_cast<Bytef*>(entry.data.data() + oldSize);
+        stream.avail_out = uInt(outputChunkSize);
+
+        result = deflate(&stream, flush);
+        entry.data.resize(oldSize + outputChunkSize - int(stream.avail_out));
+
+        if (result == Z_BUF_ERROR && stream.avail_in > 0) {
+            result = Z_OK;
+        }
+    }
+
+    deflateEnd(&stream);
+
+    entry.success = result == Z_STREAM_END;
+    return entry;
+}
+
+/**
+ * Uncompresses the raw contents of a zip entry read in raw mode
+ * and checks it against the CRC stored in the archive
+ */
+QByteArray uncompressEntry(const QByteArray &src, int method, quint32 expectedCrc, qint64 uncompressedSize)
+{
+    QByteArray result;
+
+    if (method == 0) {
+        result = src;
+    } else if (method == Z_DEFLATED) {
+        if (uncompressedSize > std::numeric_limits<int>::max()) {
+            qWarning() << "The entry is too big to be uncompressed into memory" << uncompressedSize;
+            return QByteArray();
+        }
+
+        z_stream stream;
+        memset(&stream, 0, sizeof(stream));
+
+        if (inflateInit2(&stream, -MAX_WBITS) != Z_OK) {
+            return QByteArray();
+        }
+
+        result.resize(int(uncompressedSize));
+
+        stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(src.constData()));
+        stream.avail_in = uInt(src.size());
+        stream.next_out = reinterpret_cast<Bytef*>(result.data());
+        stream.avail_out = uInt(result.size());
+
+        const int r = inflate(&stream, Z_FINISH);
+        const qint64 totalOut = stream.total_out;
+        inflateEnd(&stream);
+
+        if (r != Z_STREAM_END || totalOut != uncompressedSize) {
+            qWarning() << "Could not uncompress the entry, zlib error" << r;
+            return QByteArray();
+        }
+    } else {
+        qWarning() << "Unsupported compression method" << method;
+        return QByteArray();
+    }
+
+    uLong crc = crc32(0L, Z_NULL, 0);
+    for (qint64 pos = 0; pos < result.size(); pos += zlibChunkSize) {
+        const uInt length = uInt(qMin(zlibChunkSize, result.size() - pos));
+        crc = crc32(crc, reinterpret_cast<const Bytef*>(result.constData() + pos), length);
+    }
+
+    if (quint32(crc) != expectedCrc) {
+        qWarning() << "CRC mismatch in the uncompressed entry";
+        return QByteArray();
+    }
+
+    return result;
+}
+
+/**
+ * Upper limits for the amount of data waiting in the compression
+ * queue. When exceeded, closeWrite() blocks until the oldest entry
+ * is written into the archive.
+ */
+const qint64 maxPendingBytes = 256 * 1024 * 1024;
+const int maxPendingEntriesPerThread = 4;
+
+}
+
 struct KoQuaZipStore::Private {
 
-    Private() {}
-    ~Private() {}
+    Private() {
+        compressionPool.setMaxThreadCount(qMax(1, QThread::idealThreadCount()));
+    }
+
+    ~Private() {
+        compressionPool.waitForDone();
+    }
+
+    struct PendingEntry {
+        QString name;
+        qint64 size {0};
+        QFuture<CompressedEntry> future;
+    };
 
     QuaZip *archive {0};
     QuaZipFile *currentFile {0};
@@ -37,8 +197,73 @@ struct KoQuaZipStore::Private {
     bool usingSaveFile {false};
     QByteArray cache;
     QBuffer buffer;
+
+    /**
+     * Entries are compressed in parallel on the worker pool, but written
+     * into the archive by the saving thread only, in the same order they
+     * were added to the store.
+     */
+    QString currentEntryName;
+    QQueue<PendingEntry> pendingEntries;
+    qint64 pendingBytes {0};
+    bool hasDeferredWriteErrors {false};
+    QThreadPool compressionPool;
+
+    bool writePendingEntry(const PendingEntry &entry);
+    bool writeFinishedEntries(bool waitForAll);
 };
 
+bool KoQuaZipStore::Private::writePendingEntry(const PendingEntry &entry)
+{
+    const CompressedEntry compressed = entry.future.result();
+    if (!compressed.success) {
+        qWarning() << "Could not compress" << entry.name;
+        return false;
+    }
+
+    QuaZipFile file(archive);
+    QuaZipNewInfo newInfo(entry.name);
+    newInfo.setPermissions(QFileDevice::ReadOwner | QFileDevice::ReadGroup | QFileDevice::ReadOther);
+    newInfo.uncompressedSize = compressed.uncompressedSize;
+
+    if (!file.open(QIODevice::WriteOnly, newInfo, 0, compressed.crc, Z_DEFLATED, compressionLevel, true)) {
+        qWarning() << "Could not open" << entry.name << file.getZipError();
+        return false;
+    }
+
+    bool r = true;
+    if (file.write(compressed.data) != compressed.data.size()) {
+        qWarning() << "Could not write buffer to the file" << entry.name;
+        r = false;
+    }
+    file.close();
+
+    return r && file.getZipError() == ZIP_OK;
+}
+
+bool KoQuaZipStore::Private::writeFinishedEntries(bool waitForAll)
+{
+    const int maxPendingEntries = maxPendingEntriesPerThread * compressionPool.maxThreadCount();
+
+    while (!pendingEntries.isEmpty()) {
+        const bool mustWait =
+            waitForAll ||
+            pendingBytes > maxPendingBytes ||
+            pendingEntries.size() > maxPendingEntries;
+
+        if (!mustWait && !pendingEntries.head().future.isFinished()) break;
+
+        const PendingEntry entry = pendingEntries.dequeue();
+        pendingBytes -= entry.size;
+
+        if (!writePendingEntry(entry)) {
+            hasDeferredWriteErrors = true;
+        }
+    }
+
+    return !hasDeferredWriteErrors;
+}
+
 
 KoQuaZipStore::KoQuaZipStore(const QString &_filename, KoStore::Mode _mode, const QByteArray &appIdentification, bool writeMimetype)
     : KoStore(_mode, writeMimetype)
@@ -120,7 +345,11 @@ QStringList KoQuaZipStore::directoryList() const
         return dd->directoryListCache;
     }
     else {
-        return dd->archive->getFileNameList();
+        QStringList result = dd->archive->getFileNameList();
+        Q_FOREACH (const Private::PendingEntry &entry, dd->pendingEntries) {
+            result << entry.name;
+        }
+        return result;
     }
 }
 
@@ -169,10 +398,16 @@ bool KoQuaZipStore::doFinalize()
     Q_D(KoStore);
 
     d->stream = 0;
+
+    bool r = true;
+    if (d->mode == Write) {
+        r = dd->writeFinishedEntries(true);
+    }
+
     if (d->good && !dd->usingSaveFile) {
         dd->archive->close();
     }
-    return dd->archive->getZipError() == ZIP_OK;
+    return r && dd->archive->getZipError() == ZIP_OK;
 
 }
 
@@ -186,19 +421,19 @@ bool KoQuaZipStore::openWrite(const QString &name)
     d->stream = 0; // Not used when writing
 
     delete dd->currentFile;
-    dd->currentFile = new QuaZipFile(dd->archive);
-    QuaZipNewInfo newInfo(fixedPath);
-    newInfo.setPermissions(QFileDevice::ReadOwner | QFileDevice::ReadGroup | QFileDevice::ReadOther);
-    bool r = dd->currentFile->open(QIODevice::WriteOnly, newInfo, 0, 0, Z_DEFLATED, dd->compressionLevel);
-    if (!r) {
-        qWarning() << "Could not open" << name << dd->currentFile->getZipError();
-    }
+    dd->currentFile = 0;
+
+    /**
+     * The zip entry itself is created only when the data is
+     * compressed, see closeWrite()
+     */
+    dd->currentEntryName = fixedPath;
 
     dd->cache = QByteArray();
     dd->buffer.setBuffer(&dd->cache);
     dd->buffer.open(QBuffer::WriteOnly);
 
-    return r;
+    return !dd->hasDeferredWriteErrors;
 }
 
 bool KoQuaZipStore::openRead(const QString &name)
@@ -236,21 +471,81 @@ bool KoQuaZipStore::openRead(const QString &name)
     return true;
 }
 
-bool KoQuaZipStore::closeWrite()
+std::function<QByteArray()> KoQuaZipStore::doReadDeferred(const QString &name)
 {
     Q_D(KoStore);
 
-    bool r = true;
-    if (dd->currentFile->write(dd->cache) != dd->cache.size()) {
-        // write() returns number of bytes written, or -1 in case of error
-        // let's allow write 0 bytes in the cache, when needed
-        qWarning() << "Could not write buffer to the file";
-        r = false;
+    QString fixedPath = name;
+    fixedPath.replace("//", "/");
+
+    if (!currentPath().isEmpty() && !fixedPath.startsWith(currentPath())) {
+        fixedPath = currentPath() + '/' + fixedPath;
+    }
+
+    if (!d->substituteThis.isEmpty()) {
+        fixedPath = fixedPath.replace(d->substituteThis, d->substituteWith);
+    }
+
+    if (!dd->archive->setCurrentFile(fixedPath)) {
+        qWarning() << "\t\tCould not set current file" << dd->archive->getZipError() << fixedPath;
+        return std::function<QByteArray()>();
+    }
+
+    QuaZipFileInfo64 info;
+    if (!dd->archive->getCurrentFileInfo(&info)) {
+        return std::function<QByteArray()>();
     }
+
+    /**
+     * Only read the compressed bytes here, the inflating happens
+     * in the returned functor, possibly on a different thread
+     */
+    QuaZipFile file(dd->archive);
+    int method = 0;
+    int level = 0;
+    if (!file.open(QIODevice::ReadOnly, &method, &level, true)) {
+        qWarning() << "\t\t\tBut could not open!!!" << dd->archive->getZipError();
+        return std::function<QByteArray()>();
+    }
+
+    const QByteArray rawData = file.readAll();
+    file.close();
+
+    const quint32 crc = info.crc;
+    const qint64 uncompressedSize = qint64(info.uncompressedSize);
+
+    return [rawData, method, crc, uncompressedSize] () {
+        return uncompressEntry(rawData, method, crc, uncompressedSize);
+    };
+}
+
+bool KoQuaZipStore::closeWrite()
+{
+    Q_D(KoStore);
+
     dd->buffer.close();
-    dd->currentFile->close();
     d->stream = 0;
-    return (r && dd->currentFile->getZipError() == ZIP_OK);
+
+    /**
+     * Compress the entry on the worker pool while the caller goes on
+     * serializing the next layer. The entries that have already been
+     * compressed are written into the archive right away.
+     */
+    Private::PendingEntry entry;
+    entry.name = dd->currentEntryName;
+    entry.size = dd->cache.size();
+    entry.future = QtConcurrent::run(&dd->compressionPool,
+                                     [data = dd->cache, level = dd->compressionLevel] () {
+                                         return compressEntry(data, level);
+                                     });
+
+    dd->buffer.setBuffer(0);
+    dd->cache = QByteArray();
+
+    dd->pendingEntries.enqueue(entry);
+    dd->pendingBytes += entry.size;
+
+    return dd->writeFinishedEntries(false);
 }
 
 bool KoQuaZipStore::closeRead()
@@ -38,6 +38,7 @@ protected:
     bool enterRelativeDirectory(const QString& dirName) override;
     bool enterAbsoluteDirectory(const QString& path) override;
     bool fileExists(const QString& absPath) const override;
+    std::function<QByteArray()> doReadDeferred(const QString &name) override;
 
 private:
     struct Private;
@@ -312,6 +312,38 @@ bool KoStore::extractFile(const QString &srcName, QByteArray &data)
     return d->extractFile(srcName, buffer);
 }
 
+std::function<QByteArray()> KoStore::readDeferred(const QString &fileName)
+{
+    Q_D(KoStore);
+
+    if (d->mode != Read) {
+        errorStore << "KoStore: Can not read from store that is opened for writing" << Qt::endl;
+        return std::function<QByteArray()>();
+    }
+
+    if (d->isOpen) {
+        warnStore << "Store is already opened, missing close";
+        return std::function<QByteArray()>();
+    }
+
+    return doReadDeferred(d->toExternalNaming(fileName));
+}
+
+std::function<QByteArray()> KoStore::doReadDeferred(const QString &name)
+{
+    Q_D(KoStore);
+
+    QByteArray data;
+    QBuffer buffer(&data);
+
+    // the "tar:/" prefix tells toExternalNaming() that the name is absolute
+    if (!d->extractFile("tar:/" + name, buffer)) {
+        return std::function<QByteArray()>();
+    }
+
+    return [data] () { return data; };
+}
+
 bool KoStorePrivate::extractFile(const QString &srcName, QIODevice &buffer)
 {
     if (!q->open(srcName))
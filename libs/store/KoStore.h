@@ -10,6 +10,7 @@
 
 #include <QByteArray>
 #include <QIODevice>
+#include <functional>
 #include "kritastore_export.h"
 
 class QWidget;
@@ -198,6 +199,16 @@ public:
      */
     bool extractFile(const QString &sourceName, QByteArray &data);
 
+    /**
+     * Reads the file @p fileName out of the store and returns a functor
+     * that returns its uncompressed contents. The functor doesn't access
+     * the store and can be called from any thread, which lets the caller
+     * decompress several files in parallel. The store must not be open.
+     *
+     * @return an empty functor if the file cannot be read
+     */
+    std::function<QByteArray()> readDeferred(const QString &fileName);
+
     //@{
     /// See QIODevice
     bool seek(qint64 pos);
@@ -231,6 +242,13 @@ protected:
         return true;
     }
 
+    /**
+     * Backend part of readDeferred(). The default implementation reads
+     * and uncompresses the data right away.
+     * @param name "absolute path" (in the archive) to the file to read
+     */
+    virtual std::function<QByteArray()> doReadDeferred(const QString &name);
+
     /**
      * Open the file @p name in the store, for writing
      * On success, this method must set m_stream to a stream in which we can write.
@@ -23,6 +23,8 @@
 #include <QDesktopWidget>
 #include <QDir>
 #include <QFile>
+#include <QJsonDocument>
+#include <QJsonObject>
 #include <QLocale>
 #include <QMessageBox>
 #include <QProcessEnvironment>
@@ -30,6 +32,7 @@
 #include <QStyle>
 #include <QStyleFactory>
 #include <QSysInfo>
+#include <QTextStream>
 #include <QTimer>
 #include <QWidget>
 #include <QImageReader>
@@ -53,6 +56,7 @@
 #include "KisDocument.h"
 #include "KisMainWindow.h"
 #include "KisAutoSaveRecoveryDialog.h"
+#include "KisAutoSaveJournal.h"
 #include "KisPart.h"
 #include <kis_icon.h>
 #include "kis_splash_screen.h"
@@ -67,6 +71,8 @@
 #include <kis_meta_data_io_backend.h>
 #include <kis_meta_data_backend_registry.h>
 #include "KisApplicationArguments.h"
+#include "KisHeadlessBenchmark.h"
+#include "KisPersistentFrameCache.h"
 #include <kis_debug.h>
 #include "kis_action_registry.h"
 #include <KoResourceServer.h>
@@ -437,11 +443,13 @@ bool KisApplication::start(const KisApplicationArguments &args)
     const bool exportAs = args.exportAs();
     const bool exportSequence = args.exportSequence();
     const QString exportFileName = args.exportFileName();
+    const QString benchmarkSpecification = args.benchmarkSpecification();
+    const bool runBenchmark = !benchmarkSpecification.isEmpty();
 
-    d->batchRun = (exportAs || exportSequence || !exportFileName.isEmpty());
-    const bool needsMainWindow = (!exportAs && !exportSequence);
+    d->batchRun = (exportAs || exportSequence || runBenchmark || !exportFileName.isEmpty());
+    const bool needsMainWindow = (!exportAs && !exportSequence && !runBenchmark);
     // only show the mainWindow when no command-line mode option is passed
-    bool showmainWindow = (!exportAs && !exportSequence); // would be !batchRun;
+    bool showmainWindow = needsMainWindow; // would be !batchRun;
 
     const bool showSplashScreen = !d->batchRun && qEnvironmentVariableIsEmpty("NOSPLASH");
     if (showSplashScreen && d->splashScreen) {
@@ -550,6 +558,41 @@ bool KisApplication::start(const KisApplicationArguments &args)
     connect(this, &KisApplication::aboutToQuit, &KisSpinBoxUnitManagerFactory::clearUnitManagerBuilder); //ensure the builder is destroyed when the application leave.
     //the new syntax slot syntax allow to connect to a non q_object static method.
 
+    // let the animation caches of the closed documents be written to disk
+    connect(this, &KisApplication::aboutToQuit, &KisPersistentFrameCache::waitForPendingJobs);
+
+    if (runBenchmark) {
+        KisHeadlessBenchmark benchmark;
+
+        QJsonObject result;
+        if (benchmark.loadSpecification(benchmarkSpecification)) {
+            result = benchmark.run();
+        }
+
+        if (result.isEmpty()) {
+            errKrita << "Could not run the benchmark:" << benchmark.errorMessage();
+            QTimer::singleShot(0, this, SLOT(quit()));
+            return false;
+        }
+
+        const QByteArray data = QJsonDocument(result).toJson();
+        const QString outputFileName = args.benchmarkOutputFileName();
+
+        if (outputFileName.isEmpty()) {
+            QTextStream(stdout) << data;
+        } else {
+            QFile file(outputFileName);
+            if (!file.open(QFile::WriteOnly) || file.write(data) != data.size()) {
+                errKrita << "Could not write the benchmark results to" << outputFileName;
+                QTimer::singleShot(0, this, SLOT(quit()));
+                return false;
+            }
+        }
+
+        QTimer::singleShot(0, this, SLOT(quit()));
+        return true;
+    }
+
     // Create a new image, if needed
     if (doNewImage) {
         KisDocument *doc = args.createDocumentFromArguments();
@@ -1019,6 +1062,7 @@ void KisApplication::checkAutosaveFiles()
                 if (!filesToRecover.contains(autosaveFile)) {
                     KisUsageLogger::log(QString("Removing autosave file %1").arg(dir.absolutePath() + "/" + autosaveFile));
                     QFile::remove(dir.absolutePath() + "/" + autosaveFile);
+                    KisAutoSaveJournal::removeJournal(dir.absolutePath() + "/" + autosaveFile);
                 }
             }
             autosaveFiles = filesToRecover;
@@ -33,6 +33,8 @@ struct Q_DECL_HIDDEN KisApplicationArguments::Private
     bool exportAs {false};
     bool exportSequence {false};
     QString exportFileName;
+    QString benchmarkSpecification;
+    QString benchmarkOutputFileName;
     QString workspace;
     QString windowLayout;
     QString session;
@@ -95,6 +97,8 @@ KisApplicationArguments::KisApplicationArguments(const QApplication &app)
     parser.addOption(QCommandLineOption(QStringList() << QLatin1String("export"), i18n("Export to the given filename and exit")));
     parser.addOption(QCommandLineOption(QStringList() << QLatin1String("export-sequence"), i18n("Export animation to the given filename and exit")));
     parser.addOption(QCommandLineOption(QStringList() << QLatin1String("export-filename"), i18n("Filename for export"), QLatin1String("filename")));
+    parser.addOption(QCommandLineOption(QStringList() << QLatin1String("benchmark"), i18n("Run the headless benchmark described by the given JSON file and exit"), QLatin1String("specification")));
+    parser.addOption(QCommandLineOption(QStringList() << QLatin1String("benchmark-output"), i18n("Filename for the benchmark results, printed to the standard output if not specified"), QLatin1String("filename")));
     parser.addOption(QCommandLineOption(QStringList() << QLatin1String("file-layer"), i18n("File layer to be added to existing or new file"), QLatin1String("file-layer")));
     parser.addOption(QCommandLineOption(QStringList() << QLatin1String("resource-location"), i18n("A location that overrides the configured location for Krita's resources"), QLatin1String("file-layer")));
     parser.addPositionalArgument(QLatin1String("[file(s)]"), i18n("File(s) or URL(s) to open"));
@@ -176,6 +180,8 @@ KisApplicationArguments::KisApplicationArguments(const QApplication &app)
 
     d->fileLayer = parser.value("file-layer");
     d->exportFileName = parser.value("export-filename");
+    d->benchmarkSpecification = parser.value("benchmark");
+    d->benchmarkOutputFileName = parser.value("benchmark-output");
     d->workspace = parser.value("workspace");
     d->windowLayout = parser.value("windowlayout");
     d->session = parser.value("load-session");
@@ -326,6 +332,16 @@ QString KisApplicationArguments::exportFileName() const
     return d->exportFileName;
 }
 
+QString KisApplicationArguments::benchmarkSpecification() const
+{
+    return d->benchmarkSpecification;
+}
+
+QString KisApplicationArguments::benchmarkOutputFileName() const
+{
+    return d->benchmarkOutputFileName;
+}
+
 QString KisApplicationArguments::workspace() const
 {
     return d->workspace;
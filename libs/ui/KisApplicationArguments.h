@@ -33,6 +33,8 @@ public:
     bool exportAs() const;
     bool exportSequence() const;
     QString exportFileName() const;
+    QString benchmarkSpecification() const;
+    QString benchmarkOutputFileName() const;
     QString workspace() const;
     QString windowLayout() const;
     QString session() const;
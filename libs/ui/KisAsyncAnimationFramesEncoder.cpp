@@ -0,0 +1,204 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "KisAsyncAnimationFramesEncoder.h"
+
+#include <QFile>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QThreadPool>
+#include <QWaitCondition>
+#include <QtConcurrentRun>
+
+#include <KoColorSpace.h>
+
+#include "kis_image.h"
+#include "kis_paint_device.h"
+#include "kis_paint_layer.h"
+#include "KisDocument.h"
+#include "KisPart.h"
+
+struct KisAsyncAnimationFramesEncoder::Private
+{
+    struct SavingSlot {
+        KisDocument *document = 0;
+        KisPaintDeviceSP device;
+    };
+
+    QRect bounds;
+    qint64 frameSize = 0;
+    QByteArray outputMimeType;
+    KisPropertiesConfigurationSP exportConfiguration;
+    qint64 memoryLimit = 0;
+
+    QThreadPool pool;
+
+    /**
+     * Every thread of the pool needs its own saving document,
+     * since the documents cannot be shared between threads
+     */
+    QVector<SavingSlot> allSlots;
+    QVector<SavingSlot> freeSlots;
+
+    mutable QMutex mutex;
+    QWaitCondition memoryReleased;
+    qint64 queuedMemory = 0;
+    bool isCancelled = false;
+    bool hasFailed = false;
+
+    bool saveFrame(KisPaintDeviceSP frame, const QString &filename, const QStringList &identicalFilenames);
+};
+
+KisAsyncAnimationFramesEncoder::KisAsyncAnimationFramesEncoder(KisImageSP image,
+                                                               const QByteArray &outputMimeType,
+                                                               KisPropertiesConfigurationSP exportConfiguration,
+                                                               int numThreads,
+                                                               qint64 memoryLimit)
+    : m_d(new Private())
+{
+    m_d->bounds = image->bounds();
+    m_d->frameSize = qint64(m_d->bounds.width()) * m_d->bounds.height() * image->colorSpace()->pixelSize();
+    m_d->outputMimeType = outputMimeType;
+    m_d->exportConfiguration = exportConfiguration;
+    m_d->memoryLimit = memoryLimit;
+
+    numThreads = qMax(1, numThreads);
+    m_d->pool.setMaxThreadCount(numThreads);
+
+    // the documents are created in the GUI thread
+    for (int i = 0; i < numThreads; i++) {
+        Private::SavingSlot slot;
+        slot.document = createSavingDocument(image, &slot.device);
+        m_d->allSlots << slot;
+    }
+    m_d->freeSlots = m_d->allSlots;
+}
+
+KisAsyncAnimationFramesEncoder::~KisAsyncAnimationFramesEncoder()
+{
+    cancel();
+    m_d->pool.waitForDone();
+
+    Q_FOREACH (const Private::SavingSlot &slot, m_d->allSlots) {
+        delete slot.document;
+    }
+}
+
+KisDocument *KisAsyncAnimationFramesEncoder::createSavingDocument(KisImageSP image, KisPaintDeviceSP *savingDevice)
+{
+    KisDocument *savingDoc = KisPart::instance()->createDocument();
+
+    savingDoc->setInfiniteAutoSaveInterval();
+    savingDoc->setFileBatchMode(true);
+
+    KisImageSP savingImage = new KisImage(savingDoc->createUndoStore(),
+                                          image->bounds().width(),
+                                          image->bounds().height(),
+                                          image->colorSpace(),
+                                          QString());
+
+    savingImage->setResolution(image->xRes(), image->yRes());
+    savingDoc->setCurrentImage(savingImage);
+
+    KisPaintLayer* paintLayer = new KisPaintLayer(savingImage, "paint device", 255);
+    savingImage->addNode(paintLayer, savingImage->root(), KisLayerSP(0));
+
+    *savingDevice = paintLayer->paintDevice();
+
+    return savingDoc;
+}
+
+bool KisAsyncAnimationFramesEncoder::addFrame(KisPaintDeviceSP frame, const QString &filename, const QStringList &identicalFilenames)
+{
+    {
+        QMutexLocker l(&m_d->mutex);
+
+        /**
+         * Always let at least one frame into the queue, otherwise
+         * the frames bigger than the limit would block forever
+         */
+        while (!m_d->isCancelled && !m_d->hasFailed &&
+               m_d->queuedMemory > 0 &&
+               m_d->queuedMemory + m_d->frameSize > m_d->memoryLimit) {
+
+            m_d->memoryReleased.wait(&m_d->mutex);
+        }
+
+        if (m_d->isCancelled || m_d->hasFailed) {
+            return false;
+        }
+
+        m_d->queuedMemory += m_d->frameSize;
+    }
+
+    QtConcurrent::run(&m_d->pool,
+        [this, frame, filename, identicalFilenames] () {
+            bool isCancelled = false;
+            {
+                QMutexLocker l(&m_d->mutex);
+                isCancelled = m_d->isCancelled;
+            }
+
+            const bool result =
+                isCancelled || m_d->saveFrame(frame, filename, identicalFilenames);
+
+            QMutexLocker l(&m_d->mutex);
+            m_d->queuedMemory -= m_d->frameSize;
+            m_d->hasFailed |= !result;
+            m_d->memoryReleased.wakeAll();
+        });
+
+    return true;
+}
+
+bool KisAsyncAnimationFramesEncoder::Private::saveFrame(KisPaintDeviceSP frame, const QString &filename, const QStringList &identicalFilenames)
+{
+    SavingSlot slot;
+    {
+        QMutexLocker l(&mutex);
+        KIS_SAFE_ASSERT_RECOVER_RETURN_VALUE(!freeSlots.isEmpty(), false);
+        slot = freeSlots.takeLast();
+    }
+
+    slot.device->makeCloneFromRough(frame, bounds);
+
+    bool result = slot.document->exportDocumentSync(filename, outputMimeType, exportConfiguration);
+
+    if (result) {
+        Q_FOREACH (const QString &identicalFilename, identicalFilenames) {
+            QFile::copy(filename, identicalFilename);
+        }
+    }
+
+    // release the tiles of the frame as early as possible
+    slot.device->clear();
+
+    QMutexLocker l(&mutex);
+    freeSlots << slot;
+
+    return result;
+}
+
+void KisAsyncAnimationFramesEncoder::cancel()
+{
+    QMutexLocker l(&m_d->mutex);
+    m_d->isCancelled = true;
+    m_d->memoryReleased.wakeAll();
+}
+
+bool KisAsyncAnimationFramesEncoder::waitForFinished()
+{
+    m_d->pool.waitForDone();
+
+    QMutexLocker l(&m_d->mutex);
+    return !m_d->hasFailed;
+}
+
+bool KisAsyncAnimationFramesEncoder::hasFailed() const
+{
+    QMutexLocker l(&m_d->mutex);
+    return m_d->hasFailed;
+}
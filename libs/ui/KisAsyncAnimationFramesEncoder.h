@@ -0,0 +1,88 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KISASYNCANIMATIONFRAMESENCODER_H
+#define KISASYNCANIMATIONFRAMESENCODER_H
+
+#include "kritaui_export.h"
+
+#include <QScopedPointer>
+#include <QStringList>
+
+#include "kis_types.h"
+
+class KisDocument;
+
+/**
+ * KisAsyncAnimationFramesEncoder saves the rendered frames of an animation
+ * on its own thread pool, so that the image clones used for rendering can
+ * start regenerating the next frame right after the previous one is ready.
+ *
+ * The frames are passed as copy-on-write snapshots of the projection. The
+ * memory occupied by the frames waiting for being saved is limited: when
+ * the limit is reached, addFrame() blocks the calling rendering thread
+ * until some of the frames are saved.
+ *
+ * The encoder is shared by all the renderers of the same export.
+ */
+class KRITAUI_EXPORT KisAsyncAnimationFramesEncoder
+{
+public:
+    /**
+     * \param image the image whose frames are saved, used for fetching
+     *        the size, the color space and the resolution of the frames
+     * \param memoryLimit the maximum amount of memory (in bytes)
+     *        occupied by the queued frames
+     */
+    KisAsyncAnimationFramesEncoder(KisImageSP image,
+                                   const QByteArray &outputMimeType,
+                                   KisPropertiesConfigurationSP exportConfiguration,
+                                   int numThreads,
+                                   qint64 memoryLimit);
+    ~KisAsyncAnimationFramesEncoder();
+
+    /**
+     * Queues \p frame for being saved into \p filename. The saved file is
+     * then copied into every file of \p identicalFilenames.
+     *
+     * Can be called from any thread. Blocks while the memory limit is
+     * reached.
+     *
+     * \return false if the frame hasn't been queued, because the encoder
+     *         has been cancelled or one of the previous frames has failed
+     */
+    bool addFrame(KisPaintDeviceSP frame, const QString &filename, const QStringList &identicalFilenames);
+
+    /**
+     * Drops all the frames that haven't been started yet
+     */
+    void cancel();
+
+    /**
+     * Waits until all the queued frames are saved
+     *
+     * \return true if all the frames have been saved successfully
+     */
+    bool waitForFinished();
+
+    /**
+     * \return true if saving of one of the frames has failed
+     */
+    bool hasFailed() const;
+
+    /**
+     * Creates a document with a single paint layer, that can be used for
+     * saving the frames of \p image. The device of the layer is returned
+     * in \p savingDevice.
+     */
+    static KisDocument* createSavingDocument(KisImageSP image, KisPaintDeviceSP *savingDevice);
+
+private:
+    struct Private;
+    const QScopedPointer<Private> m_d;
+};
+
+#endif // KISASYNCANIMATIONFRAMESENCODER_H
@@ -13,34 +13,25 @@
 #include "KisDocument.h"
 #include "kis_time_span.h"
 #include "kis_paint_layer.h"
+#include "KisAsyncAnimationFramesEncoder.h"
 
 
 struct KisAsyncAnimationFramesSavingRenderer::Private
 {
-    Private(KisImageSP image, const KisTimeSpan &_range, int _sequenceNumberingOffset, bool _onlyNeedsUniqueFrames, KisPropertiesConfigurationSP _exportConfiguration)
-        : savingDoc(KisPart::instance()->createDocument()),
-          range(_range),
+    Private(KisImageSP image, const KisTimeSpan &_range, int _sequenceNumberingOffset, bool _onlyNeedsUniqueFrames, KisPropertiesConfigurationSP _exportConfiguration, QSharedPointer<KisAsyncAnimationFramesEncoder> _encoder)
+        : range(_range),
           sequenceNumberingOffset(_sequenceNumberingOffset),
           onlyNeedsUniqueFrames(_onlyNeedsUniqueFrames),
-          exportConfiguration(_exportConfiguration)
+          exportConfiguration(_exportConfiguration),
+          encoder(_encoder)
     {
-
-        savingDoc->setInfiniteAutoSaveInterval();
-        savingDoc->setFileBatchMode(true);
-
-        KisImageSP savingImage = new KisImage(savingDoc->createUndoStore(),
-                                              image->bounds().width(),
-                                              image->bounds().height(),
-                                              image->colorSpace(),
-                                              QString());
-
-        savingImage->setResolution(image->xRes(), image->yRes());
-        savingDoc->setCurrentImage(savingImage);
-
-        KisPaintLayer* paintLayer = new KisPaintLayer(savingImage, "paint device", 255);
-        savingImage->addNode(paintLayer, savingImage->root(), KisLayerSP(0));
-
-        savingDevice = paintLayer->paintDevice();
+        /**
+         * When the frames are saved by the encoder, it has its own
+         * saving documents, one per encoding thread
+         */
+        if (!encoder) {
+            savingDoc.reset(KisAsyncAnimationFramesEncoder::createSavingDocument(image, &savingDevice));
+        }
     }
 
     QScopedPointer<KisDocument> savingDoc;
@@ -56,6 +47,13 @@ struct KisAsyncAnimationFramesSavingRenderer::Private
 
     QByteArray outputMimeType;
     KisPropertiesConfigurationSP exportConfiguration;
+
+    QSharedPointer<KisAsyncAnimationFramesEncoder> encoder;
+
+    QString frameFilename(int frame) const {
+        QString frameNumber = QString("%1").arg(frame + sequenceNumberingOffset, 4, 10, QChar('0'));
+        return filenamePrefix + frameNumber + filenameSuffix;
+    }
 };
 
 KisAsyncAnimationFramesSavingRenderer::KisAsyncAnimationFramesSavingRenderer(KisImageSP image,
@@ -65,8 +63,9 @@ KisAsyncAnimationFramesSavingRenderer::KisAsyncAnimationFramesSavingRenderer(Kis
                                                                              const KisTimeSpan &range,
                                                                              const int sequenceNumberingOffset,
                                                                              const bool onlyNeedsUniqueFrames,
-                                                                             KisPropertiesConfigurationSP exportConfiguration)
-    : m_d(new Private(image, range, sequenceNumberingOffset, onlyNeedsUniqueFrames, exportConfiguration))
+                                                                             KisPropertiesConfigurationSP exportConfiguration,
+                                                                             QSharedPointer<KisAsyncAnimationFramesEncoder> encoder)
+    : m_d(new Private(image, range, sequenceNumberingOffset, onlyNeedsUniqueFrames, exportConfiguration, encoder))
 {
     m_d->filenamePrefix = fileNamePrefix;
     m_d->filenameSuffix = fileNameSuffix;
@@ -93,37 +92,54 @@ void KisAsyncAnimationFramesSavingRenderer::frameCompletedCallback(int frame, co
         return;
     }
 
+    const QString filename = m_d->frameFilename(frame);
+
+    //Get all identical frames to this one and either copy or symlink based on settings.
+    QStringList identicalFilenames;
+    KisTimeSpan identicals = KisTimeSpan::calculateIdenticalFramesRecursive(image->root(), frame);
+    identicals &= m_d->range;
+    if( !m_d->onlyNeedsUniqueFrames && identicals.start() < identicals.end() ) {
+        for (int identicalFrame = (identicals.start() + 1); identicalFrame <= identicals.end(); identicalFrame++) {
+            identicalFilenames << m_d->frameFilename(identicalFrame);
+        }
+    }
+
+    if (m_d->encoder) {
+        /**
+         * The projection is copied-on-write, so the snapshot is cheap
+         * and the clone can start rendering the next frame while this
+         * one is being encoded
+         */
+        KisPaintDeviceSP snapshot = new KisPaintDevice(*image->projection());
+
+        if (m_d->encoder->addFrame(snapshot, filename, identicalFilenames)) {
+            Q_EMIT sigCompleteRegenerationInternal(frame);
+        } else {
+            Q_EMIT sigCancelRegenerationInternal(frame, KisAsyncAnimationRendererBase::RenderingFailed);
+        }
+        return;
+    }
+
     m_d->savingDevice->makeCloneFromRough(image->projection(), image->bounds());
 
     KisImportExportErrorCode status = ImportExportCodes::OK;
 
-    QString frameNumber = QString("%1").arg(frame + m_d->sequenceNumberingOffset, 4, 10, QChar('0'));
-    QString filename = m_d->filenamePrefix + frameNumber + m_d->filenameSuffix;
-
     if (!m_d->savingDoc->exportDocumentSync(filename, m_d->outputMimeType, m_d->exportConfiguration)) {
         status = ImportExportCodes::InternalError;
     }
 
-    //Get all identical frames to this one and either copy or symlink based on settings.
-    KisTimeSpan identicals = KisTimeSpan::calculateIdenticalFramesRecursive(image->root(), frame);
-    identicals &= m_d->range;
-    if( !m_d->onlyNeedsUniqueFrames && identicals.start() < identicals.end() ) {
-        for (int identicalFrame = (identicals.start() + 1); identicalFrame <= identicals.end(); identicalFrame++) {
-            QString identicalFrameNumber = QString("%1").arg(identicalFrame + m_d->sequenceNumberingOffset, 4, 10, QChar('0'));
-            QString identicalFrameName = m_d->filenamePrefix + identicalFrameNumber + m_d->filenameSuffix;
-
-            QFile::copy(filename, identicalFrameName);
-
-            /*  This would be nice to do but sym-linking on windows isn't possible without
-             *  way more other work to be done. This works on linux though!
-             *
-             *  if (m_d->linkRedundantFrames) {
-             *      QFile::link(filename, identicalFrameName);
-             *  } else {
-             *      QFile::copy(filename, identicalFrameName);
-             *  }
-             */
-        }
+    Q_FOREACH (const QString &identicalFrameName, identicalFilenames) {
+        QFile::copy(filename, identicalFrameName);
+
+        /*  This would be nice to do but sym-linking on windows isn't possible without
+         *  way more other work to be done. This works on linux though!
+         *
+         *  if (m_d->linkRedundantFrames) {
+         *      QFile::link(filename, identicalFrameName);
+         *  } else {
+         *      QFile::copy(filename, identicalFrameName);
+         *  }
+         */
     }
 
     if (status.isOk()) {
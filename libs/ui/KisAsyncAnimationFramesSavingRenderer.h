@@ -7,10 +7,13 @@
 #ifndef KISASYNCANIMATIONFRAMESSAVINGRENDERER_H
 #define KISASYNCANIMATIONFRAMESSAVINGRENDERER_H
 
+#include <QSharedPointer>
+
 #include <KisAsyncAnimationRendererBase.h>
 
 class KisDocument;
 class KisTimeSpan;
+class KisAsyncAnimationFramesEncoder;
 
 class KisAsyncAnimationFramesSavingRenderer : public KisAsyncAnimationRendererBase
 {
@@ -23,7 +26,8 @@ public:
                                           const KisTimeSpan &range,
                                           const int sequenceNumberingOffset,
                                           const bool onlyNeedsUniqueFrames,
-                                          KisPropertiesConfigurationSP exportConfiguration);
+                                          KisPropertiesConfigurationSP exportConfiguration,
+                                          QSharedPointer<KisAsyncAnimationFramesEncoder> encoder = QSharedPointer<KisAsyncAnimationFramesEncoder>());
     ~KisAsyncAnimationFramesSavingRenderer();
 
 protected:
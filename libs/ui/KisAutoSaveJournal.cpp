@@ -0,0 +1,406 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "KisAutoSaveJournal.h"
+
+#include <QDateTime>
+#include <QDomDocument>
+#include <QFile>
+#include <QFileInfo>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QSaveFile>
+#include <QVector>
+
+#include <KoStore.h>
+
+#include "kis_config.h"
+#include "kis_debug.h"
+#include "kis_layer_utils.h"
+#include "kis_mask.h"
+#include "kis_paint_layer.h"
+#include "kis_pixel_selection.h"
+#include "kis_selection.h"
+#include "kis_selection_based_layer.h"
+#include "KisUsageLogger.h"
+
+namespace {
+
+const QString manifestFileName = "autosavejournal.xml";
+
+/**
+ * The journal is compacted into a full autosave when
+ * its size exceeds this fraction of the base file size
+ */
+const qreal maxJournalToBaseSizeRatio = 0.5;
+
+struct FileIdentity {
+    qint64 size {-1};
+    qint64 lastModified {-1};
+
+    static FileIdentity fromFile(const QString &path) {
+        FileIdentity id;
+        QFileInfo info(path);
+        if (info.exists()) {
+            id.size = info.size();
+            id.lastModified = info.lastModified().toMSecsSinceEpoch();
+        }
+        return id;
+    }
+
+    bool isValid() const {
+        return size >= 0;
+    }
+
+    bool operator==(const FileIdentity &rhs) const {
+        return size == rhs.size && lastModified == rhs.lastModified;
+    }
+};
+
+}
+
+struct KisAutoSaveJournal::Private
+{
+    mutable QMutex mutex;
+
+    QString basePath;
+    FileIdentity baseIdentity;
+    DeviceRevisions baseRevisions;
+    QHash<QString, QString> baseEntries;
+    int numJournalSaves {0};
+
+    bool savingInProgress {false};
+    bool savingJournal {false};
+    QString pendingPath;
+    DeviceRevisions pendingRevisions;
+    QHash<QString, QString> pendingEntries;
+    QVector<QPair<QString, QString>> reusedEntries;
+
+    void resetPendingState() {
+        savingInProgress = false;
+        savingJournal = false;
+        pendingPath.clear();
+        pendingRevisions.clear();
+        pendingEntries.clear();
+        reusedEntries.clear();
+    }
+};
+
+KisAutoSaveJournal::KisAutoSaveJournal()
+    : m_d(new Private)
+{
+}
+
+KisAutoSaveJournal::~KisAutoSaveJournal()
+{
+}
+
+QString KisAutoSaveJournal::deviceKey(const KisNode *node, DeviceRole role)
+{
+    return node->uuid().toString() + (role == PixelSelection ? "/pixelselection" : "/device");
+}
+
+KisAutoSaveJournal::DeviceRevisions KisAutoSaveJournal::collectRevisions(KisNodeSP root)
+{
+    DeviceRevisions revisions;
+
+    auto addDevice = [&revisions] (KisNodeSP node, DeviceRole role, KisPaintDeviceSP device) {
+        if (!device) return;
+
+        revisions.insert(deviceKey(node.data(), role), device->contentRevision());
+    };
+
+    KisLayerUtils::recursiveApplyNodes(root,
+        [&addDevice] (KisNodeSP node) {
+            if (KisPaintLayer *layer = dynamic_cast<KisPaintLayer*>(node.data())) {
+                addDevice(node, NodeDevice, layer->paintDevice());
+            }
+
+            KisSelectionSP selection;
+            if (KisMask *mask = dynamic_cast<KisMask*>(node.data())) {
+                selection = mask->selection();
+            } else if (KisSelectionBasedLayer *layer = dynamic_cast<KisSelectionBasedLayer*>(node.data())) {
+                selection = layer->internalSelection();
+            }
+
+            if (selection) {
+                addDevice(node, PixelSelection, selection->pixelSelection());
+            }
+        });
+
+    return revisions;
+}
+
+QString KisAutoSaveJournal::journalPath(const QString &autoSavePath)
+{
+    QString result = autoSavePath;
+
+    if (result.endsWith(".kra")) {
+        result.chop(4);
+    }
+
+    return result + "-journal.kra";
+}
+
+bool KisAutoSaveJournal::mergeJournal(const QString &autoSavePath)
+{
+    const QString journal = journalPath(autoSavePath);
+    if (!QFile::exists(journal)) return true;
+
+    QScopedPointer<KoStore> journalStore(KoStore::createStore(journal, KoStore::Read, "", KoStore::Zip));
+    if (!journalStore || journalStore->bad()) {
+        warnKrita << "Could not open the autosave journal" << journal;
+        return false;
+    }
+
+    QByteArray manifestData;
+    QDomDocument manifest;
+    if (!journalStore->extractFile(manifestFileName, manifestData) ||
+        !manifest.setContent(manifestData)) {
+
+        warnKrita << "Could not read the manifest of the autosave journal" << journal;
+        return false;
+    }
+
+    const QDomElement root = manifest.documentElement();
+
+    FileIdentity expectedBase;
+    expectedBase.size = root.attribute("baseSize", "-1").toLongLong();
+    expectedBase.lastModified = root.attribute("baseModified", "-1").toLongLong();
+
+    if (!(expectedBase == FileIdentity::fromFile(autoSavePath))) {
+        KisUsageLogger::log(QString("Removing stale autosave journal: %1").arg(journal));
+        QFile::remove(journal);
+        return true;
+    }
+
+    QVector<QPair<QString, QString>> reusedEntries;
+    for (QDomElement e = root.firstChildElement("entry"); !e.isNull(); e = e.nextSiblingElement("entry")) {
+        reusedEntries.append(qMakePair(e.attribute("name"), e.attribute("base")));
+    }
+
+    QScopedPointer<KoStore> baseStore(KoStore::createStore(autoSavePath, KoStore::Read, "", KoStore::Zip));
+    if (!baseStore || baseStore->bad()) {
+        warnKrita << "Could not open the autosave file" << autoSavePath;
+        return false;
+    }
+
+    QSaveFile file(autoSavePath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        warnKrita << "Could not open the autosave file for writing" << autoSavePath;
+        return false;
+    }
+
+    QScopedPointer<KoStore> mergedStore(KoStore::createStore(&file, KoStore::Write, "application/x-krita", KoStore::Zip));
+    if (!mergedStore || mergedStore->bad()) {
+        file.cancelWriting();
+        return false;
+    }
+
+    auto copyEntry = [&mergedStore] (KoStore *srcStore, const QString &srcName, const QString &dstName) {
+        QByteArray data;
+        if (!srcStore->extractFile(srcName, data)) {
+            warnKrita << "Could not extract" << srcName << "while merging the autosave journal";
+            return false;
+        }
+
+        if (!mergedStore->open(dstName)) return false;
+        const bool result = mergedStore->write(data) == data.size();
+        return mergedStore->close() && result;
+    };
+
+    bool result = true;
+
+    Q_FOREACH (const QString &name, journalStore->directoryList()) {
+        if (name == "mimetype" || name == manifestFileName || name.endsWith('/')) continue;
+
+        result &= copyEntry(journalStore.data(), name, name);
+    }
+
+    for (auto it = reusedEntries.constBegin(); it != reusedEntries.constEnd(); ++it) {
+        result &= copyEntry(baseStore.data(), it->second, it->first);
+    }
+
+    result &= mergedStore->finalize();
+    mergedStore.reset();
+    baseStore.reset();
+    journalStore.reset();
+
+    if (!result) {
+        file.cancelWriting();
+        warnKrita << "Failed to merge the autosave journal into" << autoSavePath;
+        return false;
+    }
+
+    if (!file.commit()) {
+        return false;
+    }
+
+    KisUsageLogger::log(QString("Merged autosave journal: %1").arg(journal));
+    QFile::remove(journal);
+
+    return true;
+}
+
+void KisAutoSaveJournal::removeJournal(const QString &autoSavePath)
+{
+    const QString journal = journalPath(autoSavePath);
+    if (QFile::exists(journal)) {
+        KisUsageLogger::log(QString("Removing autosave journal: %1").arg(journal));
+        QFile::remove(journal);
+    }
+}
+
+QString KisAutoSaveJournal::beginAutoSave(const QString &autoSavePath)
+{
+    QMutexLocker l(&m_d->mutex);
+
+    KIS_SAFE_ASSERT_RECOVER_NOOP(!m_d->savingInProgress);
+    m_d->resetPendingState();
+
+    KisConfig cfg(true);
+
+    /**
+     * The journal can be written only if the base file is still the
+     * one we have written, e.g. it hasn't been overwritten by a
+     * non-incremental save or removed by the user.
+     */
+    bool useJournal =
+        cfg.incrementalAutoSave() &&
+        m_d->basePath == autoSavePath &&
+        m_d->baseIdentity.isValid() &&
+        m_d->baseIdentity == FileIdentity::fromFile(autoSavePath) &&
+        m_d->numJournalSaves < cfg.incrementalAutoSaveMaxSteps();
+
+    const QString journal = journalPath(autoSavePath);
+
+    if (useJournal && QFile::exists(journal)) {
+        useJournal = QFileInfo(journal).size() < maxJournalToBaseSizeRatio * m_d->baseIdentity.size;
+    }
+
+    m_d->savingInProgress = true;
+    m_d->savingJournal = useJournal;
+    m_d->pendingPath = useJournal ? journal : autoSavePath;
+
+    if (!useJournal) {
+        m_d->basePath = autoSavePath;
+    }
+
+    return m_d->pendingPath;
+}
+
+void KisAutoSaveJournal::setSavedRevisions(const DeviceRevisions &revisions)
+{
+    QMutexLocker l(&m_d->mutex);
+    m_d->pendingRevisions = revisions;
+}
+
+void KisAutoSaveJournal::endAutoSave(bool success)
+{
+    QMutexLocker l(&m_d->mutex);
+    KIS_SAFE_ASSERT_RECOVER_RETURN(m_d->savingInProgress);
+
+    if (success) {
+        if (m_d->savingJournal) {
+            m_d->numJournalSaves++;
+        } else {
+            m_d->baseIdentity = FileIdentity::fromFile(m_d->basePath);
+            m_d->baseRevisions = m_d->pendingRevisions;
+            m_d->baseEntries = m_d->pendingEntries;
+            m_d->numJournalSaves = 0;
+
+            // the old journal refers to the previous version of the base
+            removeJournal(m_d->basePath);
+        }
+    } else if (!m_d->savingJournal) {
+        // the base might have been partially overwritten
+        m_d->baseIdentity = FileIdentity();
+    }
+
+    m_d->resetPendingState();
+}
+
+void KisAutoSaveJournal::cancelAutoSave()
+{
+    QMutexLocker l(&m_d->mutex);
+    m_d->resetPendingState();
+}
+
+void KisAutoSaveJournal::reset()
+{
+    QMutexLocker l(&m_d->mutex);
+
+    m_d->basePath.clear();
+    m_d->baseIdentity = FileIdentity();
+    m_d->baseRevisions.clear();
+    m_d->baseEntries.clear();
+    m_d->numJournalSaves = 0;
+}
+
+bool KisAutoSaveJournal::isSavingJournal() const
+{
+    QMutexLocker l(&m_d->mutex);
+    return m_d->savingInProgress && m_d->savingJournal;
+}
+
+QString KisAutoSaveJournal::reusableEntry(const QString &key) const
+{
+    QMutexLocker l(&m_d->mutex);
+
+    if (!m_d->savingJournal) return QString();
+
+    auto baseIt = m_d->baseRevisions.constFind(key);
+    auto pendingIt = m_d->pendingRevisions.constFind(key);
+
+    if (baseIt == m_d->baseRevisions.constEnd() ||
+        pendingIt == m_d->pendingRevisions.constEnd() ||
+        *baseIt != *pendingIt) {
+
+        return QString();
+    }
+
+    return m_d->baseEntries.value(key);
+}
+
+void KisAutoSaveJournal::addReusedEntry(const QString &location, const QString &baseLocation)
+{
+    QMutexLocker l(&m_d->mutex);
+    m_d->reusedEntries.append(qMakePair(location, baseLocation));
+}
+
+void KisAutoSaveJournal::addWrittenEntry(const QString &key, const QString &location)
+{
+    QMutexLocker l(&m_d->mutex);
+    m_d->pendingEntries.insert(key, location);
+}
+
+bool KisAutoSaveJournal::saveManifest(KoStore *store) const
+{
+    QMutexLocker l(&m_d->mutex);
+    KIS_SAFE_ASSERT_RECOVER_RETURN_VALUE(m_d->savingJournal, false);
+
+    QDomDocument doc;
+    QDomElement root = doc.createElement("autosavejournal");
+    root.setAttribute("version", "1");
+    root.setAttribute("baseSize", QString::number(m_d->baseIdentity.size));
+    root.setAttribute("baseModified", QString::number(m_d->baseIdentity.lastModified));
+    doc.appendChild(root);
+
+    for (auto it = m_d->reusedEntries.constBegin(); it != m_d->reusedEntries.constEnd(); ++it) {
+        QDomElement e = doc.createElement("entry");
+        e.setAttribute("name", it->first);
+        e.setAttribute("base", it->second);
+        root.appendChild(e);
+    }
+
+    if (!store->open(manifestFileName)) {
+        return false;
+    }
+
+    const QByteArray data = doc.toByteArray();
+    const bool result = store->write(data) == data.size();
+    return store->close() && result;
+}
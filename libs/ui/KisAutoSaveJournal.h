@@ -0,0 +1,162 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KISAUTOSAVEJOURNAL_H
+#define KISAUTOSAVEJOURNAL_H
+
+#include "kritaui_export.h"
+
+#include <QHash>
+#include <QScopedPointer>
+#include <QString>
+
+#include "kis_types.h"
+
+class KoStore;
+
+/**
+ * KisAutoSaveJournal implements incremental autosaving of a document.
+ *
+ * The first autosave of a document writes the usual full .kra file, which
+ * becomes the base of the journal. The following autosaves write a journal
+ * file next to it. The journal is a .kra file that contains all the data of
+ * the document except for the pixel data of the paint devices that have not
+ * changed since the base was written. Such entries are listed in the journal's
+ * manifest and are taken from the base file when the autosave is recovered
+ * (see mergeJournal()).
+ *
+ * The journal is compacted, that is, a full autosave is written instead,
+ * when it becomes too big in comparison with the base or when too many
+ * journal autosaves have been written in a row.
+ *
+ * The changes are tracked with the sequence numbers of the paint devices
+ * of the original document, which are fetched when the document is cloned
+ * for saving (see collectRevisions()).
+ */
+class KRITAUI_EXPORT KisAutoSaveJournal
+{
+public:
+    enum DeviceRole {
+        NodeDevice,
+        PixelSelection
+    };
+
+    /**
+     * The revision of the pixel data of a device, see
+     * KisPaintDevice::contentRevision(). The revisions are unique
+     * among all the devices, so equal revisions mean the same
+     * device with the same content.
+     */
+    using DeviceRevision = quint64;
+
+    using DeviceRevisions = QHash<QString, DeviceRevision>;
+
+public:
+    KisAutoSaveJournal();
+    ~KisAutoSaveJournal();
+
+    /**
+     * \return the key of the device with \p role of \p node. The key
+     * is stable over the cloning of the image, since the clone keeps
+     * the UUIDs of the nodes.
+     */
+    static QString deviceKey(const KisNode *node, DeviceRole role);
+
+    /**
+     * Fetches the revisions of the paint devices of all the nodes in the
+     * tree. The image should be locked while calling this function.
+     */
+    static DeviceRevisions collectRevisions(KisNodeSP root);
+
+    /**
+     * \return the path of the journal file that belongs to the autosave
+     * file \p autoSavePath
+     */
+    static QString journalPath(const QString &autoSavePath);
+
+    /**
+     * Merges the journal file that belongs to \p autoSavePath (if any) into
+     * the autosave file itself and removes the journal. Should be called
+     * before opening an autosave file. A journal that doesn't belong to the
+     * current version of the autosave file is discarded.
+     *
+     * \return false if the merging failed, in which case the autosave file
+     * is kept unchanged
+     */
+    static bool mergeJournal(const QString &autoSavePath);
+
+    /**
+     * Removes the journal file that belongs to \p autoSavePath
+     */
+    static void removeJournal(const QString &autoSavePath);
+
+    /**
+     * Starts a new autosave into \p autoSavePath and decides whether
+     * a full autosave or a journal should be written.
+     *
+     * \return the path of the file that should be written
+     */
+    QString beginAutoSave(const QString &autoSavePath);
+
+    /**
+     * Sets the revisions of the devices of the document that is being
+     * autosaved. Without them, all the pixel data is written into the
+     * journal.
+     */
+    void setSavedRevisions(const DeviceRevisions &revisions);
+
+    /**
+     * Ends the autosave started with beginAutoSave()
+     */
+    void endAutoSave(bool success);
+
+    /**
+     * Cancels the autosave started with beginAutoSave() when
+     * it could not be started at all
+     */
+    void cancelAutoSave();
+
+    /**
+     * Forgets about the base file, so the next autosave will be a full one
+     */
+    void reset();
+
+    /**
+     * \return true if the autosave in progress writes a journal
+     */
+    bool isSavingJournal() const;
+
+    /**
+     * Used by the .kra saver: \return the location of the pixel data of
+     * the device with \p key in the base file, if the device has not
+     * changed since the base was written; an empty string otherwise.
+     */
+    QString reusableEntry(const QString &key) const;
+
+    /**
+     * Used by the .kra saver: the data for \p location should be
+     * taken from \p baseLocation of the base file
+     */
+    void addReusedEntry(const QString &location, const QString &baseLocation);
+
+    /**
+     * Used by the .kra saver: the pixel data of the device with
+     * \p key has been written into \p location
+     */
+    void addWrittenEntry(const QString &key, const QString &location);
+
+    /**
+     * Used by the .kra saver: writes the manifest of the journal
+     * into \p store
+     */
+    bool saveManifest(KoStore *store) const;
+
+private:
+    struct Private;
+    const QScopedPointer<Private> m_d;
+};
+
+#endif // KISAUTOSAVEJOURNAL_H
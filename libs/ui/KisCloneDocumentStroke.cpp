@@ -45,6 +45,7 @@ void KisCloneDocumentStroke::initStrokeCallback()
 void KisCloneDocumentStroke::finishStrokeCallback()
 {
     KisDocument *doc = m_d->document->clone();
+    KisLayerUtils::purgeAllLodData(doc->image()->root());
     doc->moveToThread(qApp->thread());
     Q_EMIT sigDocumentCloned(doc);
 }
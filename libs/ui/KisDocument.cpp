@@ -48,6 +48,7 @@
 #include <kis_generator_layer.h>
 #include <kis_generator_registry.h>
 #include <KisAutoSaveRecoveryDialog.h>
+#include <KisAutoSaveJournal.h>
 #include <kdesktopfile.h>
 #include <kconfiggroup.h>
 #include <KisBackup.h>
@@ -359,6 +360,18 @@ public:
     bool disregardAutosaveFailure = false;
     int autoSaveFailureCount = 0;
 
+    /**
+     * The journal of the incremental autosave. It is owned by the original
+     * document and shared with its clone while the clone is being autosaved.
+     */
+    QSharedPointer<KisAutoSaveJournal> autoSaveJournal;
+
+    /**
+     * The revisions of the paint devices of the document this document
+     * has been cloned from, fetched at the moment of cloning
+     */
+    KisAutoSaveJournal::DeviceRevisions sourceDeviceRevisions;
+
     KUndo2Stack *undoStack = 0;
 
     KisGuidesConfig guidesConfig;
@@ -1152,14 +1165,25 @@ KisDocument *KisDocument::Private::lockAndCloneImpl(bool fetchResourcesFromLayer
         }
     }
 
-    Private::StrippedSafeSavingLocker locker(&savingMutex, image);
-    if (!locker.successfullyLocked()) {
-        return 0;
-    }
+    KisDocument *doc = 0;
 
-    KisDocument *doc = new KisDocument(*this->q, false);
+    {
+        Private::StrippedSafeSavingLocker locker(&savingMutex, image);
+        if (!locker.successfullyLocked()) {
+            return 0;
+        }
+
+        /**
+         * The clone shares all the pixel data with the source image
+         * via copy-on-write, so the image should be locked only while
+         * the layer tree itself is being copied. All the post-processing
+         * happens on the clone and doesn't block painting.
+         */
+        doc = new KisDocument(*this->q, false);
+    }
 
     if (fetchResourcesFromLayers) {
+        KisLayerUtils::purgeAllLodData(doc->image()->root());
         doc->d->uploadLinkedResourcesFromLayersToStorage();
     }
 
@@ -1216,6 +1240,7 @@ void KisDocument::copyFromDocumentImpl(const KisDocument &rhs, CopyPolicy policy
         } else {
             // clone the image with keeping the GUIDs of the layers intact
             // NOTE: we expect the image to be locked!
+            d->sourceDeviceRevisions = KisAutoSaveJournal::collectRevisions(rhs.image()->root());
             setCurrentImage(rhs.image()->clone(/* exactCopy = */ true), /* forceInitialUpdate = */ false);
         }
     }
@@ -1363,6 +1388,11 @@ KritaUtils::JobResult KisDocument::initiateSavingInBackground(const QString acti
 
     if (d->backgroundSaveJob.flags & KritaUtils::SaveInAutosaveMode) {
         d->backgroundSaveDocument->d->isAutosaving = true;
+
+        if (d->autoSaveJournal) {
+            d->autoSaveJournal->setSavedRevisions(d->backgroundSaveDocument->d->sourceDeviceRevisions);
+            d->backgroundSaveDocument->d->autoSaveJournal = d->autoSaveJournal;
+        }
     }
 
     connect(d->backgroundSaveDocument.data(),
@@ -1444,11 +1474,22 @@ void KisDocument::slotAutoSaveImpl(std::unique_ptr<KisDocument> &&optionalCloned
     KritaUtils::JobResult result = KritaUtils::JobResult::Failure;
 
     if (d->image->isIdle() || hadClonedDocument) {
+        if (!d->autoSaveJournal) {
+            d->autoSaveJournal.reset(new KisAutoSaveJournal());
+        }
+
+        // the file is either the full autosave or its journal
+        const QString targetFileName = d->autoSaveJournal->beginAutoSave(autoSaveFileName);
+
         result = initiateSavingInBackground(i18n("Autosaving..."),
                                              this, SLOT(slotCompleteAutoSaving(KritaUtils::ExportFileJob, KisImportExportErrorCode, QString, QString)),
-                                             KritaUtils::ExportFileJob(autoSaveFileName, nativeFormatMimeType(), KritaUtils::SaveIsExporting | KritaUtils::SaveInAutosaveMode),
+                                             KritaUtils::ExportFileJob(targetFileName, nativeFormatMimeType(), KritaUtils::SaveIsExporting | KritaUtils::SaveInAutosaveMode),
                                              0,
                                              std::move(optionalClonedDocument));
+
+        if (result != KritaUtils::JobResult::Success) {
+            d->autoSaveJournal->cancelAutoSave();
+        }
     } else {
         Q_EMIT statusBarMessage(i18n("Autosaving postponed: document is busy..."), errorMessageTimeout);
     }
@@ -1590,6 +1631,10 @@ void KisDocument::slotCompleteAutoSaving(const KritaUtils::ExportFileJob &job, K
 
     const QString fileName = QFileInfo(job.filePath).fileName();
 
+    if (d->autoSaveJournal) {
+        d->autoSaveJournal->endAutoSave(status.isOk());
+    }
+
     if (!status.isOk()) {
         setEmergencyAutoSaveInterval();
         Q_EMIT statusBarMessage(i18nc("%1 --- failing file name, %2 --- error message",
@@ -1892,6 +1937,7 @@ bool KisDocument::openPath(const QString &_path, OpenFlags flags)
             case KisRecoverNamedAutosaveDialog::OpenMainFile :
                 KisUsageLogger::log(QString("Removing autosave file: %1").arg(asf));
                 QFile::remove(asf);
+                KisAutoSaveJournal::removeJournal(asf);
                 break;
             default: // Cancel
                 return false;
@@ -1899,6 +1945,11 @@ bool KisDocument::openPath(const QString &_path, OpenFlags flags)
         }
     }
 
+    if (autosaveOpened || flags & RecoveryFile) {
+        // bring the changes saved incrementally into the autosave file
+        KisAutoSaveJournal::mergeJournal(path);
+    }
+
     bool ret = openPathInternal(path);
 
     if (autosaveOpened || flags & RecoveryFile) {
@@ -2201,12 +2252,19 @@ void KisDocument::removeAutoSaveFiles(const QString &autosaveBaseName, bool wasR
         KisUsageLogger::log(QString("Removing autosave file: %1").arg(asf));
         QFile::remove(asf);
     }
+    KisAutoSaveJournal::removeJournal(asf);
+
     asf = generateAutoSaveFileName(QString());   // and the one in $HOME
 
     if (QFile::exists(asf)) {
         KisUsageLogger::log(QString("Removing autosave file: %1").arg(asf));
         QFile::remove(asf);
     }
+    KisAutoSaveJournal::removeJournal(asf);
+
+    if (d->autoSaveJournal) {
+        d->autoSaveJournal->reset();
+    }
 
     QList<QRegularExpression> expressions;
 
@@ -2221,6 +2279,7 @@ void KisDocument::removeAutoSaveFiles(const QString &autosaveBaseName, bool wasR
 
             KisUsageLogger::log(QString("Removing autosave file: %1").arg(autosaveBaseName));
             QFile::remove(autosaveBaseName);
+            KisAutoSaveJournal::removeJournal(autosaveBaseName);
         }
     }
 }
@@ -2841,6 +2900,11 @@ bool KisDocument::isAutosaving() const
     return d->isAutosaving;
 }
 
+KisAutoSaveJournal *KisDocument::autoSaveJournal() const
+{
+    return d->isAutosaving ? d->autoSaveJournal.data() : 0;
+}
+
 QString KisDocument::exportErrorToUserMessage(KisImportExportErrorCode status, const QString &errorMessage)
 {
     return errorMessage.isEmpty() ? status.errorMessage() : errorMessage;
@@ -54,6 +54,7 @@ class KisGuidesConfig;
 class KisMirrorAxisConfig;
 class QDomDocument;
 class KisReferenceImagesLayer;
+class KisAutoSaveJournal;
 
 #define KIS_MIME_TYPE "application/x-krita"
 
@@ -579,6 +580,12 @@ public:
 
     bool isAutosaving() const;
 
+    /**
+     * \return the journal of the incremental autosave, if the document
+     * is being autosaved, and null otherwise
+     */
+    KisAutoSaveJournal *autoSaveJournal() const;
+
 public:
 
     QString localFilePath() const;
@@ -115,8 +115,8 @@ FrameInfo::~FrameInfo()
 
 struct KRITAUI_NO_EXPORT KisFrameCacheStore::Private
 {
-    Private(const QString &frameCachePath)
-        : serializer(frameCachePath)
+    Private(const QString &frameCachePath, KisFrameDataSerializer::Compression compression)
+        : serializer(frameCachePath, compression)
     {
     }
 
@@ -139,7 +139,12 @@ KisFrameCacheStore::KisFrameCacheStore()
 }
 
 KisFrameCacheStore::KisFrameCacheStore(const QString &frameCachePath)
-    : m_d(new Private(frameCachePath))
+    : KisFrameCacheStore(frameCachePath, KisFrameDataSerializer::CompressionLzf)
+{
+}
+
+KisFrameCacheStore::KisFrameCacheStore(const QString &frameCachePath, KisFrameDataSerializer::Compression compression)
+    : m_d(new Private(frameCachePath, compression))
 {
 }
 
@@ -244,14 +249,10 @@ void KisFrameCacheStore::saveFrame(int frameId, KisOpenGLUpdateInfoSP info, cons
 
 KisOpenGLUpdateInfoSP KisFrameCacheStore::loadFrame(int frameId, const KisOpenGLUpdateInfoBuilder &builder)
 {
-    KisOpenGLUpdateInfoSP info = new KisOpenGLUpdateInfo();
-    KIS_SAFE_ASSERT_RECOVER_RETURN_VALUE(m_d->savedFrames.contains(frameId), info);
+    KIS_SAFE_ASSERT_RECOVER_RETURN_VALUE(m_d->savedFrames.contains(frameId), new KisOpenGLUpdateInfo());
 
     FrameInfoSP frameInfo = m_d->savedFrames[frameId];
 
-    info->assignDirtyImageRect(frameInfo->dirtyImageRect());
-    info->assignLevelOfDetail(frameInfo->levelOfDetail());
-
     KisFrameDataSerializer::Frame frame;
 
     switch (frameInfo->type()) {
@@ -295,25 +296,43 @@ KisOpenGLUpdateInfoSP KisFrameCacheStore::loadFrame(int frameId, const KisOpenGL
     }
     }
 
+    return frameToUpdateInfo(frame,
+                             frameInfo->dirtyImageRect(),
+                             frameInfo->imageBounds(),
+                             frameInfo->levelOfDetail(),
+                             builder);
+}
+
+KisOpenGLUpdateInfoSP KisFrameCacheStore::frameToUpdateInfo(KisFrameDataSerializer::Frame &frame,
+                                                             const QRect &dirtyImageRect,
+                                                             const QRect &imageBounds,
+                                                             int levelOfDetail,
+                                                             const KisOpenGLUpdateInfoBuilder &builder)
+{
+    KisOpenGLUpdateInfoSP info = new KisOpenGLUpdateInfo();
+
+    info->assignDirtyImageRect(dirtyImageRect);
+    info->assignLevelOfDetail(levelOfDetail);
+
     for (auto it = frame.frameTiles.begin(); it != frame.frameTiles.end(); ++it) {
         KisFrameDataSerializer::FrameTile &tile = *it;
 
         QRect patchRect = tile.rect;
 
-        if (frameInfo->levelOfDetail()) {
-            patchRect = KisLodTransform::upscaledRect(patchRect, frameInfo->levelOfDetail());
+        if (levelOfDetail) {
+            patchRect = KisLodTransform::upscaledRect(patchRect, levelOfDetail);
         }
 
         const QRect fullSizeTileRect =
             builder.calculatePhysicalTileRect(tile.col, tile.row,
-                                              frameInfo->imageBounds(),
-                                              frameInfo->levelOfDetail());
+                                              imageBounds,
+                                              levelOfDetail);
 
         KisTextureTileUpdateInfoSP tileInfo(
             new KisTextureTileUpdateInfo(tile.col, tile.row,
                                          fullSizeTileRect, patchRect,
-                                         frameInfo->imageBounds(),
-                                         frameInfo->levelOfDetail(),
+                                         imageBounds,
+                                         levelOfDetail,
                                          builder.textureInfoPool()));
 
         tileInfo->putPixelData(std::move(tile.data), builder.destinationColorSpace());
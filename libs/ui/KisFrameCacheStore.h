@@ -11,6 +11,7 @@
 #include "kis_types.h"
 
 #include "opengl/kis_texture_tile_info_pool.h"
+#include "KisFrameDataSerializer.h"
 
 class KisOpenGLUpdateInfoBuilder;
 
@@ -40,6 +41,7 @@ class KRITAUI_EXPORT KisFrameCacheStore
 public:
     KisFrameCacheStore();
     KisFrameCacheStore(const QString &frameCachePath);
+    KisFrameCacheStore(const QString &frameCachePath, KisFrameDataSerializer::Compression compression);
 
     ~KisFrameCacheStore();
 
@@ -55,6 +57,16 @@ public:
     int frameLevelOfDetail(int frameId) const;
     QRect frameDirtyRect(int frameId) const;
 
+    /**
+     * Converts the serialized \p frame back into the texture tiles. The
+     * pixel data is moved out of \p frame.
+     */
+    static KisOpenGLUpdateInfoSP frameToUpdateInfo(KisFrameDataSerializer::Frame &frame,
+                                                   const QRect &dirtyImageRect,
+                                                   const QRect &imageBounds,
+                                                   int levelOfDetail,
+                                                   const KisOpenGLUpdateInfoBuilder &builder);
+
 private:
     struct Private;
     const QScopedPointer<Private> m_d;
@@ -12,8 +12,8 @@
 
 struct KisFrameCacheSwapper::Private
 {
-    Private(const KisOpenGLUpdateInfoBuilder &_builder, const QString &frameCachePath)
-        : frameStore(frameCachePath),
+    Private(const KisOpenGLUpdateInfoBuilder &_builder, const QString &frameCachePath, KisFrameDataSerializer::Compression compression)
+        : frameStore(frameCachePath, compression),
           builder(_builder)
     {
     }
@@ -28,7 +28,12 @@ KisFrameCacheSwapper::KisFrameCacheSwapper(const KisOpenGLUpdateInfoBuilder &bui
 }
 
 KisFrameCacheSwapper::KisFrameCacheSwapper(const KisOpenGLUpdateInfoBuilder &builder, const QString &frameCachePath)
-    : m_d(new Private(builder, frameCachePath))
+    : KisFrameCacheSwapper(builder, frameCachePath, KisFrameDataSerializer::CompressionLzf)
+{
+}
+
+KisFrameCacheSwapper::KisFrameCacheSwapper(const KisOpenGLUpdateInfoBuilder &builder, const QString &frameCachePath, KisFrameDataSerializer::Compression compression)
+    : m_d(new Private(builder, frameCachePath, compression))
 {
 }
 
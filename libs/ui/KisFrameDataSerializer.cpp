@@ -5,17 +5,56 @@
  */
 #include "KisFrameDataSerializer.h"
 
+#include <atomic>
 #include <cstring>
 
 #include <QTemporaryDir>
-#include <QElapsedTimer>
+#include <QDataStream>
 
 #include "tiles3/swap/kis_lzf_compression.h"
+#include "KisConcurrentRangeUtils.h"
+
+namespace {
+
+/**
+ * The values of TileRaw and TileLzf coincide with the boolean
+ * "isCompressed" flag used by the older versions of the format
+ */
+enum TileStorage : quint8 {
+    TileRaw = 0,
+    TileLzf = 1,
+    TileZero = 2
+};
+
+struct EncodedTile
+{
+    TileStorage storage = TileRaw;
+    QByteArray data;
+};
+
+bool isZeroData(const quint8 *data, int size)
+{
+    const int numQWords = size / 8;
+    const quint64 *qwordPtr = reinterpret_cast<const quint64*>(data);
+
+    for (int i = 0; i < numQWords; i++) {
+        if (qwordPtr[i]) return false;
+    }
+
+    for (int i = numQWords * 8; i < size; i++) {
+        if (data[i]) return false;
+    }
+
+    return true;
+}
+
+}
 
 struct KRITAUI_NO_EXPORT KisFrameDataSerializer::Private
 {
-    Private(const QString &frameCachePath)
-        : framesDir(
+    Private(const QString &frameCachePath, Compression _compression)
+        : compression(_compression),
+          framesDir(
               (!frameCachePath.isEmpty() && QTemporaryDir(frameCachePath + "/KritaFrameCacheXXXXXX").isValid()
                ? frameCachePath
                : QDir::tempPath())
@@ -47,18 +86,10 @@ struct KRITAUI_NO_EXPORT KisFrameDataSerializer::Private
         return nextFrameId++;
     }
 
-    quint8* getCompressionBuffer(int size) {
-        if (compressionBuffer.size() < size) {
-            compressionBuffer.resize(size);
-        }
-        return reinterpret_cast<quint8*>(compressionBuffer.data());
-    }
-
+    Compression compression = CompressionLzf;
     QTemporaryDir framesDir;
     QDir framesDirObject;
     int nextFrameId = 0;
-
-    QByteArray compressionBuffer;
 };
 
 KisFrameDataSerializer::KisFrameDataSerializer()
@@ -67,7 +98,12 @@ KisFrameDataSerializer::KisFrameDataSerializer()
 }
 
 KisFrameDataSerializer::KisFrameDataSerializer(const QString &frameCachePath)
-    : m_d(new Private(frameCachePath))
+    : KisFrameDataSerializer(frameCachePath, CompressionLzf)
+{
+}
+
+KisFrameDataSerializer::KisFrameDataSerializer(const QString &frameCachePath, Compression compression)
+    : m_d(new Private(frameCachePath, compression))
 {
 }
 
@@ -75,10 +111,13 @@ KisFrameDataSerializer::~KisFrameDataSerializer()
 {
 }
 
-int KisFrameDataSerializer::saveFrame(const KisFrameDataSerializer::Frame &frame)
+KisFrameDataSerializer::Compression KisFrameDataSerializer::compression() const
 {
-    KisLzfCompression compression;
+    return m_d->compression;
+}
 
+int KisFrameDataSerializer::saveFrame(const KisFrameDataSerializer::Frame &frame)
+{
     const int frameId = m_d->generateFrameId();
 
     const QString frameSubfolder = m_d->subfolderNameForFrame(frameId);
@@ -101,74 +140,119 @@ int KisFrameDataSerializer::saveFrame(const KisFrameDataSerializer::Frame &frame
 
     QDataStream stream(&file);
     stream << frameId;
-    stream << frame.pixelSize;
+    writeFrame(stream, frame, m_d->compression);
 
-    stream << int(frame.frameTiles.size());
+    file.close();
 
-    for (int i = 0; i < int(frame.frameTiles.size()); i++) {
-        const FrameTile &tile = frame.frameTiles[i];
+    return frameId;
+}
 
-        stream << tile.col;
-        stream << tile.row;
-        stream << tile.rect;
+KisFrameDataSerializer::Frame KisFrameDataSerializer::loadFrame(int frameId, KisTextureTileInfoPoolSP pool)
+{
+    int loadedFrameId = -1;
 
-        const int frameByteSize = frame.pixelSize * tile.rect.width() * tile.rect.height();
-        const int maxBufferSize = compression.outputBufferSize(frameByteSize);
-        quint8 *buffer = m_d->getCompressionBuffer(maxBufferSize);
+    const QString framePath = m_d->filePathForFrame(frameId);
 
-        const int compressedSize =
-            compression.compress(tile.data.data(), frameByteSize, buffer, maxBufferSize);
+    QFile file(framePath);
+    KIS_SAFE_ASSERT_RECOVER_NOOP(file.exists());
+    if (!file.open(QFile::ReadOnly)) return KisFrameDataSerializer::Frame();
 
-        //ENTER_FUNCTION() << ppVar(compressedSize) << ppVar(frameByteSize);
+    QDataStream stream(&file);
 
-        const bool isCompressed = compressedSize < frameByteSize;
-        stream << isCompressed;
+    stream >> loadedFrameId;
+    KIS_SAFE_ASSERT_RECOVER_RETURN_VALUE(loadedFrameId == frameId, KisFrameDataSerializer::Frame());
 
-        if (isCompressed) {
-            stream << compressedSize;
-            stream.writeRawData((char*)buffer, compressedSize);
-        } else {
-            stream << frameByteSize;
-            stream.writeRawData((char*)tile.data.data(), frameByteSize);
-        }
-    }
+    KisFrameDataSerializer::Frame frame = readFrame(stream, pool);
 
     file.close();
 
-    return frameId;
+    return frame;
 }
 
-KisFrameDataSerializer::Frame KisFrameDataSerializer::loadFrame(int frameId, KisTextureTileInfoPoolSP pool)
+void KisFrameDataSerializer::writeFrame(QDataStream &stream, const KisFrameDataSerializer::Frame &frame, Compression compression)
 {
-    KisLzfCompression compression;
+    const int numTiles = int(frame.frameTiles.size());
+    std::vector<EncodedTile> encodedTiles(numTiles);
 
-    QElapsedTimer loadingTime;
-    loadingTime.start();
+    KritaUtils::processRangeConcurrently(numTiles, 1,
+        [&] (int begin, int end) {
+            KisLzfCompression lzf;
 
-    int loadedFrameId = -1;
-    KisFrameDataSerializer::Frame frame;
+            for (int i = begin; i < end; i++) {
+                const FrameTile &tile = frame.frameTiles[i];
+                EncodedTile &encoded = encodedTiles[i];
 
-    qint64 compressionTime = 0;
+                const int frameByteSize = frame.pixelSize * tile.rect.width() * tile.rect.height();
 
-    const QString framePath = m_d->filePathForFrame(frameId);
+                if (isZeroData(tile.data.data(), frameByteSize)) {
+                    encoded.storage = TileZero;
+                    continue;
+                }
 
-    QFile file(framePath);
-    KIS_SAFE_ASSERT_RECOVER_NOOP(file.exists());
-    if (!file.open(QFile::ReadOnly)) return frame;
+                if (compression == CompressionNone) continue;
 
-    QDataStream stream(&file);
+                const int maxBufferSize = lzf.outputBufferSize(frameByteSize);
+                encoded.data.resize(maxBufferSize);
+
+                const int compressedSize =
+                    lzf.compress(tile.data.data(), frameByteSize,
+                                 reinterpret_cast<quint8*>(encoded.data.data()), maxBufferSize);
+
+                if (compressedSize > 0 && compressedSize < frameByteSize) {
+                    encoded.storage = TileLzf;
+                    encoded.data.resize(compressedSize);
+                } else {
+                    encoded.data.clear();
+                }
+            }
+        });
 
+    stream << frame.pixelSize;
+    stream << numTiles;
+
+    for (int i = 0; i < numTiles; i++) {
+        const FrameTile &tile = frame.frameTiles[i];
+        const EncodedTile &encoded = encodedTiles[i];
+
+        stream << tile.col;
+        stream << tile.row;
+        stream << tile.rect;
+        stream << quint8(encoded.storage);
+
+        if (encoded.storage == TileZero) {
+            stream << 0;
+        } else if (encoded.storage == TileLzf) {
+            stream << encoded.data.size();
+            stream.writeRawData(encoded.data.constData(), encoded.data.size());
+        } else {
+            const int frameByteSize = frame.pixelSize * tile.rect.width() * tile.rect.height();
+            stream << frameByteSize;
+            stream.writeRawData((char*)tile.data.data(), frameByteSize);
+        }
+    }
+}
+
+KisFrameDataSerializer::Frame KisFrameDataSerializer::readFrame(QDataStream &stream, KisTextureTileInfoPoolSP pool)
+{
+    KisFrameDataSerializer::Frame frame;
     int numTiles = 0;
 
-    stream >> loadedFrameId;
     stream >> frame.pixelSize;
     stream >> numTiles;
-    KIS_SAFE_ASSERT_RECOVER_RETURN_VALUE(loadedFrameId == frameId, KisFrameDataSerializer::Frame());
 
+    KIS_SAFE_ASSERT_RECOVER_RETURN_VALUE(frame.pixelSize > 0 && numTiles >= 0, KisFrameDataSerializer::Frame());
 
+    std::vector<EncodedTile> encodedTiles(numTiles);
+    frame.frameTiles.reserve(numTiles);
 
+    /**
+     * The file is read sequentially, the decompression of
+     * the tiles happens afterwards in multiple threads
+     */
     for (int i = 0; i < numTiles; i++) {
         FrameTile tile(pool);
+        EncodedTile &encoded = encodedTiles[i];
+
         stream >> tile.col;
         stream >> tile.row;
         stream >> tile.rect;
@@ -177,44 +261,62 @@ KisFrameDataSerializer::Frame KisFrameDataSerializer::loadFrame(int frameId, Kis
         KIS_SAFE_ASSERT_RECOVER_RETURN_VALUE(frameByteSize <= pool->chunkSize(frame.pixelSize),
                                              KisFrameDataSerializer::Frame());
 
-        bool isCompressed = false;
+        quint8 storage = TileRaw;
         int inputSize = -1;
 
-        stream >> isCompressed;
+        stream >> storage;
         stream >> inputSize;
 
-        if (isCompressed) {
-            const int maxBufferSize = compression.outputBufferSize(inputSize);
-            quint8 *buffer = m_d->getCompressionBuffer(maxBufferSize);
-            stream.readRawData((char*)buffer, inputSize);
-
-            tile.data.allocate(frame.pixelSize);
-
-            QElapsedTimer compTime;
-            compTime.start();
-
-            const int decompressedSize =
-                compression.decompress(buffer, inputSize, tile.data.data(), frameByteSize);
+        KIS_SAFE_ASSERT_RECOVER_RETURN_VALUE(storage <= TileZero && inputSize >= 0,
+                                             KisFrameDataSerializer::Frame());
 
-            compressionTime += compTime.nsecsElapsed();
+        encoded.storage = TileStorage(storage);
+        tile.data.allocate(frame.pixelSize);
 
-            KIS_SAFE_ASSERT_RECOVER_RETURN_VALUE(frameByteSize == decompressedSize,
-                                                 KisFrameDataSerializer::Frame());
-
-        } else {
+        if (encoded.storage == TileLzf) {
+            encoded.data.resize(inputSize);
+            if (stream.readRawData(encoded.data.data(), inputSize) != inputSize) {
+                return KisFrameDataSerializer::Frame();
+            }
+        } else if (encoded.storage == TileRaw) {
             KIS_SAFE_ASSERT_RECOVER_RETURN_VALUE(frameByteSize == inputSize,
                                                  KisFrameDataSerializer::Frame());
 
-            tile.data.allocate(frame.pixelSize);
-            stream.readRawData((char*)tile.data.data(), inputSize);
+            if (stream.readRawData((char*)tile.data.data(), inputSize) != inputSize) {
+                return KisFrameDataSerializer::Frame();
+            }
         }
 
         frame.frameTiles.push_back(std::move(tile));
     }
 
-    Q_UNUSED(compressionTime);
+    std::atomic<bool> hasFailed(false);
 
-    file.close();
+    KritaUtils::processRangeConcurrently(numTiles, 1,
+        [&] (int begin, int end) {
+            KisLzfCompression lzf;
+
+            for (int i = begin; i < end; i++) {
+                FrameTile &tile = frame.frameTiles[i];
+                const EncodedTile &encoded = encodedTiles[i];
+
+                const int frameByteSize = frame.pixelSize * tile.rect.width() * tile.rect.height();
+
+                if (encoded.storage == TileZero) {
+                    memset(tile.data.data(), 0, frameByteSize);
+                } else if (encoded.storage == TileLzf) {
+                    const int decompressedSize =
+                        lzf.decompress(reinterpret_cast<const quint8*>(encoded.data.constData()),
+                                       encoded.data.size(), tile.data.data(), frameByteSize);
+
+                    if (decompressedSize != frameByteSize) {
+                        hasFailed = true;
+                    }
+                }
+            }
+        });
+
+    KIS_SAFE_ASSERT_RECOVER_RETURN_VALUE(!hasFailed, KisFrameDataSerializer::Frame());
 
     return frame;
 }
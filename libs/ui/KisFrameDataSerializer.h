@@ -17,6 +17,7 @@
 #include <boost/optional.hpp>
 
 class QString;
+class QDataStream;
 
 
 /**
@@ -28,6 +29,10 @@ class QString;
  *    but a preprocessed pixel differences)
  *
  * 2) Compress this data and save it on disk
+ *
+ * The tiles of a frame are compressed and decompressed concurrently.
+ * The tiles that consist of zeros only (which is the usual case for the
+ * unchanged areas of the difference frames) are stored without any data.
  */
 
 class KRITAUI_EXPORT KisFrameDataSerializer
@@ -94,11 +99,19 @@ public:
         }
     };
 
+    enum Compression {
+        CompressionLzf = 0,
+        CompressionNone ///< the fastest option, but the frames take more space on disk
+    };
+
 public:
     KisFrameDataSerializer();
     KisFrameDataSerializer(const QString &frameCachePath);
+    KisFrameDataSerializer(const QString &frameCachePath, Compression compression);
     ~KisFrameDataSerializer();
 
+    Compression compression() const;
+
     int saveFrame(const Frame &frame);
     Frame loadFrame(int frameId, KisTextureTileInfoPoolSP pool);
 
@@ -111,6 +124,19 @@ public:
     static bool subtractFrames(Frame &dst, const Frame &src);
     static void addFrames(Frame &dst, const Frame &src);
 
+    /**
+     * Writes \p frame into \p stream in the same format as saveFrame()
+     * does. Can be used for storing the frames in custom containers.
+     */
+    static void writeFrame(QDataStream &stream, const Frame &frame, Compression compression);
+
+    /**
+     * Reads a frame written by writeFrame() from \p stream
+     *
+     * \return an invalid frame if the data is corrupted
+     */
+    static Frame readFrame(QDataStream &stream, KisTextureTileInfoPoolSP pool);
+
 private:
     template<template <typename U> class OpPolicy>
     static bool processFrames(KisFrameDataSerializer::Frame &dst, const KisFrameDataSerializer::Frame &src);
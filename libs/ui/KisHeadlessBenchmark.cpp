@@ -0,0 +1,546 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "KisHeadlessBenchmark.h"
+
+#include <algorithm>
+#include <numeric>
+
+#include <QApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QThread>
+#include <QtMath>
+
+#include <KoCanvasResourceProvider.h>
+#include <KoColor.h>
+#include <KoColorSpace.h>
+#include <KoColorSpaceRegistry.h>
+#include <KoCompositeOpRegistry.h>
+#include <KisGlobalResourcesInterface.h>
+#include <KritaVersionWrapper.h>
+
+#include "kis_algebra_2d.h"
+#include "kis_image.h"
+#include "kis_image_config.h"
+#include "kis_layer_utils.h"
+#include "kis_paint_device.h"
+#include "kis_paint_layer.h"
+#include "kis_paintop_preset.h"
+#include "krita_utils.h"
+#include "KisConcurrentRangeUtils.h"
+#include "KisDocument.h"
+#include "kundo2stack.h"
+#include "KisPart.h"
+#include "KisResourceServerProvider.h"
+#include "filter/kis_filter.h"
+#include "filter/kis_filter_configuration.h"
+#include "filter/kis_filter_registry.h"
+#include "KisStrokeRecorder.h"
+#include "KisStrokeReplayer.h"
+
+namespace {
+
+const int defaultIterations = 5;
+const int defaultNumStrokePoints = 200;
+
+qreal percentile(const QVector<qreal> &sortedSamples, qreal p)
+{
+    KIS_SAFE_ASSERT_RECOVER_RETURN_VALUE(!sortedSamples.isEmpty(), 0.0);
+
+    // nearest-rank method
+    const int rank = qCeil(p / 100.0 * sortedSamples.size());
+    return sortedSamples[qBound(0, rank - 1, sortedSamples.size() - 1)];
+}
+
+QJsonObject latencyStatistics(QVector<qreal> samples)
+{
+    QJsonObject result;
+    if (samples.isEmpty()) return result;
+
+    std::sort(samples.begin(), samples.end());
+
+    result["min"] = samples.first();
+    result["mean"] = std::accumulate(samples.begin(), samples.end(), 0.0) / samples.size();
+    result["p50"] = percentile(samples, 50);
+
+    /**
+     * With fewer samples the high percentiles are just the maximum,
+     * so they are reported only when they carry some information
+     */
+    if (samples.size() >= 10) {
+        result["p90"] = percentile(samples, 90);
+    }
+    if (samples.size() >= 100) {
+        result["p99"] = percentile(samples, 99);
+    }
+
+    result["max"] = samples.last();
+
+    return result;
+}
+
+qreal meanSeconds(const QVector<qreal> &samplesMs)
+{
+    if (samplesMs.isEmpty()) return 0.0;
+    return std::accumulate(samplesMs.begin(), samplesMs.end(), 0.0) / samplesMs.size() / 1000.0;
+}
+
+qreal elapsedMs(const QElapsedTimer &timer)
+{
+    return qreal(timer.nsecsElapsed()) / 1000000.0;
+}
+
+QVector<KisPaintInformation> strokePoints(const QJsonObject &strokeSpec, const QRect &bounds)
+{
+    QVector<KisPaintInformation> points;
+
+    const QJsonArray recordedPoints = strokeSpec["points"].toArray();
+
+    if (!recordedPoints.isEmpty()) {
+        qreal time = 0.0;
+
+        Q_FOREACH (const QJsonValue &value, recordedPoints) {
+            const QJsonArray point = value.toArray();
+            if (point.size() < 2) continue;
+
+            time = point.size() > 3 ? point[3].toDouble() : time + 1.0;
+
+            points << KisPaintInformation(QPointF(point[0].toDouble(), point[1].toDouble()),
+                                          point.size() > 2 ? point[2].toDouble() : PRESSURE_DEFAULT,
+                                          0.0, 0.0, 0.0, 0.0, 1.0,
+                                          time, 0.0);
+        }
+    } else {
+        const int numPoints = qMax(2, strokeSpec["numPoints"].toInt(defaultNumStrokePoints));
+        const QRectF rc = KisAlgebra2D::blowRect(QRectF(bounds), -0.1);
+
+        for (int i = 0; i < numPoints; i++) {
+            const qreal t = qreal(i) / (numPoints - 1);
+            const QPointF pos(rc.left() + t * rc.width(),
+                              rc.center().y() + 0.5 * rc.height() * std::sin(t * 4.0 * M_PI));
+
+            points << KisPaintInformation(pos, 0.2 + 0.8 * std::sin(t * M_PI),
+                                          0.0, 0.0, 0.0, 0.0, 1.0,
+                                          i * 8.0, 0.0);
+        }
+    }
+
+    return points;
+}
+
+}
+
+struct KisHeadlessBenchmark::Private
+{
+    QJsonObject specification;
+    QString errorMessage;
+
+    QScopedPointer<KisDocument> document;
+    KisImageSP image;
+    KisPaintLayerSP strokeLayer;
+
+    bool prepareDocument(const QJsonObject &documentSpec);
+    bool synthesizeDocument(const QJsonObject &documentSpec);
+
+    QJsonObject benchmarkMerge(int iterations);
+    QJsonObject benchmarkStroke(const QJsonObject &strokeSpec, int iterations);
+    QJsonObject benchmarkRecording(const QJsonObject &strokeSpec, int iterations);
+    QJsonObject benchmarkFilter(const QString &filterId, int iterations);
+
+    QJsonObject documentInfo() const;
+};
+
+bool KisHeadlessBenchmark::Private::prepareDocument(const QJsonObject &documentSpec)
+{
+    const QString fileName = documentSpec["file"].toString();
+
+    if (!fileName.isEmpty()) {
+        document.reset(KisPart::instance()->createDocument());
+        document->setFileBatchMode(true);
+
+        if (!document->openPath(fileName)) {
+            errorMessage = QString("Could not load %1: %2").arg(fileName).arg(document->errorMessage());
+            return false;
+        }
+
+        qApp->processEvents(); // For vector layers to be updated
+        image = document->image();
+    } else if (!synthesizeDocument(documentSpec)) {
+        return false;
+    }
+
+    KIS_SAFE_ASSERT_RECOVER_RETURN_VALUE(image, false);
+
+    /**
+     * The strokes are painted on a separate layer, which is cleared
+     * after every iteration, so that all the iterations paint on the
+     * same image
+     */
+    strokeLayer = new KisPaintLayer(image, "Benchmark strokes", OPACITY_OPAQUE_U8);
+    image->addNode(strokeLayer, image->root());
+
+    image->refreshGraphAsync();
+    image->waitForDone();
+
+    return true;
+}
+
+bool KisHeadlessBenchmark::Private::synthesizeDocument(const QJsonObject &documentSpec)
+{
+    const int width = documentSpec["width"].toInt(4000);
+    const int height = documentSpec["height"].toInt(3000);
+    const int numLayers = documentSpec["layers"].toInt(10);
+
+    const KoColorSpace *colorSpace =
+        KoColorSpaceRegistry::instance()->colorSpace(documentSpec["colorModel"].toString("RGBA"),
+                                                     documentSpec["colorDepth"].toString("U8"),
+                                                     "");
+    if (!colorSpace) {
+        errorMessage = QString("Unsupported color space: %1/%2")
+            .arg(documentSpec["colorModel"].toString())
+            .arg(documentSpec["colorDepth"].toString());
+        return false;
+    }
+
+    QStringList compositeOps;
+    Q_FOREACH (const QJsonValue &value, documentSpec["compositeOps"].toArray()) {
+        compositeOps << value.toString();
+    }
+    if (compositeOps.isEmpty()) {
+        compositeOps << COMPOSITE_OVER;
+    }
+
+    document.reset(KisPart::instance()->createDocument());
+    document->setFileBatchMode(true);
+
+    image = new KisImage(document->createUndoStore(), width, height, colorSpace, "Benchmark");
+    document->setCurrentImage(image);
+
+    /**
+     * Every layer is filled with a checkerboard of semi-transparent
+     * cells shifted by the layer index, so that the layers overlap
+     * only partially and the merger has to blend real data
+     */
+    const int cellSize = 256;
+
+    for (int i = 0; i < numLayers; i++) {
+        KisPaintLayerSP layer = new KisPaintLayer(image, QString("Layer %1").arg(i + 1), OPACITY_OPAQUE_U8);
+        layer->setCompositeOpId(compositeOps[i % compositeOps.size()]);
+
+        KoColor color(QColor::fromHsv((i * 37) % 360, 200, 220, 180), colorSpace);
+
+        for (int y = 0; y < height; y += cellSize) {
+            for (int x = 0; x < width; x += cellSize) {
+                if ((x / cellSize + y / cellSize + i) % 3 == 0) continue;
+                layer->paintDevice()->fill(QRect(x, y, cellSize, cellSize) & image->bounds(), color);
+            }
+        }
+
+        image->addNode(layer, image->root());
+    }
+
+    return true;
+}
+
+QJsonObject KisHeadlessBenchmark::Private::benchmarkMerge(int iterations)
+{
+    QVector<qreal> samples;
+    QElapsedTimer timer;
+
+    for (int i = 0; i < iterations; i++) {
+        timer.start();
+        image->refreshGraphAsync();
+        image->waitForDone();
+        samples << elapsedMs(timer);
+    }
+
+    const qreal megapixels = qreal(image->width()) * image->height() / 1000000.0;
+
+    QJsonObject result;
+    result["stage"] = "merge";
+    result["name"] = "full refresh";
+    result["latency_ms"] = latencyStatistics(samples);
+    result["throughput"] = megapixels / meanSeconds(samples);
+    result["throughput_unit"] = "Mpx/s";
+    return result;
+}
+
+QJsonObject KisHeadlessBenchmark::Private::benchmarkStroke(const QJsonObject &strokeSpec, int iterations)
+{
+    const QString presetName = strokeSpec["preset"].toString();
+
+    QJsonObject result;
+    result["stage"] = "stroke";
+    result["name"] = presetName;
+
+    KisPaintOpPresetSP preset =
+        KisResourceServerProvider::instance()->paintOpPresetServer()->resourceByName(presetName);
+
+    if (!preset) {
+        result["error"] = QString("Preset not found: %1").arg(presetName);
+        return result;
+    }
+
+    const QVector<KisPaintInformation> points = strokePoints(strokeSpec, image->bounds());
+    if (points.size() < 2) {
+        result["error"] = QString("The stroke has less than two points");
+        return result;
+    }
+
+    KoCanvasResourceProvider resourceManager;
+    resourceManager.setForegroundColor(KoColor(Qt::black, image->colorSpace()));
+    resourceManager.setBackgroundColor(KoColor(Qt::white, image->colorSpace()));
+
+    /**
+     * The stroke is painted by KisStrokeReplayer, so that the latencies
+     * of the individual jobs are measured the same way as for the
+     * recorded strokes
+     */
+    KisRecordedStroke stroke;
+    stroke.presetName = presetName;
+    stroke.nodeName = strokeLayer->name();
+    stroke.nodeUuid = strokeLayer->uuid();
+    stroke.strokeInfos << KisRecordedStroke::StartDistance();
+
+    for (int j = 1; j < points.size(); j++) {
+        stroke.addLine(0, points[j].currentTime(), points[j - 1], points[j]);
+    }
+
+    KisStrokeReplayer replayer(image, strokeLayer, &resourceManager);
+
+    QVector<qreal> samples;
+    QVector<qreal> jobLatencies;
+    QVector<qreal> updateLatencies;
+
+    for (int i = 0; i < iterations; i++) {
+        const KisStrokeReplayer::Statistics stats =
+            replayer.replay({stroke}, KisStrokeReplayer::MaximumSpeed);
+
+        samples << stats.totalTime;
+        jobLatencies << stats.jobLatencies;
+        updateLatencies << stats.updateLatencies;
+
+        strokeLayer->paintDevice()->clear();
+        strokeLayer->setDirty();
+        image->waitForDone();
+    }
+
+    result["points"] = points.size();
+    result["latency_ms"] = latencyStatistics(samples);
+    result["job_latency_ms"] = latencyStatistics(jobLatencies);
+    result["update_latency_ms"] = latencyStatistics(updateLatencies);
+    result["throughput"] = points.size() / meanSeconds(samples);
+    result["throughput_unit"] = "points/s";
+    return result;
+}
+
+QJsonObject KisHeadlessBenchmark::Private::benchmarkRecording(const QJsonObject &strokeSpec, int iterations)
+{
+    const QString fileName = strokeSpec["recording"].toString();
+    const bool recordedSpeed = strokeSpec["speed"].toString() == "recorded";
+
+    QJsonObject result;
+    result["stage"] = "recording";
+    result["name"] = fileName;
+    result["speed"] = recordedSpeed ? "recorded" : "maximum";
+
+    QVector<KisRecordedStroke> strokes;
+    if (!KisStrokeRecorder::loadRecording(fileName, &strokes)) {
+        result["error"] = QString("Could not load the stroke recording: %1").arg(fileName);
+        return result;
+    }
+
+    KoCanvasResourceProvider resourceManager;
+    resourceManager.setForegroundColor(KoColor(Qt::black, image->colorSpace()));
+    resourceManager.setBackgroundColor(KoColor(Qt::white, image->colorSpace()));
+
+    KisStrokeReplayer replayer(image, strokeLayer, &resourceManager);
+
+    QVector<qreal> samples;
+    QVector<qreal> jobLatencies;
+    QVector<qreal> updateLatencies;
+    KisStrokeReplayer::Statistics stats;
+
+    for (int i = 0; i < iterations; i++) {
+        stats = replayer.replay(strokes,
+                                recordedSpeed ?
+                                    KisStrokeReplayer::RecordedSpeed :
+                                    KisStrokeReplayer::MaximumSpeed);
+
+        samples << stats.totalTime;
+        jobLatencies << stats.jobLatencies;
+        updateLatencies << stats.updateLatencies;
+
+        /**
+         * The recorded strokes may be painted on the layers of the
+         * loaded document, so the whole image is reverted
+         */
+        while (document->undoStack()->canUndo()) {
+            document->undoStack()->undo();
+        }
+        strokeLayer->paintDevice()->clear();
+        strokeLayer->setDirty();
+        image->waitForDone();
+    }
+
+    result["strokes"] = stats.numStrokes;
+    result["skippedStrokes"] = stats.numSkippedStrokes;
+    result["jobs"] = stats.numJobs;
+    result["latency_ms"] = latencyStatistics(samples);
+    result["job_latency_ms"] = latencyStatistics(jobLatencies);
+    result["update_latency_ms"] = latencyStatistics(updateLatencies);
+    result["throughput"] = stats.numJobs / meanSeconds(samples);
+    result["throughput_unit"] = "jobs/s";
+    return result;
+}
+
+QJsonObject KisHeadlessBenchmark::Private::benchmarkFilter(const QString &filterId, int iterations)
+{
+    QJsonObject result;
+    result["stage"] = "filter";
+    result["name"] = filterId;
+
+    KisFilterSP filter = KisFilterRegistry::instance()->value(filterId);
+    if (!filter) {
+        result["error"] = QString("Filter not found: %1").arg(filterId);
+        return result;
+    }
+
+    KisFilterConfigurationSP config =
+        filter->defaultConfiguration(KisGlobalResourcesInterface::instance());
+
+    KisPaintDeviceSP src = new KisPaintDevice(*image->projection());
+    const QRect bounds = image->bounds();
+    const QVector<QRect> patches = KritaUtils::splitRectIntoPatches(bounds, KritaUtils::optimalPatchSize());
+
+    QVector<qreal> samples;
+    QElapsedTimer timer;
+
+    for (int i = 0; i < iterations; i++) {
+        KisPaintDeviceSP dst = new KisPaintDevice(src->colorSpace());
+
+        timer.start();
+
+        // the patches are processed concurrently, like KisFilterStrokeStrategy does
+        KritaUtils::processRangeConcurrently(patches.size(), 1,
+            [&] (int begin, int end) {
+                for (int j = begin; j < end; j++) {
+                    filter->process(src, dst, KisSelectionSP(), patches[j], config);
+                }
+            });
+
+        samples << elapsedMs(timer);
+    }
+
+    const qreal megapixels = qreal(bounds.width()) * bounds.height() / 1000000.0;
+
+    result["latency_ms"] = latencyStatistics(samples);
+    result["throughput"] = megapixels / meanSeconds(samples);
+    result["throughput_unit"] = "Mpx/s";
+    return result;
+}
+
+QJsonObject KisHeadlessBenchmark::Private::documentInfo() const
+{
+    int numLayers = 0;
+    KisLayerUtils::recursiveApplyNodes(image->root(),
+        [&numLayers] (KisNodeSP node) {
+            if (node->inherits("KisLayer") && node->parent()) {
+                numLayers++;
+            }
+        });
+
+    QJsonObject result;
+    result["width"] = image->width();
+    result["height"] = image->height();
+    result["layers"] = numLayers;
+    result["colorModel"] = image->colorSpace()->colorModelId().id();
+    result["colorDepth"] = image->colorSpace()->colorDepthId().id();
+    return result;
+}
+
+KisHeadlessBenchmark::KisHeadlessBenchmark()
+    : m_d(new Private)
+{
+}
+
+KisHeadlessBenchmark::~KisHeadlessBenchmark()
+{
+    if (m_d->image) {
+        m_d->image->waitForDone();
+    }
+}
+
+bool KisHeadlessBenchmark::loadSpecification(const QString &filePath)
+{
+    QFile file(filePath);
+    if (!file.open(QFile::ReadOnly)) {
+        m_d->errorMessage = QString("Could not open %1").arg(filePath);
+        return false;
+    }
+
+    QJsonParseError error;
+    const QJsonDocument doc = QJsonDocument::fromJson(file.readAll(), &error);
+
+    if (error.error != QJsonParseError::NoError || !doc.isObject()) {
+        m_d->errorMessage = QString("Could not parse %1: %2").arg(filePath).arg(error.errorString());
+        return false;
+    }
+
+    m_d->specification = doc.object();
+    return true;
+}
+
+void KisHeadlessBenchmark::setSpecification(const QJsonObject &specification)
+{
+    m_d->specification = specification;
+}
+
+QJsonObject KisHeadlessBenchmark::run()
+{
+    if (!m_d->prepareDocument(m_d->specification["document"].toObject())) {
+        return QJsonObject();
+    }
+
+    const int iterations = qMax(1, m_d->specification["iterations"].toInt(defaultIterations));
+
+    QJsonArray benchmarks;
+
+    benchmarks.append(m_d->benchmarkMerge(iterations));
+
+    Q_FOREACH (const QJsonValue &value, m_d->specification["strokes"].toArray()) {
+        const QJsonObject strokeSpec = value.toObject();
+
+        if (strokeSpec.contains("recording")) {
+            benchmarks.append(m_d->benchmarkRecording(strokeSpec, iterations));
+        } else {
+            benchmarks.append(m_d->benchmarkStroke(strokeSpec, iterations));
+        }
+    }
+
+    Q_FOREACH (const QJsonValue &value, m_d->specification["filters"].toArray()) {
+        benchmarks.append(m_d->benchmarkFilter(value.toString(), iterations));
+    }
+
+    QJsonObject result;
+    result["version"] = KritaVersionWrapper::versionString(true);
+    result["idealThreadCount"] = QThread::idealThreadCount();
+    result["maxNumberOfThreads"] = KisImageConfig(true).maxNumberOfThreads();
+    result["iterations"] = iterations;
+    result["document"] = m_d->documentInfo();
+    result["benchmarks"] = benchmarks;
+
+    return result;
+}
+
+QString KisHeadlessBenchmark::errorMessage() const
+{
+    return m_d->errorMessage;
+}
@@ -0,0 +1,102 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KISHEADLESSBENCHMARK_H
+#define KISHEADLESSBENCHMARK_H
+
+#include "kritaui_export.h"
+
+#include <QScopedPointer>
+
+class QJsonObject;
+class QString;
+
+/**
+ * KisHeadlessBenchmark measures the throughput of the image pipeline
+ * without any GUI. It is run with `krita --benchmark spec.json` and
+ * is intended for catching performance regressions on the nightly
+ * builds.
+ *
+ * The benchmark is described by a JSON specification:
+ *
+ * \code{.json}
+ * {
+ *     "iterations": 5,
+ *     "document": {
+ *         "file": "/path/to/document.kra"
+ *     },
+ *     "strokes": [
+ *         { "preset": "b) Basic-5 Size Opacity",
+ *           "points": [[100, 100, 0.5], [120, 110, 0.7, 16]] },
+ *         { "preset": "c) Pencil-2", "numPoints": 500 },
+ *         { "recording": "/path/to/krita-strokes.rec", "speed": "recorded" }
+ *     ],
+ *     "filters": [ "blur", "unsharp" ]
+ * }
+ * \endcode
+ *
+ * Instead of "file", the document may be synthesized with the keys
+ * "width", "height", "layers", "colorModel", "colorDepth" and
+ * "compositeOps", the latter being the list of the composite op ids
+ * assigned to the layers in turn.
+ *
+ * Every point of a stroke is `[x, y, pressure, time]`, where pressure
+ * and time (in milliseconds) are optional. When a stroke has no points,
+ * a wavy stroke of "numPoints" points crossing the image is generated.
+ *
+ * A stroke with "recording" replays all the strokes recorded by
+ * KisStrokeRecorder with KisStrokeReplayer, either at the "recorded"
+ * or at the "maximum" speed (default). The results of all the strokes
+ * also contain the latencies of the individual jobs and the updates.
+ *
+ * The benchmark runs the following stages, every stage is repeated
+ * "iterations" times:
+ *
+ * - "merge": full regeneration of the image projection
+ * - "stroke": every stroke is painted on a separate layer through the
+ *   strokes framework, the latency includes merging of the stroke
+ * - "recording": the recorded strokes are replayed on the layers they
+ *   were painted on, the image is reverted after every iteration
+ * - "filter": every filter is applied with its default configuration
+ *   to a copy of the projection
+ *
+ * The result is a JSON object with the latency percentiles (in
+ * milliseconds) and the throughput of every stage. The 90th and 99th
+ * percentiles are reported only for at least 10 and 100 samples.
+ */
+class KRITAUI_EXPORT KisHeadlessBenchmark
+{
+public:
+    KisHeadlessBenchmark();
+    ~KisHeadlessBenchmark();
+
+    /**
+     * Loads the specification of the benchmark from \p filePath
+     *
+     * \return false if the file cannot be read or parsed,
+     *         see errorMessage() for details
+     */
+    bool loadSpecification(const QString &filePath);
+
+    void setSpecification(const QJsonObject &specification);
+
+    /**
+     * Runs the benchmark. Must be called from the GUI thread after
+     * the resources and the plugins are loaded.
+     *
+     * \return the results of all the stages or an empty object
+     *         if the document couldn't be prepared
+     */
+    QJsonObject run();
+
+    QString errorMessage() const;
+
+private:
+    struct Private;
+    const QScopedPointer<Private> m_d;
+};
+
+#endif // KISHEADLESSBENCHMARK_H
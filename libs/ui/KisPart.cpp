@@ -38,6 +38,10 @@
 #include <QMenu>
 #include <QScopedPointer>
 #include <QMap>
+#include <QDateTime>
+#include <QFile>
+#include <QTextStream>
+#include <QTimer>
 
 #include <QMenuBar>
 #include <klocalizedstring.h>
@@ -56,6 +60,7 @@
 
 #include <kis_group_layer.h>
 #include "kis_config.h"
+#include "kis_config_notifier.h"
 #include "kis_shape_controller.h"
 #include "KisResourceServerProvider.h"
 #include "kis_animation_cache_populator.h"
@@ -67,6 +72,9 @@
 #include "kis_color_manager.h"
 
 #include <KisCursorOverrideLock.h>
+#include <KisPerformanceCounters.h>
+#include <KisPerformanceTracer.h>
+#include <KisUsageLogger.h>
 #include "kis_action.h"
 #include "kis_action_registry.h"
 #include "KisSessionResource.h"
@@ -115,6 +123,10 @@ public:
 
     QMap<QUrl, QUrl> pendingAddRecentUrlMap;
 
+    QTimer performanceCountersTimer;
+    bool logPerformanceCounters {false};
+    KisPerformanceCounters::Snapshot lastPerformanceCountersSnapshot;
+
     bool queryCloseDocument(KisDocument *document) {
         Q_FOREACH(auto view, views) {
             if (view && view->isVisible() && view->document() == document) {
@@ -141,6 +153,17 @@ void busyWaitWithFeedback(KisImageSP image)
         dialog.blockIfImageIsBusy();
     }
 }
+
+void savePerformanceTrace()
+{
+    const QString filePath = KisPerformanceTracer::defaultTraceFilePath();
+
+    if (KisPerformanceTracer::instance()->saveChromeTrace(filePath)) {
+        KisUsageLogger::log(QString("Performance trace saved to %1").arg(filePath));
+    } else {
+        warnKrita << "Failed to save performance trace to" << filePath;
+    }
+}
 }
 
 KisPart::KisPart()
@@ -163,6 +186,15 @@ KisPart::KisPart()
             &d->animationCachePopulator, SLOT(slotRequestRegeneration()));
     connect(&d->idleWatcher, SIGNAL(startedIdleMode()),
             KisMemoryStatisticsServer::instance(), SLOT(tryForceUpdateMemoryStatisticsWhileIdle()));
+    connect(KisConfigNotifier::instance(), SIGNAL(configChanged()),
+            this, SLOT(slotConfigChanged()));
+
+    // the history of the performance counters is shown in the docker
+    // and can be requested by the scripts, so it is always collected
+    d->performanceCountersTimer.setInterval(1000);
+    connect(&d->performanceCountersTimer, SIGNAL(timeout()),
+            this, SLOT(slotSamplePerformanceCounters()));
+    d->performanceCountersTimer.start();
 
     // We start by loading the simple QTimer-based anim playback engine first.
     // To save RAM, the MLT-based engine will be loaded later, once the KisImage in question becomes animated.
@@ -170,10 +202,17 @@ KisPart::KisPart()
 
     d->animationCachePopulator.slotRequestRegeneration();
     KisBusyWaitBroker::instance()->setFeedbackCallback(&busyWaitWithFeedback);
+
+    slotConfigChanged();
 }
 
 KisPart::~KisPart()
 {
+    KisPerformanceTracer *tracer = KisPerformanceTracer::instance();
+    if (tracer && tracer->isEnabled()) {
+        savePerformanceTrace();
+    }
+
     while (!d->documents.isEmpty()) {
         delete d->documents.takeFirst();
     }
@@ -189,6 +228,44 @@ KisPart::~KisPart()
     delete d;
 }
 
+void KisPart::slotConfigChanged()
+{
+    KisConfig cfg(true);
+    const bool enableTracing = cfg.enablePerformanceTracing();
+
+    KisPerformanceTracer *tracer = KisPerformanceTracer::instance();
+
+    if (tracer->isEnabled() && !enableTracing) {
+        savePerformanceTrace();
+    }
+
+    tracer->setEnabled(enableTracing);
+
+    d->logPerformanceCounters = cfg.logPerformanceCounters();
+}
+
+void KisPart::slotSamplePerformanceCounters()
+{
+    KisPerformanceCounters *counters = KisPerformanceCounters::instance();
+    if (!counters) return;
+
+    const KisPerformanceCounters::Snapshot snapshot = counters->sample();
+    const KisPerformanceCounters::Snapshot previous = d->lastPerformanceCountersSnapshot;
+    d->lastPerformanceCountersSnapshot = snapshot;
+
+    if (!d->logPerformanceCounters || previous.samples.isEmpty()) return;
+
+    QFile file(KisPerformanceCounters::defaultLogFilePath());
+    if (!file.open(QFile::WriteOnly | QFile::Append | QFile::Text)) {
+        warnKrita << "Failed to open the performance counters log" << file.fileName();
+        return;
+    }
+
+    QTextStream stream(&file);
+    stream << QDateTime::currentDateTime().toString(Qt::ISODate) << " "
+           << KisPerformanceCounters::formatSnapshot(previous, snapshot) << "\n";
+}
+
 void KisPart::updateIdleWatcherConnections()
 {
     QVector<KisImageSP> images;
@@ -203,6 +203,10 @@ private Q_SLOTS:
 
     void updateShortcuts();
 
+    void slotConfigChanged();
+
+    void slotSamplePerformanceCounters();
+
 Q_SIGNALS:
     /**
      * emitted when a new document is opened. (for the idle watcher)
@@ -0,0 +1,329 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+#include "KisPersistentFrameCache.h"
+
+#include <cstring>
+
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QThreadPool>
+
+#include <KoColorSpace.h>
+#include <KoColorProfile.h>
+
+#include "kis_file_layer.h"
+#include "kis_layer_utils.h"
+#include "kis_update_info.h"
+#include "KisAbstractFrameCacheSwapper.h"
+#include "KisFrameCacheStore.h"
+#include "KisFrameDataSerializer.h"
+#include "KisProofingConfiguration.h"
+#include "opengl/KisOpenGLUpdateInfoBuilder.h"
+
+namespace {
+
+const QByteArray cacheFileMagic("KritaFrameCache");
+const qint32 cacheFileVersion = 2;
+
+enum RecordType : quint8 {
+    RecordFull = 0,
+    RecordDiff = 1
+};
+
+struct CacheThreadPool : public QThreadPool
+{
+    CacheThreadPool() {
+        setMaxThreadCount(1);
+    }
+};
+
+Q_GLOBAL_STATIC(CacheThreadPool, s_cacheThreadPool)
+
+}
+
+struct KRITAUI_NO_EXPORT KisPersistentFrameCache::Private
+{
+    Private(const QString &_documentPath,
+            const QStringList &_externalFiles,
+            const KisOpenGLUpdateInfoBuilder &_builder)
+        : documentPath(_documentPath),
+          externalFiles(_externalFiles),
+          builder(_builder)
+    {
+    }
+
+    QString documentPath;
+    QStringList externalFiles;
+    const KisOpenGLUpdateInfoBuilder &builder;
+
+    QString cacheFilePath() const;
+    QString revisionKey() const;
+
+    KisFrameDataSerializer::Frame copyFrameData(KisOpenGLUpdateInfoSP info) const;
+};
+
+QString KisPersistentFrameCache::Private::cacheFilePath() const
+{
+    const QByteArray pathHash =
+        QCryptographicHash::hash(QFileInfo(documentPath).absoluteFilePath().toUtf8(),
+                                 QCryptographicHash::Sha1).toHex();
+
+    return QDir(cacheLocation()).filePath(QString::fromLatin1(pathHash) + ".kfc");
+}
+
+QString KisPersistentFrameCache::Private::revisionKey() const
+{
+    const QFileInfo fileInfo(documentPath);
+    const KoColorSpace *dstColorSpace = builder.destinationColorSpace();
+    const KisProofingConfigurationSP proofingConfig = builder.proofingConfig();
+
+    const bool isProofing =
+        proofingConfig &&
+        proofingConfig->conversionFlags.testFlag(KoColorConversionTransformation::SoftProofing);
+
+    QStringList key;
+    key << QString::number(fileInfo.size())
+        << QString::number(fileInfo.lastModified().toMSecsSinceEpoch())
+        << dstColorSpace->id()
+        << QString::fromLatin1(dstColorSpace->profile() ? dstColorSpace->profile()->uniqueId().toHex() : QByteArray())
+        << QString::number(builder.effectiveTextureSize().width())
+        << QString::number(builder.effectiveTextureSize().height())
+        << QString::number(builder.textureBorder())
+        << (isProofing ? proofingConfig->proofingProfile : QString());
+
+    Q_FOREACH (const QString &path, externalFiles) {
+        const QFileInfo externalFileInfo(path);
+
+        key << externalFileInfo.absoluteFilePath()
+            << QString::number(externalFileInfo.exists() ? externalFileInfo.size() : -1)
+            << QString::number(externalFileInfo.exists() ? externalFileInfo.lastModified().toMSecsSinceEpoch() : -1);
+    }
+
+    return key.join(':');
+}
+
+KisFrameDataSerializer::Frame KisPersistentFrameCache::Private::copyFrameData(KisOpenGLUpdateInfoSP info) const
+{
+    KisFrameDataSerializer::Frame frame;
+
+    Q_FOREACH (KisTextureTileUpdateInfoSP tileInfo, info->tileList) {
+        if (!frame.pixelSize) {
+            frame.pixelSize = tileInfo->pixelSize();
+        }
+
+        KIS_SAFE_ASSERT_RECOVER_RETURN_VALUE(frame.pixelSize == tileInfo->pixelSize(),
+                                             KisFrameDataSerializer::Frame());
+
+        KisFrameDataSerializer::FrameTile tile(builder.textureInfoPool());
+        tile.col = tileInfo->tileCol();
+        tile.row = tileInfo->tileRow();
+        tile.rect = tileInfo->realPatchRect();
+        tile.data.allocate(frame.pixelSize);
+
+        memcpy(tile.data.data(), tileInfo->data(),
+               frame.pixelSize * tile.rect.width() * tile.rect.height());
+
+        frame.frameTiles.push_back(std::move(tile));
+    }
+
+    return frame;
+}
+
+KisPersistentFrameCache::KisPersistentFrameCache(const QString &documentPath,
+                                                 const QStringList &externalFiles,
+                                                 const KisOpenGLUpdateInfoBuilder &builder)
+    : m_d(new Private(documentPath, externalFiles, builder))
+{
+}
+
+KisPersistentFrameCache::~KisPersistentFrameCache()
+{
+}
+
+bool KisPersistentFrameCache::isValid() const
+{
+    return !m_d->documentPath.isEmpty() &&
+        QFileInfo(m_d->documentPath).exists() &&
+        m_d->builder.destinationColorSpace() &&
+        m_d->builder.textureInfoPool() &&
+        !m_d->builder.effectiveTextureSize().isEmpty();
+}
+
+bool KisPersistentFrameCache::loadFrames(const QRect &imageBounds, FrameCallback callback)
+{
+    KIS_SAFE_ASSERT_RECOVER_RETURN_VALUE(isValid(), false);
+
+    QFile file(m_d->cacheFilePath());
+    if (!file.open(QFile::ReadOnly)) return false;
+
+    QDataStream stream(&file);
+
+    QByteArray magic;
+    qint32 version = 0;
+    QString key;
+    QRect storedImageBounds;
+    int numFrames = 0;
+
+    stream >> magic >> version >> key >> storedImageBounds >> numFrames;
+
+    if (stream.status() != QDataStream::Ok ||
+        magic != cacheFileMagic ||
+        version != cacheFileVersion ||
+        key != m_d->revisionKey() ||
+        storedImageBounds != imageBounds) {
+
+        return false;
+    }
+
+    KisFrameDataSerializer::Frame baseFrame;
+
+    for (int i = 0; i < numFrames; i++) {
+        int start = 0;
+        int length = 0;
+        int levelOfDetail = 0;
+        QRect dirtyImageRect;
+        quint8 recordType = RecordFull;
+
+        stream >> start >> length >> levelOfDetail >> dirtyImageRect >> recordType;
+        if (stream.status() != QDataStream::Ok) return false;
+
+        KisFrameDataSerializer::Frame frame =
+            KisFrameDataSerializer::readFrame(stream, m_d->builder.textureInfoPool());
+
+        if (!frame.isValid() || stream.status() != QDataStream::Ok) return false;
+
+        if (recordType == RecordDiff) {
+            if (!baseFrame.isValid()) return false;
+            KisFrameDataSerializer::addFrames(frame, baseFrame);
+        } else {
+            baseFrame = frame.clone();
+        }
+
+        callback(KisFrameCacheStore::frameToUpdateInfo(frame, dirtyImageRect, imageBounds, levelOfDetail, m_d->builder),
+                 start, length);
+    }
+
+    // the modification time orders the files for trimCacheLocation()
+    file.setFileTime(QDateTime::currentDateTimeUtc(), QFileDevice::FileModificationTime);
+
+    return true;
+}
+
+bool KisPersistentFrameCache::saveFrames(const QMap<int, int> &frames, KisAbstractFrameCacheSwapper *swapper, const QRect &imageBounds)
+{
+    KIS_SAFE_ASSERT_RECOVER_RETURN_VALUE(isValid(), false);
+
+    const QString filePath = m_d->cacheFilePath();
+
+    if (frames.isEmpty()) {
+        QFile::remove(filePath);
+        return true;
+    }
+
+    if (!QDir().mkpath(cacheLocation())) return false;
+
+    QSaveFile file(filePath);
+    if (!file.open(QFile::WriteOnly)) return false;
+
+    QDataStream stream(&file);
+
+    stream << cacheFileMagic << cacheFileVersion << m_d->revisionKey() << imageBounds << frames.size();
+
+    KisFrameDataSerializer::Frame baseFrame;
+
+    for (auto it = frames.constBegin(); it != frames.constEnd(); ++it) {
+        KisOpenGLUpdateInfoSP info = swapper->loadFrame(it.key());
+
+        KisFrameDataSerializer::Frame frame;
+        if (info) {
+            frame = m_d->copyFrameData(info);
+        }
+
+        if (!frame.isValid()) {
+            file.cancelWriting();
+            return false;
+        }
+
+        RecordType recordType = RecordFull;
+
+        if (baseFrame.isValid()) {
+            boost::optional<qreal> uniqueness =
+                KisFrameDataSerializer::estimateFrameUniqueness(baseFrame, frame, 0.01);
+
+            if (uniqueness && *uniqueness < 0.5) {
+                KisFrameDataSerializer::subtractFrames(frame, baseFrame);
+                recordType = RecordDiff;
+            }
+        }
+
+        stream << it.key() << it.value() << info->levelOfDetail() << info->dirtyImageRect() << quint8(recordType);
+        KisFrameDataSerializer::writeFrame(stream, frame, KisFrameDataSerializer::CompressionLzf);
+
+        if (recordType == RecordFull) {
+            baseFrame = std::move(frame);
+        }
+    }
+
+    return stream.status() == QDataStream::Ok && file.commit();
+}
+
+QStringList KisPersistentFrameCache::externalFiles(KisNodeSP root)
+{
+    QStringList files;
+
+    KisLayerUtils::recursiveApplyNodes(root,
+        [&files] (KisNodeSP node) {
+            KisFileLayer *fileLayer = dynamic_cast<KisFileLayer*>(node.data());
+            if (fileLayer) {
+                files << fileLayer->path();
+            }
+        });
+
+    files.sort();
+    files.removeDuplicates();
+
+    return files;
+}
+
+QString KisPersistentFrameCache::cacheLocation()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/animation_frames";
+}
+
+void KisPersistentFrameCache::trimCacheLocation(qint64 maxSize)
+{
+    QDir dir(cacheLocation());
+    if (!dir.exists()) return;
+
+    // newest files first
+    const QFileInfoList files = dir.entryInfoList(QStringList() << "*.kfc", QDir::Files, QDir::Time);
+
+    qint64 totalSize = 0;
+
+    Q_FOREACH (const QFileInfo &fileInfo, files) {
+        totalSize += fileInfo.size();
+
+        if (totalSize > maxSize) {
+            QFile::remove(fileInfo.absoluteFilePath());
+        }
+    }
+}
+
+QThreadPool* KisPersistentFrameCache::threadPool()
+{
+    return s_cacheThreadPool;
+}
+
+void KisPersistentFrameCache::waitForPendingJobs()
+{
+    s_cacheThreadPool->waitForDone();
+}
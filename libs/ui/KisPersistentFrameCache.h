@@ -0,0 +1,113 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+#ifndef KISPERSISTENTFRAMECACHE_H
+#define KISPERSISTENTFRAMECACHE_H
+
+#include "kritaui_export.h"
+
+#include <functional>
+
+#include <QMap>
+#include <QScopedPointer>
+#include <QString>
+#include <QStringList>
+
+#include "kis_types.h"
+
+class QRect;
+class QThreadPool;
+class KisOpenGLUpdateInfoBuilder;
+class KisAbstractFrameCacheSwapper;
+
+class KisOpenGLUpdateInfo;
+typedef KisSharedPtr<KisOpenGLUpdateInfo> KisOpenGLUpdateInfoSP;
+
+/**
+ * KisPersistentFrameCache keeps the animation cache of a document on
+ * disk between the sessions.
+ *
+ * Every document has a single cache file, which name is derived from
+ * the path of the document. The file stores the key of the document
+ * revision it has been generated for, which consists of the size and
+ * the modification time of the document file and of all the external
+ * files it depends on (see externalFiles()), and the parameters of
+ * the textures the frames have been converted into. The cache is
+ * discarded when the key doesn't match.
+ *
+ * The frames are stored in the KisFrameDataSerializer format. A frame
+ * that is similar enough to the last full frame is stored as a
+ * difference to it.
+ */
+class KRITAUI_EXPORT KisPersistentFrameCache
+{
+public:
+    /**
+     * Called for every loaded frame, \p length is -1 for
+     * the frames lasting till the end of the animation
+     */
+    using FrameCallback = std::function<void (KisOpenGLUpdateInfoSP info, int start, int length)>;
+
+public:
+    KisPersistentFrameCache(const QString &documentPath,
+                            const QStringList &externalFiles,
+                            const KisOpenGLUpdateInfoBuilder &builder);
+    ~KisPersistentFrameCache();
+
+    /**
+     * \return true if the document file exists and the textures
+     *         of the canvas have already been initialized
+     */
+    bool isValid() const;
+
+    /**
+     * Loads all the frames stored for the current revision of the document.
+     * The file is marked as recently used, see trimCacheLocation().
+     *
+     * \return false if there is no cache for the current revision
+     */
+    bool loadFrames(const QRect &imageBounds, FrameCallback callback);
+
+    /**
+     * Stores \p frames, which are a map of the frames' start times into
+     * their lengths, fetching the data from \p swapper
+     */
+    bool saveFrames(const QMap<int, int> &frames, KisAbstractFrameCacheSwapper *swapper, const QRect &imageBounds);
+
+    /**
+     * \return the paths of the files outside the document the image
+     *         depends on, i.e. the sources of the file layers. Must be
+     *         called in the GUI thread.
+     */
+    static QStringList externalFiles(KisNodeSP root);
+
+    /**
+     * \return the directory where the cache files are stored
+     */
+    static QString cacheLocation();
+
+    /**
+     * Removes the cache files that have been used least recently until
+     * the total size of the cache directory fits into \p maxSize bytes
+     */
+    static void trimCacheLocation(qint64 maxSize);
+
+    /**
+     * The cache files are loaded and saved in this pool. It has a single
+     * thread, so the jobs accessing the same file never overlap.
+     */
+    static QThreadPool* threadPool();
+
+    /**
+     * Waits until all the files in the pool are loaded and saved
+     */
+    static void waitForPendingJobs();
+
+private:
+    struct Private;
+    const QScopedPointer<Private> m_d;
+};
+
+#endif // KISPERSISTENTFRAMECACHE_H
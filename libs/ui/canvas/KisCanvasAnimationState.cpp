@@ -42,6 +42,7 @@
 #include "kis_icon_utils.h"
 
 #include "KisPart.h"
+#include "kis_animation_cache_populator.h"
 #include "dialogs/KisAsyncAnimationCacheRenderDialog.h"
 #include "KisRollingMeanAccumulatorWrapper.h"
 #include "kis_onion_skin_compositor.h"
@@ -368,6 +369,9 @@ void KisCanvasAnimationState::setPlaybackState(PlaybackState p_state)
 
             m_d->playbackEnvironment->prepare(m_d->canvas);
 
+            // let the populator fill the frames ahead of the playhead
+            KisPart::instance()->cachePopulator()->slotRequestRegeneration();
+
             m_d->m_statsTimer.start();
             Q_EMIT sigPlaybackStatisticsUpdated();
 
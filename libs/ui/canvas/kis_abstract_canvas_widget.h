@@ -90,6 +90,13 @@ public:
     virtual bool isBusy() const = 0;
 
     virtual void setLodResetInProgress(bool value) = 0;
+
+    /**
+     * Notifies the widget about the level of detail the image is
+     * currently displayed at, so that it could skip preparing the data
+     * that will never be shown
+     */
+    virtual void setDisplayLevelOfDetail(int lod) = 0;
 };
 
 #endif // _KIS_ABSTRACT_CANVAS_WIDGET_
@@ -1147,6 +1147,7 @@ void KisCanvas2::notifyLevelOfDetailChange()
 
     if (m_d->bootstrapLodBlocked || !m_d->lodIsSupported()) {
         image->setLodPreferences(KisLodPreferences(KisLodPreferences::None, 0));
+        m_d->canvasWidget->setDisplayLevelOfDetail(0);
     } else {
         const qreal effectiveZoom = m_d->coordinatesConverter->effectiveZoom();
 
@@ -1159,6 +1160,9 @@ void KisCanvas2::notifyLevelOfDetailChange()
             flags |= KisLodPreferences::LodPreferred;
         }
         image->setLodPreferences(KisLodPreferences(flags, lod));
+
+        // the textures use the same mipmap planes as the LoD strokes
+        m_d->canvasWidget->setDisplayLevelOfDetail(cfg.downsampledCanvasTexturesEnabled() ? lod : 0);
     }
 }
 
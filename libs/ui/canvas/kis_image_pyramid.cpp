@@ -6,6 +6,10 @@
 #include "kis_image_pyramid.h"
 
 #include <QBitArray>
+#include <QMutexLocker>
+#include <QReadLocker>
+#include <QWriteLocker>
+#include <cstring>
 #include <KoChannelInfo.h>
 #include <KoCompositeOp.h>
 #include <KoColorSpaceRegistry.h>
@@ -102,6 +106,8 @@ void KisImagePyramid::setMonitorProfile(const KoColorProfile* monitorProfile,
                                         KoColorConversionTransformation::Intent renderingIntent,
                                         KoColorConversionTransformation::ConversionFlags conversionFlags)
 {
+    QWriteLocker l(&m_pyramidLock);
+
     m_monitorProfile = monitorProfile;
     /**
      * If you change pixel size here, don't forget to change it
@@ -150,6 +156,8 @@ void KisImagePyramid::rebuildPyramid()
 
 void KisImagePyramid::clearPyramid()
 {
+    QWriteLocker l(&m_pyramidLock);
+
     for (qint32 i = 0; i < m_pyramidHeight; i++) {
         m_pyramid[i]->clear();
     }
@@ -163,36 +171,12 @@ void KisImagePyramid::setImage(KisImageWSP newImage)
         clearPyramid();
         setImageSize(m_originalImage->width(), m_originalImage->height());
 
-        // Get the full image size
-        QRect rc = m_originalImage->projection()->exactBounds();
-
-        KisImageConfig config(true);
-
-        int patchWidth = config.updatePatchWidth();
-        int patchHeight = config.updatePatchHeight();
-
-        if (rc.width() * rc.height() <= patchWidth * patchHeight) {
-            retrieveImageData(rc);
-        }
-        else {
-            qint32 firstCol = rc.x() / patchWidth;
-            qint32 firstRow = rc.y() / patchHeight;
-
-            qint32 lastCol = (rc.x() + rc.width()) / patchWidth;
-            qint32 lastRow = (rc.y() + rc.height()) / patchHeight;
-
-            for(qint32 i = firstRow; i <= lastRow; i++) {
-                for(qint32 j = firstCol; j <= lastCol; j++) {
-                    QRect maxPatchRect(j * patchWidth,
-                                       i * patchHeight,
-                                       patchWidth, patchHeight);
-                    QRect patchRect = rc & maxPatchRect;
-                    retrieveImageData(patchRect);
-                }
-            }
-
-        }
-        //TODO: check whether there is needed recalculateCache()
+        /**
+         * The planes are not filled here: the canvas starts a full update
+         * of the image right after setting it (see
+         * KisCanvas2::startResizingImage()), which fills all of them in
+         * updateCache() on the update threads.
+         */
     }
 }
 
@@ -205,7 +189,25 @@ void KisImagePyramid::setImageSize(qint32 w, qint32 h)
 
 void KisImagePyramid::updateCache(const QRect &dirtyImageRect)
 {
+    QReadLocker l(&m_pyramidLock);
+
     retrieveImageData(dirtyImageRect);
+    updatePyramidLevels(dirtyImageRect);
+}
+
+void KisImagePyramid::updatePyramidLevels(const QRect &rect)
+{
+    QMutexLocker l(&m_downsampleLock);
+
+    QRect currentSrcRect = rect;
+
+    for (int i = FIRST_NOT_ORIGINAL_INDEX; i < m_pyramidHeight; i++) {
+        if (currentSrcRect.isEmpty()) break;
+
+        currentSrcRect = downsampleByFactor2(currentSrcRect,
+                                             m_pyramid[i-1].data(),
+                                             m_pyramid[i].data());
+    }
 }
 
 void KisImagePyramid::retrieveImageData(const QRect &rect)
@@ -287,17 +289,11 @@ void KisImagePyramid::retrieveImageData(const QRect &rect)
 
 void KisImagePyramid::recalculateCache(KisPPUpdateInfoSP info)
 {
-    KisPaintDevice *src;
-    KisPaintDevice *dst;
-    QRect currentSrcRect = info->dirtyImageRectVar;
-
-    for (int i = FIRST_NOT_ORIGINAL_INDEX; i < m_pyramidHeight; i++) {
-        src = m_pyramid[i-1].data();
-        dst = m_pyramid[i].data();
-        if (!currentSrcRect.isEmpty()) {
-            currentSrcRect = downsampleByFactor2(currentSrcRect, src, dst);
-        }
-    }
+    /**
+     * All the planes have already been regenerated in updateCache()
+     * by the update threads, so the GUI thread has nothing to do here
+     */
+    Q_UNUSED(info);
 
 #ifdef DEBUG_PYRAMID
     QImage image = m_pyramid[ORIGINAL_INDEX]->convertToQImage(m_monitorProfile, m_renderingIntent, m_conversionFlags);
@@ -365,26 +361,36 @@ void  KisImagePyramid::downsamplePixels(const quint8 *srcRow0,
                                         qint32 numSrcPixels)
 {
     /**
-     * FIXME (mandatory): Use SSE and friends here.
+     * The preview color space is always rgba8, so a pair of the
+     * neighbouring pixels fits a single 64-bit word. The channels are
+     * split into two words with 16-bit-wide fields, so the sums of
+     * all four pixels of the 2x2 box are calculated for all the
+     * channels at once without overflowing into the neighbouring
+     * field. The loop has no branches and no cross-iteration
+     * dependencies, so the compiler is free to vectorize it.
      */
-
-    qint16 b = 0;
-    qint16 g = 0;
-    qint16 r = 0;
-    qint16 a = 0;
-
     static const qint32 pixelSize = 4; // This is preview argb8 mode
+    static const quint64 channelMask = 0x00FF00FF00FF00FFULL;
+    static const quint32 roundingOffset = 0x00020002;
 
     for (qint32 i = 0; i < numSrcPixels / 2; i++) {
-        b = srcRow0[0] + srcRow1[0] + srcRow0[4] + srcRow1[4];
-        g = srcRow0[1] + srcRow1[1] + srcRow0[5] + srcRow1[5];
-        r = srcRow0[2] + srcRow1[2] + srcRow0[6] + srcRow1[6];
-        a = srcRow0[3] + srcRow1[3] + srcRow0[7] + srcRow1[7];
-
-        dstRow[0] = b / 4;
-        dstRow[1] = g / 4;
-        dstRow[2] = r / 4;
-        dstRow[3] = a / 4;
+        quint64 pixels0;
+        quint64 pixels1;
+        memcpy(&pixels0, srcRow0, 2 * pixelSize);
+        memcpy(&pixels1, srcRow1, 2 * pixelSize);
+
+        quint64 sumLo = (pixels0 & channelMask) + (pixels1 & channelMask);
+        quint64 sumHi = ((pixels0 >> 8) & channelMask) + ((pixels1 >> 8) & channelMask);
+
+        // add up the left and the right pixels of the pair
+        sumLo += sumLo >> 32;
+        sumHi += sumHi >> 32;
+
+        const quint32 avgLo = ((quint32(sumLo) + roundingOffset) >> 2) & 0x00FF00FF;
+        const quint32 avgHi = ((quint32(sumHi) + roundingOffset) >> 2) & 0x00FF00FF;
+        const quint32 result = avgLo | (avgHi << 8);
+
+        memcpy(dstRow, &result, pixelSize);
 
         dstRow += pixelSize;
         srcRow0 += 2 * pixelSize;
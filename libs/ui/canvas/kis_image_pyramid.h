@@ -10,6 +10,8 @@
 #include <QImage>
 #include <QVector>
 #include <QThreadStorage>
+#include <QMutex>
+#include <QReadWriteLock>
 
 #include <KoColorSpace.h>
 #include <kis_image.h>
@@ -64,6 +66,18 @@ public:
 private:
 
     void retrieveImageData(const QRect &rect);
+
+    /**
+     * Regenerates the downscaled planes of the pyramid covering
+     * @rect of the original plane. Can be called from any thread,
+     * @m_pyramidLock must be held for reading.
+     */
+    void updatePyramidLevels(const QRect &rect);
+
+    /**
+     * Recreates the planes in the current monitor color space,
+     * @m_pyramidLock must be held for writing
+     */
     void rebuildPyramid();
     void clearPyramid();
 
@@ -77,7 +91,7 @@ private:
 
     /**
      * Auxiliary function. Downsamples two lines in @srcRow0
-     * and @srcRow1 into one line @dstRow
+     * and @srcRow1 into one line @dstRow using a 2x2 box filter
      * Note: @numSrcPixels must be EVEN
      */
     void downsamplePixels(const quint8 *srcRow0, const quint8 *srcRow1,
@@ -104,6 +118,21 @@ private Q_SLOTS:
 private:
 
     QVector<KisPaintDeviceSP> m_pyramid;
+
+    /**
+     * The update threads hold the lock for reading while they write into
+     * the planes. Recreating or clearing the planes and changing the
+     * monitor color space hold it for writing.
+     */
+    QReadWriteLock m_pyramidLock;
+
+    /**
+     * The downscaled planes are regenerated by the update threads
+     * right after the original plane has been written. The lock
+     * serializes the regeneration of the overlapping areas, so that
+     * the last writer of the original plane always downsamples it.
+     */
+    QMutex m_downsampleLock;
     KisImageWSP  m_originalImage;
 
     const KoColorProfile* m_monitorProfile {0};
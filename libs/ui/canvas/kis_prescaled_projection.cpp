@@ -24,6 +24,7 @@
 #include "kis_config_notifier.h"
 #include "kis_image.h"
 #include "krita_utils.h"
+#include <KisPerformanceTracer.h>
 
 #include "kis_coordinates_converter.h"
 #include "kis_projection_backend.h"
@@ -190,6 +191,8 @@ void KisPrescaledProjection::slotImageSizeChanged(qint32 w, qint32 h)
 
 KisUpdateInfoSP KisPrescaledProjection::updateCache(const QRect &dirtyImageRect)
 {
+    KIS_TRACE_SCOPE("canvas", "KisPrescaledProjection::updateCache");
+
     if (!m_d->image) {
         dbgRender.noquote() << "Calling updateCache without an image:" << kisBacktrace() << Qt::endl;
         // return invalid info
@@ -211,6 +214,8 @@ KisUpdateInfoSP KisPrescaledProjection::updateCache(const QRect &dirtyImageRect)
 
 void KisPrescaledProjection::recalculateCache(KisUpdateInfoSP info)
 {
+    KIS_TRACE_SCOPE("canvas", "KisPrescaledProjection::recalculateCache");
+
     KisPPUpdateInfoSP ppInfo = dynamic_cast<KisPPUpdateInfo*>(info.data());
     if(!ppInfo) return;
 
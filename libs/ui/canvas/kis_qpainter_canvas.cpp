@@ -23,6 +23,7 @@
 
 #include <kis_debug.h>
 #include <kis_config.h>
+#include <KisPerformanceTracer.h>
 
 #include <KoColorProfile.h>
 #include "kis_coordinates_converter.h"
@@ -89,6 +90,8 @@ void KisQPainterCanvas::setPrescaledProjection(KisPrescaledProjectionSP prescale
 
 void KisQPainterCanvas::paintEvent(QPaintEvent * ev)
 {
+    KIS_TRACE_SCOPE("canvas", "KisQPainterCanvas::paintEvent");
+
     KisImageWSP image = canvas()->image();
     if (image == 0) return;
 
@@ -79,6 +79,10 @@ public: // Implement kis_abstract_canvas_widget interface
         Q_UNUSED(value);
     }
 
+    void setDisplayLevelOfDetail(int lod) override {
+        Q_UNUSED(lod);
+    }
+
     void updateCanvasImage(const QRect &imageUpdateRect) override {
         update(imageUpdateRect);
     }
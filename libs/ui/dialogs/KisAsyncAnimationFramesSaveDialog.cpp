@@ -10,6 +10,8 @@
 #include <kis_time_span.h>
 
 #include <KisAsyncAnimationFramesSavingRenderer.h>
+#include <KisAsyncAnimationFramesEncoder.h>
+#include "kis_image_config.h"
 #include "kis_properties_configuration.h"
 
 #include "KisMimeDatabase.h"
@@ -53,6 +55,8 @@ struct KisAsyncAnimationFramesSaveDialog::Private {
 
     int sequenceNumberingOffset;
     KisPropertiesConfigurationSP exportConfiguration;
+
+    QSharedPointer<KisAsyncAnimationFramesEncoder> encoder;
 };
 
 KisAsyncAnimationFramesSaveDialog::KisAsyncAnimationFramesSaveDialog(KisImageSP originalImage,
@@ -131,8 +135,36 @@ KisAsyncAnimationRenderDialogBase::Result KisAsyncAnimationFramesSaveDialog::reg
         }
     }
 
+    /**
+     * The frames are encoded on a separate pool, so that the image clones
+     * could render the next frames while the previous ones are being saved.
+     * The encoder is shared between all the renderers of the dialog.
+     */
+    KisImageConfig cfg(true);
+    const int encodingMemoryLimit = cfg.frameEncodingMemoryLimit();
+    if (encodingMemoryLimit > 0) {
+        m_d->encoder.reset(
+            new KisAsyncAnimationFramesEncoder(m_d->originalImage,
+                                               m_d->outputMimeType,
+                                               m_d->exportConfiguration,
+                                               qMax(1, cfg.maxNumberOfThreads() / 2),
+                                               qint64(encodingMemoryLimit) * 1024 * 1024));
+    }
+
     KisAsyncAnimationRenderDialogBase::Result renderingResult = KisAsyncAnimationRenderDialogBase::regenerateRange(viewManager);
 
+    if (m_d->encoder) {
+        if (renderingResult != RenderComplete) {
+            m_d->encoder->cancel();
+        }
+
+        if (!m_d->encoder->waitForFinished() && renderingResult == RenderComplete) {
+            renderingResult = RenderFailed;
+        }
+
+        m_d->encoder.reset();
+    }
+
     filesList = savedFiles();
 
     // If we cancel rendering or fail rendering process, lets clean up any files that may have been created
@@ -181,7 +213,8 @@ KisAsyncAnimationRendererBase *KisAsyncAnimationFramesSaveDialog::createRenderer
                                                      m_d->range,
                                                      m_d->sequenceNumberingOffset,
                                                      m_d->onlyNeedsUniqueFrames,
-                                                     m_d->exportConfiguration);
+                                                     m_d->exportConfiguration,
+                                                     m_d->encoder);
 }
 
 void KisAsyncAnimationFramesSaveDialog::initializeRendererForFrame(KisAsyncAnimationRendererBase *renderer, KisImageSP image, int frame)
@@ -1558,6 +1558,9 @@ void PerformanceTab::load(bool requestDefault)
         KisConfig cfg2(true);
         chkOpenGLFramerateLogging->setChecked(cfg2.enableOpenGLFramerateLogging(requestDefault));
         chkBrushSpeedLogging->setChecked(cfg2.enableBrushSpeedLogging(requestDefault));
+        chkPerformanceTracing->setChecked(cfg2.enablePerformanceTracing(requestDefault));
+        chkStrokeRecording->setChecked(cfg2.enableStrokeRecording(requestDefault));
+        chkPerformanceCountersLogging->setChecked(cfg2.logPerformanceCounters(requestDefault));
         chkDisableVectorOptimizations->setChecked(cfg2.disableVectorOptimizations(requestDefault));
 #ifdef Q_OS_WIN
         chkDisableAVXOptimizations->setChecked(cfg2.disableAVXOptimizations(requestDefault));
@@ -1621,6 +1624,9 @@ void PerformanceTab::save()
         KisConfig cfg2(true);
         cfg2.setEnableOpenGLFramerateLogging(chkOpenGLFramerateLogging->isChecked());
         cfg2.setEnableBrushSpeedLogging(chkBrushSpeedLogging->isChecked());
+        cfg2.setEnablePerformanceTracing(chkPerformanceTracing->isChecked());
+        cfg2.setEnableStrokeRecording(chkStrokeRecording->isChecked());
+        cfg2.setLogPerformanceCounters(chkPerformanceCountersLogging->isChecked());
         cfg2.setDisableVectorOptimizations(chkDisableVectorOptimizations->isChecked());
 #ifdef Q_OS_WIN
         cfg2.setDisableAVXOptimizations(chkDisableAVXOptimizations->isChecked());
@@ -15,6 +15,7 @@
 #include <QTouchEvent>
 #include <QElapsedTimer>
 #include <QWidget>
+#include <KisPerformanceTracer.h>
 
 #include <KoToolManager.h>
 #include <KoPointerEvent.h>
@@ -288,6 +289,8 @@ bool shouldResetWheelDelta(QEvent * event)
 
 bool KisInputManager::eventFilterImpl(QEvent * event)
 {
+    KIS_TRACE_SCOPE("input", "KisInputManager::eventFilterImpl");
+
     bool retval = false;
 
     // Try closing any open popup widget and
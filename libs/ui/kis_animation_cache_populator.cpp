@@ -11,6 +11,7 @@
 #include <QTimer>
 #include <QMutex>
 #include <QtConcurrent>
+#include <QtMath>
 
 #include "kis_config.h"
 #include "kis_config_notifier.h"
@@ -28,6 +29,9 @@
 #include "kis_node_manager.h"
 #include "kis_keyframe_channel.h"
 #include "KisMainWindow.h"
+#include "kis_image_config.h"
+#include "KisCanvasAnimationState.h"
+#include "animation/KisFrameDisplayProxy.h"
 
 #include <KisLockFrameGenerationLock.h>
 #include "KisAsyncAnimationCacheRenderer.h"
@@ -50,8 +54,16 @@ struct KisAnimationCachePopulator::Private
     static const int IDLE_CHECK_INTERVAL = 500;
     static const int BETWEEN_FRAMES_INTERVAL = 10;
 
+    /**
+     * How far ahead of the playhead (in seconds of playback) the frames
+     * are regenerated with the highest priority while the animation is
+     * playing
+     */
+    static const int LOOK_AHEAD_SECONDS = 2;
+
     KisAsyncAnimationCacheRenderer regenerator;
     bool calculateAnimationCacheInBackground = true;
+    qint64 cacheMemoryLimit = 0;
 
     enum State {
         NotWaitingForAnything,
@@ -92,8 +104,84 @@ struct KisAnimationCachePopulator::Private
         }
     }
 
+    KisCanvas2* activeCanvas() const
+    {
+        KisMainWindow *activeWindow = part->currentMainwindow();
+        return activeWindow && activeWindow->activeView() ? activeWindow->activeView()->canvasBase() : nullptr;
+    }
+
+    bool isActiveCanvasPlaying() const
+    {
+        KisCanvas2 *canvas = activeCanvas();
+        return canvas && canvas->animationState() &&
+            canvas->animationState()->playbackState() == PLAYING;
+    }
+
+    /**
+     * The time the playhead of the canvas showing the image of \p cache
+     * is at, or the current time of the image if there is no such canvas
+     */
+    int playheadTime(KisAnimationFrameCacheSP cache) const
+    {
+        KisCanvas2 *canvas = activeCanvas();
+        if (canvas && canvas->frameCache() == cache && canvas->animationState()) {
+            return canvas->animationState()->displayProxy()->activeFrame();
+        }
+
+        return cache->image()->animationInterface()->currentUITime();
+    }
+
+    /**
+     * Finds the first uncached frame the playhead of \p canvas is going
+     * to reach within the look-ahead window. The window is measured in
+     * the playback time, so it grows with the framerate and the speed of
+     * the playback.
+     */
+    int predictNextFrame(KisCanvas2 *canvas) const
+    {
+        KisAnimationFrameCacheSP cache = canvas->frameCache();
+        KisImageAnimationInterface *animation = canvas->image()->animationInterface();
+
+        const KisTimeSpan range = animation->activePlaybackRange();
+        if (!range.isValid() || range.isInfinite()) return -1;
+
+        const int windowSize =
+            qMin(range.duration(),
+                 qCeil(animation->framerate() * canvas->animationState()->playbackSpeed() * LOOK_AHEAD_SECONDS));
+
+        const int time = canvas->animationState()->displayProxy()->activeFrame();
+        const int offset = range.contains(time) ? time - range.start() : 0;
+
+        // the playback loops within the active range
+        for (int i = 0; i < windowSize; i++) {
+            const int frame = range.start() + (offset + i) % range.duration();
+
+            if (cache->frameStatus(frame) == KisAnimationFrameCache::Uncached) {
+                return frame;
+            }
+        }
+
+        return -1;
+    }
+
     void generateIfIdle()
     {
+        /**
+         * During the playback the image is not idle, but the frames ahead
+         * of the playhead should be regenerated as fast as possible
+         */
+        if (isActiveCanvasPlaying()) {
+            idleCounter = IDLE_COUNT_THRESHOLD;
+
+            RegenerationRequestResult result = tryRequestGeneration();
+
+            if (result != RequestSuccessful) {
+                enterState(WaitingForIdle);
+            }
+
+            return;
+        }
+
         if (part->idleWatcher()->isIdle()) {
             idleCounter++;
 
@@ -173,15 +261,26 @@ struct KisAnimationCachePopulator::Private
         // Prioritize the active document
         KisAnimationFrameCacheSP activeDocumentCache = KisAnimationFrameCacheSP(0);
 
-        KisMainWindow *activeWindow = part->currentMainwindow();
-        if (activeWindow && activeWindow->activeView()) {
-            KisCanvas2 *activeCanvas = activeWindow->activeView()->canvasBase();
-
-            if (activeCanvas && activeCanvas->frameCache() &&
+        KisCanvas2 *activeCanvas = this->activeCanvas();
+        if (activeCanvas) {
+            if (activeCanvas->frameCache() &&
                 activeCanvas->image()->animationInterface()->hasAnimation()) {
 
                 activeDocumentCache = activeCanvas->frameCache();
 
+                // While playing, the frames right ahead of the playhead go first
+                if (isActiveCanvasPlaying() &&
+                    !activeCanvas->image()->animationInterface()->backgroundFrameGenerationBlocked()) {
+
+                    const int predictedFrame = predictNextFrame(activeCanvas);
+
+                    if (predictedFrame >= 0) {
+                        RegenerationRequestResult result =
+                            tryRequestGeneration(activeDocumentCache, KisTimeSpan(), predictedFrame);
+                        if (result == RequestSuccessful) return result;
+                    }
+                }
+
                 // Let's skip frames affected by changes to the active node (on the active document)
                 // This avoids constant invalidation and regeneration while drawing
                 KisNodeSP activeNode = activeCanvas->viewManager()->nodeManager()->activeNode();
@@ -245,6 +344,14 @@ struct KisAnimationCachePopulator::Private
         const int frame = priorityFrame >= 0 ? priorityFrame : KisAsyncAnimationCacheRenderDialog::calcFirstDirtyFrame(cache, currentRange, skipRange);
 
         if (frame >= 0) {
+            if (cacheMemoryLimit > 0 &&
+                !cache->makeRoomForFrame(frame, playheadTime(cache),
+                                         animation->activePlaybackRange(), cacheMemoryLimit)) {
+
+                // the cache is filled with the frames closer to the playhead
+                return RequestRejected;
+            }
+
             return regenerate(cache, frame);
         }
 
@@ -379,6 +486,9 @@ void KisAnimationCachePopulator::slotRequestRegeneration()
     // skip if the user forbade background regeneration
     if (!m_d->calculateAnimationCacheInBackground) return;
 
+    // the regenerator will continue with the next frame itself
+    if (m_d->state == Private::WaitingForFrame) return;
+
     m_d->enterState(Private::WaitingForIdle);
 }
 
@@ -397,5 +507,6 @@ void KisAnimationCachePopulator::slotConfigChanged()
 {
     KisConfig cfg(true);
     m_d->calculateAnimationCacheInBackground = cfg.calculateAnimationCacheInBackground();
+    m_d->cacheMemoryLimit = qint64(KisImageConfig(true).animationCacheMemoryLimit()) * 1024 * 1024;
     QTimer::singleShot(1000, this, SLOT(slotRequestRegeneration()));
 }
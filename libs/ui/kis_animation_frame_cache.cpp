@@ -7,7 +7,11 @@
 #include "kis_animation_frame_cache.h"
 #include "kis_animation_frame_cache_p.h"
 
+#include <QFutureWatcher>
 #include <QMap>
+#include <QPointer>
+#include <QTimer>
+#include <QtConcurrent>
 
 #include "kis_debug.h"
 
@@ -20,6 +24,8 @@
 #include <KisAbstractFrameCacheSwapper.h>
 #include "KisFrameCacheSwapper.h"
 #include "KisInMemoryFrameCacheSwapper.h"
+#include "KisPersistentFrameCache.h"
+#include "KisDocument.h"
 
 #include "kis_image_config.h"
 #include "kis_config_notifier.h"
@@ -28,6 +34,10 @@
 
 #include <kis_algebra_2d.h>
 #include <cmath>
+#include <limits>
+
+#include <KoColorSpace.h>
+#include "opengl/KisOpenGLUpdateInfoBuilder.h"
 
 
 struct KisAnimationFrameCache::Private
@@ -45,9 +55,53 @@ struct KisAnimationFrameCache::Private
     KisOpenGLImageTexturesSP textures;
     KisImageWSP image;
 
-    QScopedPointer<KisAbstractFrameCacheSwapper> swapper;
+    QSharedPointer<KisAbstractFrameCacheSwapper> swapper;
     int frameSizeLimit = 777;
 
+    /**
+     * The document the frames belong to, used for keeping
+     * the cache on disk between the sessions
+     */
+    QPointer<KisDocument> document;
+    bool persistentFramesPending = false;
+
+    /**
+     * The frames kept on disk are loaded into a separate swapper
+     * in the background and merged into the cache when ready
+     */
+    QSharedPointer<KisAbstractFrameCacheSwapper> loadedSwapper;
+    QFutureWatcher<QMap<int, int>> loadedFramesWatcher;
+
+    /**
+     * Incremented on every change of the image frames. The loaded frames
+     * are merged only if the image hasn't changed since loading started.
+     */
+    int framesChangedSeqNo = 0;
+    int loadingFramesChangedSeqNo = 0;
+
+    KisAbstractFrameCacheSwapper* createSwapper() const;
+
+    void startLoadingPersistentFrames();
+    void mergeLoadedFrames();
+    void startSavingPersistentFrames();
+
+    /**
+     * The jobs of the persistent cache use the builder of the textures,
+     * so keep them alive until \p future is finished. The textures are
+     * released in the GUI thread then.
+     */
+    template <typename T>
+    static void keepTexturesUntilFinished(QFuture<T> future, KisOpenGLImageTexturesSP textures)
+    {
+        QFutureWatcher<T> *watcher = new QFutureWatcher<T>();
+        QObject::connect(watcher, &QFutureWatcher<T>::finished, watcher,
+            [watcher, textures] () {
+                Q_UNUSED(textures);
+                watcher->deleteLater();
+            });
+        watcher->setFuture(future);
+    }
+
     KisOpenGLUpdateInfoSP fetchFrameDataImpl(KisImageSP image, const QRect &requestedRect, int lod);
 
     struct Frame
@@ -163,6 +217,34 @@ struct KisAnimationFrameCache::Private
         return cacheChanged;
     }
 
+    qint64 estimateFrameSize(const QRect &rc, int lod) const {
+        const KoColorSpace *dstColorSpace = textures->updateInfoBuilder().destinationColorSpace();
+        const int pixelSize = dstColorSpace ? dstColorSpace->pixelSize() : 4;
+        const QRect lodRect = KisLodTransform::alignedRect(rc, lod);
+
+        return qint64(lodRect.width() >> lod) * (lodRect.height() >> lod) * pixelSize;
+    }
+
+    /**
+     * The number of frames the playhead should pass from \p playheadTime
+     * to reach the frame starting at \p start
+     */
+    int playbackDistance(int start, int length, int playheadTime, const KisTimeSpan &playbackRange) const {
+        if (start <= playheadTime && (length == -1 || playheadTime < start + length)) {
+            return 0;
+        }
+
+        if (!playbackRange.isValid() || playbackRange.isInfinite() ||
+            !playbackRange.contains(start)) {
+
+            return std::numeric_limits<int>::max();
+        }
+
+        return start > playheadTime ?
+            start - playheadTime :
+            playbackRange.end() - playheadTime + start - playbackRange.start() + 1;
+    }
+
     int effectiveLevelOfDetail(const QRect &rc) const {
         if (!frameSizeLimit) return 0;
 
@@ -215,17 +297,199 @@ KisAnimationFrameCache::KisAnimationFrameCache(KisOpenGLImageTexturesSP textures
     // create swapping backend
     slotConfigChanged();
 
+    Q_FOREACH (QPointer<KisDocument> document, KisPart::instance()->documents()) {
+        if (document && document->image() == m_d->image) {
+            m_d->document = document;
+            break;
+        }
+    }
+
+    connect(&m_d->loadedFramesWatcher, SIGNAL(finished()), SLOT(slotPersistentFramesLoaded()));
+
+    if (KisImageConfig(true).usePersistentAnimationCache() && m_d->document) {
+        m_d->persistentFramesPending = true;
+
+        // the textures of the canvas are not initialized yet
+        QTimer::singleShot(0, this, SLOT(slotLoadPersistentFrames()));
+    }
+
     connect(m_d->image->animationInterface(), SIGNAL(sigFramesChanged(KisTimeSpan,QRect)), this, SLOT(framesChanged(KisTimeSpan,QRect)));
     connect(KisConfigNotifier::instance(), SIGNAL(configChanged()), SLOT(slotConfigChanged()));
 }
 
 KisAnimationFrameCache::~KisAnimationFrameCache()
 {
+    if (m_d->loadedFramesWatcher.isRunning()) {
+        Private::keepTexturesUntilFinished(m_d->loadedFramesWatcher.future(), m_d->textures);
+    }
+
+    // the stored cache is still valid if it hasn't been merged yet
+    if (!m_d->loadedFramesWatcher.isRunning() && !m_d->loadedSwapper) {
+        m_d->startSavingPersistentFrames();
+    }
+
     Private::caches.remove(m_d->textures);
 }
 
+KisAbstractFrameCacheSwapper* KisAnimationFrameCache::Private::createSwapper() const
+{
+    KisImageConfig cfg(true);
+
+    if (cfg.useOnDiskAnimationCacheSwapping()) {
+        return new KisFrameCacheSwapper(textures->updateInfoBuilder(),
+                                        cfg.swapDir(),
+                                        cfg.useAnimationCacheCompression() ?
+                                            KisFrameDataSerializer::CompressionLzf :
+                                            KisFrameDataSerializer::CompressionNone);
+    } else {
+        return new KisInMemoryFrameCacheSwapper();
+    }
+}
+
+void KisAnimationFrameCache::Private::startLoadingPersistentFrames()
+{
+    if (!persistentFramesPending || !document) return;
+
+    KisImageSP image = this->image;
+    if (!image) return;
+
+    const QString documentPath = document->path();
+    const QStringList externalFiles = KisPersistentFrameCache::externalFiles(image->root());
+    const KisOpenGLUpdateInfoBuilder *builder = &textures->updateInfoBuilder();
+
+    if (!KisPersistentFrameCache(documentPath, externalFiles, *builder).isValid()) return;
+
+    persistentFramesPending = false;
+
+    // the document has already been changed since loading
+    if (document->isModified()) return;
+
+    const QRect imageBounds = image->bounds();
+    QSharedPointer<KisAbstractFrameCacheSwapper> swapper(createSwapper());
+    loadedSwapper = swapper;
+    loadingFramesChangedSeqNo = framesChangedSeqNo;
+
+    QFuture<QMap<int, int>> future =
+        QtConcurrent::run(KisPersistentFrameCache::threadPool(),
+            [documentPath, externalFiles, imageBounds, swapper, builder] () {
+                QMap<int, int> frames;
+
+                KisPersistentFrameCache persistentCache(documentPath, externalFiles, *builder);
+                persistentCache.loadFrames(imageBounds,
+                    [&frames, swapper, imageBounds] (KisOpenGLUpdateInfoSP info, int start, int length) {
+                        frames.insert(start, length);
+                        swapper->saveFrame(start, info, imageBounds);
+                    });
+
+                return frames;
+            });
+
+    loadedFramesWatcher.setFuture(future);
+}
+
+void KisAnimationFrameCache::Private::mergeLoadedFrames()
+{
+    QSharedPointer<KisAbstractFrameCacheSwapper> loadedSwapper = this->loadedSwapper;
+    this->loadedSwapper.reset();
+
+    const QMap<int, int> loadedFrames = loadedFramesWatcher.result();
+
+    /**
+     * The image has been changed while loading, so the loaded frames
+     * may be stale. The same happens when the swapper is recreated.
+     * Don't rely on the modified state of the document here, it is
+     * reset by saving and by undoing the changes.
+     */
+    if (!loadedSwapper ||
+        framesChangedSeqNo != loadingFramesChangedSeqNo ||
+        loadedFrames.isEmpty()) {
+
+        return;
+    }
+
+    /**
+     * The frames generated while loading are usually few, so move them
+     * into the loaded swapper. They replace the overlapping loaded
+     * frames in addFrame().
+     */
+    QSharedPointer<KisAbstractFrameCacheSwapper> generatedSwapper = swapper;
+    const QMap<int, int> generatedFrames = newFrames;
+
+    swapper = loadedSwapper;
+    newFrames = loadedFrames;
+
+    for (auto it = generatedFrames.constBegin(); it != generatedFrames.constEnd(); ++it) {
+        const KisTimeSpan range = it.value() < 0 ?
+            KisTimeSpan::infinite(it.key()) :
+            KisTimeSpan::fromTimeWithDuration(it.key(), it.value());
+
+        KisOpenGLUpdateInfoSP info = generatedSwapper->loadFrame(it.key());
+        if (info) {
+            addFrame(info, range);
+        } else {
+            invalidate(range);
+        }
+    }
+}
+
+void KisAnimationFrameCache::Private::startSavingPersistentFrames()
+{
+    KisImageConfig cfg(true);
+
+    if (!document || !cfg.usePersistentAnimationCache()) return;
+
+    /**
+     * The cache always corresponds to the current state of the image,
+     * so it is valid for the file only when the document is unmodified
+     */
+    if (document->isModified() || document->path().isEmpty()) return;
+
+    KisImageSP image = this->image;
+    if (!image) return;
+
+    const QString documentPath = document->path();
+    const QStringList externalFiles = KisPersistentFrameCache::externalFiles(image->root());
+    const KisOpenGLUpdateInfoBuilder *builder = &textures->updateInfoBuilder();
+
+    if (!KisPersistentFrameCache(documentPath, externalFiles, *builder).isValid()) return;
+
+    const QRect imageBounds = image->bounds();
+    const QMap<int, int> frames = newFrames;
+    const qint64 maxCacheSize = qint64(cfg.persistentAnimationCacheSize()) * 1024 * 1024;
+    QSharedPointer<KisAbstractFrameCacheSwapper> swapper = this->swapper;
+
+    QFuture<void> future =
+        QtConcurrent::run(KisPersistentFrameCache::threadPool(),
+            [documentPath, externalFiles, imageBounds, frames, swapper, maxCacheSize, builder] () {
+                KisPersistentFrameCache persistentCache(documentPath, externalFiles, *builder);
+                persistentCache.saveFrames(frames, swapper.data(), imageBounds);
+
+                KisPersistentFrameCache::trimCacheLocation(maxCacheSize);
+            });
+
+    keepTexturesUntilFinished(future, textures);
+}
+
+void KisAnimationFrameCache::slotLoadPersistentFrames()
+{
+    m_d->startLoadingPersistentFrames();
+}
+
+void KisAnimationFrameCache::slotPersistentFramesLoaded()
+{
+    m_d->mergeLoadedFrames();
+
+    if (!m_d->newFrames.isEmpty()) {
+        Q_EMIT changed();
+    }
+}
+
 bool KisAnimationFrameCache::uploadFrame(int time)
 {
+    if (m_d->persistentFramesPending) {
+        slotLoadPersistentFrames();
+    }
+
     KisOpenGLUpdateInfoSP info = m_d->getFrame(time);
 
     if (!info) {
@@ -365,6 +629,8 @@ void KisAnimationFrameCache::framesChanged(const KisTimeSpan &range, const QRect
 
     if (!range.isValid()) return;
 
+    m_d->framesChangedSeqNo++;
+
     bool cacheChanged = m_d->invalidate(range);
 
     if (cacheChanged) {
@@ -375,14 +641,12 @@ void KisAnimationFrameCache::framesChanged(const KisTimeSpan &range, const QRect
 void KisAnimationFrameCache::slotConfigChanged()
 {
     m_d->newFrames.clear();
+    m_d->swapper.reset(m_d->createSwapper());
 
-    KisImageConfig cfg(true);
+    // the frames being loaded belong to the old swapper type
+    m_d->loadedSwapper.reset();
 
-    if (cfg.useOnDiskAnimationCacheSwapping()) {
-        m_d->swapper.reset(new KisFrameCacheSwapper(m_d->textures->updateInfoBuilder(), cfg.swapDir()));
-    } else {
-        m_d->swapper.reset(new KisInMemoryFrameCacheSwapper());
-    }
+    KisImageConfig cfg(true);
 
     m_d->frameSizeLimit = cfg.useAnimationCacheFrameSizeLimit() ? cfg.animationCacheFrameSizeLimit() : 0;
     Q_EMIT changed();
@@ -507,3 +771,61 @@ bool KisAnimationFrameCache::framesHaveValidRoi(const KisTimeSpan &range, const
 
     return true;
 }
+
+bool KisAnimationFrameCache::makeRoomForFrame(int frame, int playheadTime, const KisTimeSpan &playbackRange, qint64 memoryLimit)
+{
+    KisImageSP image = m_d->image;
+    if (!image || memoryLimit <= 0) return true;
+
+    struct FrameRecord {
+        int start;
+        int distance;
+        qint64 size;
+    };
+
+    QVector<FrameRecord> records;
+    qint64 totalSize = 0;
+
+    for (auto it = m_d->newFrames.constBegin(); it != m_d->newFrames.constEnd(); ++it) {
+        const qint64 size = m_d->estimateFrameSize(m_d->swapper->frameDirtyRect(it.key()),
+                                                   m_d->swapper->frameLevelOfDetail(it.key()));
+        totalSize += size;
+        records.append({it.key(), m_d->playbackDistance(it.key(), it.value(), playheadTime, playbackRange), size});
+    }
+
+    const QRect bounds = image->bounds();
+    const qint64 newFrameSize = m_d->estimateFrameSize(bounds, m_d->effectiveLevelOfDetail(bounds));
+
+    if (totalSize + newFrameSize <= memoryLimit) return true;
+
+    const int newFrameDistance = m_d->playbackDistance(frame, 1, playheadTime, playbackRange);
+
+    std::sort(records.begin(), records.end(),
+              [] (const FrameRecord &lhs, const FrameRecord &rhs) {
+                  return lhs.distance > rhs.distance;
+              });
+
+    bool cacheChanged = false;
+
+    for (auto it = records.constBegin(); it != records.constEnd(); ++it) {
+        if (totalSize + newFrameSize <= memoryLimit) break;
+
+        // never drop the frames the playhead reaches earlier than the new one
+        if (it->distance <= newFrameDistance) break;
+
+        m_d->swapper->forgetFrame(it->start);
+        m_d->newFrames.remove(it->start);
+        totalSize -= it->size;
+        cacheChanged = true;
+    }
+
+    if (cacheChanged) {
+        Q_EMIT changed();
+    }
+
+    /**
+     * Let at least one frame into the cache, otherwise the frames
+     * bigger than the limit would never be generated
+     */
+    return totalSize + newFrameSize <= memoryLimit || m_d->newFrames.isEmpty();
+}
@@ -65,6 +65,18 @@ public:
 
     bool framesHaveValidRoi(const KisTimeSpan &range, const QRect &regionOfInterest);
 
+    /**
+     * Drops the cached frames that are farther from \p playheadTime
+     * than \p frame until a new frame fits into \p memoryLimit (in bytes).
+     * The distance is measured in the direction of playback, wrapping
+     * around the end of \p playbackRange; the frames outside the range
+     * are dropped first.
+     *
+     * \return false if the cache is filled with the frames closer to
+     *         the playhead, so \p frame should not be generated
+     */
+    bool makeRoomForFrame(int frame, int playheadTime, const KisTimeSpan &playbackRange, qint64 memoryLimit);
+
 Q_SIGNALS:
     void changed();
 
@@ -76,6 +88,8 @@ private:
 private Q_SLOTS:
     void framesChanged(const KisTimeSpan &range, const QRect &rect);
     void slotConfigChanged();
+    void slotLoadPersistentFrames();
+    void slotPersistentFramesLoaded();
 };
 
 #endif
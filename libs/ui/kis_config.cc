@@ -1277,6 +1277,27 @@ void KisConfig::setAutoSaveInterval(int seconds)  const
     return m_cfg.writeEntry("AutoSaveInterval", seconds);
 }
 
+bool KisConfig::incrementalAutoSave(bool defaultValue) const
+{
+    return (defaultValue ? true : m_cfg.readEntry("IncrementalAutoSave", true));
+}
+
+void KisConfig::setIncrementalAutoSave(bool value) const
+{
+    m_cfg.writeEntry("IncrementalAutoSave", value);
+}
+
+int KisConfig::incrementalAutoSaveMaxSteps(bool defaultValue) const
+{
+    const int def = 8;
+    return (defaultValue ? def : m_cfg.readEntry("IncrementalAutoSaveMaxSteps", def));
+}
+
+void KisConfig::setIncrementalAutoSaveMaxSteps(int value) const
+{
+    m_cfg.writeEntry("IncrementalAutoSaveMaxSteps", value);
+}
+
 bool KisConfig::backupFile(bool defaultValue) const
 {
     return (defaultValue ? true : m_cfg.readEntry("CreateBackupFile", true));
@@ -1665,6 +1686,16 @@ void KisConfig::setLevelOfDetailEnabled(bool value)
     m_cfg.writeEntry("levelOfDetailEnabled", value);
 }
 
+bool KisConfig::downsampledCanvasTexturesEnabled(bool defaultValue) const
+{
+    return (defaultValue ? true : m_cfg.readEntry("downsampledCanvasTexturesEnabled", true));
+}
+
+void KisConfig::setDownsampledCanvasTexturesEnabled(bool value)
+{
+    m_cfg.writeEntry("downsampledCanvasTexturesEnabled", value);
+}
+
 KisOcioConfiguration KisConfig::ocioConfiguration(bool defaultValue) const
 {
     KisOcioConfiguration cfg;
@@ -2200,6 +2231,36 @@ void KisConfig::setEnableBrushSpeedLogging(bool value) const
     m_cfg.writeEntry("enableBrushSpeedLogging", value);
 }
 
+bool KisConfig::enablePerformanceTracing(bool defaultValue) const
+{
+    return (defaultValue ? false : m_cfg.readEntry("enablePerformanceTracing", false));
+}
+
+void KisConfig::setEnablePerformanceTracing(bool value) const
+{
+    m_cfg.writeEntry("enablePerformanceTracing", value);
+}
+
+bool KisConfig::enableStrokeRecording(bool defaultValue) const
+{
+    return (defaultValue ? false : m_cfg.readEntry("enableStrokeRecording", false));
+}
+
+void KisConfig::setEnableStrokeRecording(bool value) const
+{
+    m_cfg.writeEntry("enableStrokeRecording", value);
+}
+
+bool KisConfig::logPerformanceCounters(bool defaultValue) const
+{
+    return (defaultValue ? false : m_cfg.readEntry("logPerformanceCounters", false));
+}
+
+void KisConfig::setLogPerformanceCounters(bool value) const
+{
+    m_cfg.writeEntry("logPerformanceCounters", value);
+}
+
 void KisConfig::setDisableVectorOptimizations(bool value)
 {
     // use the old key name for compatibility
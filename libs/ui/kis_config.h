@@ -315,6 +315,12 @@ public:
     int autoSaveInterval(bool defaultValue = false) const;
     void setAutoSaveInterval(int seconds) const;
 
+    bool incrementalAutoSave(bool defaultValue = false) const;
+    void setIncrementalAutoSave(bool value) const;
+
+    int incrementalAutoSaveMaxSteps(bool defaultValue = false) const;
+    void setIncrementalAutoSaveMaxSteps(int value) const;
+
     bool backupFile(bool defaultValue = false) const;
     void setBackupFile(bool backupFile) const;
 
@@ -417,6 +423,9 @@ public:
     bool levelOfDetailEnabled(bool defaultValue = false) const;
     void setLevelOfDetailEnabled(bool value);
 
+    bool downsampledCanvasTexturesEnabled(bool defaultValue = false) const;
+    void setDownsampledCanvasTexturesEnabled(bool value);
+
     KisOcioConfiguration ocioConfiguration(bool defaultValue = false) const;
     void setOcioConfiguration(const KisOcioConfiguration &cfg);
 
@@ -594,6 +603,27 @@ public:
     void setEnableBrushSpeedLogging(bool value) const;
     bool enableBrushSpeedLogging(bool defaultValue = false) const;
 
+    /**
+     * Records the spans of the canvas pipeline with KisPerformanceTracer.
+     * The trace is saved when the option is switched off or Krita is closed.
+     */
+    void setEnablePerformanceTracing(bool value) const;
+    bool enablePerformanceTracing(bool defaultValue = false) const;
+
+    /**
+     * Records the input of the freehand strokes with KisStrokeRecorder,
+     * the strokes are appended to the recording as soon as they are finished
+     */
+    void setEnableStrokeRecording(bool value) const;
+    bool enableStrokeRecording(bool defaultValue = false) const;
+
+    /**
+     * Appends the values of KisPerformanceCounters to a log file
+     * every second
+     */
+    void setLogPerformanceCounters(bool value) const;
+    bool logPerformanceCounters(bool defaultValue = false) const;
+
     void setDisableVectorOptimizations(bool value);
     bool disableVectorOptimizations(bool defaultValue = false) const;
 
@@ -21,10 +21,14 @@
 #include <limits.h>
 #include <stdio.h>
 #include <zlib.h>
+#include <functional>
+#include <limits>
 
 #include <QBuffer>
 #include <QFile>
 #include <QApplication>
+#include <QThreadPool>
+#include <QtEndian>
 
 #include <klocalizedstring.h>
 #include <QUrl>
@@ -56,6 +60,7 @@
 #include <kis_transaction.h>
 
 #include <kis_assert.h>
+#include <KisConcurrentRangeUtils.h>
 
 namespace
 {
@@ -410,6 +415,367 @@ void _flush_fn(png_structp png_ptr)
     Q_UNUSED(png_ptr);
 }
 
+namespace {
+
+int zlibCompressionStrategy(KisPNGOptions::CompressionStrategy strategy)
+{
+    switch (strategy) {
+    case KisPNGOptions::FilteredStrategy:
+        return Z_FILTERED;
+    case KisPNGOptions::HuffmanOnlyStrategy:
+        return Z_HUFFMAN_ONLY;
+    case KisPNGOptions::RLEStrategy:
+        return Z_RLE;
+    case KisPNGOptions::DefaultStrategy:
+        break;
+    }
+
+    return Z_DEFAULT_STRATEGY;
+}
+
+inline int paethPredictor(int a, int b, int c)
+{
+    const int p = a + b - c;
+    const int pa = qAbs(p - a);
+    const int pb = qAbs(p - b);
+    const int pc = qAbs(p - c);
+
+    return pa <= pb && pa <= pc ? a : pb <= pc ? b : c;
+}
+
+/**
+ * Applies PNG filter \p filterType to \p row and returns the sum of
+ * the absolute values of the filtered bytes (treated as signed), which
+ * is used for choosing the best filter for the row.
+ */
+template <int filterType>
+quint64 applyRowFilter(const quint8 *row, const quint8 *prior, int rowBytes, int bpp, quint8 *dst)
+{
+    quint64 sum = 0;
+
+    for (int i = 0; i < rowBytes; i++) {
+        const int a = i >= bpp ? row[i - bpp] : 0;
+        const int b = prior ? prior[i] : 0;
+        const int c = prior && i >= bpp ? prior[i - bpp] : 0;
+
+        int predictor = 0;
+
+        switch (filterType) {
+        case PNG_FILTER_VALUE_SUB:
+            predictor = a;
+            break;
+        case PNG_FILTER_VALUE_UP:
+            predictor = b;
+            break;
+        case PNG_FILTER_VALUE_AVG:
+            predictor = (a + b) >> 1;
+            break;
+        case PNG_FILTER_VALUE_PAETH:
+            predictor = paethPredictor(a, b, c);
+            break;
+        default:
+            break;
+        }
+
+        const quint8 value = quint8(row[i] - predictor);
+        dst[i] = value;
+        sum += value < 128 ? value : 256 - value;
+    }
+
+    return sum;
+}
+
+/**
+ * Filters \p row with the filter that gives the minimum sum of absolute
+ * differences (the heuristic recommended by the PNG specification) and
+ * writes the filter type byte followed by the filtered data into \p dst.
+ * \p prior is the unfiltered previous row or null for the first row of
+ * the image.
+ */
+void filterRowAdaptive(const quint8 *row, const quint8 *prior, int rowBytes, int bpp, quint8 *dst, quint8 *scratch)
+{
+    using FilterFunc = quint64 (*)(const quint8 *, const quint8 *, int, int, quint8 *);
+
+    static const FilterFunc filters[] = {
+        &applyRowFilter<PNG_FILTER_VALUE_NONE>,
+        &applyRowFilter<PNG_FILTER_VALUE_SUB>,
+        &applyRowFilter<PNG_FILTER_VALUE_UP>,
+        &applyRowFilter<PNG_FILTER_VALUE_AVG>,
+        &applyRowFilter<PNG_FILTER_VALUE_PAETH>
+    };
+
+    quint64 bestSum = std::numeric_limits<quint64>::max();
+
+    for (int filterType = 0; filterType < int(sizeof(filters) / sizeof(filters[0])); filterType++) {
+        // the up filter is the same as none for the first row
+        if (!prior && filterType == PNG_FILTER_VALUE_UP) continue;
+
+        const quint64 sum = filters[filterType](row, prior, rowBytes, bpp, scratch);
+
+        if (sum < bestSum) {
+            bestSum = sum;
+            dst[0] = quint8(filterType);
+            memcpy(dst + 1, scratch, rowBytes);
+        }
+    }
+}
+
+/**
+ * Writes the image data (IDAT chunks) of a non-interlaced PNG file
+ * using all the available threads.
+ *
+ * The rows are split into blocks that are filtered and deflated
+ * independently. All the blocks except the last one are finished with
+ * a sync flush, which aligns them to a byte boundary, so the compressed
+ * blocks can be simply concatenated into a single zlib stream (the
+ * approach used by pigz). The tail of the previous block is used as a
+ * preset dictionary for the next one, so the compression ratio stays
+ * close to the one of a single deflate stream.
+ *
+ * The rows are fetched from the paint device on demand and only a few
+ * blocks per thread are kept in memory at a time.
+ */
+class ParallelIDATWriter
+{
+public:
+    /**
+     * Fills \p dst with the PNG representation of row \p row of the image
+     */
+    using RowFetcher = std::function<bool (quint8 *dst, int row)>;
+
+    ParallelIDATWriter(QIODevice *device, int numRows, int rowBytes, int bpp, bool useFilters,
+                       int compressionLevel, int compressionStrategy)
+        : m_device(device),
+          m_numRows(numRows),
+          m_rowBytes(rowBytes),
+          m_bpp(bpp),
+          m_useFilters(useFilters),
+          m_compressionLevel(compressionLevel),
+          m_compressionStrategy(compressionStrategy)
+    {
+    }
+
+    KisImportExportErrorCode write(RowFetcher fetchRow)
+    {
+        const int numThreads = qMax(1, QThreadPool::globalInstance()->maxThreadCount());
+        const int rowsPerBlock = qMax(1, blockSize / (m_rowBytes + 1));
+        const int numBlocks = (m_numRows + rowsPerBlock - 1) / rowsPerBlock;
+        const int blocksPerBatch = 2 * numThreads;
+
+        QByteArray dictionary;
+        uLong adler = adler32(0L, Z_NULL, 0);
+
+        for (int batchStart = 0; batchStart < numBlocks; batchStart += blocksPerBatch) {
+            QVector<Block> blocks(qMin(blocksPerBatch, numBlocks - batchStart));
+
+            KritaUtils::processRangeConcurrently(blocks.size(), 1,
+                [&] (int begin, int end) {
+                    for (int i = begin; i < end; i++) {
+                        const int firstRow = (batchStart + i) * rowsPerBlock;
+                        const int lastRow = qMin(m_numRows, firstRow + rowsPerBlock);
+                        blocks[i].success = filterBlock(fetchRow, firstRow, lastRow, blocks[i]);
+                    }
+                });
+
+            for (const Block &block : blocks) {
+                if (!block.success) {
+                    return ImportExportCodes::FormatColorSpaceUnsupported;
+                }
+            }
+
+            KritaUtils::processRangeConcurrently(blocks.size(), 1,
+                [&] (int begin, int end) {
+                    for (int i = begin; i < end; i++) {
+                        const QByteArray &blockDictionary =
+                            i > 0 ? blocks[i - 1].filtered : dictionary;
+                        const bool isLastBlock = batchStart + i == numBlocks - 1;
+                        blocks[i].success = compressBlock(blocks[i], blockDictionary, isLastBlock);
+                    }
+                });
+
+            for (int i = 0; i < blocks.size(); i++) {
+                Block &block = blocks[i];
+
+                if (!block.success) {
+                    return ImportExportCodes::InternalError;
+                }
+
+                adler = adler32_combine(adler, block.adler, block.filtered.size());
+
+                if (batchStart + i == 0) {
+                    block.compressed.prepend(zlibHeader());
+                }
+
+                if (batchStart + i == numBlocks - 1) {
+                    block.compressed.append(bigEndianBytes(adler));
+                }
+
+                if (!writeChunk("IDAT", block.compressed)) {
+                    return ImportExportCodes::ErrorWhileWriting;
+                }
+            }
+
+            dictionary = blocks.last().filtered.right(maxDictionarySize);
+        }
+
+        return writeChunk("IEND", QByteArray()) ?
+            ImportExportCodes::OK : ImportExportCodes::ErrorWhileWriting;
+    }
+
+private:
+    struct Block {
+        QByteArray filtered;
+        QByteArray compressed;
+        uLong adler = 0;
+        bool success = false;
+    };
+
+    bool filterBlock(const RowFetcher &fetchRow, int firstRow, int lastRow, Block &block) const
+    {
+        QVector<quint8> buffer(3 * m_rowBytes);
+        quint8 *row = buffer.data();
+        quint8 *prior = row + m_rowBytes;
+        quint8 *scratch = prior + m_rowBytes;
+
+        block.filtered.resize((lastRow - firstRow) * (m_rowBytes + 1));
+        quint8 *dst = reinterpret_cast<quint8*>(block.filtered.data());
+
+        bool hasPrior = false;
+
+        if (m_useFilters && firstRow > 0) {
+            if (!fetchRow(prior, firstRow - 1)) return false;
+            hasPrior = true;
+        }
+
+        for (int y = firstRow; y < lastRow; y++) {
+            if (!fetchRow(row, y)) return false;
+
+            if (m_useFilters) {
+                filterRowAdaptive(row, hasPrior ? prior : 0, m_rowBytes, m_bpp, dst, scratch);
+                std::swap(row, prior);
+                hasPrior = true;
+            } else {
+                dst[0] = PNG_FILTER_VALUE_NONE;
+                memcpy(dst + 1, row, m_rowBytes);
+            }
+
+            dst += m_rowBytes + 1;
+        }
+
+        block.adler = adler32(adler32(0L, Z_NULL, 0),
+                              reinterpret_cast<const Bytef*>(block.filtered.constData()),
+                              block.filtered.size());
+        return true;
+    }
+
+    bool compressBlock(Block &block, const QByteArray &dictionary, bool isLastBlock) const
+    {
+        z_stream stream;
+        memset(&stream, 0, sizeof(stream));
+
+        if (deflateInit2(&stream, m_compressionLevel, Z_DEFLATED, -MAX_WBITS, 8, m_compressionStrategy) != Z_OK) {
+            return false;
+        }
+
+        const QByteArray dictionaryTail = dictionary.right(maxDictionarySize);
+        if (!dictionaryTail.isEmpty()) {
+            deflateSetDictionary(&stream,
+                                 reinterpret_cast<const Bytef*>(dictionaryTail.constData()),
+                                 dictionaryTail.size());
+        }
+
+        const int flush = isLastBlock ? Z_FINISH : Z_SYNC_FLUSH;
+
+        stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(block.filtered.constData()));
+        stream.avail_in = block.filtered.size();
+
+        // the sync flush marker and the empty blocks need a few extra bytes
+        block.compressed.resize(deflateBound(&stream, block.filtered.size()) + 64);
+
+        int written = 0;
+        bool success = true;
+
+        forever {
+            stream.next_out = reinterpret_cast<Bytef*>(block.compressed.data() + written);
+            stream.avail_out = block.compressed.size() - written;
+
+            const int result = deflate(&stream, flush);
+            written = block.compressed.size() - stream.avail_out;
+
+            if (result == Z_STREAM_ERROR) {
+                success = false;
+                break;
+            }
+
+            if (isLastBlock ? result == Z_STREAM_END : stream.avail_out > 0) {
+                break;
+            }
+
+            block.compressed.resize(2 * block.compressed.size());
+        }
+
+        deflateEnd(&stream);
+        block.compressed.resize(written);
+
+        return success;
+    }
+
+    QByteArray zlibHeader() const
+    {
+        const int cmf = 0x78; // deflate with 32K window
+        const int level =
+            m_compressionLevel < 0 ? 2 :
+            m_compressionLevel < 2 ? 0 :
+            m_compressionLevel < 6 ? 1 :
+            m_compressionLevel == 6 ? 2 : 3;
+
+        int flg = level << 6;
+        flg += 31 - (cmf * 256 + flg) % 31;
+
+        QByteArray header;
+        header.append(char(cmf));
+        header.append(char(flg));
+        return header;
+    }
+
+    static QByteArray bigEndianBytes(quint32 value)
+    {
+        QByteArray bytes(4, 0);
+        qToBigEndian(value, reinterpret_cast<uchar*>(bytes.data()));
+        return bytes;
+    }
+
+    bool writeChunk(const char *type, const QByteArray &data)
+    {
+        QByteArray chunk;
+        chunk.reserve(data.size() + 12);
+        chunk.append(bigEndianBytes(data.size()));
+        chunk.append(type, 4);
+        chunk.append(data);
+
+        const uLong crc = crc32(crc32(0L, Z_NULL, 0),
+                                reinterpret_cast<const Bytef*>(chunk.constData() + 4),
+                                chunk.size() - 4);
+        chunk.append(bigEndianBytes(crc));
+
+        return m_device->write(chunk) == chunk.size();
+    }
+
+private:
+    static constexpr int blockSize = 1 << 20;
+    static constexpr int maxDictionarySize = 32768;
+
+    QIODevice *m_device = 0;
+    const int m_numRows;
+    const int m_rowBytes;
+    const int m_bpp;
+    const bool m_useFilters;
+    const int m_compressionLevel;
+    const int m_compressionStrategy;
+};
+
+}
+
 KisImportExportErrorCode KisPNGConverter::buildImage(QIODevice* iod)
 {
     dbgFile << "Start decoding PNG File";
@@ -1028,7 +1394,7 @@ KisImportExportErrorCode KisPNGConverter::buildFile(QIODevice* iodevice, const Q
 
     /* set other zlib parameters */
     png_set_compression_mem_level(png_ptr, 8);
-    png_set_compression_strategy(png_ptr, Z_DEFAULT_STRATEGY);
+    png_set_compression_strategy(png_ptr, zlibCompressionStrategy(options.compressionStrategy));
     png_set_compression_window_bits(png_ptr, 15);
     png_set_compression_method(png_ptr, 8);
     png_set_compression_buffer_size(png_ptr, 8192);
@@ -1294,57 +1660,26 @@ KisImportExportErrorCode KisPNGConverter::buildFile(QIODevice* iodevice, const Q
     png_write_info(png_ptr, info_ptr);
     png_write_flush(png_ptr);
 
-    // swap byteorder on little endian machines.
-#ifndef WORDS_BIGENDIAN
-    if (color_nb_bits > 8)
-        png_set_swap(png_ptr);
-#endif
-
-    // Write the PNG
-    //     png_write_png(png_ptr, info_ptr, PNG_TRANSFORM_IDENTITY, 0);
-
-    struct RowPointersStruct {
-        RowPointersStruct(const QSize &size, int pixelSize)
-            : numRows(size.height())
-        {
-            rows = new png_byte*[numRows];
-
-            for (int i = 0; i < numRows; i++) {
-                rows[i] = new png_byte[size.width() * pixelSize];
-            }
-        }
-
-        ~RowPointersStruct() {
-            for (int i = 0; i < numRows; i++) {
-                delete[] rows[i];
-            }
-            delete[] rows;
-        }
-
-        const int numRows = 0;
-        png_byte** rows = 0;
-    };
-
-
-    // Fill the data structure
-    RowPointersStruct rowPointers(imageRect.size(), device->pixelSize());
-
-    int row = 0;
-    for (int y = imageRect.y(); y < imageRect.y() + imageRect.height(); y++, row++) {
-        KisHLineConstIteratorSP it = device->createHLineConstIteratorNG(imageRect.x(), y, imageRect.width());
+    /**
+     * Converts row \p y of the image into the PNG pixel layout. The rows are
+     * fetched directly from the device, so the image is never materialized
+     * in memory as a whole.
+     */
+    auto fillRow = [&] (quint8 *dst8, int y) {
+        KisHLineConstIteratorSP it = device->createHLineConstIteratorNG(imageRect.x(), imageRect.y() + y, imageRect.width());
 
         switch (color_type) {
         case PNG_COLOR_TYPE_GRAY:
         case PNG_COLOR_TYPE_GRAY_ALPHA:
             if (color_nb_bits == 16) {
-                quint16 *dst = reinterpret_cast<quint16 *>(rowPointers.rows[row]);
+                quint16 *dst = reinterpret_cast<quint16 *>(dst8);
                 do {
                     const quint16 *d = reinterpret_cast<const quint16 *>(it->oldRawData());
                     *(dst++) = d[0];
                     if (options.alpha) *(dst++) = d[1];
                 } while (it->nextPixel());
             } else {
-                quint8 *dst = rowPointers.rows[row];
+                quint8 *dst = dst8;
                 do {
                     const quint8 *d = it->oldRawData();
                     *(dst++) = d[0];
@@ -1355,7 +1690,7 @@ KisImportExportErrorCode KisPNGConverter::buildFile(QIODevice* iodevice, const Q
         case PNG_COLOR_TYPE_RGB:
         case PNG_COLOR_TYPE_RGB_ALPHA:
             if (color_nb_bits == 16) {
-                quint16 *dst = reinterpret_cast<quint16 *>(rowPointers.rows[row]);
+                quint16 *dst = reinterpret_cast<quint16 *>(dst8);
                 do {
                     const quint16 *d = reinterpret_cast<const quint16 *>(it->oldRawData());
                     *(dst++) = d[2];
@@ -1364,7 +1699,7 @@ KisImportExportErrorCode KisPNGConverter::buildFile(QIODevice* iodevice, const Q
                     if (options.alpha) *(dst++) = d[3];
                 } while (it->nextPixel());
             } else {
-                quint8 *dst = rowPointers.rows[row];
+                quint8 *dst = dst8;
                 do {
                     const quint8 *d = it->oldRawData();
                     *(dst++) = d[2];
@@ -1375,7 +1710,7 @@ KisImportExportErrorCode KisPNGConverter::buildFile(QIODevice* iodevice, const Q
             }
             break;
         case PNG_COLOR_TYPE_PALETTE: {
-            quint8 *dst = rowPointers.rows[row];
+            quint8 *dst = dst8;
             KisPNGWriteStream writestream(dst, color_nb_bits);
             do {
                 const quint8 *d = it->oldRawData();
@@ -1392,11 +1727,70 @@ KisImportExportErrorCode KisPNGConverter::buildFile(QIODevice* iodevice, const Q
         }
             break;
         default:
-            return ImportExportCodes::FormatColorSpaceUnsupported;
+            return false;
         }
+
+        return true;
+    };
+
+    if (options.parallelCompression && interlace_type == PNG_INTERLACE_NONE) {
+        const int channels = png_get_channels(png_ptr, info_ptr);
+        const int rowBytes = (imageRect.width() * channels * color_nb_bits + 7) / 8;
+        const int bpp = qMax(1, channels * color_nb_bits / 8);
+
+        /**
+         * PNG specification recommends to use no filtering for
+         * palette-based images and images with low bit depth
+         */
+        const bool useFilters = color_type != PNG_COLOR_TYPE_PALETTE && color_nb_bits >= 8;
+
+        ParallelIDATWriter writer(iodevice, imageRect.height(), rowBytes, bpp, useFilters,
+                                  options.compression, zlibCompressionStrategy(options.compressionStrategy));
+
+        const KisImportExportErrorCode result = writer.write(
+            [&] (quint8 *dst, int y) {
+                if (!fillRow(dst, y)) return false;
+
+                // PNG stores 16-bit samples in network byte order
+#ifndef WORDS_BIGENDIAN
+                if (color_nb_bits == 16) {
+                    quint16 *samples = reinterpret_cast<quint16*>(dst);
+                    for (int i = 0; i < rowBytes / 2; i++) {
+                        samples[i] = qbswap(samples[i]);
+                    }
+                }
+#endif
+                return true;
+            });
+
+        // the image data and the end of the file are written by the writer
+        png_destroy_write_struct(&png_ptr, &info_ptr);
+        return result;
     }
 
-    png_write_image(png_ptr, rowPointers.rows);
+    // swap byteorder on little endian machines.
+#ifndef WORDS_BIGENDIAN
+    if (color_nb_bits > 8)
+        png_set_swap(png_ptr);
+#endif
+
+    QVector<png_byte> rowBuffer(png_get_rowbytes(png_ptr, info_ptr));
+
+    /**
+     * Stream the rows into libpng one by one. For interlaced images libpng
+     * needs every row once per pass, it picks the pixels of the pass itself.
+     */
+    const int numPasses = png_set_interlace_handling(png_ptr);
+
+    for (int pass = 0; pass < numPasses; pass++) {
+        for (int y = 0; y < imageRect.height(); y++) {
+            if (!fillRow(rowBuffer.data(), y)) {
+                png_destroy_write_struct(&png_ptr, &info_ptr);
+                return ImportExportCodes::FormatColorSpaceUnsupported;
+            }
+            png_write_row(png_ptr, rowBuffer.data());
+        }
+    }
 
     // Writing is over
     png_write_end(png_ptr, info_ptr);
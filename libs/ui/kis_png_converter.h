@@ -30,8 +30,20 @@ class Store;
 }
 
 struct KisPNGOptions {
+    /**
+     * The zlib strategy used for compressing the image data
+     */
+    enum CompressionStrategy {
+        DefaultStrategy = 0,
+        FilteredStrategy,
+        HuffmanOnlyStrategy,
+        RLEStrategy
+    };
+
     KisPNGOptions()
         : compression(0)
+        , compressionStrategy(DefaultStrategy)
+        , parallelCompression(true)
         , interlace(false)
         , alpha(true)
         , exif(true)
@@ -48,6 +60,8 @@ struct KisPNGOptions {
     {}
 
     int compression;
+    CompressionStrategy compressionStrategy;
+    bool parallelCompression; // Compresses blocks of rows in multiple threads (non-interlaced images only)
     bool interlace;
     bool alpha;
     bool exif;
@@ -582,6 +582,15 @@ void KisOpenGLCanvasRenderer::setLodResetInProgress(bool value)
     d->lodSwitchInProgress = value;
 }
 
+void KisOpenGLCanvasRenderer::setDisplayLevelOfDetail(int lod)
+{
+    const QRect refetchRect = d->openGLImageTextures->setDisplayLevelOfDetail(lod);
+
+    if (!refetchRect.isEmpty()) {
+        canvas()->startUpdateInPatches(refetchRect);
+    }
+}
+
 void KisOpenGLCanvasRenderer::drawBackground(const QRect &updateRect)
 {
     Q_UNUSED(updateRect);
@@ -1117,7 +1126,7 @@ KisUpdateInfoSP KisOpenGLCanvasRenderer::startUpdateCanvasProjection(const QRect
         d->openGLImageTextures->setProofingConfig(canvas()->proofingConfiguration());
         canvas()->setProofingConfigUpdated(false);
     }
-    return d->openGLImageTextures->updateCache(rc, d->openGLImageTextures->image());
+    return d->openGLImageTextures->updateCacheAtDisplayLevelOfDetail(rc, d->openGLImageTextures->image());
 }
 
 
@@ -85,6 +85,7 @@ public:
     QRect updateCanvasProjection(KisUpdateInfoSP info);
 
     void setLodResetInProgress(bool value);
+    void setDisplayLevelOfDetail(int lod);
 
 private:
     void setDisplayFilterImpl(QSharedPointer<KisDisplayFilter> displayFilter, bool initializing);
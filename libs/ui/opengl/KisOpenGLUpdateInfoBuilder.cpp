@@ -10,10 +10,25 @@
 #include "opengl/kis_texture_tile_info_pool.h"
 
 #include "KisProofingConfiguration.h"
+#include "opengl/kis_opengl_canvas_debugger.h"
+#include "KisConcurrentRangeUtils.h"
 
 #include <QReadWriteLock>
 #include <QReadLocker>
 #include <QWriteLocker>
+#include <QElapsedTimer>
+#include <KisPerformanceTracer.h>
+
+namespace {
+
+/**
+ * The updates smaller than this amount of pixels are converted in
+ * the calling thread, since the threading overhead would exceed the
+ * conversion cost for them (e.g. for small brush dabs)
+ */
+constexpr int minPixelsForConcurrentConversion = 128 * 128;
+
+}
 
 
 struct KRITAUI_NO_EXPORT KisOpenGLUpdateInfoBuilder::Private
@@ -38,6 +53,9 @@ struct KRITAUI_NO_EXPORT KisOpenGLUpdateInfoBuilder::Private
 KisOpenGLUpdateInfoBuilder::KisOpenGLUpdateInfoBuilder()
     : m_d(new Private)
 {
+    // make sure the debugger is created in the GUI thread,
+    // since the updates are built in the worker threads
+    (void) KisOpenglCanvasDebugger::instance();
 }
 
 KisOpenGLUpdateInfoBuilder::~KisOpenGLUpdateInfoBuilder()
@@ -51,6 +69,8 @@ KisOpenGLUpdateInfoSP KisOpenGLUpdateInfoBuilder::buildUpdateInfo(const QRect &r
 
 KisOpenGLUpdateInfoSP KisOpenGLUpdateInfoBuilder::buildUpdateInfo(const QRect &rect, KisPaintDeviceSP projection, const QRect &bounds, int levelOfDetail, bool convertColorSpace)
 {
+    KIS_TRACE_SCOPE("canvas", "KisOpenGLUpdateInfoBuilder::buildUpdateInfo");
+
     KisOpenGLUpdateInfoSP info = new KisOpenGLUpdateInfo();
 
     QRect updateRect = rect & bounds;
@@ -115,7 +135,6 @@ KisOpenGLUpdateInfoSP KisOpenGLUpdateInfoBuilder::buildUpdateInfo(const QRect &r
     }
 
     qint32 numItems = (lastColumn - firstColumn + 1) * (lastRow - firstRow + 1);
-    info->tileList.reserve(numItems);
 
     QRect alignedUpdateRect = updateRect;
     QRect alignedBounds = bounds;
@@ -125,6 +144,10 @@ KisOpenGLUpdateInfoSP KisOpenGLUpdateInfoBuilder::buildUpdateInfo(const QRect &r
         alignedBounds = KisLodTransform::alignedRect(alignedBounds, levelOfDetail);
     }
 
+    KisTextureTileUpdateInfoSPList validTiles;
+    validTiles.reserve(numItems);
+    qint64 totalPixels = 0;
+
     for (int col = firstColumn; col <= lastColumn; col++) {
         for (int row = firstRow; row <= lastRow; row++) {
 
@@ -139,6 +162,29 @@ KisOpenGLUpdateInfoSP KisOpenGLUpdateInfoBuilder::buildUpdateInfo(const QRect &r
                                                      m_d->pool));
             // Don't update empty tiles
             if (tileInfo->valid()) {
+                totalPixels += tileInfo->realPatchSize().width() * tileInfo->realPatchSize().height();
+                validTiles.append(tileInfo);
+            }
+            else {
+                dbgUI << "Trying to create an empty tileinfo record" << col << row << alignedTileTextureRect << updateRect << bounds;
+            }
+        }
+    }
+
+    QElapsedTimer conversionTimer;
+    conversionTimer.start();
+
+    /**
+     * The tiles are independent from each other, so the fetching
+     * and the conversion of the tiles is spread over the worker threads.
+     * The shared state of the builder is protected by the read lock
+     * held by this thread until all the tiles are processed.
+     */
+    auto processTiles =
+        [&] (int begin, int end) {
+            for (int i = begin; i < end; i++) {
+                const KisTextureTileUpdateInfoSP &tileInfo = validTiles.at(i);
+
                 tileInfo->retrieveData(projection, channelFlags, m_d->onlyOneChannelSelected, m_d->selectedChannelIndex);
 
                 if (convertColorSpace) {
@@ -148,14 +194,16 @@ KisOpenGLUpdateInfoSP KisOpenGLUpdateInfoBuilder::buildUpdateInfo(const QRect &r
                         tileInfo->convertTo(m_d->conversionOptions.m_destinationColorSpace, m_d->conversionOptions.m_renderingIntent, m_d->conversionOptions.m_conversionFlags);
                     }
                 }
-
-                info->tileList.append(tileInfo);
             }
-            else {
-                dbgUI << "Trying to create an empty tileinfo record" << col << row << alignedTileTextureRect << updateRect << bounds;
-            }
-        }
-    }
+        };
+
+    KritaUtils::processRangeConcurrently(validTiles.size(),
+                                         totalPixels >= minPixelsForConcurrentConversion ? 1 : validTiles.size(),
+                                         processTiles);
+
+    KisOpenglCanvasDebugger::instance()->notifyTextureConversion(validTiles.size(), conversionTimer.nsecsElapsed());
+
+    info->tileList = validTiles;
 
     info->assignDirtyImageRect(rect);
     info->assignLevelOfDetail(levelOfDetail);
@@ -226,6 +274,13 @@ void KisOpenGLUpdateInfoBuilder::setTextureBorder(int value)
     m_d->textureBorder = value;
 }
 
+int KisOpenGLUpdateInfoBuilder::textureBorder() const
+{
+    QReadLocker lock(&m_d->lock);
+
+    return m_d->textureBorder;
+}
+
 void KisOpenGLUpdateInfoBuilder::setEffectiveTextureSize(const QSize &size)
 {
     QWriteLocker lock(&m_d->lock);
@@ -233,6 +288,13 @@ void KisOpenGLUpdateInfoBuilder::setEffectiveTextureSize(const QSize &size)
     m_d->effectiveTextureSize = size;
 }
 
+QSize KisOpenGLUpdateInfoBuilder::effectiveTextureSize() const
+{
+    QReadLocker lock(&m_d->lock);
+
+    return m_d->effectiveTextureSize;
+}
+
 void KisOpenGLUpdateInfoBuilder::setTextureInfoPool(KisTextureTileInfoPoolSP pool)
 {
     QWriteLocker lock(&m_d->lock);
@@ -52,7 +52,10 @@ public:
     void setChannelFlags(const QBitArray &channelFrags, bool onlyOneChannelSelected, int selectedChannelIndex);
 
     void setTextureBorder(int value);
+    int textureBorder() const;
+
     void setEffectiveTextureSize(const QSize &size);
+    QSize effectiveTextureSize() const;
 
     void setTextureInfoPool(KisTextureTileInfoPoolSP pool);
     KisTextureTileInfoPoolSP textureInfoPool() const;
@@ -19,6 +19,7 @@
 #include "kis_debug.h"
 #include <KisViewManager.h>
 #include "KisRepaintDebugger.h"
+#include <KisPerformanceTracer.h>
 
 #include <QPointer>
 #include "KisOpenGLModeProber.h"
@@ -197,6 +198,8 @@ void KisOpenGLCanvas2::resizeGL(int width, int height)
 
 void KisOpenGLCanvas2::paintGL()
 {
+    KIS_TRACE_SCOPE("canvas", "KisOpenGLCanvas2::paintGL");
+
     const QRect updateRect = d->updateRect ? *d->updateRect : QRect();
 
     if (!OPENGL_SUCCESS) {
@@ -287,6 +290,11 @@ void KisOpenGLCanvas2::setLodResetInProgress(bool value)
     d->renderer->setLodResetInProgress(value);
 }
 
+void KisOpenGLCanvas2::setDisplayLevelOfDetail(int lod)
+{
+    d->renderer->setDisplayLevelOfDetail(lod);
+}
+
 void KisOpenGLCanvas2::slotConfigChanged()
 {
     d->renderer->updateConfig();
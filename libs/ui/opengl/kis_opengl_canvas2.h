@@ -85,6 +85,7 @@ public: // Implement kis_abstract_canvas_widget interface
 
     bool isBusy() const override;
     void setLodResetInProgress(bool value) override;
+    void setDisplayLevelOfDetail(int lod) override;
 
     KisOpenGLImageTexturesSP openGLImageTextures() const;
 
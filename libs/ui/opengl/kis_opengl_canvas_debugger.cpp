@@ -10,6 +10,8 @@
 
 #include <QElapsedTimer>
 #include <QDebug>
+#include <QMutex>
+#include <QMutexLocker>
 
 #include "kis_config.h"
 #include <kis_config_notifier.h>
@@ -32,6 +34,11 @@ struct KisOpenglCanvasDebugger::Private
     int syncFlaggedCounter;
     int syncFlaggedSum;
 
+    QMutex conversionLock;
+    int conversionUpdatesCounter = 0;
+    qint64 conversionTilesSum = 0;
+    qint64 conversionTimeSum = 0;
+
     bool isEnabled;
 };
 
@@ -107,3 +114,23 @@ void KisOpenglCanvasDebugger::notifySyncStatus(bool isBusy)
         m_d->syncFlaggedCounter = 0;
     }
 }
+
+void KisOpenglCanvasDebugger::notifyTextureConversion(int numTiles, qint64 nsecs)
+{
+    if (!m_d->isEnabled) return;
+
+    QMutexLocker l(&m_d->conversionLock);
+
+    m_d->conversionUpdatesCounter++;
+    m_d->conversionTilesSum += numTiles;
+    m_d->conversionTimeSum += nsecs;
+
+    if (m_d->conversionUpdatesCounter > 100) {
+        qDebug() << "Texture conversion:"
+                 << qreal(m_d->conversionTimeSum) / m_d->conversionUpdatesCounter / 1000000.0 << "ms per update,"
+                 << qreal(m_d->conversionTilesSum) / m_d->conversionUpdatesCounter << "tiles per update";
+        m_d->conversionUpdatesCounter = 0;
+        m_d->conversionTilesSum = 0;
+        m_d->conversionTimeSum = 0;
+    }
+}
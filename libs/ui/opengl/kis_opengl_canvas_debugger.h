@@ -24,6 +24,14 @@ public:
 
     void notifyPaintRequested();
     void notifySyncStatus(bool value);
+
+    /**
+     * Accounts the time spent on converting \p numTiles texture tiles
+     * into the display color space for a single update. Can be called
+     * from any thread.
+     */
+    void notifyTextureConversion(int numTiles, qint64 nsecs);
+
     qreal accumulatedFps();
 
 private Q_SLOTS:
@@ -28,10 +28,13 @@
 #include "KisPart.h"
 #include "KisOpenGLModeProber.h"
 #include "kis_fixed_paint_device.h"
+#include "kis_paint_device.h"
+#include "kis_lod_transform.h"
 #include "KisOpenGLSync.h"
 #include <QVector3D>
 #include "kis_painting_tweaks.h"
 #include "KisOpenGLBufferCreationGuard.h"
+#include <KisPerformanceTracer.h>
 
 /// we use Angle's EGL on Windows, so we need access to
 /// EGL_ANGLE_platform_angle definition
@@ -311,6 +314,10 @@ void KisOpenGLImageTextures::destroyImageTextureTiles()
     m_tileVertexBuffer.destroy();
     m_tileTexCoordBuffer.destroy();
     m_storedImageBounds = QRect();
+
+    QMutexLocker l(&m_downsampledAreaLock);
+    m_downsampledRect = QRect();
+    m_downsampledLevelOfDetail = 0;
 }
 
 KisOpenGLUpdateInfoSP KisOpenGLImageTextures::updateCache(const QRect& rect, KisImageSP srcImage)
@@ -323,6 +330,75 @@ KisOpenGLUpdateInfoSP KisOpenGLImageTextures::updateCacheNoConversion(const QRec
     return updateCacheImpl(rect, m_image, false);
 }
 
+KisOpenGLUpdateInfoSP KisOpenGLImageTextures::updateCacheAtDisplayLevelOfDetail(const QRect& rect, KisImageSP srcImage)
+{
+    if (!m_initialized) return new KisOpenGLUpdateInfo();
+
+    int lod = 0;
+    QRect updateRect;
+
+    {
+        QMutexLocker l(&m_downsampledAreaLock);
+        lod = m_displayLevelOfDetail;
+
+        // the updates of LoD strokes are already downsampled
+        if (!lod || srcImage->currentLevelOfDetail() > 0) {
+            l.unlock();
+            return updateCacheImpl(rect, srcImage, true);
+        }
+
+        /**
+         * The area is recorded before it is downsampled, so if the level
+         * of detail is lowered meanwhile, setDisplayLevelOfDetail()
+         * will request it to be refetched
+         */
+        updateRect = KisLodTransform::alignedRect(rect & srcImage->bounds(), lod);
+        if (updateRect.isEmpty()) return new KisOpenGLUpdateInfo();
+
+        m_downsampledRect |= updateRect;
+        m_downsampledLevelOfDetail = qMax(m_downsampledLevelOfDetail, lod);
+    }
+
+    KisPaintDeviceSP projection = srcImage->projection();
+
+    KisPaintDeviceSP lodDevice = new KisPaintDevice(projection->colorSpace());
+    lodDevice->prepareClone(projection);
+    projection->generateLodCloneDevice(lodDevice, updateRect, lod);
+
+    KisOpenGLUpdateInfoSP info =
+        m_updateInfoBuilder.buildUpdateInfo(updateRect, lodDevice, srcImage->bounds(), lod, true);
+
+    /**
+     * The level of detail has been lowered while downsampling. The area
+     * is being refetched already, and the refetched data may be uploaded
+     * before this update, so drop it instead of overwriting the sharper
+     * data with the downsampled one.
+     */
+    QMutexLocker l(&m_downsampledAreaLock);
+    if (m_displayLevelOfDetail < lod) {
+        return new KisOpenGLUpdateInfo();
+    }
+
+    return info;
+}
+
+QRect KisOpenGLImageTextures::setDisplayLevelOfDetail(int lod)
+{
+    QMutexLocker l(&m_downsampledAreaLock);
+
+    m_displayLevelOfDetail = lod;
+
+    QRect refetchRect;
+
+    if (lod < m_downsampledLevelOfDetail) {
+        refetchRect = m_downsampledRect;
+        m_downsampledRect = QRect();
+        m_downsampledLevelOfDetail = 0;
+    }
+
+    return refetchRect;
+}
+
 // TODO: add sanity checks about the conformance of the passed srcImage!
 KisOpenGLUpdateInfoSP KisOpenGLImageTextures::updateCacheImpl(const QRect& rect, KisImageSP srcImage, bool convertColorSpace)
 {
@@ -332,6 +408,8 @@ KisOpenGLUpdateInfoSP KisOpenGLImageTextures::updateCacheImpl(const QRect& rect,
 
 void KisOpenGLImageTextures::recalculateCache(KisUpdateInfoSP info, bool blockMipmapRegeneration)
 {
+    KIS_TRACE_SCOPE("canvas", "KisOpenGLImageTextures::recalculateCache");
+
     if (!m_initialized) {
         dbgUI << "OpenGL: Tried to edit image texture cache before it was initialized.";
         return;
@@ -6,8 +6,10 @@
 #ifndef KIS_OPENGL_IMAGE_TEXTURES_H_
 #define KIS_OPENGL_IMAGE_TEXTURES_H_
 
+
 #include <QVector>
 #include <QMap>
+#include <QMutex>
 #include <QOpenGLFunctions>
 
 #include "kritaui_export.h"
@@ -155,6 +157,23 @@ public:
     KisOpenGLUpdateInfoSP updateCache(const QRect& rect, KisImageSP srcImage);
     KisOpenGLUpdateInfoSP updateCacheNoConversion(const QRect& rect);
 
+    /**
+     * Same as updateCache(), but when the canvas is displayed at a
+     * nonzero level of detail, the updated area of the projection is
+     * downsampled to this level first. The tiles then get only the
+     * corresponding mipmap plane, so the amount of converted and uploaded
+     * texels is proportional to the displayed area.
+     */
+    KisOpenGLUpdateInfoSP updateCacheAtDisplayLevelOfDetail(const QRect& rect, KisImageSP srcImage);
+
+    /**
+     * Sets the level of detail the canvas is displayed at
+     *
+     * \return the rect that should be refetched from the image, because
+     *         it has been uploaded at a lower resolution than needed now
+     */
+    QRect setDisplayLevelOfDetail(int lod);
+
     void recalculateCache(KisUpdateInfoSP info, bool blockMipmapRegeneration);
 
     void slotImageSizeChanged(qint32 w, qint32 h);
@@ -219,6 +238,17 @@ private:
 
     KisOpenGLUpdateInfoBuilder m_updateInfoBuilder;
 
+    /**
+     * The level of detail of the canvas, the area that has been uploaded
+     * downsampled and the coarsest level of detail used for it. They are
+     * changed together, so that no downsampled update is missed by
+     * setDisplayLevelOfDetail().
+     */
+    QMutex m_downsampledAreaLock;
+    int m_displayLevelOfDetail {0};
+    QRect m_downsampledRect;
+    int m_downsampledLevelOfDetail {0};
+
 private:
     typedef QMap<KisImageWSP, KisOpenGLImageTextures*> ImageTexturesMap;
     static ImageTexturesMap imageTexturesMap;
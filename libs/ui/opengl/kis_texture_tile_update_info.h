@@ -18,6 +18,8 @@
 #include <KoColorConversionTransformation.h>
 #include <KoColorModelStandardIds.h>
 #include <KoColorSpace.h>
+#include <KoColorProfile.h>
+#include <KoOptimizedPixelDataScalerU8ToU16Factory.h>
 #include <kis_lod_transform.h>
 
 class KisTextureTileUpdateInfo;
@@ -188,6 +190,8 @@ public:
         }
 
         if (m_patchRect.isValid()) {
+            if (tryConvertByScaling(dstCS)) return;
+
             const qint32 numPixels = m_patchRect.width() * m_patchRect.height();
             DataBuffer conversionCache(dstCS->pixelSize(), m_pool);
 
@@ -307,6 +311,63 @@ public:
 private:
     Q_DISABLE_COPY(KisTextureTileUpdateInfo)
 
+    /**
+     * When the texture has the same profile as the image and differs
+     * only in bit depth (e.g. a 16-bit image shown on an 8-bit texture),
+     * the conversion is a plain rescaling of the channels, which is done
+     * by a vectorized scaler instead of a full color transformation.
+     */
+    bool tryConvertByScaling(const KoColorSpace *dstCS)
+    {
+        if (m_patchColorSpace->colorModelId() != RGBAColorModelID ||
+            dstCS->colorModelId() != RGBAColorModelID) {
+
+            return false;
+        }
+
+        const KoID srcDepth = m_patchColorSpace->colorDepthId();
+        const KoID dstDepth = dstCS->colorDepthId();
+
+        const bool isU16ToU8 = srcDepth == Integer16BitsColorDepthID && dstDepth == Integer8BitsColorDepthID;
+        const bool isU8ToU16 = srcDepth == Integer8BitsColorDepthID && dstDepth == Integer16BitsColorDepthID;
+
+        if (!isU16ToU8 && !isU8ToU16) return false;
+
+        const KoColorProfile *srcProfile = m_patchColorSpace->profile();
+        const KoColorProfile *dstProfile = dstCS->profile();
+
+        if (!srcProfile || !dstProfile ||
+            (srcProfile != dstProfile && !(*srcProfile == *dstProfile))) {
+
+            return false;
+        }
+
+        static const QScopedPointer<KoOptimizedPixelDataScalerU8ToU16Base> scaler(
+            KoOptimizedPixelDataScalerU8ToU16Factory::createRgbaScaler());
+
+        const int numPixels = m_patchRect.width() * m_patchRect.height();
+        DataBuffer conversionCache(dstCS->pixelSize(), m_pool);
+
+        /**
+         * The patch is stored contiguously, so it is processed as a
+         * single row to let the scaler use the widest vector blocks
+         */
+        if (isU16ToU8) {
+            scaler->convertU16ToU8(m_patchPixels.data(), numPixels * m_patchColorSpace->pixelSize(),
+                                   conversionCache.data(), numPixels * dstCS->pixelSize(),
+                                   1, numPixels);
+        } else {
+            scaler->convertU8ToU16(m_patchPixels.data(), numPixels * m_patchColorSpace->pixelSize(),
+                                   conversionCache.data(), numPixels * dstCS->pixelSize(),
+                                   1, numPixels);
+        }
+
+        m_patchColorSpace = dstCS;
+        conversionCache.swap(m_patchPixels);
+
+        return true;
+    }
+
 private:
     qint32 m_tileCol {0};
     qint32 m_tileRow {0};
@@ -0,0 +1,355 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "KisStrokeRecorder.h"
+
+#include <QDataStream>
+#include <QDateTime>
+#include <QDomDocument>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QGlobalStatic>
+#include <QStandardPaths>
+
+#include "kis_config.h"
+#include "kis_config_notifier.h"
+#include "kis_debug.h"
+#include "kis_distance_information.h"
+#include "kis_node.h"
+#include "kis_paintop_preset.h"
+#include "kis_resources_snapshot.h"
+#include "kis_stroke_random_source.h"
+#include "strokes/KisFreehandStrokeInfo.h"
+
+
+namespace {
+
+const QByteArray recordingFileMagic("KritaStrokeRecording");
+const qint32 recordingFileVersion = 3;
+
+/**
+ * All the floating point values are saved in double precision, so that
+ * the replayed paint information is bit-exact and the dabs are placed
+ * exactly the same way as in the original stroke
+ */
+void setupStream(QDataStream &stream)
+{
+    stream.setFloatingPointPrecision(QDataStream::DoublePrecision);
+}
+
+}
+
+void KisRecordedStroke::addPoint(int strokeInfoId, qreal time, const KisPaintInformation &pi)
+{
+    Job job;
+    job.type = Job::Point;
+    job.strokeInfoId = strokeInfoId;
+    job.time = time;
+    job.pi1 = pi;
+    jobs.append(job);
+}
+
+void KisRecordedStroke::addLine(int strokeInfoId, qreal time, const KisPaintInformation &pi1, const KisPaintInformation &pi2)
+{
+    Job job;
+    job.type = Job::Line;
+    job.strokeInfoId = strokeInfoId;
+    job.time = time;
+    job.pi1 = pi1;
+    job.pi2 = pi2;
+    jobs.append(job);
+}
+
+void KisRecordedStroke::addCurve(int strokeInfoId, qreal time,
+                                 const KisPaintInformation &pi1,
+                                 const QPointF &control1, const QPointF &control2,
+                                 const KisPaintInformation &pi2)
+{
+    Job job;
+    job.type = Job::Curve;
+    job.strokeInfoId = strokeInfoId;
+    job.time = time;
+    job.pi1 = pi1;
+    job.pi2 = pi2;
+    job.control1 = control1;
+    job.control2 = control2;
+    jobs.append(job);
+}
+
+void KisRecordedStroke::toDataStream(QDataStream &stream, bool writePresetXml) const
+{
+    stream << presetName << (writePresetXml ? presetXml : QString()) << nodeName << nodeUuid << startTime;
+    stream << fgColor.toXML() << bgColor.toXML() << opacity << compositeOpId;
+    stream << randomSeed << perStrokeRandomSeed;
+
+    stream << strokeInfos.size();
+    Q_FOREACH (const StartDistance &dist, strokeInfos) {
+        stream << dist.lastPosition
+               << dist.lastAngle
+               << dist.spacingUpdateInterval
+               << dist.timingUpdateInterval;
+    }
+
+    stream << jobs.size();
+    Q_FOREACH (const Job &job, jobs) {
+        stream << quint8(job.type) << qint32(job.strokeInfoId) << job.time;
+
+        job.pi1.toDataStream(stream);
+
+        if (job.type == Job::Curve) {
+            stream << job.control1 << job.control2;
+        }
+
+        if (job.type != Job::Point) {
+            job.pi2.toDataStream(stream);
+        }
+    }
+}
+
+KisRecordedStroke KisRecordedStroke::fromDataStream(QDataStream &stream)
+{
+    KisRecordedStroke stroke;
+
+    stream >> stroke.presetName >> stroke.presetXml >> stroke.nodeName >> stroke.nodeUuid >> stroke.startTime;
+
+    QString fgColorXml;
+    QString bgColorXml;
+    stream >> fgColorXml >> bgColorXml >> stroke.opacity >> stroke.compositeOpId;
+    stroke.fgColor = KoColor::fromXML(fgColorXml);
+    stroke.bgColor = KoColor::fromXML(bgColorXml);
+
+    stream >> stroke.randomSeed >> stroke.perStrokeRandomSeed;
+
+    int numStrokeInfos = 0;
+    stream >> numStrokeInfos;
+
+    for (int i = 0; i < numStrokeInfos && stream.status() == QDataStream::Ok; i++) {
+        StartDistance dist;
+        stream >> dist.lastPosition
+               >> dist.lastAngle
+               >> dist.spacingUpdateInterval
+               >> dist.timingUpdateInterval;
+        stroke.strokeInfos.append(dist);
+    }
+
+    int numJobs = 0;
+    stream >> numJobs;
+
+    for (int i = 0; i < numJobs && stream.status() == QDataStream::Ok; i++) {
+        Job job;
+
+        quint8 type = 0;
+        qint32 strokeInfoId = 0;
+        stream >> type >> strokeInfoId >> job.time;
+
+        if (type > Job::Curve || strokeInfoId < 0 || strokeInfoId >= numStrokeInfos) {
+            stream.setStatus(QDataStream::ReadCorruptData);
+            break;
+        }
+
+        job.type = Job::Type(type);
+        job.strokeInfoId = strokeInfoId;
+        job.pi1 = KisPaintInformation::fromDataStream(stream);
+
+        if (job.type == Job::Curve) {
+            stream >> job.control1 >> job.control2;
+        }
+
+        if (job.type != Job::Point) {
+            job.pi2 = KisPaintInformation::fromDataStream(stream);
+        }
+
+        stroke.jobs.append(job);
+    }
+
+    return stroke;
+}
+
+
+Q_GLOBAL_STATIC(KisStrokeRecorder, s_instance)
+
+struct KisStrokeRecorder::Private
+{
+    bool isEnabled = false;
+    QElapsedTimer recordingTime;
+
+    /// the file of the current recording session
+    QString filePath;
+
+    /// the preset settings of the last stroke written into the file
+    QString lastPresetXml;
+};
+
+KisStrokeRecorder::KisStrokeRecorder()
+    : m_d(new Private)
+{
+    connect(KisConfigNotifier::instance(), SIGNAL(configChanged()), SLOT(slotConfigChanged()));
+    slotConfigChanged();
+}
+
+KisStrokeRecorder::~KisStrokeRecorder()
+{
+}
+
+KisStrokeRecorder *KisStrokeRecorder::instance()
+{
+    return s_instance;
+}
+
+bool KisStrokeRecorder::isEnabled() const
+{
+    return m_d->isEnabled;
+}
+
+void KisStrokeRecorder::slotConfigChanged()
+{
+    KisConfig cfg(true);
+    const bool enableRecording = cfg.enableStrokeRecording();
+
+    if (enableRecording == m_d->isEnabled) return;
+
+    m_d->isEnabled = enableRecording;
+
+    if (enableRecording) {
+        /**
+         * Every session of recording starts a new file, the files of
+         * the previous sessions are never overwritten
+         */
+        m_d->filePath =
+            QStandardPaths::writableLocation(QStandardPaths::GenericDataLocation) +
+            "/krita-strokes-" +
+            QDateTime::currentDateTime().toString("yyyyMMdd-hhmmsszzz") +
+            ".rec";
+
+        m_d->lastPresetXml.clear();
+        m_d->recordingTime.start();
+    }
+}
+
+KisRecordedStrokeSP KisStrokeRecorder::beginStroke(KisResourcesSnapshotSP resources,
+                                                   const QVector<KisFreehandStrokeInfo*> &strokeInfos,
+                                                   const KisStrokeRandomSource &randomSource)
+{
+    if (!m_d->isEnabled) return KisRecordedStrokeSP();
+
+    KisRecordedStrokeSP stroke(new KisRecordedStroke());
+
+    if (resources->currentPaintOpPreset()) {
+        stroke->presetName = resources->currentPaintOpPreset()->name();
+
+        /**
+         * Serializing sanitizes the settings of the preset,
+         * so don't touch the one the stroke will use
+         */
+        KisPaintOpPresetSP preset =
+            resources->currentPaintOpPreset()->clone().dynamicCast<KisPaintOpPreset>();
+
+        QDomDocument doc;
+        QDomElement root = doc.createElement("Preset");
+        preset->toXML(doc, root);
+        doc.appendChild(root);
+
+        stroke->presetXml = doc.toString();
+    }
+
+    stroke->fgColor = resources->currentFgColor();
+    stroke->bgColor = resources->currentBgColor();
+    stroke->opacity = resources->opacity();
+    stroke->compositeOpId = resources->compositeOpId();
+
+    stroke->randomSeed = randomSource.seed();
+    stroke->perStrokeRandomSeed = randomSource.perStrokeSeed();
+
+    if (resources->currentNode()) {
+        stroke->nodeName = resources->currentNode()->name();
+        stroke->nodeUuid = resources->currentNode()->uuid();
+    }
+
+    stroke->startTime = m_d->recordingTime.elapsed();
+
+    Q_FOREACH (KisFreehandStrokeInfo *info, strokeInfos) {
+        KisRecordedStroke::StartDistance dist;
+        dist.lastPosition = info->dragDistance->lastPosition();
+        dist.lastAngle = info->dragDistance->lastDrawingAngle();
+        dist.spacingUpdateInterval = info->dragDistance->getSpacingInterval();
+        dist.timingUpdateInterval = info->dragDistance->getTimingUpdateInterval();
+        stroke->strokeInfos.append(dist);
+    }
+
+    return stroke;
+}
+
+void KisStrokeRecorder::endStroke(KisRecordedStrokeSP stroke)
+{
+    KIS_SAFE_ASSERT_RECOVER_RETURN(stroke);
+    if (!m_d->isEnabled || stroke->jobs.isEmpty()) return;
+
+    QFile file(m_d->filePath);
+    if (!file.open(QFile::WriteOnly | QFile::Append)) {
+        warnUI << "Failed to open the stroke recording file" << file.fileName();
+        return;
+    }
+
+    QDataStream stream(&file);
+    setupStream(stream);
+
+    if (file.size() == 0) {
+        stream << recordingFileMagic << recordingFileVersion;
+        m_d->lastPresetXml.clear();
+    }
+
+    // the preset is usually the same for many strokes in a row
+    const bool writePresetXml = stroke->presetXml != m_d->lastPresetXml;
+    stroke->toDataStream(stream, writePresetXml);
+    m_d->lastPresetXml = stroke->presetXml;
+}
+
+QString KisStrokeRecorder::recordingFilePath() const
+{
+    return m_d->isEnabled ? m_d->filePath : QString();
+}
+
+bool KisStrokeRecorder::loadRecording(const QString &filePath, QVector<KisRecordedStroke> *strokes)
+{
+    QFile file(filePath);
+    if (!file.open(QFile::ReadOnly)) return false;
+
+    QDataStream stream(&file);
+    setupStream(stream);
+
+    QByteArray magic;
+    qint32 version = 0;
+    stream >> magic >> version;
+
+    if (stream.status() != QDataStream::Ok ||
+        magic != recordingFileMagic ||
+        version != recordingFileVersion) {
+
+        return false;
+    }
+
+    QString lastPresetXml;
+
+    while (!stream.atEnd()) {
+        KisRecordedStroke stroke = KisRecordedStroke::fromDataStream(stream);
+
+        /**
+         * The last stroke might have been written only partially
+         * if Krita crashed, so just drop it
+         */
+        if (stream.status() != QDataStream::Ok) break;
+
+        if (stroke.presetXml.isEmpty()) {
+            stroke.presetXml = lastPresetXml;
+        } else {
+            lastPresetXml = stroke.presetXml;
+        }
+
+        strokes->append(stroke);
+    }
+
+    return true;
+}
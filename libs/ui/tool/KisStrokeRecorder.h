@@ -0,0 +1,177 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KISSTROKERECORDER_H
+#define KISSTROKERECORDER_H
+
+#include <QObject>
+#include <QPointF>
+#include <QSharedPointer>
+#include <QUuid>
+#include <QVector>
+
+#include "kis_types.h"
+#include "kritaui_export.h"
+#include <brushengine/kis_paint_information.h>
+#include <KoColor.h>
+
+class KisFreehandStrokeInfo;
+class KisStrokeRandomSource;
+class QDataStream;
+
+
+/**
+ * The input of a single freehand stroke, that is, exactly the jobs
+ * KisToolFreehandHelper has fed to the strokes queue
+ */
+struct KRITAUI_EXPORT KisRecordedStroke
+{
+    /**
+     * The initial state of the distance information of every stroke
+     * info (there are several of them in the multihand tool)
+     */
+    struct StartDistance {
+        QPointF lastPosition;
+        qreal lastAngle = 0.0;
+        qreal spacingUpdateInterval = 0.0;
+        qreal timingUpdateInterval = 0.0;
+    };
+
+    struct Job {
+        enum Type : quint8 {
+            Point = 0,
+            Line,
+            Curve
+        };
+
+        Type type = Point;
+        int strokeInfoId = 0;
+
+        /// the number of milliseconds since the start of the stroke
+        /// when the job has been added to the queue
+        qreal time = 0.0;
+
+        KisPaintInformation pi1;
+        KisPaintInformation pi2;
+        QPointF control1;
+        QPointF control2;
+    };
+
+    QString presetName;
+
+    /**
+     * The full settings of the preset as saved by KisPaintOpPreset::toXML(),
+     * so that the stroke is replayed with the same settings even when
+     * the preset has been modified, but not saved
+     */
+    QString presetXml;
+
+    QString nodeName;
+    QUuid nodeUuid;
+
+    /// the resources the stroke has been painted with
+    KoColor fgColor;
+    KoColor bgColor;
+    quint8 opacity = OPACITY_OPAQUE_U8;
+    QString compositeOpId;
+
+    /// the seeds of the random sources of the stroke (see KisStrokeRandomSource)
+    qint32 randomSeed = 0;
+    qint32 perStrokeRandomSeed = 0;
+
+    /// the number of milliseconds since the start of the recording
+    qint64 startTime = 0;
+
+    QVector<StartDistance> strokeInfos;
+    QVector<Job> jobs;
+
+    void addPoint(int strokeInfoId, qreal time, const KisPaintInformation &pi);
+    void addLine(int strokeInfoId, qreal time, const KisPaintInformation &pi1, const KisPaintInformation &pi2);
+    void addCurve(int strokeInfoId, qreal time,
+                  const KisPaintInformation &pi1,
+                  const QPointF &control1, const QPointF &control2,
+                  const KisPaintInformation &pi2);
+
+    /**
+     * Writes the stroke into \p stream. When \p writePresetXml is
+     * false, the preset settings are omitted, because they are the same
+     * as the ones of the previous stroke in the stream.
+     */
+    void toDataStream(QDataStream &stream, bool writePresetXml = true) const;
+
+    /**
+     * Reads the stroke from \p stream. If the preset settings have been
+     * omitted, presetXml is empty and should be taken from the previous
+     * stroke.
+     */
+    static KisRecordedStroke fromDataStream(QDataStream &stream);
+};
+
+typedef QSharedPointer<KisRecordedStroke> KisRecordedStrokeSP;
+
+
+/**
+ * KisStrokeRecorder captures the freehand strokes painted by the user
+ * into a compact binary file, so that the real artist's workload could
+ * later be replayed with KisStrokeReplayer and used for benchmarking of
+ * the brush engines.
+ *
+ * The recording is enabled with KisConfig::enableStrokeRecording(). Every
+ * finished stroke is appended to the recording file immediately, so
+ * the recording survives a crash. Cancelled strokes are not recorded.
+ */
+class KRITAUI_EXPORT KisStrokeRecorder : public QObject
+{
+    Q_OBJECT
+public:
+    KisStrokeRecorder();
+    ~KisStrokeRecorder();
+
+    static KisStrokeRecorder* instance();
+
+    bool isEnabled() const;
+
+    /**
+     * Starts recording of a new stroke. Must be called from the GUI
+     * thread right before the stroke is started.
+     *
+     * \return the stroke the jobs should be added to or null if the
+     *         recording is disabled
+     */
+    KisRecordedStrokeSP beginStroke(KisResourcesSnapshotSP resources,
+                                    const QVector<KisFreehandStrokeInfo*> &strokeInfos,
+                                    const KisStrokeRandomSource &randomSource);
+
+    /**
+     * Appends the finished \p stroke to the recording file
+     */
+    void endStroke(KisRecordedStrokeSP stroke);
+
+    /**
+     * \return the file the strokes of the current recording session are
+     *         written into or an empty string if the recording is disabled.
+     *         Every session gets a new file named after its start time,
+     *         it is placed next to the Krita usage log.
+     */
+    QString recordingFilePath() const;
+
+    /**
+     * Loads all the strokes saved in the recording \p filePath
+     *
+     * \return false if the file cannot be read or is not a stroke
+     *         recording
+     */
+    static bool loadRecording(const QString &filePath, QVector<KisRecordedStroke> *strokes);
+
+private Q_SLOTS:
+    void slotConfigChanged();
+
+private:
+    struct Private;
+    const QScopedPointer<Private> m_d;
+};
+
+#endif // KISSTROKERECORDER_H
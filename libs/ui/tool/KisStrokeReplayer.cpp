@@ -0,0 +1,286 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "KisStrokeReplayer.h"
+
+#include <QDomDocument>
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QThread>
+
+#include <kundo2magicstring.h>
+
+#include "kis_debug.h"
+#include "kis_distance_information.h"
+#include "kis_image.h"
+#include "kis_layer_utils.h"
+#include "kis_paintop_preset.h"
+#include "kis_resources_snapshot.h"
+#include "kis_stroke_random_source.h"
+#include "KisAsynchronousStrokeUpdateHelper.h"
+#include "KisGlobalResourcesInterface.h"
+#include "KisResourceServerProvider.h"
+#include "KisStrokeRecorder.h"
+#include "strokes/freehand_stroke.h"
+#include "strokes/KisFreehandStrokeInfo.h"
+
+
+namespace {
+
+/**
+ * Collects the latencies reported by the worker threads
+ */
+struct LatencyCollector
+{
+    QElapsedTimer clock;
+
+    QMutex mutex;
+    QVector<qreal> jobLatencies;
+    QVector<qreal> updateLatencies;
+
+    /// submission times of the jobs that are painted,
+    /// but haven't reached the projection yet
+    QVector<qint64> pendingUpdates;
+
+    static qreal toMs(qint64 nsecs) {
+        return qreal(nsecs) / 1000000.0;
+    }
+
+    void reportJobPainted(qint64 submitTime) {
+        const qint64 now = clock.nsecsElapsed();
+
+        QMutexLocker l(&mutex);
+        jobLatencies.append(toMs(now - submitTime));
+        pendingUpdates.append(submitTime);
+    }
+
+    void reportImageUpdated() {
+        const qint64 now = clock.nsecsElapsed();
+
+        QMutexLocker l(&mutex);
+        Q_FOREACH (qint64 submitTime, pendingUpdates) {
+            updateLatencies.append(toMs(now - submitTime));
+        }
+        pendingUpdates.clear();
+    }
+};
+
+class TimedData : public FreehandStrokeStrategy::Data
+{
+public:
+    using FreehandStrokeStrategy::Data::Data;
+
+    qint64 submitTime = 0;
+};
+
+class ReplayStrokeStrategy : public FreehandStrokeStrategy
+{
+public:
+    ReplayStrokeStrategy(KisResourcesSnapshotSP resources,
+                         QVector<KisFreehandStrokeInfo*> strokeInfos,
+                         LatencyCollector *collector)
+        : FreehandStrokeStrategy(resources, strokeInfos,
+                                 kundo2_noi18n("Replayed stroke"),
+                                 FreehandStrokeStrategy::SupportsContinuedInterstrokeData),
+          m_collector(collector)
+    {
+    }
+
+    void doStrokeCallback(KisStrokeJobData *data) override {
+        FreehandStrokeStrategy::doStrokeCallback(data);
+
+        if (TimedData *d = dynamic_cast<TimedData*>(data)) {
+            m_collector->reportJobPainted(d->submitTime);
+        }
+    }
+
+    KisStrokeStrategy* createLodClone(int levelOfDetail) override {
+        Q_UNUSED(levelOfDetail);
+        return 0;
+    }
+
+private:
+    LatencyCollector *m_collector;
+};
+
+TimedData* createJobData(const KisRecordedStroke::Job &job)
+{
+    switch (job.type) {
+    case KisRecordedStroke::Job::Point:
+        return new TimedData(job.strokeInfoId, job.pi1);
+    case KisRecordedStroke::Job::Line:
+        return new TimedData(job.strokeInfoId, job.pi1, job.pi2);
+    case KisRecordedStroke::Job::Curve:
+        return new TimedData(job.strokeInfoId, job.pi1, job.control1, job.control2, job.pi2);
+    }
+
+    return 0;
+}
+
+/**
+ * Restores the preset from the settings stored in the stroke. The
+ * preset with the same name is used if they cannot be loaded.
+ */
+KisPaintOpPresetSP loadPreset(const KisRecordedStroke &stroke)
+{
+    if (!stroke.presetXml.isEmpty()) {
+        QDomDocument doc;
+        if (doc.setContent(stroke.presetXml)) {
+            KisPaintOpPresetSP preset(new KisPaintOpPreset());
+            preset->fromXML(doc.documentElement(), KisGlobalResourcesInterface::instance());
+
+            if (preset->valid()) {
+                return preset;
+            }
+        }
+
+        warnUI << "Failed to load the settings of the replayed preset:" << stroke.presetName;
+    }
+
+    return KisResourceServerProvider::instance()->paintOpPresetServer()->resourceByName(stroke.presetName);
+}
+
+}
+
+struct KisStrokeReplayer::Private
+{
+    KisImageSP image;
+    KisNodeSP fallbackNode;
+    KoCanvasResourceProvider *resourceManager = 0;
+
+    LatencyCollector collector;
+
+    bool replayStroke(const KisRecordedStroke &stroke, Speed speed);
+};
+
+bool KisStrokeReplayer::Private::replayStroke(const KisRecordedStroke &stroke, Speed speed)
+{
+    KisPaintOpPresetSP preset = loadPreset(stroke);
+
+    if (!preset || stroke.strokeInfos.isEmpty()) {
+        warnUI << "Skipping the replayed stroke, the preset is not found:" << stroke.presetName;
+        return false;
+    }
+
+    KisNodeSP node = KisLayerUtils::findNodeByUuid(image->root(), stroke.nodeUuid);
+    if (!node || !node->paintDevice() || !node->isEditable()) {
+        node = fallbackNode;
+    }
+
+    KisResourcesSnapshotSP resources =
+        new KisResourcesSnapshot(image, node, resourceManager, 0, KisNodeList(), preset);
+
+    /**
+     * The snapshot swaps the colors when the "other" color is in use,
+     * and the recorded colors are already the effective ones
+     */
+    if (stroke.fgColor.colorSpace() && stroke.bgColor.colorSpace()) {
+        const bool swapColors = resources->isUsingOtherColor();
+        resources->setFGColorOverride(swapColors ? stroke.bgColor : stroke.fgColor);
+        resources->setBGColorOverride(swapColors ? stroke.fgColor : stroke.bgColor);
+    }
+
+    resources->setOpacity(qreal(stroke.opacity) / OPACITY_OPAQUE_U8);
+
+    if (!stroke.compositeOpId.isEmpty()) {
+        resources->setCompositeOpId(stroke.compositeOpId);
+    }
+
+    QVector<KisFreehandStrokeInfo*> strokeInfos;
+    Q_FOREACH (const KisRecordedStroke::StartDistance &dist, stroke.strokeInfos) {
+        strokeInfos << new KisFreehandStrokeInfo(
+                           KisDistanceInformation(dist.lastPosition,
+                                                  dist.lastAngle,
+                                                  dist.spacingUpdateInterval,
+                                                  dist.timingUpdateInterval,
+                                                  0));
+    }
+
+    ReplayStrokeStrategy *strategy = new ReplayStrokeStrategy(resources, strokeInfos, &collector);
+    strategy->setRandomSource(KisStrokeRandomSource(stroke.randomSeed, stroke.perStrokeRandomSeed));
+
+    KisStrokeId strokeId = image->startStroke(strategy);
+
+    QElapsedTimer strokeTime;
+    strokeTime.start();
+
+    Q_FOREACH (const KisRecordedStroke::Job &job, stroke.jobs) {
+        if (speed == RecordedSpeed) {
+            const qint64 timeToWait = qint64(job.time) - strokeTime.elapsed();
+            if (timeToWait > 0) {
+                QThread::msleep(timeToWait);
+            }
+        }
+
+        TimedData *data = createJobData(job);
+        data->submitTime = collector.clock.nsecsElapsed();
+        image->addJob(strokeId, data);
+    }
+
+    image->addJob(strokeId, new KisAsynchronousStrokeUpdateHelper::UpdateData(true));
+    image->endStroke(strokeId);
+    image->waitForDone();
+
+    return true;
+}
+
+KisStrokeReplayer::KisStrokeReplayer(KisImageSP image, KisNodeSP fallbackNode, KoCanvasResourceProvider *resourceManager)
+    : m_d(new Private)
+{
+    m_d->image = image;
+    m_d->fallbackNode = fallbackNode;
+    m_d->resourceManager = resourceManager;
+}
+
+KisStrokeReplayer::~KisStrokeReplayer()
+{
+}
+
+KisStrokeReplayer::Statistics KisStrokeReplayer::replay(const QVector<KisRecordedStroke> &strokes, Speed speed)
+{
+    Statistics stats;
+
+    {
+        QMutexLocker l(&m_d->collector.mutex);
+        m_d->collector.jobLatencies.clear();
+        m_d->collector.updateLatencies.clear();
+        m_d->collector.pendingUpdates.clear();
+    }
+
+    m_d->collector.clock.start();
+
+    /**
+     * The projection is updated from the worker threads, so the signal
+     * should be handled right there, without waiting for the event loop
+     */
+    LatencyCollector *collector = &m_d->collector;
+    QMetaObject::Connection connection =
+        QObject::connect(m_d->image.data(), &KisImage::sigImageUpdated,
+                         [collector] () { collector->reportImageUpdated(); });
+
+    QElapsedTimer timer;
+
+    Q_FOREACH (const KisRecordedStroke &stroke, strokes) {
+        timer.start();
+
+        if (m_d->replayStroke(stroke, speed)) {
+            stats.totalTime += qreal(timer.nsecsElapsed()) / 1000000.0;
+            stats.numStrokes++;
+            stats.numJobs += stroke.jobs.size();
+        } else {
+            stats.numSkippedStrokes++;
+        }
+    }
+
+    QObject::disconnect(connection);
+
+    QMutexLocker l(&m_d->collector.mutex);
+    stats.jobLatencies = m_d->collector.jobLatencies;
+    stats.updateLatencies = m_d->collector.updateLatencies;
+
+    return stats;
+}
@@ -0,0 +1,83 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KISSTROKEREPLAYER_H
+#define KISSTROKEREPLAYER_H
+
+#include <QScopedPointer>
+#include <QVector>
+
+#include "kis_types.h"
+#include "kritaui_export.h"
+
+struct KisRecordedStroke;
+class KoCanvasResourceProvider;
+
+
+/**
+ * KisStrokeReplayer feeds the strokes recorded by KisStrokeRecorder
+ * back into the strokes queue of an image and measures how fast the
+ * image processes them.
+ *
+ * Two latencies are measured for every job:
+ *
+ * - the job latency: the time between adding the job to the queue and
+ *   the moment the brush has finished painting its dabs
+ * - the update latency: the time between adding the job to the queue and
+ *   the first update of the image projection issued after the job has
+ *   been painted, that is, the moment the dabs become visible
+ *
+ * The strokes are replayed without level of detail, so that the results
+ * do not depend on the zoom of the canvas the strokes were recorded on.
+ */
+class KRITAUI_EXPORT KisStrokeReplayer
+{
+public:
+    enum Speed {
+        RecordedSpeed, ///< every job is added at the same time since the start of the stroke as it was recorded
+        MaximumSpeed   ///< the jobs are added as fast as possible
+    };
+
+    struct Statistics {
+        int numStrokes = 0;
+        int numSkippedStrokes = 0;
+        int numJobs = 0;
+
+        /// the total time spent on painting the strokes, in milliseconds
+        qreal totalTime = 0.0;
+
+        /// the latencies of every job, in milliseconds
+        QVector<qreal> jobLatencies;
+        QVector<qreal> updateLatencies;
+    };
+
+public:
+    /**
+     * \p fallbackNode is the node the stroke is painted on if the node
+     * it was recorded on is not present in \p image
+     */
+    KisStrokeReplayer(KisImageSP image, KisNodeSP fallbackNode, KoCanvasResourceProvider *resourceManager);
+    ~KisStrokeReplayer();
+
+    /**
+     * Replays \p strokes one after another and blocks till the image
+     * processes all of them. Must be called from the GUI thread.
+     *
+     * Every stroke is painted with the recorded preset settings, colors,
+     * opacity, composite op and random seeds, so it produces the same
+     * dabs as the original one. If the preset settings cannot be loaded,
+     * the preset with the recorded name is used instead, and the stroke
+     * is skipped if there is no such preset. The idle time between the
+     * strokes is not reproduced.
+     */
+    Statistics replay(const QVector<KisRecordedStroke> &strokes, Speed speed);
+
+private:
+    struct Private;
+    const QScopedPointer<Private> m_d;
+};
+
+#endif // KISSTROKEREPLAYER_H
@@ -367,6 +367,11 @@ quint8 KisResourcesSnapshot::opacity() const
     return m_d->opacity;
 }
 
+void KisResourcesSnapshot::setCompositeOpId(const QString &compositeOpId)
+{
+    m_d->compositeOpId = compositeOpId;
+}
+
 QString KisResourcesSnapshot::compositeOpId() const
 {
     return m_d->compositeOpId;
@@ -66,6 +66,7 @@ public:
 
     void setOpacity(qreal opacity);
     quint8 opacity() const;
+    void setCompositeOpId(const QString &compositeOpId);
     QString compositeOpId() const;
 
     KoPatternSP currentPattern() const;
@@ -26,10 +26,12 @@
 #include "kis_update_time_monitor.h"
 #include "kis_stabilized_events_sampler.h"
 #include "KisStabilizerDelayedPaintHelper.h"
+#include "KisStrokeRecorder.h"
 #include "kis_config.h"
 
 #include "kis_random_source.h"
 #include "KisPerStrokeRandomSource.h"
+#include "kis_stroke_random_source.h"
 
 #include "strokes/freehand_stroke.h"
 #include "strokes/KisFreehandStrokeInfo.h"
@@ -74,6 +76,7 @@ struct KisToolFreehandHelper::Private
     QVector<KisFreehandStrokeInfo*> strokeInfos;
     KisResourcesSnapshotSP resources;
     KisStrokeId strokeId;
+    KisRecordedStrokeSP recordedStroke;
 
     KisPaintInformation previousPaintInformation;
     KisPaintInformation olderPaintInformation;
@@ -301,13 +304,15 @@ void KisToolFreehandHelper::initPaintImpl(qreal startAngle,
     createPainters(m_d->strokeInfos,
                    startDist);
 
-    KisStrokeStrategy *stroke =
+    FreehandStrokeStrategy *stroke =
         new FreehandStrokeStrategy(m_d->resources,
                                    m_d->strokeInfos,
                                    m_d->transactionText,
                                    FreehandStrokeStrategy::SupportsContinuedInterstrokeData |
                                    FreehandStrokeStrategy::SupportsTimedMergeId);
 
+    m_d->recordedStroke = KisStrokeRecorder::instance()->beginStroke(m_d->resources, m_d->strokeInfos,
+                                                                     stroke->randomSource());
     m_d->strokeId = m_d->strokesFacade->startStroke(stroke);
 
     m_d->history.clear();
@@ -701,6 +706,11 @@ void KisToolFreehandHelper::endPaint()
     m_d->strokesFacade->endStroke(m_d->strokeId);
     m_d->strokeId.clear();
     m_d->infoBuilder->reset();
+
+    if (m_d->recordedStroke) {
+        KisStrokeRecorder::instance()->endStroke(m_d->recordedStroke);
+        m_d->recordedStroke.clear();
+    }
 }
 
 void KisToolFreehandHelper::cancelPaint()
@@ -730,6 +740,7 @@ void KisToolFreehandHelper::cancelPaint()
 
     m_d->strokesFacade->cancelStroke(m_d->strokeId);
     m_d->strokeId.clear();
+    m_d->recordedStroke.clear();
 
 }
 
@@ -976,6 +987,10 @@ void KisToolFreehandHelper::paintAt(int strokeInfoId,
     m_d->strokesFacade->addJob(m_d->strokeId,
                                new FreehandStrokeStrategy::Data(strokeInfoId, pi));
 
+    if (m_d->recordedStroke) {
+        m_d->recordedStroke->addPoint(strokeInfoId, elapsedStrokeTime(), pi);
+    }
+
 }
 
 void KisToolFreehandHelper::paintLine(int strokeInfoId,
@@ -986,6 +1001,10 @@ void KisToolFreehandHelper::paintLine(int strokeInfoId,
     m_d->strokesFacade->addJob(m_d->strokeId,
                                new FreehandStrokeStrategy::Data(strokeInfoId, pi1, pi2));
 
+    if (m_d->recordedStroke) {
+        m_d->recordedStroke->addLine(strokeInfoId, elapsedStrokeTime(), pi1, pi2);
+    }
+
 }
 
 void KisToolFreehandHelper::paintBezierCurve(int strokeInfoId,
@@ -1024,6 +1043,10 @@ void KisToolFreehandHelper::paintBezierCurve(int strokeInfoId,
                                new FreehandStrokeStrategy::Data(strokeInfoId,
                                                                 pi1, control1, control2, pi2));
 
+    if (m_d->recordedStroke) {
+        m_d->recordedStroke->addCurve(strokeInfoId, elapsedStrokeTime(), pi1, control1, control2, pi2);
+    }
+
 }
 
 void KisToolFreehandHelper::createPainters(QVector<KisFreehandStrokeInfo*> &strokeInfos,
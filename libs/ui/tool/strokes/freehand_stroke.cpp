@@ -346,3 +346,13 @@ void FreehandStrokeStrategy::notifyUserEndedStroke()
 {
     m_d->efficiencyMeasurer.notifyCursorMoveFinished();
 }
+
+KisStrokeRandomSource FreehandStrokeStrategy::randomSource() const
+{
+    return m_d->randomSource;
+}
+
+void FreehandStrokeStrategy::setRandomSource(const KisStrokeRandomSource &value)
+{
+    m_d->randomSource = value;
+}
@@ -18,6 +18,8 @@
 #include "kis_lod_transform.h"
 #include "KoColor.h"
 
+class KisStrokeRandomSource;
+
 
 
 class KRITAUI_EXPORT FreehandStrokeStrategy : public KisPainterBasedStrokeStrategy
@@ -197,6 +199,14 @@ public:
     void notifyUserStartedStroke() override;
     void notifyUserEndedStroke() override;
 
+    /**
+     * The random sources the dabs of the stroke are generated with.
+     * The same input painted with the same sources produces the same
+     * dabs. The sources should be set before the stroke is started.
+     */
+    KisStrokeRandomSource randomSource() const;
+    void setRandomSource(const KisStrokeRandomSource &value);
+
 protected:
     FreehandStrokeStrategy(const FreehandStrokeStrategy &rhs, int levelOfDetail);
 
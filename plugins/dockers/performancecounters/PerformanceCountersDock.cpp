@@ -0,0 +1,99 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "PerformanceCountersDock.h"
+
+#include <QHeaderView>
+#include <QTreeWidget>
+
+#include <klocalizedstring.h>
+
+#include <KisPerformanceCounters.h>
+
+PerformanceCountersDock::PerformanceCountersDock()
+    : QDockWidget(i18n("Performance Counters"))
+{
+    m_countersView = new QTreeWidget(this);
+    m_countersView->setColumnCount(3);
+    m_countersView->setHeaderLabels({i18n("Counter"), i18n("Value"), i18n("Per Second")});
+    m_countersView->setRootIsDecorated(false);
+    m_countersView->setSortingEnabled(false);
+    m_countersView->header()->setSectionResizeMode(0, QHeaderView::Stretch);
+    m_countersView->header()->setSectionResizeMode(1, QHeaderView::ResizeToContents);
+    m_countersView->header()->setSectionResizeMode(2, QHeaderView::ResizeToContents);
+    m_countersView->header()->setStretchLastSection(false);
+    setWidget(m_countersView);
+
+    // the counters are sampled by KisPart once a second
+    m_updateTimer.setInterval(1000);
+    connect(&m_updateTimer, SIGNAL(timeout()), SLOT(slotUpdateCounters()));
+}
+
+void PerformanceCountersDock::setCanvas(KoCanvasBase *)
+{
+    setEnabled(true);
+}
+
+void PerformanceCountersDock::setViewManager(KisViewManager *kisview)
+{
+    Q_UNUSED(kisview);
+}
+
+void PerformanceCountersDock::showEvent(QShowEvent *event)
+{
+    QDockWidget::showEvent(event);
+
+    slotUpdateCounters();
+    m_updateTimer.start();
+}
+
+void PerformanceCountersDock::hideEvent(QHideEvent *event)
+{
+    QDockWidget::hideEvent(event);
+
+    m_updateTimer.stop();
+}
+
+void PerformanceCountersDock::slotUpdateCounters()
+{
+    KisPerformanceCounters *counters = KisPerformanceCounters::instance();
+    if (!counters) return;
+
+    const QVector<KisPerformanceCounters::Snapshot> history = counters->history();
+    if (history.isEmpty()) return;
+
+    const KisPerformanceCounters::Snapshot &current = history.last();
+
+    QMap<QString, qreal> rates;
+    if (history.size() > 1) {
+        rates = KisPerformanceCounters::rates(history[history.size() - 2], current);
+    }
+
+    /**
+     * The counters are registered in static initializers of the
+     * plugins, so the set of them may change over time
+     */
+    if (m_countersView->topLevelItemCount() != current.samples.size()) {
+        m_countersView->clear();
+
+        Q_FOREACH (const KisPerformanceCounters::Sample &sample, current.samples) {
+            QTreeWidgetItem *item = new QTreeWidgetItem(m_countersView);
+            item->setText(0, sample.name);
+            item->setTextAlignment(1, Qt::AlignRight | Qt::AlignVCenter);
+            item->setTextAlignment(2, Qt::AlignRight | Qt::AlignVCenter);
+        }
+    }
+
+    for (int i = 0; i < current.samples.size(); i++) {
+        const KisPerformanceCounters::Sample &sample = current.samples[i];
+        QTreeWidgetItem *item = m_countersView->topLevelItem(i);
+
+        item->setText(0, sample.name);
+        item->setText(1, QString::number(sample.value));
+        item->setText(2, sample.type == KisPerformanceCounter::Gauge || !rates.contains(sample.name) ?
+                          QString() : QString::number(rates.value(sample.name), 'f', 1));
+    }
+}
@@ -0,0 +1,45 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef _PERFORMANCE_COUNTERS_DOCK_H_
+#define _PERFORMANCE_COUNTERS_DOCK_H_
+
+#include <QDockWidget>
+#include <QTimer>
+
+#include <kis_mainwindow_observer.h>
+
+class QTreeWidget;
+
+/**
+ * Shows the values of KisPerformanceCounters sampled by KisPart
+ * during the last second. The counters are shown as per second
+ * rates, the gauges are shown as they are.
+ */
+class PerformanceCountersDock : public QDockWidget, public KisMainwindowObserver
+{
+    Q_OBJECT
+public:
+    PerformanceCountersDock();
+
+    QString observerName() override { return "PerformanceCountersDock"; }
+    void setCanvas(KoCanvasBase *canvas) override;
+    void unsetCanvas() override {}
+    void setViewManager(KisViewManager *kisview) override;
+
+protected:
+    void showEvent(QShowEvent *event) override;
+    void hideEvent(QHideEvent *event) override;
+
+private Q_SLOTS:
+    void slotUpdateCounters();
+
+private:
+    QTreeWidget *m_countersView;
+    QTimer m_updateTimer;
+};
+
+#endif
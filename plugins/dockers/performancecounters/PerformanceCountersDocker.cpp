@@ -0,0 +1,54 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+#include "PerformanceCountersDocker.h"
+
+#include <kpluginfactory.h>
+
+#include <KoDockFactoryBase.h>
+#include <KoDockRegistry.h>
+
+#include "PerformanceCountersDock.h"
+
+K_PLUGIN_FACTORY_WITH_JSON(PerformanceCountersDockerPluginFactory,
+                           "krita_performancecountersdocker.json",
+                           registerPlugin<PerformanceCountersDockerPlugin>();)
+
+class PerformanceCountersDockFactory : public KoDockFactoryBase {
+public:
+    PerformanceCountersDockFactory()
+    {
+    }
+
+    QString id() const override
+    {
+        return QString("PerformanceCountersDocker");
+    }
+
+    QDockWidget* createDockWidget() override
+    {
+        PerformanceCountersDock *dockWidget = new PerformanceCountersDock();
+        dockWidget->setObjectName(id());
+        return dockWidget;
+    }
+
+    DockPosition defaultDockPosition() const override
+    {
+        return DockMinimized;
+    }
+};
+
+
+PerformanceCountersDockerPlugin::PerformanceCountersDockerPlugin(QObject *parent, const QVariantList &)
+    : QObject(parent)
+{
+    KoDockRegistry::instance()->add(new PerformanceCountersDockFactory());
+}
+
+PerformanceCountersDockerPlugin::~PerformanceCountersDockerPlugin()
+{
+}
+
+#include "PerformanceCountersDocker.moc"
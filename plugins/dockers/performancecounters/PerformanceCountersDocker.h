@@ -0,0 +1,21 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef _PERFORMANCE_COUNTERS_DOCKER_H_
+#define _PERFORMANCE_COUNTERS_DOCKER_H_
+
+#include <QObject>
+#include <QVariant>
+
+class PerformanceCountersDockerPlugin : public QObject
+{
+    Q_OBJECT
+public:
+    PerformanceCountersDockerPlugin(QObject *parent, const QVariantList &);
+    ~PerformanceCountersDockerPlugin() override;
+};
+
+#endif
@@ -13,8 +13,11 @@
 #include <ImfChannelList.h>
 #include <ImfFrameBuffer.h>
 #include <ImfHeader.h>
+#include <ImfCompression.h>
 #include <ImfInputFile.h>
 #include <ImfOutputFile.h>
+#include <ImfTileDescription.h>
+#include <ImfTiledOutputFile.h>
 
 #include <ImfStringAttribute.h>
 #include "exr_extra_tags.h"
@@ -25,6 +28,7 @@
 #include <QThread>
 
 #include <QFileInfo>
+#include <QSharedPointer>
 
 #include <KoColorSpaceRegistry.h>
 #include <KoCompositeOpRegistry.h>
@@ -40,6 +44,8 @@
 #include <kis_paint_layer.h>
 #include <kis_transaction.h>
 #include "kis_iterator_ng.h"
+#include <kis_sequential_iterator.h>
+#include <KisConcurrentRangeUtils.h>
 #include <kis_exr_layers_sorter.h>
 
 #include <kis_meta_data_entry.h>
@@ -138,16 +144,6 @@ struct EXRConverter::Private {
 
     QString errorMessage;
 
-    template <class WrapperType>
-    void unmultiplyAlpha(typename WrapperType::pixel_type *pixel);
-
-    template<typename _T_>
-    void decodeData4(Imf::InputFile& file, ExrPaintLayerInfo& info, KisPaintLayerSP layer, int width, int xstart, int ystart, int height, Imf::PixelType ptype);
-
-    template<typename _T_>
-    void decodeData1(Imf::InputFile& file, ExrPaintLayerInfo& info, KisPaintLayerSP layer, int width, int xstart, int ystart, int height, Imf::PixelType ptype);
-
-
     QDomDocument loadExtraLayersInfo(const Imf::Header &header);
     bool checkExtraLayersInfoConsistent(const QDomDocument &doc, std::set<std::string> exrLayerNames);
     void makeLayerNamesUnique(QList<ExrPaintLayerSaveInfo>& informationObjects);
@@ -305,12 +301,17 @@ struct GrayPixelWrapper
     pixel_type &pixel;
 };
 
+/**
+ * \return true if the alpha channel of the pixel had to be modified
+ */
 template <class WrapperType>
-void EXRConverter::Private::unmultiplyAlpha(typename WrapperType::pixel_type *pixel)
+bool unmultiplyAlpha(typename WrapperType::pixel_type *pixel)
 {
     typedef typename WrapperType::pixel_type pixel_type;
     typedef typename WrapperType::channel_type channel_type;
 
+    bool alphaWasModified = false;
+
     WrapperType srcPixel(*pixel);
 
     if (!srcPixel.checkMultipliedColorsConsistent()) {
@@ -341,6 +342,8 @@ void EXRConverter::Private::unmultiplyAlpha(typename WrapperType::pixel_type *pi
     } else if (srcPixel.alpha() > 0.0) {
         srcPixel.setUnmultiplied(srcPixel.pixel, srcPixel.alpha());
     }
+
+    return alphaWasModified;
 }
 
 template <typename T, typename Pixel, int size, int alphaPos>
@@ -361,112 +364,305 @@ void multiplyAlpha(Pixel *pixel)
     }
 }
 
+/**
+ * The height of the tiles of Krita's paint devices. The strips of
+ * scanlines and the tiles of EXR files are aligned to it, so that
+ * different threads never access the same tile of a paint device.
+ */
+const int exrTileSize = 64;
+
+/**
+ * Limits the size of the strips of scanlines read from (or written
+ * into) the file at once, including the data of all the layers
+ */
+const qint64 exrStripMemoryLimit = 128 * 1024 * 1024;
+
+inline int alignDownToTile(int y)
+{
+    return y - ((y % exrTileSize) + exrTileSize) % exrTileSize;
+}
+
+/**
+ * \return the number of scanlines in a strip when every scanline
+ * takes \p bytesPerRow bytes
+ */
+int stripHeight(qint64 bytesPerRow)
+{
+    const qint64 numTiles = exrStripMemoryLimit / qMax(qint64(1), bytesPerRow) / exrTileSize;
+    return int(qMax(qint64(1), numTiles)) * exrTileSize;
+}
+
+/**
+ * A decoder fetches the channels of a single layer from a strip of
+ * scanlines of the file and writes them into the layer's device
+ */
+class Decoder
+{
+public:
+    virtual ~Decoder() {}
+    virtual qint64 bytesPerRow() const = 0;
+    virtual void prepareFrameBuffer(Imf::FrameBuffer *frameBuffer, int ystart, int numRows) = 0;
+
+    /**
+     * Writes \p numRows rows of the strip starting at \p y into the device
+     * \return true if the alpha channel of some pixels had to be modified
+     */
+    virtual bool decodeData(int y, int numRows) = 0;
+};
+
 template<typename _T_>
-void EXRConverter::Private::decodeData4(Imf::InputFile& file, ExrPaintLayerInfo& info, KisPaintLayerSP layer, int width, int xstart, int ystart, int height, Imf::PixelType ptype)
+class RgbDecoderImpl : public Decoder
 {
-    typedef Rgba<_T_> Rgba;
-
-    QVector<Rgba> pixels(width * height);
-
-    bool hasAlpha = info.channelMap.contains("A");
-
-    Imf::FrameBuffer frameBuffer;
-    Rgba* frameBufferData = (pixels.data()) - xstart - ystart * width;
-    frameBuffer.insert(info.channelMap["R"].toLatin1().constData(),
-            Imf::Slice(ptype, (char *) &frameBufferData->r,
-                       sizeof(Rgba) * 1,
-                       sizeof(Rgba) * width));
-    frameBuffer.insert(info.channelMap["G"].toLatin1().constData(),
-            Imf::Slice(ptype, (char *) &frameBufferData->g,
-                       sizeof(Rgba) * 1,
-                       sizeof(Rgba) * width));
-    frameBuffer.insert(info.channelMap["B"].toLatin1().constData(),
-            Imf::Slice(ptype, (char *) &frameBufferData->b,
-                       sizeof(Rgba) * 1,
-                       sizeof(Rgba) * width));
-    if (hasAlpha) {
-        frameBuffer.insert(info.channelMap["A"].toLatin1().constData(),
-                Imf::Slice(ptype, (char *) &frameBufferData->a,
-                           sizeof(Rgba) * 1,
-                           sizeof(Rgba) * width));
+public:
+    typedef Rgba<_T_> pixel_type;
+
+    RgbDecoderImpl(const ExrPaintLayerInfo &info, KisPaintDeviceSP device, int xstart, int width, Imf::PixelType ptype)
+        : m_info(info),
+          m_device(device),
+          m_xstart(xstart),
+          m_width(width),
+          m_ptype(ptype),
+          m_hasAlpha(info.channelMap.contains("A"))
+    {
     }
 
-    file.setFrameBuffer(frameBuffer);
-    file.readPixels(ystart, height + ystart - 1);
-    Rgba *rgba = pixels.data();
+    qint64 bytesPerRow() const override {
+        return qint64(m_width) * sizeof(pixel_type);
+    }
 
-    QRect paintRegion(xstart, ystart, width, height);
-    KisSequentialIterator it(layer->paintDevice(), paintRegion);
-    while (it.nextPixel()) {
-        if (hasAlpha) {
-            unmultiplyAlpha<RgbPixelWrapper<_T_> >(rgba);
+    void prepareFrameBuffer(Imf::FrameBuffer *frameBuffer, int ystart, int numRows) override
+    {
+        m_pixels.resize(m_width * numRows);
+        m_ystart = ystart;
+
+        pixel_type *frameBufferData = (m_pixels.data()) - m_xstart - ystart * m_width;
+        frameBuffer->insert(m_info.channelMap["R"].toLatin1().constData(),
+                Imf::Slice(m_ptype, (char *) &frameBufferData->r,
+                           sizeof(pixel_type) * 1,
+                           sizeof(pixel_type) * m_width));
+        frameBuffer->insert(m_info.channelMap["G"].toLatin1().constData(),
+                Imf::Slice(m_ptype, (char *) &frameBufferData->g,
+                           sizeof(pixel_type) * 1,
+                           sizeof(pixel_type) * m_width));
+        frameBuffer->insert(m_info.channelMap["B"].toLatin1().constData(),
+                Imf::Slice(m_ptype, (char *) &frameBufferData->b,
+                           sizeof(pixel_type) * 1,
+                           sizeof(pixel_type) * m_width));
+        if (m_hasAlpha) {
+            frameBuffer->insert(m_info.channelMap["A"].toLatin1().constData(),
+                    Imf::Slice(m_ptype, (char *) &frameBufferData->a,
+                               sizeof(pixel_type) * 1,
+                               sizeof(pixel_type) * m_width));
         }
+    }
 
-        typename KoRgbTraits<_T_>::Pixel* dst = reinterpret_cast<typename KoRgbTraits<_T_>::Pixel*>(it.rawData());
+    bool decodeData(int y, int numRows) override
+    {
+        bool alphaWasModified = false;
+        pixel_type *rgba = m_pixels.data() + (y - m_ystart) * m_width;
 
-        dst->red = rgba->r;
-        dst->green = rgba->g;
-        dst->blue = rgba->b;
-        if (hasAlpha) {
-            dst->alpha = rgba->a;
-        } else {
-            dst->alpha = 1.0;
+        KisSequentialIterator it(m_device, QRect(m_xstart, y, m_width, numRows));
+        while (it.nextPixel()) {
+            if (m_hasAlpha) {
+                alphaWasModified |= unmultiplyAlpha<RgbPixelWrapper<_T_> >(rgba);
+            }
+
+            typename KoRgbTraits<_T_>::Pixel* dst = reinterpret_cast<typename KoRgbTraits<_T_>::Pixel*>(it.rawData());
+
+            dst->red = rgba->r;
+            dst->green = rgba->g;
+            dst->blue = rgba->b;
+            if (m_hasAlpha) {
+                dst->alpha = rgba->a;
+            } else {
+                dst->alpha = 1.0;
+            }
+
+            ++rgba;
         }
 
-        ++rgba;
+        return alphaWasModified;
     }
-}
+
+private:
+    const ExrPaintLayerInfo &m_info;
+    KisPaintDeviceSP m_device;
+    const int m_xstart;
+    const int m_width;
+    const Imf::PixelType m_ptype;
+    const bool m_hasAlpha;
+    int m_ystart = 0;
+    QVector<pixel_type> m_pixels;
+};
 
 template<typename _T_>
-void EXRConverter::Private::decodeData1(Imf::InputFile& file, ExrPaintLayerInfo& info, KisPaintLayerSP layer, int width, int xstart, int ystart, int height, Imf::PixelType ptype)
+class GrayDecoderImpl : public Decoder
 {
+public:
     typedef typename GrayPixelWrapper<_T_>::channel_type channel_type;
     typedef typename GrayPixelWrapper<_T_>::pixel_type pixel_type;
 
-    KIS_ASSERT_RECOVER_RETURN(
-                layer->paintDevice()->colorSpace()->colorModelId() == GrayAColorModelID);
+    GrayDecoderImpl(const ExrPaintLayerInfo &info, KisPaintDeviceSP device, int xstart, int width, Imf::PixelType ptype)
+        : m_info(info),
+          m_device(device),
+          m_xstart(xstart),
+          m_width(width),
+          m_ptype(ptype),
+          m_hasAlpha(info.channelMap.contains("A"))
+    {
+        Q_ASSERT(info.channelMap.contains("Y"));
+        dbgFile << "Gray -> " << info.channelMap["Y"];
+        dbgFile << "Has Alpha:" << m_hasAlpha;
+    }
 
-    QVector<pixel_type> pixels(width * height);
+    qint64 bytesPerRow() const override {
+        return qint64(m_width) * sizeof(pixel_type);
+    }
 
-    Q_ASSERT(info.channelMap.contains("Y"));
-    dbgFile << "Gray -> " << info.channelMap["Y"];
+    void prepareFrameBuffer(Imf::FrameBuffer *frameBuffer, int ystart, int numRows) override
+    {
+        m_pixels.resize(m_width * numRows);
+        m_ystart = ystart;
+
+        pixel_type* frameBufferData = (m_pixels.data()) - m_xstart - ystart * m_width;
+        frameBuffer->insert(
+            m_info.channelMap["Y"].toLatin1().constData(),
+            Imf::Slice(m_ptype, (char *)&frameBufferData->gray, sizeof(pixel_type) * 1, sizeof(pixel_type) * m_width));
+
+        if (m_hasAlpha) {
+            frameBuffer->insert(m_info.channelMap["A"].toLatin1().constData(),
+                    Imf::Slice(m_ptype, (char *) &frameBufferData->alpha,
+                               sizeof(pixel_type) * 1,
+                               sizeof(pixel_type) * m_width));
+        }
+    }
 
-    bool hasAlpha = info.channelMap.contains("A");
-    dbgFile << "Has Alpha:" << hasAlpha;
+    bool decodeData(int y, int numRows) override
+    {
+        bool alphaWasModified = false;
+        pixel_type *srcPtr = m_pixels.data() + (y - m_ystart) * m_width;
 
+        KisSequentialIterator it(m_device, QRect(m_xstart, y, m_width, numRows));
+        while (it.nextPixel()) {
+            if (m_hasAlpha) {
+                alphaWasModified |= unmultiplyAlpha<GrayPixelWrapper<_T_> >(srcPtr);
+            }
 
-    Imf::FrameBuffer frameBuffer;
-    pixel_type* frameBufferData = (pixels.data()) - xstart - ystart * width;
-    frameBuffer.insert(
-        info.channelMap["Y"].toLatin1().constData(),
-        Imf::Slice(ptype, (char *)&frameBufferData->gray, sizeof(pixel_type) * 1, sizeof(pixel_type) * width));
+            pixel_type* dstPtr = reinterpret_cast<pixel_type*>(it.rawData());
 
-    if (hasAlpha) {
-        frameBuffer.insert(info.channelMap["A"].toLatin1().constData(),
-                Imf::Slice(ptype, (char *) &frameBufferData->alpha,
-                           sizeof(pixel_type) * 1,
-                           sizeof(pixel_type) * width));
+            dstPtr->gray = srcPtr->gray;
+            dstPtr->alpha = m_hasAlpha ? srcPtr->alpha : channel_type(1.0);
+
+            ++srcPtr;
+        }
+
+        return alphaWasModified;
     }
 
-    file.setFrameBuffer(frameBuffer);
-    file.readPixels(ystart, height + ystart - 1);
+private:
+    const ExrPaintLayerInfo &m_info;
+    KisPaintDeviceSP m_device;
+    const int m_xstart;
+    const int m_width;
+    const Imf::PixelType m_ptype;
+    const bool m_hasAlpha;
+    int m_ystart = 0;
+    QVector<pixel_type> m_pixels;
+};
 
-    pixel_type *srcPtr = pixels.data();
+Decoder* decoder(const ExrPaintLayerInfo &info, KisPaintDeviceSP device, int xstart, int width)
+{
+    switch (info.channelMap.size()) {
+    case 1:
+    case 2:
+        KIS_ASSERT_RECOVER_RETURN_VALUE(device->colorSpace()->colorModelId() == GrayAColorModelID, 0);
+
+        switch (info.imageType) {
+        case IT_FLOAT16:
+            return new GrayDecoderImpl<half>(info, device, xstart, width, Imf::HALF);
+        case IT_FLOAT32:
+            return new GrayDecoderImpl<float>(info, device, xstart, width, Imf::FLOAT);
+        case IT_UNKNOWN:
+        case IT_UNSUPPORTED:
+            qFatal("Impossible error");
+        }
+        break;
+    case 3:
+    case 4:
+        switch (info.imageType) {
+        case IT_FLOAT16:
+            return new RgbDecoderImpl<half>(info, device, xstart, width, Imf::HALF);
+        case IT_FLOAT32:
+            return new RgbDecoderImpl<float>(info, device, xstart, width, Imf::FLOAT);
+        case IT_UNKNOWN:
+        case IT_UNSUPPORTED:
+            qFatal("Impossible error");
+        }
+        break;
+    default:
+        qFatal("Invalid number of channels: %i", info.channelMap.size());
+    }
 
-    QRect paintRegion(xstart, ystart, width, height);
-    KisSequentialIterator it(layer->paintDevice(), paintRegion);
-    while (it.nextPixel()) {
-        if (hasAlpha) {
-            unmultiplyAlpha<GrayPixelWrapper<_T_> >(srcPtr);
+    return 0;
+}
+
+/**
+ * Reads the data of all the layers strip by strip. Every strip is read
+ * with a single readPixels() call, so OpenEXR decompresses the line
+ * buffers (or tiles) of the strip only once for all the layers and
+ * does it in its own thread pool. Then the strip is written into the
+ * layers in parallel. Only one strip of every layer is kept in memory.
+ *
+ * \return true if the alpha channel of some pixels had to be modified
+ */
+bool decodeData(Imf::InputFile &file, const QVector<QSharedPointer<Decoder>> &decoders, int ystart, int height)
+{
+    if (decoders.isEmpty()) return false;
+
+    qint64 bytesPerRow = 0;
+    Q_FOREACH (QSharedPointer<Decoder> decoder, decoders) {
+        bytesPerRow += decoder->bytesPerRow();
+    }
+
+    const int maxStripHeight = stripHeight(bytesPerRow);
+    bool alphaWasModified = false;
+
+    for (int y = ystart; y < ystart + height;) {
+        const int numRows = qMin(ystart + height, alignDownToTile(y) + maxStripHeight) - y;
+
+        Imf::FrameBuffer frameBuffer;
+        Q_FOREACH (QSharedPointer<Decoder> decoder, decoders) {
+            decoder->prepareFrameBuffer(&frameBuffer, y, numRows);
         }
+        file.setFrameBuffer(frameBuffer);
+        file.readPixels(y, y + numRows - 1);
 
-        pixel_type* dstPtr = reinterpret_cast<pixel_type*>(it.rawData());
+        /**
+         * Split the strip into the rows of tiles, so that every tile
+         * of every layer is written by a single thread
+         */
+        QVector<QPair<int, int>> bands;
+        for (int bandStart = y; bandStart < y + numRows;) {
+            const int bandEnd = qMin(y + numRows, alignDownToTile(bandStart) + exrTileSize);
+            bands.append(qMakePair(bandStart, bandEnd - bandStart));
+            bandStart = bandEnd;
+        }
+
+        QVector<char> bandAlphaWasModified(decoders.size() * bands.size(), false);
 
-        dstPtr->gray = srcPtr->gray;
-        dstPtr->alpha = hasAlpha ? srcPtr->alpha : channel_type(1.0);
+        KritaUtils::processRangeConcurrently(bandAlphaWasModified.size(), 1,
+            [&] (int begin, int end) {
+                for (int i = begin; i < end; i++) {
+                    const QPair<int, int> &band = bands[i % bands.size()];
+                    bandAlphaWasModified[i] = decoders[i / bands.size()]->decodeData(band.first, band.second);
+                }
+            });
 
-        ++srcPtr;
-    } ;
+        alphaWasModified |= bandAlphaWasModified.contains(true);
+        y += numRows;
+    }
+
+    return alphaWasModified;
 }
 
 bool recCheckGroup(const ExrGroupLayerInfo& group, QStringList list, int idx1, int idx2)
@@ -834,7 +1030,10 @@ KisImportExportErrorCode EXRConverter::decode(const QString &filename)
             d->image->addNode(info.groupLayer, groupLayerParent);
         }
 
-        // Load the layers
+        // Create the layers
+        QVector<QPair<KisPaintLayerSP, KisGroupLayerSP>> layers;
+        QVector<QSharedPointer<Decoder>> decoders;
+
         for (int i = informationObjects.size() - 1; i >= 0; --i) {
             ExrPaintLayerInfo& info = informationObjects[i];
             if (info.colorSpace) {
@@ -847,40 +1046,11 @@ KisImportExportErrorCode EXRConverter::decode(const QString &filename)
 
                 layer->setCompositeOpId(COMPOSITE_OVER);
 
-                switch (info.channelMap.size()) {
-                case 1:
-                case 2:
-                    // Decode the data
-                    switch (info.imageType) {
-                    case IT_FLOAT16:
-                        d->decodeData1<half>(file, info, layer, width, dx, dy, height, Imf::HALF);
-                        break;
-                    case IT_FLOAT32:
-                        d->decodeData1<float>(file, info, layer, width, dx, dy, height, Imf::FLOAT);
-                        break;
-                    case IT_UNKNOWN:
-                    case IT_UNSUPPORTED:
-                        qFatal("Impossible error");
-                    }
-                    break;
-                case 3:
-                case 4:
-                    // Decode the data
-                    switch (info.imageType) {
-                    case IT_FLOAT16:
-                        d->decodeData4<half>(file, info, layer, width, dx, dy, height, Imf::HALF);
-                        break;
-                    case IT_FLOAT32:
-                        d->decodeData4<float>(file, info, layer, width, dx, dy, height, Imf::FLOAT);
-                        break;
-                    case IT_UNKNOWN:
-                    case IT_UNSUPPORTED:
-                        qFatal("Impossible error");
-                    }
-                    break;
-                default:
-                    qFatal("Invalid number of channels: %i", info.channelMap.size());
+                QSharedPointer<Decoder> layerDecoder(decoder(info, layer->paintDevice(), dx, width));
+                if (layerDecoder) {
+                    decoders.append(layerDecoder);
                 }
+
                 // Check if should set the channels
                 if (!info.remappedChannels.isEmpty()) {
                     QList<KisMetaData::Value> values;
@@ -892,14 +1062,24 @@ KisImportExportErrorCode EXRConverter::decode(const QString &filename)
                     }
                     layer->metaData()->addEntry(KisMetaData::Entry(KisMetaData::SchemaRegistry::instance()->create("http://krita.org/exrchannels/1.0/" , "exrchannels"), "channelsmap", values));
                 }
-                // Add the layer
+
                 KisGroupLayerSP groupLayerParent = (info.parent) ? info.parent->groupLayer : d->image->rootLayer();
-                d->image->addNode(layer, groupLayerParent);
+                layers.append(qMakePair(layer, groupLayerParent));
             } else {
                 dbgFile << "No decoding " << info.name << " with " << info.channelMap.size() << " channels, and lack of a color space";
             }
         }
 
+        // Load the data of all the layers at once
+        if (decodeData(file, decoders, dy, height)) {
+            d->alphaWasModified = true;
+        }
+
+        // Add the layers
+        for (const QPair<KisPaintLayerSP, KisGroupLayerSP> &layer : layers) {
+            d->image->addNode(layer.first, layer.second);
+        }
+
         // After reading the image, notify the user about changed alpha.
         if (d->alphaWasModified) {
             QString msg =
@@ -964,8 +1144,9 @@ class Encoder
 {
 public:
     virtual ~Encoder() {}
-    virtual void prepareFrameBuffer(Imf::FrameBuffer*, int line) = 0;
-    virtual void encodeData(int line) = 0;
+    virtual qint64 bytesPerRow() const = 0;
+    virtual void prepareFrameBuffer(Imf::FrameBuffer*, int ystart, int numRows) = 0;
+    virtual void encodeData(int y, int numRows) = 0;
 
 };
 
@@ -973,24 +1154,33 @@ template<typename _T_, int size, int alphaPos>
 class EncoderImpl : public Encoder
 {
 public:
-    EncoderImpl(Imf::OutputFile* _file, const ExrPaintLayerSaveInfo* _info, int width) : file(_file), info(_info), pixels(width), m_width(width) {}
+    EncoderImpl(const ExrPaintLayerSaveInfo* _info, int width) : info(_info), m_width(width) {}
     ~EncoderImpl() override {}
-    void prepareFrameBuffer(Imf::FrameBuffer*, int line) override;
-    void encodeData(int line) override;
+    qint64 bytesPerRow() const override;
+    void prepareFrameBuffer(Imf::FrameBuffer*, int ystart, int numRows) override;
+    void encodeData(int y, int numRows) override;
 private:
     typedef ExrPixel_<_T_, size> ExrPixel;
-    Imf::OutputFile* file;
     const ExrPaintLayerSaveInfo* info;
     QVector<ExrPixel> pixels;
     int m_width;
+    int m_ystart = 0;
 };
 
 template<typename _T_, int size, int alphaPos>
-void EncoderImpl<_T_, size, alphaPos>::prepareFrameBuffer(Imf::FrameBuffer* frameBuffer, int line)
+qint64 EncoderImpl<_T_, size, alphaPos>::bytesPerRow() const
+{
+    return qint64(m_width) * sizeof(ExrPixel);
+}
+
+template<typename _T_, int size, int alphaPos>
+void EncoderImpl<_T_, size, alphaPos>::prepareFrameBuffer(Imf::FrameBuffer* frameBuffer, int ystart, int numRows)
 {
+    pixels.resize(m_width * numRows);
+    m_ystart = ystart;
+
     int xstart = 0;
-    int ystart = 0;
-    ExrPixel* frameBufferData = (pixels.data()) - xstart - (ystart + line) * m_width;
+    ExrPixel* frameBufferData = (pixels.data()) - xstart - ystart * m_width;
     for (int k = 0; k < size; ++k) {
         frameBuffer->insert(info->channels[k].toUtf8(),
                             Imf::Slice(info->pixelType, (char *) &frameBufferData->data[k],
@@ -1000,12 +1190,12 @@ void EncoderImpl<_T_, size, alphaPos>::prepareFrameBuffer(Imf::FrameBuffer* fram
 }
 
 template<typename _T_, int size, int alphaPos>
-void EncoderImpl<_T_, size, alphaPos>::encodeData(int line)
+void EncoderImpl<_T_, size, alphaPos>::encodeData(int y, int numRows)
 {
-    ExrPixel *rgba = pixels.data();
-    KisHLineConstIteratorSP it = info->layerDevice->createHLineConstIteratorNG(0, line, m_width);
-    do {
-        const _T_* dst = reinterpret_cast < const _T_* >(it->oldRawData());
+    ExrPixel *rgba = pixels.data() + (y - m_ystart) * m_width;
+    KisSequentialConstIterator it(info->layerDevice, QRect(0, y, m_width, numRows));
+    while (it.nextPixel()) {
+        const _T_* dst = reinterpret_cast < const _T_* >(it.oldRawData());
 
         for (int i = 0; i < size; ++i) {
             rgba->data[i] = dst[i];
@@ -1016,40 +1206,40 @@ void EncoderImpl<_T_, size, alphaPos>::encodeData(int line)
         }
 
         ++rgba;
-    } while (it->nextPixel());
+    }
 }
 
-Encoder* encoder(Imf::OutputFile& file, const ExrPaintLayerSaveInfo& info, int width)
+Encoder* encoder(const ExrPaintLayerSaveInfo& info, int width)
 {
     dbgFile << "Create encoder for" << info.name << info.channels << info.layerDevice->colorSpace()->channelCount();
     switch (info.layerDevice->colorSpace()->channelCount()) {
     case 1: {
         if (info.layerDevice->colorSpace()->colorDepthId() == Float16BitsColorDepthID) {
             Q_ASSERT(info.pixelType == Imf::HALF);
-            return new EncoderImpl < half, 1, -1 > (&file, &info, width);
+            return new EncoderImpl < half, 1, -1 > (&info, width);
         } else if (info.layerDevice->colorSpace()->colorDepthId() == Float32BitsColorDepthID) {
             Q_ASSERT(info.pixelType == Imf::FLOAT);
-            return new EncoderImpl < float, 1, -1 > (&file, &info, width);
+            return new EncoderImpl < float, 1, -1 > (&info, width);
         }
         break;
     }
     case 2: {
         if (info.layerDevice->colorSpace()->colorDepthId() == Float16BitsColorDepthID) {
             Q_ASSERT(info.pixelType == Imf::HALF);
-            return new EncoderImpl<half, 2, 1>(&file, &info, width);
+            return new EncoderImpl<half, 2, 1>(&info, width);
         } else if (info.layerDevice->colorSpace()->colorDepthId() == Float32BitsColorDepthID) {
             Q_ASSERT(info.pixelType == Imf::FLOAT);
-            return new EncoderImpl<float, 2, 1>(&file, &info, width);
+            return new EncoderImpl<float, 2, 1>(&info, width);
         }
         break;
     }
     case 4: {
         if (info.layerDevice->colorSpace()->colorDepthId() == Float16BitsColorDepthID) {
             Q_ASSERT(info.pixelType == Imf::HALF);
-            return new EncoderImpl<half, 4, 3>(&file, &info, width);
+            return new EncoderImpl<half, 4, 3>(&info, width);
         } else if (info.layerDevice->colorSpace()->colorDepthId() == Float32BitsColorDepthID) {
             Q_ASSERT(info.pixelType == Imf::FLOAT);
-            return new EncoderImpl<float, 4, 3>(&file, &info, width);
+            return new EncoderImpl<float, 4, 3>(&info, width);
         }
         break;
     }
@@ -1059,25 +1249,87 @@ Encoder* encoder(Imf::OutputFile& file, const ExrPaintLayerSaveInfo& info, int w
     return 0;
 }
 
-void encodeData(Imf::OutputFile& file, const QList<ExrPaintLayerSaveInfo>& informationObjects, int width, int height)
+/**
+ * Writes the data of all the layers strip by strip. The pixels of a
+ * strip are fetched from the layers in parallel and the strip is passed
+ * to OpenEXR with a single call, so that it can compress the line
+ * buffers (or tiles) of the strip in its own thread pool. Only one
+ * strip of every layer is kept in memory.
+ *
+ * \p writeStrip is called with the first and the last row of the strip
+ */
+template <typename File, typename WriteStripFunc>
+void encodeData(File& file, const QList<ExrPaintLayerSaveInfo>& informationObjects, int width, int height, WriteStripFunc writeStrip)
 {
-    QList<Encoder*> encoders;
-    Q_FOREACH (const ExrPaintLayerSaveInfo& info, informationObjects) {
-        encoders.push_back(encoder(file, info, width));
+    QVector<QSharedPointer<Encoder>> encoders;
+    qint64 bytesPerRow = 0;
+
+    for (const ExrPaintLayerSaveInfo& info : informationObjects) {
+        QSharedPointer<Encoder> layerEncoder(encoder(info, width));
+        KIS_SAFE_ASSERT_RECOVER(layerEncoder) { continue; }
+
+        encoders.append(layerEncoder);
+        bytesPerRow += layerEncoder->bytesPerRow();
     }
 
-    for (int y = 0; y < height; ++y) {
+    const int maxStripHeight = stripHeight(bytesPerRow);
+
+    for (int y = 0; y < height; y += maxStripHeight) {
+        const int numRows = qMin(height - y, maxStripHeight);
+
         Imf::FrameBuffer frameBuffer;
-        Q_FOREACH (Encoder* encoder, encoders) {
-            encoder->prepareFrameBuffer(&frameBuffer, y);
+        Q_FOREACH (QSharedPointer<Encoder> encoder, encoders) {
+            encoder->prepareFrameBuffer(&frameBuffer, y, numRows);
         }
         file.setFrameBuffer(frameBuffer);
-        Q_FOREACH (Encoder* encoder, encoders) {
-            encoder->encodeData(y);
-        }
-        file.writePixels(1);
+
+        KritaUtils::processRangeConcurrently(numRows, 1,
+            [&] (int begin, int end) {
+                Q_FOREACH (QSharedPointer<Encoder> encoder, encoders) {
+                    encoder->encodeData(y + begin, end - begin);
+                }
+            });
+
+        writeStrip(y, y + numRows - 1);
+    }
+}
+
+void encodeData(Imf::OutputFile& file, const QList<ExrPaintLayerSaveInfo>& informationObjects, int width, int height)
+{
+    encodeData(file, informationObjects, width, height,
+        [&file] (int firstRow, int lastRow) {
+            file.writePixels(lastRow - firstRow + 1);
+        });
+}
+
+void encodeData(Imf::TiledOutputFile& file, const QList<ExrPaintLayerSaveInfo>& informationObjects, int width, int height)
+{
+    encodeData(file, informationObjects, width, height,
+        [&file] (int firstRow, int lastRow) {
+            file.writeTiles(0, file.numXTiles() - 1,
+                            firstRow / exrTileSize, lastRow / exrTileSize);
+        });
+}
+
+/**
+ * Sets up the compression and the layout of the file in \p header
+ * and writes the layers into the file
+ */
+void writeFile(const QString &filename, Imf::Header &header, const QList<ExrPaintLayerSaveInfo>& informationObjects, int width, int height, const EXROptions &options)
+{
+    header.compression() = Imf::Compression(qBound(int(Imf::NO_COMPRESSION),
+                                                   int(options.compression),
+                                                   int(Imf::NUM_COMPRESSION_METHODS) - 1));
+
+    if (options.tiled) {
+        header.setTileDescription(Imf::TileDescription(exrTileSize, exrTileSize, Imf::ONE_LEVEL));
+
+        Imf::TiledOutputFile file(filename.toUtf8(), header);
+        encodeData(file, informationObjects, width, height);
+    } else {
+        Imf::OutputFile file(filename.toUtf8(), header);
+        encodeData(file, informationObjects, width, height);
     }
-    qDeleteAll(encoders);
 }
 
 KisPaintDeviceSP wrapLayerDevice(KisPaintDeviceSP device)
@@ -1104,7 +1356,7 @@ KisPaintDeviceSP wrapLayerDevice(KisPaintDeviceSP device)
     return device;
 }
 
-KisImportExportErrorCode EXRConverter::buildFile(const QString &filename, KisPaintLayerSP layer)
+KisImportExportErrorCode EXRConverter::buildFile(const QString &filename, KisPaintLayerSP layer, const EXROptions &options)
 {
     KIS_ASSERT_RECOVER_RETURN_VALUE(layer, ImportExportCodes::InternalError);
 
@@ -1160,11 +1412,9 @@ KisImportExportErrorCode EXRConverter::buildFile(const QString &filename, KisPai
 
     // Open file for writing
     try {
-        Imf::OutputFile file(filename.toUtf8(), header);
-
         QList<ExrPaintLayerSaveInfo> informationObjects;
         informationObjects.push_back(info);
-        encodeData(file, informationObjects, width, height);
+        writeFile(filename, header, informationObjects, width, height, options);
         return ImportExportCodes::OK;
 
     } catch(std::exception &e) {
@@ -1366,7 +1616,7 @@ QString EXRConverter::Private::fetchExtraLayersInfo(QList<ExrPaintLayerSaveInfo>
     return doc.toString();
 }
 
-KisImportExportErrorCode EXRConverter::buildFile(const QString &filename, KisGroupLayerSP layer, bool flatten)
+KisImportExportErrorCode EXRConverter::buildFile(const QString &filename, KisGroupLayerSP layer, bool flatten, const EXROptions &options)
 {
     KIS_ASSERT_RECOVER_RETURN_VALUE(layer, ImportExportCodes::InternalError);
 
@@ -1380,7 +1630,7 @@ KisImportExportErrorCode EXRConverter::buildFile(const QString &filename, KisGro
     if (flatten) {
         KisPaintDeviceSP pd = new KisPaintDevice(*image->projection());
         KisPaintLayerSP l = new KisPaintLayer(image, "projection", OPACITY_OPAQUE_U8, pd);
-        return buildFile(filename, l);
+        return buildFile(filename, l, options);
     }
     else {
         QList<ExrPaintLayerSaveInfo> informationObjects;
@@ -1407,8 +1657,7 @@ KisImportExportErrorCode EXRConverter::buildFile(const QString &filename, KisGro
 
         // Open file for writing
         try {
-            Imf::OutputFile file(filename.toUtf8(), header);
-            encodeData(file, informationObjects, width, height);
+            writeFile(filename, header, informationObjects, width, height, options);
             return ImportExportCodes::OK;
         } catch(std::exception &e) {
             dbgFile << "Exception while writing to exr file: " << e.what();
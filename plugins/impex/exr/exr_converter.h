@@ -16,6 +16,33 @@
 
 class KisDocument;
 
+struct EXROptions {
+    /**
+     * The compression methods supported by OpenEXR, the values
+     * match the ones of Imf::Compression
+     */
+    enum Compression {
+        NoCompression = 0,
+        RLECompression,
+        ZIPSCompression,
+        ZIPCompression,
+        PIZCompression,
+        PXR24Compression,
+        B44Compression,
+        B44ACompression,
+        DWAACompression,
+        DWABCompression
+    };
+
+    Compression compression = ZIPCompression;
+
+    /**
+     * Write the image as tiles of the same size as the tiles of Krita's
+     * paint devices instead of scanlines
+     */
+    bool tiled = false;
+};
+
 class EXRConverter : public QObject
 {
     Q_OBJECT
@@ -24,8 +51,8 @@ public:
     ~EXRConverter() override;
 public:
     KisImportExportErrorCode buildImage(const QString &filename);
-    KisImportExportErrorCode buildFile(const QString &filename, KisPaintLayerSP layer);
-    KisImportExportErrorCode buildFile(const QString &filename, KisGroupLayerSP layer, bool flatten=false);
+    KisImportExportErrorCode buildFile(const QString &filename, KisPaintLayerSP layer, const EXROptions &options = EXROptions());
+    KisImportExportErrorCode buildFile(const QString &filename, KisGroupLayerSP layer, bool flatten=false, const EXROptions &options = EXROptions());
     /**
      * Retrieve the constructed image
      */
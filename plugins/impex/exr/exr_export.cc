@@ -45,6 +45,8 @@ KisPropertiesConfigurationSP EXRExport::defaultConfiguration(const QByteArray &/
 {
     KisPropertiesConfigurationSP cfg = new KisPropertiesConfiguration();
     cfg->setProperty("flatten", false);
+    cfg->setProperty("compression", int(EXROptions::ZIPCompression));
+    cfg->setProperty("tiled", false);
     return cfg;
 }
 
@@ -63,13 +65,22 @@ KisImportExportErrorCode EXRExport::convert(KisDocument *document, QIODevice */*
 
     EXRConverter exrConverter(document, !batchMode());
 
+    EXROptions options;
+    if (configuration) {
+        options.compression = EXROptions::Compression(
+            qBound<int>(EXROptions::NoCompression,
+                        configuration->getInt("compression", EXROptions::ZIPCompression),
+                        EXROptions::DWABCompression));
+        options.tiled = configuration->getBool("tiled", false);
+    }
+
     KisImportExportErrorCode res;
 
     if (configuration && configuration->getBool("flatten")) {
-        res = exrConverter.buildFile(filename(), image->rootLayer(), true);
+        res = exrConverter.buildFile(filename(), image->rootLayer(), true, options);
     }
     else {
-        res = exrConverter.buildFile(filename(), image->rootLayer());
+        res = exrConverter.buildFile(filename(), image->rootLayer(), false, options);
     }
 
     if (!exrConverter.errorMessage().isNull()) {
@@ -107,12 +118,16 @@ void EXRExport::initializeCapabilities()
 void KisWdgOptionsExr::setConfiguration(const KisPropertiesConfigurationSP cfg)
 {
     chkFlatten->setChecked(cfg->getBool("flatten", false));
+    cmbCompression->setCurrentIndex(cfg->getInt("compression", EXROptions::ZIPCompression));
+    chkTiled->setChecked(cfg->getBool("tiled", false));
 }
 
 KisPropertiesConfigurationSP KisWdgOptionsExr::configuration() const
 {
     KisPropertiesConfigurationSP cfg = new KisPropertiesConfiguration();
     cfg->setProperty("flatten", chkFlatten->isChecked());
+    cfg->setProperty("compression", cmbCompression->currentIndex());
+    cfg->setProperty("tiled", chkTiled->isChecked());
     return cfg;
 }
 
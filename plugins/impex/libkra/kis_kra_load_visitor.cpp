@@ -17,6 +17,7 @@
 #include <QByteArray>
 #include <QMessageBox>
 #include <QApplication>
+#include <QtConcurrentRun>
 
 #include <KoMD5Generator.h>
 #include <KoColorSpaceRegistry.h>
@@ -44,6 +45,7 @@
 #include <kis_filter_mask.h>
 #include <kis_group_layer.h>
 #include <kis_image.h>
+#include <kis_image_config.h>
 #include <kis_layer.h>
 #include <kis_meta_data_backend_registry.h>
 #include <kis_meta_data_store.h>
@@ -99,6 +101,10 @@ KisKraLoadVisitor::KisKraLoadVisitor(KisImageSP image,
     , m_name(name)
     , m_shapeController(shapeController)
 {
+    KisImageConfig cfg(true);
+    m_useParallelLoading = cfg.useParallelKraLoading();
+    m_loadingPool.setMaxThreadCount(cfg.maxNumberOfThreads());
+
     m_store->pushDirectory();
 
     if (!m_store->enterDirectory(m_name)) {
@@ -119,12 +125,38 @@ KisKraLoadVisitor::KisKraLoadVisitor(KisImageSP image,
     m_syntaxVersion = syntaxVersion;
 }
 
+KisKraLoadVisitor::~KisKraLoadVisitor()
+{
+    waitForPendingLoads();
+}
+
 void KisKraLoadVisitor::setExternalUri(const QString &uri)
 {
     m_external = true;
     m_uri = uri;
 }
 
+void KisKraLoadVisitor::waitForPendingLoads()
+{
+    Q_FOREACH (const PendingLoad &load, m_pendingLoads) {
+        m_warningMessages << load.future.result();
+    }
+    m_pendingLoads.clear();
+}
+
+void KisKraLoadVisitor::waitForPendingLoad(KisPaintDeviceSP device)
+{
+    auto it = m_pendingLoads.begin();
+    while (it != m_pendingLoads.end()) {
+        if (it->device == device) {
+            m_warningMessages << it->future.result();
+            it = m_pendingLoads.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
 bool KisKraLoadVisitor::visit(KisExternalLayer * layer)
 {
     bool result = false;
@@ -189,10 +221,15 @@ bool KisKraLoadVisitor::visit(KisPaintLayer *layer)
 {
     loadNodeKeyframes(layer);
 
-    if (!loadPaintDevice(layer->paintDevice(), getLocation(layer))) {
+    /**
+     * The profile is assigned before the pixel data is loaded, because
+     * the pixel data may be decoded asynchronously. Assigning a profile
+     * doesn't touch the pixels, so the order doesn't change the result.
+     */
+    if (!loadProfile(layer->paintDevice(), getLocation(layer, DOT_ICC))) {
         return false;
     }
-    if (!loadProfile(layer->paintDevice(), getLocation(layer, DOT_ICC))) {
+    if (!loadPaintDevice(layer->paintDevice(), getLocation(layer))) {
         return false;
     }
     if (!loadMetaData(layer)) {
@@ -246,6 +283,9 @@ bool KisKraLoadVisitor::visit(KisAdjustmentLayer* layer)
         KisSelectionSP selection = new KisSelection();
         KisPixelSelectionSP pixelSelection = selection->pixelSelection();
         result = loadPaintDevice(pixelSelection, getLocation(layer, ".selection"));
+
+        // setInternalSelection() copies the selection
+        waitForPendingLoad(pixelSelection);
         layer->setInternalSelection(selection);
     } else if (m_syntaxVersion == 2) {
         result = loadSelection(getLocation(layer), layer->internalSelection());
@@ -483,6 +523,9 @@ bool KisKraLoadVisitor::visit(KisColorizeMask *mask)
 
     loadPaintDevice(mask->coloringProjection(), COLORIZE_COLORING_DEVICE);
 
+    // resetCache() rerenders the mask from the key strokes right away
+    waitForPendingLoads();
+
     const KoColorProfile *profile =
         loadProfile(getLocation(mask, DOT_ICC), mask->colorSpace()->colorModelId().id(), mask->colorSpace()->colorDepthId().id());
 
@@ -556,6 +599,9 @@ struct FramedDevicePolicy
 
 bool KisKraLoadVisitor::loadPaintDevice(KisPaintDeviceSP device, const QString& location)
 {
+    QVector<DeferredFrameLoad> deferredLoads;
+    QVector<DeferredFrameLoad> *deferredLoadsPtr = m_useParallelLoading ? &deferredLoads : 0;
+
     // Layer data
     KisPaintDeviceFramesInterface *frameInterface = device->framesInterface();
     QList<int> frames;
@@ -564,8 +610,10 @@ bool KisKraLoadVisitor::loadPaintDevice(KisPaintDeviceSP device, const QString&
         frames = device->framesInterface()->frames();
     }
 
+    bool result = true;
+
     if (!frameInterface || frames.count() <= 1) {
-        return loadPaintDeviceFrame(device, location, SimpleDevicePolicy());
+        result = loadPaintDeviceFrame(device, location, SimpleDevicePolicy(), deferredLoadsPtr);
     } else {
         KisRasterKeyframeChannel *keyframeChannel = device->keyframeChannel();
 
@@ -579,18 +627,25 @@ bool KisKraLoadVisitor::loadPaintDevice(KisPaintDeviceSP device, const QString&
                 QString frameFilename = getLocation(keyframeChannel->frameFilename(id));
                 Q_ASSERT(!frameFilename.isEmpty());
 
-                if (!loadPaintDeviceFrame(device, frameFilename, FramedDevicePolicy(id))) {
+                if (!loadPaintDeviceFrame(device, frameFilename, FramedDevicePolicy(id), deferredLoadsPtr)) {
                     m_warningMessages << i18n("Could not load keyframe pixel data for frame %1 in %2.", id, location);
                 }
             }
         }
     }
 
-    return true;
+    if (!deferredLoads.isEmpty()) {
+        addPendingLoad(device, deferredLoads);
+    } else if (KisPixelSelection *pixelSelection = dynamic_cast<KisPixelSelection*>(device.data())) {
+        pixelSelection->invalidateOutlineCache();
+    }
+
+    return result;
 }
 
 template<class DevicePolicy>
-bool KisKraLoadVisitor::loadPaintDeviceFrame(KisPaintDeviceSP device, const QString &location, DevicePolicy policy)
+bool KisKraLoadVisitor::loadPaintDeviceFrame(KisPaintDeviceSP device, const QString &location, DevicePolicy policy,
+                                             QVector<DeferredFrameLoad> *deferredLoads)
 {
     {
         const int pixelSize = device->colorSpace()->pixelSize();
@@ -607,7 +662,27 @@ bool KisKraLoadVisitor::loadPaintDeviceFrame(KisPaintDeviceSP device, const QStr
         policy.setDefaultPixel(device, color);
     }
 
-    if (m_store->open(location)) {
+    if (deferredLoads) {
+        std::function<QByteArray()> reader = m_store->readDeferred(location);
+
+        if (!reader) {
+            m_warningMessages << i18n("Could not load pixel data: %1.", location);
+            return true;
+        }
+
+        *deferredLoads << [device, location, policy, reader] () mutable {
+            QByteArray data = reader();
+            QBuffer buffer(&data);
+            buffer.open(QIODevice::ReadOnly);
+
+            if (!policy.read(device, &buffer)) {
+                device->disconnect();
+                return i18n("Could not read pixel data: %1.", location);
+            }
+            return QString();
+        };
+
+    } else if (m_store->open(location)) {
         if (!policy.read(device, m_store->device())) {
             m_warningMessages << i18n("Could not read pixel data: %1.", location);
             device->disconnect();
@@ -623,6 +698,45 @@ bool KisKraLoadVisitor::loadPaintDeviceFrame(KisPaintDeviceSP device, const QStr
     return true;
 }
 
+void KisKraLoadVisitor::addPendingLoad(KisPaintDeviceSP device, const QVector<DeferredFrameLoad> &deferredLoads)
+{
+    /**
+     * Limit the amount of compressed data kept in memory when the
+     * workers cannot keep up with reading the store
+     */
+    const int maxPendingLoads = 4 * m_loadingPool.maxThreadCount();
+
+    while (m_pendingLoads.size() >= maxPendingLoads) {
+        m_warningMessages << m_pendingLoads.takeFirst().future.result();
+    }
+
+    /**
+     * All the frames of a device are decoded by the same job,
+     * since they share the device's internal structures
+     */
+    PendingLoad pendingLoad;
+    pendingLoad.device = device;
+    pendingLoad.future = QtConcurrent::run(&m_loadingPool,
+        [device, deferredLoads] () {
+            QStringList warnings;
+
+            Q_FOREACH (const DeferredFrameLoad &load, deferredLoads) {
+                const QString warning = load();
+                if (!warning.isEmpty()) {
+                    warnings << warning;
+                }
+            }
+
+            if (KisPixelSelection *pixelSelection = dynamic_cast<KisPixelSelection*>(device.data())) {
+                pixelSelection->invalidateOutlineCache();
+            }
+
+            return warnings;
+        });
+
+    m_pendingLoads << pendingLoad;
+}
+
 
 bool KisKraLoadVisitor::loadProfile(KisPaintDeviceSP device, const QString& location)
 {
@@ -789,7 +903,6 @@ bool KisKraLoadVisitor::loadSelection(const QString& location, KisSelectionSP ds
             if (!result) {
                 m_warningMessages << i18n("Could not load raster selection %1.", location);
             }
-            pixelSelection->invalidateOutlineCache();
         }
     }
 
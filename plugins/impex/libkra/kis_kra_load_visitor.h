@@ -10,6 +10,10 @@
 
 #include <QRect>
 #include <QStringList>
+#include <QFuture>
+#include <QThreadPool>
+
+#include <functional>
 
 // kritaimage
 #include "kis_types.h"
@@ -36,9 +40,26 @@ public:
                       const QString & name,
                       int syntaxVersion);
 
+    ~KisKraLoadVisitor() override;
+
 public:
     void setExternalUri(const QString &uri);
 
+    /**
+     * When parallel loading is enabled in KisImageConfig, the visitor
+     * only reads the compressed pixel data from the store and decodes it
+     * into the paint devices on a thread pool. Call this method after the
+     * visitor has passed the whole tree, but before accessing the pixel
+     * data of the loaded nodes or the warning messages.
+     */
+    void waitForPendingLoads();
+
+    /**
+     * Waits until the pixel data of \p device is decoded. Must be
+     * called before any change to the device after loadPaintDevice().
+     */
+    void waitForPendingLoad(KisPaintDeviceSP device);
+
     bool visit(KisNode*) override {
         return true;
     }
@@ -59,10 +80,19 @@ public:
 
 private:
 
+    /**
+     * A part of the pixel data that is decoded on a worker thread.
+     * Returns a warning message in case of failure.
+     */
+    using DeferredFrameLoad = std::function<QString()>;
+
     bool loadPaintDevice(KisPaintDeviceSP device, const QString& location);
 
     template<class DevicePolicy>
-    bool loadPaintDeviceFrame(KisPaintDeviceSP device, const QString &location, DevicePolicy policy);
+    bool loadPaintDeviceFrame(KisPaintDeviceSP device, const QString &location, DevicePolicy policy,
+                              QVector<DeferredFrameLoad> *deferredLoads);
+
+    void addPendingLoad(KisPaintDeviceSP device, const QVector<DeferredFrameLoad> &deferredLoads);
 
     bool loadProfile(KisPaintDeviceSP device,  const QString& location);
     bool loadFilterConfiguration(KisFilterConfigurationSP kfc, const QString& location);
@@ -96,6 +126,15 @@ private:
     QStringList m_warningMessages;
     KoShapeControllerBase *m_shapeController;
     QMap<QString, const KoColorProfile *> m_profileCache;
+
+    bool m_useParallelLoading {false};
+    QThreadPool m_loadingPool;
+
+    struct PendingLoad {
+        KisPaintDeviceSP device;
+        QFuture<QStringList> future;
+    };
+    QList<PendingLoad> m_pendingLoads;
 };
 
 #endif // KIS_KRA_LOAD_VISITOR_H_
@@ -472,6 +472,8 @@ void KisKraLoader::loadBinaryData(KoStore * store, KisImageSP image, const QStri
     }
 
     image->rootLayer()->accept(visitor);
+    visitor.waitForPendingLoads();
+
     if (!visitor.errorMessages().isEmpty()) {
         m_d->errorMessages.append(visitor.errorMessages());
     }
@@ -44,6 +44,7 @@
 
 #include "kis_config.h"
 #include "kis_store_paintdevice_writer.h"
+#include "KisAutoSaveJournal.h"
 #include "flake/kis_shape_selection.h"
 
 #include "kis_raster_keyframe_channel.h"
@@ -78,6 +79,11 @@ void KisKraSaveVisitor::setExternalUri(const QString &uri)
     m_uri = uri;
 }
 
+void KisKraSaveVisitor::setAutoSaveJournal(KisAutoSaveJournal *journal)
+{
+    m_autoSaveJournal = journal;
+}
+
 bool KisKraSaveVisitor::visit(KisExternalLayer * layer)
 {
     bool result = false;
@@ -120,7 +126,8 @@ bool KisKraSaveVisitor::visit(KisExternalLayer * layer)
 
 bool KisKraSaveVisitor::visit(KisPaintLayer *layer)
 {
-    if (!savePaintDevice(layer->paintDevice(), getLocation(layer))) {
+    if (!savePaintDevice(layer->paintDevice(), getLocation(layer),
+                         KisAutoSaveJournal::deviceKey(layer, KisAutoSaveJournal::NodeDevice))) {
         m_errorMessages << i18n("Failed to save the pixel data for layer %1.", layer->name());
         return false;
     }
@@ -335,12 +342,9 @@ struct FramedDevicePolicy
 };
 
 bool KisKraSaveVisitor::savePaintDevice(KisPaintDeviceSP device,
-                                        QString location)
+                                        QString location,
+                                        const QString &journalKey)
 {
-    // Layer data
-    KisConfig cfg(true);
-    m_store->setCompressionEnabled(cfg.compressKra());
-
     KisPaintDeviceFramesInterface *frameInterface = device->framesInterface();
     QList<int> frames;
 
@@ -348,7 +352,25 @@ bool KisKraSaveVisitor::savePaintDevice(KisPaintDeviceSP device,
         frames = frameInterface->frames();
     }
 
-    if (!frameInterface || frames.count() <= 1) {
+    const bool isSingleFrame = !frameInterface || frames.count() <= 1;
+
+    if (m_autoSaveJournal && !journalKey.isEmpty() && isSingleFrame) {
+        const QString baseLocation = m_autoSaveJournal->reusableEntry(journalKey);
+
+        if (!baseLocation.isEmpty()) {
+            m_autoSaveJournal->addReusedEntry(location, baseLocation);
+            m_autoSaveJournal->addReusedEntry(location + ".defaultpixel", baseLocation + ".defaultpixel");
+            return true;
+        }
+
+        m_autoSaveJournal->addWrittenEntry(journalKey, location);
+    }
+
+    // Layer data
+    KisConfig cfg(true);
+    m_store->setCompressionEnabled(cfg.compressKra());
+
+    if (isSingleFrame) {
         savePaintDeviceFrame(device, location, SimpleDevicePolicy());
     } else {
         KisRasterKeyframeChannel *keyframeChannel = device->keyframeChannel();
@@ -448,7 +470,8 @@ bool KisKraSaveVisitor::saveSelection(KisNode* node)
 
     if (selection->hasNonEmptyPixelSelection()) {
         KisPaintDeviceSP dev = selection->pixelSelection();
-        if (!savePaintDevice(dev, getLocation(node, DOT_PIXEL_SELECTION))) {
+        if (!savePaintDevice(dev, getLocation(node, DOT_PIXEL_SELECTION),
+                             KisAutoSaveJournal::deviceKey(node, KisAutoSaveJournal::PixelSelection))) {
             m_errorMessages << i18n("Failed to save the pixel selection data for layer %1.", node->name());
             retval = false;
         }
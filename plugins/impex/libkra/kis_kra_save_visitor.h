@@ -18,6 +18,7 @@
 
 class KisPaintDeviceWriter;
 class KoStore;
+class KisAutoSaveJournal;
 
 class KRITALIBKRA_EXPORT KisKraSaveVisitor : public KisNodeVisitor
 {
@@ -29,6 +30,13 @@ public:
 public:
     void setExternalUri(const QString &uri);
 
+    /**
+     * When the document is autosaved incrementally, the pixel data
+     * of the devices that haven't changed since the last full
+     * autosave is not written, but referenced in the \p journal
+     */
+    void setAutoSaveJournal(KisAutoSaveJournal *journal);
+
     bool visit(KisNode*) override {
         return true;
     }
@@ -60,7 +68,7 @@ public:
 
 private:
 
-    bool savePaintDevice(KisPaintDeviceSP device, QString location);
+    bool savePaintDevice(KisPaintDeviceSP device, QString location, const QString &journalKey = QString());
 
     template<class DevicePolicy>
     bool savePaintDeviceFrame(KisPaintDeviceSP device, QString location, DevicePolicy policy);
@@ -82,6 +90,7 @@ private:
     QMap<const KisNode*, QString> m_nodeFileNames;
     KisPaintDeviceWriter *m_writer;
     QStringList m_errorMessages;
+    KisAutoSaveJournal *m_autoSaveJournal {0};
 };
 
 #endif // KIS_KRA_SAVE_VISITOR_H_
@@ -43,6 +43,7 @@
 #include "kis_keyframe_channel.h"
 #include <kis_time_span.h>
 #include "KisDocument.h"
+#include "KisAutoSaveJournal.h"
 #include <string>
 #include "kis_dom_utils.h"
 #include "kis_grid_config.h"
@@ -467,6 +468,9 @@ bool KisKraSaver::saveBinaryData(KoStore* store, KisImageSP image, const QString
     if (external)
         visitor.setExternalUri(uri);
 
+    KisAutoSaveJournal *journal = m_d->doc->autoSaveJournal();
+    visitor.setAutoSaveJournal(journal);
+
     image->rootLayer()->accept(visitor);
 
     m_d->errorMessages.append(visitor.errorMessages());
@@ -474,6 +478,11 @@ bool KisKraSaver::saveBinaryData(KoStore* store, KisImageSP image, const QString
         return false;
     }
 
+    if (journal && journal->isSavingJournal() && !journal->saveManifest(store)) {
+        m_d->errorMessages << i18n("Could not save the autosave journal manifest.");
+        return false;
+    }
+
     bool success = true;
     bool r = true;
     qint64 nwritten = 0;
@@ -53,6 +53,11 @@ KisImportExportErrorCode KisPNGExport::convert(KisDocument *document, QIODevice
     options.alpha = configuration->getBool("alpha", true);
     options.interlace = configuration->getBool("interlaced", false);
     options.compression = configuration->getInt("compression", 3);
+    options.compressionStrategy = KisPNGOptions::CompressionStrategy(
+        qBound<int>(KisPNGOptions::DefaultStrategy,
+                    configuration->getInt("compressionStrategy", KisPNGOptions::DefaultStrategy),
+                    KisPNGOptions::RLEStrategy));
+    options.parallelCompression = configuration->getBool("parallelCompression", true);
     options.tryToSaveAsIndexed = configuration->getBool("indexed", false);
     KoColor c(KoColorSpaceRegistry::instance()->rgb8());
     c.fromQColor(Qt::white);
@@ -92,6 +97,8 @@ KisPropertiesConfigurationSP KisPNGExport::defaultConfiguration(const QByteArray
     cfg->setProperty("alpha", true);
     cfg->setProperty("indexed", false);
     cfg->setProperty("compression", 3);
+    cfg->setProperty("compressionStrategy", int(KisPNGOptions::DefaultStrategy));
+    cfg->setProperty("parallelCompression", true);
     cfg->setProperty("interlaced", false);
 
     KoColor fill_color(KoColorSpaceRegistry::instance()->rgb8());
@@ -163,6 +170,8 @@ void KisWdgOptionsPNG::setConfiguration(const KisPropertiesConfigurationSP cfg)
     interlacing->setChecked(cfg->getBool("interlaced", false));
     compressionLevel->setValue(cfg->getInt("compression", 3));
     compressionLevel->setRange(1, 9, 0);
+    cmbCompressionStrategy->setCurrentIndex(cfg->getInt("compressionStrategy", KisPNGOptions::DefaultStrategy));
+    chkParallelCompression->setChecked(cfg->getBool("parallelCompression", true));
 
     tryToSaveAsIndexed->setVisible(!isThereAlpha);
 
@@ -196,6 +205,8 @@ KisPropertiesConfigurationSP KisWdgOptionsPNG::configuration() const
     bool alpha = this->alpha->isChecked();
     bool interlace = interlacing->isChecked();
     int compression = (int)compressionLevel->value();
+    int compressionStrategy = cmbCompressionStrategy->currentIndex();
+    bool parallelCompression = chkParallelCompression->isChecked();
     bool saveAsHDR = chkSaveAsHDR->isChecked();
     bool tryToSaveAsIndexed = !saveAsHDR && this->tryToSaveAsIndexed->isChecked();
     bool saveSRGB = !saveAsHDR && chkSRGB->isChecked();
@@ -211,6 +222,8 @@ KisPropertiesConfigurationSP KisWdgOptionsPNG::configuration() const
     cfg->setProperty("alpha", alpha);
     cfg->setProperty("indexed", tryToSaveAsIndexed);
     cfg->setProperty("compression", compression);
+    cfg->setProperty("compressionStrategy", compressionStrategy);
+    cfg->setProperty("parallelCompression", parallelCompression);
     cfg->setProperty("interlaced", interlace);
     cfg->setProperty("transparencyFillcolor", transparencyFillcolor);
     cfg->setProperty("saveAsHDR", saveAsHDR);
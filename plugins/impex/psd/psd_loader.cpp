@@ -8,6 +8,8 @@
 #include <QApplication>
 
 #include <QFileInfo>
+#include <QIODevice>
+#include <QSharedPointer>
 #include <QStack>
 
 #include <KoColorSpace.h>
@@ -44,6 +46,144 @@
 #include "KisEmbeddedResourceStorageProxy.h"
 #include "KisImageBarrierLock.h"
 #include "KisImportUserFeedbackInterface.h"
+#include "KisConcurrentRangeUtils.h"
+
+#include <limits>
+
+namespace {
+
+/**
+ * A read-only window into a part of the file loaded into memory. The
+ * positions of the device are the positions in the original file, so the
+ * layer records can decode their channels from it just like from the
+ * file itself, but without sharing the file between the threads.
+ */
+class PSDFileWindow : public QIODevice
+{
+public:
+    PSDFileWindow(const QByteArray &data, qint64 offset)
+        : m_data(data),
+          m_offset(offset)
+    {
+        open(QIODevice::ReadOnly | QIODevice::Unbuffered);
+    }
+
+    qint64 size() const override {
+        return m_offset + m_data.size();
+    }
+
+    bool seek(qint64 pos) override {
+        if (pos < m_offset || pos > size()) return false;
+        return QIODevice::seek(pos);
+    }
+
+protected:
+    qint64 readData(char *data, qint64 maxSize) override {
+        const qint64 start = pos() - m_offset;
+        if (start < 0) return -1;
+
+        const qint64 length = qMin(maxSize, qint64(m_data.size()) - start);
+        if (length <= 0) return 0;
+
+        memcpy(data, m_data.constData() + start, length);
+        return length;
+    }
+
+    qint64 writeData(const char *, qint64) override {
+        return -1;
+    }
+
+private:
+    const QByteArray m_data;
+    const qint64 m_offset;
+};
+
+struct PendingPixelData {
+    PSDLayerRecord *layerRecord = nullptr;
+    KisPaintDeviceSP device;
+};
+
+/**
+ * The layers are decoded in batches, so that the compressed data of
+ * at most this many bytes is kept in memory at a time
+ */
+const qint64 maxPixelDataBatchSize = 256 * 1024 * 1024;
+
+/**
+ * \return the range of the file that holds the channels of \p layerRecord
+ */
+QPair<qint64, qint64> channelDataRange(const PSDLayerRecord *layerRecord, qint64 fileSize)
+{
+    qint64 start = std::numeric_limits<qint64>::max();
+    qint64 end = 0;
+
+    Q_FOREACH (const ChannelInfo *channelInfo, layerRecord->channelInfoRecords) {
+        // the compression type of the channel precedes its data
+        start = qMin(start, qint64(channelInfo->channelDataStart) - 2);
+        end = qMax(end, qint64(channelInfo->channelDataStart + channelInfo->channelDataLength));
+    }
+
+    start = qBound(qint64(0), start, fileSize);
+    end = qBound(start, end, fileSize);
+
+    return qMakePair(start, end);
+}
+
+/**
+ * Decodes the pixel data of the layers in parallel. The file is read
+ * sequentially, but the compressed data of every layer is decoded in
+ * its own thread. If a layer fails to decode from the loaded window,
+ * it is decoded once again directly from the file.
+ */
+bool readPixelDataConcurrently(QIODevice &io, const QVector<PendingPixelData> &pendingData)
+{
+    for (int begin = 0; begin < pendingData.size();) {
+        QVector<QSharedPointer<PSDFileWindow>> windows;
+        qint64 batchSize = 0;
+
+        int end = begin;
+        while (end < pendingData.size() && (end == begin || batchSize < maxPixelDataBatchSize)) {
+            const QPair<qint64, qint64> range = channelDataRange(pendingData[end].layerRecord, io.size());
+
+            QByteArray data;
+            if (io.seek(range.first)) {
+                data = io.read(range.second - range.first);
+            }
+
+            windows << QSharedPointer<PSDFileWindow>(new PSDFileWindow(data, range.first));
+            batchSize += data.size();
+            end++;
+        }
+
+        QVector<char> results(end - begin, false);
+
+        KritaUtils::processRangeConcurrently(end - begin, 1,
+            [&] (int first, int last) {
+                for (int i = first; i < last; i++) {
+                    const PendingPixelData &pending = pendingData[begin + i];
+                    results[i] = pending.layerRecord->readPixelData(*windows[i], pending.device);
+                }
+            });
+
+        for (int i = 0; i < results.size(); i++) {
+            if (results[i]) continue;
+
+            const PendingPixelData &pending = pendingData[begin + i];
+            pending.device->clear();
+
+            if (!pending.layerRecord->readPixelData(io, pending.device)) {
+                dbgFile << "failed reading channels for layer: " << pending.layerRecord->layerName << pending.layerRecord->error;
+                return false;
+            }
+        }
+
+        begin = end;
+    }
+
+    return true;
+}
+
+}
 
 
 PSDLoader::PSDLoader(KisDocument *doc, KisImportUserFeedbackInterface *feedbackInterface)
@@ -214,6 +354,12 @@ KisImportExportErrorCode PSDLoader::decode(QIODevice &io)
      */
     KisNodeSP lastAddedLayer;
 
+    /**
+     * The pixel data of the layers is decoded in parallel after
+     * the whole layer stack is created
+     */
+    QVector<PendingPixelData> pendingPixelData;
+
     typedef QPair<QDomDocument, KisLayerSP> LayerStyleMapping;
     QVector<LayerStyleMapping> allStylesXml;
     using namespace std::placeholders;
@@ -346,10 +492,11 @@ KisImportExportErrorCode PSDLoader::decode(QIODevice &io)
 
             } else {
                 layer = new KisPaintLayer(m_image, layerRecord->layerName, layerRecord->opacity);
-                if (!layerRecord->readPixelData(io, layer->paintDevice())) {
-                    dbgFile << "failed reading channels for layer: " << layerRecord->layerName << layerRecord->error;
-                    return ImportExportCodes::FileFormatIncorrect;
-                }
+
+                PendingPixelData pending;
+                pending.layerRecord = layerRecord;
+                pending.device = layer->paintDevice();
+                pendingPixelData << pending;
             }
             layer->setCompositeOpId(psd_blendmode_to_composite_op(layerRecord->blendModeKey));
 
@@ -393,6 +540,10 @@ KisImportExportErrorCode PSDLoader::decode(QIODevice &io)
         lastAddedLayer = newLayer;
     }
 
+    if (!readPixelDataConcurrently(io, pendingPixelData)) {
+        return ImportExportCodes::FileFormatIncorrect;
+    }
+
     if (!allStylesXml.isEmpty()) {
         Q_FOREACH (const LayerStyleMapping &mapping, allStylesXml) {
 
@@ -12,6 +12,8 @@
 #include <KoUnit.h>
 
 #include <QFileInfo>
+#include <QTemporaryFile>
+#include <QtConcurrent>
 
 #include <kis_annotation.h>
 #include <kis_types.h>
@@ -202,6 +204,34 @@ KisImportExportErrorCode PSDSaver::buildFile(QIODevice &io)
         return ImportExportCodes::ErrorWhileWriting;
     }
 
+    /**
+     * The composited image is encoded into a temporary file in a separate
+     * thread while the layers are being written, and is copied into the
+     * file afterwards. The encoder streams the rows of the channels into
+     * the device and seeks back to fill in the table of the row sizes, so
+     * the memory usage doesn't depend on the size of the image. The encoded
+     * data only contains positions relative to the beginning of the block,
+     * so it can be moved freely.
+     *
+     * If the temporary file cannot be created, the image is encoded directly
+     * into the file after the layers.
+     */
+    QTemporaryFile imageDataFile;
+    const bool useImageDataFile = imageDataFile.open();
+
+    PSDImageData imagedata(&header);
+    KisPaintDeviceSP projection = m_image->projection();
+
+    QFuture<bool> imageDataFuture;
+
+    if (useImageDataFile) {
+        imageDataFuture = QtConcurrent::run(
+            [&imagedata, &imageDataFile, projection, haveLayers] () {
+                // Photoshop compresses layer data by default with RLE.
+                return imagedata.write(imageDataFile, projection, haveLayers, psd_compression_type::RLE);
+            });
+    }
+
     // LAYER AND MASK DATA
     // Only save layers and masks if there is more than one layer
     dbgFile << "m_image->rootLayer->childCount" << m_image->rootLayer()->childCount() << io.pos();
@@ -213,6 +243,9 @@ KisImportExportErrorCode PSDSaver::buildFile(QIODevice &io)
 
         if (!layerSection.write(io, m_image->rootLayer(), psd_compression_type::RLE)) {
             dbgFile << "failed to write layer section. Error:" << layerSection.error << io.pos();
+            if (useImageDataFile) {
+                imageDataFuture.waitForFinished();
+            }
             return ImportExportCodes::ErrorWhileWriting;
         }
     }
@@ -224,13 +257,37 @@ KisImportExportErrorCode PSDSaver::buildFile(QIODevice &io)
 
     // IMAGE DATA
     dbgFile << "Saving composited image" << io.pos();
-    PSDImageData imagedata(&header);
-    // Photoshop compresses layer data by default with RLE.
-    if (!imagedata.write(io, m_image->projection(), haveLayers, psd_compression_type::RLE)) {
+
+    if (!useImageDataFile) {
+        if (!imagedata.write(io, projection, haveLayers, psd_compression_type::RLE)) {
+            dbgFile << "Failed to write image data. Error:"  << imagedata.error;
+            return ImportExportCodes::ErrorWhileWriting;
+        }
+
+        return ImportExportCodes::OK;
+    }
+
+    if (!imageDataFuture.result()) {
         dbgFile << "Failed to write image data. Error:"  << imagedata.error;
         return ImportExportCodes::ErrorWhileWriting;
     }
 
+    const qint64 imageDataCopyChunkSize = 4 * 1024 * 1024;
+
+    if (!imageDataFile.seek(0)) {
+        dbgFile << "Failed to read image data. Error:" << imageDataFile.errorString();
+        return ImportExportCodes::ErrorWhileWriting;
+    }
+
+    while (!imageDataFile.atEnd()) {
+        const QByteArray chunk = imageDataFile.read(imageDataCopyChunkSize);
+
+        if (chunk.isEmpty() || io.write(chunk) != chunk.size()) {
+            dbgFile << "Failed to write image data. Error:" << io.errorString();
+            return ImportExportCodes::ErrorWhileWriting;
+        }
+    }
+
     return ImportExportCodes::OK;
 }
 
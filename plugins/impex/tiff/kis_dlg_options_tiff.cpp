@@ -24,6 +24,8 @@
 
 #include <config-tiff.h>
 
+#include <tiffio.h>
+
 KisTIFFOptionsWidget::KisTIFFOptionsWidget(QWidget *parent)
     : KisConfigWidget(parent)
 {
@@ -44,14 +46,21 @@ KisTIFFOptionsWidget::KisTIFFOptionsWidget(QWidget *parent)
         i18nc("TIFF options", "Lempel-Ziv & Welch"),
         3);
     kComboBoxCompressionType->addItem(i18nc("TIFF options", "Pixar Log"), 4);
+#ifdef COMPRESSION_ZSTD
+    if (TIFFIsCODECConfigured(COMPRESSION_ZSTD)) {
+        kComboBoxCompressionType->addItem(i18nc("TIFF options", "Zstandard"), 5);
+    }
+#endif
 
     connect(kComboBoxCompressionType,
             QOverload<int>::of(&QComboBox::currentIndexChanged),
             [&](int index) {
                 const int deflate = kComboBoxCompressionType->findData(2);
                 const int lzw = kComboBoxCompressionType->findData(3);
+                const int zstd = kComboBoxCompressionType->findData(5);
                 kComboBoxPredictor->setEnabled(index == deflate
-                                               || index == lzw);
+                                               || index == lzw
+                                               || index == zstd);
             });
 
     kComboBoxPredictor->addItem(i18nc("TIFF options", "None"), 0);
@@ -83,6 +92,8 @@ void KisTIFFOptionsWidget::setConfiguration(const KisPropertiesConfigurationSP c
     compressionLevelDeflate->setValue(cfg->getInt("deflate", 6));
     compressionLevelPixarLog->setValue(cfg->getInt("pixarlog", 6));
     chkSaveProfile->setChecked(cfg->getBool("saveProfile", true));
+    chkTiled->setChecked(cfg->getBool("tiled", false));
+    chkBigTiff->setChecked(cfg->getBool("bigTiff", false));
 
     {
         const QString colorDepthId =
@@ -127,6 +138,8 @@ KisPropertiesConfigurationSP KisTIFFOptionsWidget::configuration() const
     cfg->setProperty("deflate", compressionLevelDeflate->value());
     cfg->setProperty("pixarlog", compressionLevelPixarLog->value());
     cfg->setProperty("saveProfile", chkSaveProfile->isChecked());
+    cfg->setProperty("tiled", chkTiled->isChecked());
+    cfg->setProperty("bigTiff", chkBigTiff->isChecked());
 
     return cfg;
 }
@@ -139,6 +152,11 @@ void KisTIFFOptionsWidget::activated(int index)
         codecsOptionsStack->setCurrentIndex(1);
         break;
     case 2: // Deflate
+        groupBoxDeflate->setTitle(i18nc("TIFF options", "Deflate Compression Options"));
+        codecsOptionsStack->setCurrentIndex(2);
+        break;
+    case 5: // Zstandard, shares the compression level with Deflate
+        groupBoxDeflate->setTitle(i18nc("TIFF options", "Zstandard Compression Options"));
         codecsOptionsStack->setCurrentIndex(2);
         break;
     case 4: // Pixar Log
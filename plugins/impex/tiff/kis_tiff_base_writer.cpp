@@ -9,11 +9,277 @@
 #include <KoColorSpace.h>
 #include <KoColorSpaceRegistry.h>
 #include <KoID.h>
+#include <kis_assert.h>
 #include <kis_iterator_ng.h>
+#include <kis_paint_device.h>
+#include <KisConcurrentRangeUtils.h>
+
+#include <QPair>
+#include <QRect>
+#include <QThreadPool>
+#include <QVector>
+
+#include <cstdio>
+#include <cstring>
+#include <memory>
 
 #include "kis_tiff_base_writer.h"
 #include "kis_tiff_converter.h"
 
+namespace {
+
+/**
+ * The size of the tiles of a tiled TIFF file
+ */
+constexpr uint32_t tiffTileSize = 256;
+
+/**
+ * The approximate size of the uncompressed data of a single strip
+ */
+constexpr qint64 tiffStripDataSize = 1 << 20;
+
+/**
+ * The approximate amount of uncompressed data processed in one batch
+ */
+constexpr qint64 tiffBatchDataSize = 64 << 20;
+
+std::array<quint8, 5> samplePositions(uint16_t color_type,
+                                      uint16_t sample_format,
+                                      uint8_t &nbcolorssamples)
+{
+    switch (color_type) {
+    case PHOTOMETRIC_MINISBLACK:
+        nbcolorssamples = 1;
+        return {0, 1};
+    case PHOTOMETRIC_RGB:
+        nbcolorssamples = 3;
+        if (sample_format == SAMPLEFORMAT_IEEEFP) {
+            return {0, 1, 2, 3};
+        } else {
+            return {2, 1, 0, 3};
+        }
+    case PHOTOMETRIC_SEPARATED:
+        nbcolorssamples = 4;
+        return {0, 1, 2, 3, 4};
+    case PHOTOMETRIC_ICCLAB:
+    case PHOTOMETRIC_YCBCR:
+        nbcolorssamples = 3;
+        return {0, 1, 2, 3};
+    }
+
+    nbcolorssamples = 0;
+    return {};
+}
+
+/**
+ * An in-memory TIFF file used for compressing a single block of the
+ * image in a worker thread. libtiff handles cannot be shared between
+ * threads, so every block gets its own one.
+ */
+struct MemoryTIFFStream {
+    QByteArray data;
+    qint64 pos = 0;
+
+    static tmsize_t read(thandle_t handle, void *buf, tmsize_t size)
+    {
+        MemoryTIFFStream *s = static_cast<MemoryTIFFStream *>(handle);
+        const tmsize_t length = qBound<tmsize_t>(0, s->data.size() - s->pos, size);
+        memcpy(buf, s->data.constData() + s->pos, static_cast<size_t>(length));
+        s->pos += length;
+        return length;
+    }
+
+    static tmsize_t write(thandle_t handle, void *buf, tmsize_t size)
+    {
+        MemoryTIFFStream *s = static_cast<MemoryTIFFStream *>(handle);
+        if (s->pos + size > s->data.size()) {
+            s->data.resize(static_cast<int>(s->pos + size));
+        }
+        memcpy(s->data.data() + s->pos, buf, static_cast<size_t>(size));
+        s->pos += size;
+        return size;
+    }
+
+    static toff_t seek(thandle_t handle, toff_t offset, int whence)
+    {
+        MemoryTIFFStream *s = static_cast<MemoryTIFFStream *>(handle);
+        qint64 newPos = static_cast<qint64>(offset);
+        if (whence == SEEK_CUR) {
+            newPos += s->pos;
+        } else if (whence == SEEK_END) {
+            newPos += s->data.size();
+        }
+        if (newPos < 0) return static_cast<toff_t>(-1);
+
+        s->pos = newPos;
+        return static_cast<toff_t>(newPos);
+    }
+
+    static int close(thandle_t)
+    {
+        return 0;
+    }
+
+    static toff_t size(thandle_t handle)
+    {
+        return static_cast<toff_t>(static_cast<MemoryTIFFStream *>(handle)->data.size());
+    }
+
+    static int map(thandle_t, void **, toff_t *)
+    {
+        return 0;
+    }
+
+    static void unmap(thandle_t, void *, toff_t)
+    {
+    }
+};
+
+/**
+ * The fields that define the encoding of the pixel data. They are fetched
+ * from the image once, so that the worker threads don't access its handle.
+ */
+struct TIFFEncodingFields {
+    QVector<QPair<ttag_t, uint16_t>> uint16Fields;
+    QVector<uint16_t> extraSamples;
+    bool hasExtraSamples = false;
+    uint16_t ycbcrSubsampling[2] = {1, 1};
+    bool hasYCbCrSubsampling = false;
+    uint16_t compression = COMPRESSION_NONE;
+    ttag_t qualityTag = 0;
+    int quality = 0;
+    uint16_t predictor = PREDICTOR_NONE;
+    bool hasPredictor = false;
+
+    void fetch(TIFF *image)
+    {
+        const std::array<ttag_t, 5> tags = {TIFFTAG_BITSPERSAMPLE,
+                                            TIFFTAG_SAMPLESPERPIXEL,
+                                            TIFFTAG_PHOTOMETRIC,
+                                            TIFFTAG_SAMPLEFORMAT,
+                                            TIFFTAG_PLANARCONFIG};
+
+        for (ttag_t tag : tags) {
+            uint16_t value = 0;
+            if (TIFFGetField(image, tag, &value)) {
+                uint16Fields << qMakePair(tag, value);
+            }
+        }
+
+        uint16_t count = 0;
+        uint16_t *values = nullptr;
+        if (TIFFGetField(image, TIFFTAG_EXTRASAMPLES, &count, &values)) {
+            hasExtraSamples = true;
+            for (int i = 0; i < count; i++) {
+                extraSamples << values[i];
+            }
+        }
+
+        hasYCbCrSubsampling =
+            TIFFGetField(image, TIFFTAG_YCBCRSUBSAMPLING, &ycbcrSubsampling[0], &ycbcrSubsampling[1]);
+
+        TIFFGetField(image, TIFFTAG_COMPRESSION, &compression);
+
+        if (compression == COMPRESSION_ADOBE_DEFLATE) {
+            qualityTag = TIFFTAG_ZIPQUALITY;
+        } else if (compression == COMPRESSION_PIXARLOG) {
+            qualityTag = TIFFTAG_PIXARLOGQUALITY;
+#ifdef COMPRESSION_ZSTD
+        } else if (compression == COMPRESSION_ZSTD) {
+            qualityTag = TIFFTAG_ZSTD_LEVEL;
+#endif
+        }
+
+        if (qualityTag && !TIFFGetField(image, qualityTag, &quality)) {
+            qualityTag = 0;
+        }
+
+        hasPredictor = TIFFGetField(image, TIFFTAG_PREDICTOR, &predictor);
+    }
+
+    void apply(TIFF *image) const
+    {
+        for (const auto &field : uint16Fields) {
+            TIFFSetField(image, field.first, field.second);
+        }
+
+        if (hasExtraSamples) {
+            TIFFSetField(image, TIFFTAG_EXTRASAMPLES, extraSamples.size(), extraSamples.constData());
+        }
+
+        if (hasYCbCrSubsampling) {
+            TIFFSetField(image, TIFFTAG_YCBCRSUBSAMPLING, ycbcrSubsampling[0], ycbcrSubsampling[1]);
+        }
+
+        // the codec-specific fields are available only after the codec is set
+        TIFFSetField(image, TIFFTAG_COMPRESSION, compression);
+
+        if (qualityTag) {
+            TIFFSetField(image, qualityTag, quality);
+        }
+
+        if (hasPredictor) {
+            TIFFSetField(image, TIFFTAG_PREDICTOR, predictor);
+        }
+    }
+};
+
+/**
+ * Compresses a block of the image with the encoding defined by \p fields
+ *
+ * \return the compressed data or an empty array on failure
+ */
+QByteArray encodeBlock(const TIFFEncodingFields &fields, bool tiled, QByteArray &rawData, uint32_t blockWidth, uint32_t blockHeight)
+{
+    MemoryTIFFStream stream;
+
+    std::unique_ptr<TIFF, decltype(&TIFFCleanup)> block(
+        TIFFClientOpen("block", "w", &stream,
+                       &MemoryTIFFStream::read,
+                       &MemoryTIFFStream::write,
+                       &MemoryTIFFStream::seek,
+                       &MemoryTIFFStream::close,
+                       &MemoryTIFFStream::size,
+                       &MemoryTIFFStream::map,
+                       &MemoryTIFFStream::unmap),
+        &TIFFCleanup);
+
+    if (!block) return QByteArray();
+
+    TIFFSetField(block.get(), TIFFTAG_IMAGEWIDTH, blockWidth);
+    TIFFSetField(block.get(), TIFFTAG_IMAGELENGTH, blockHeight);
+    fields.apply(block.get());
+
+    if (tiled) {
+        TIFFSetField(block.get(), TIFFTAG_TILEWIDTH, blockWidth);
+        TIFFSetField(block.get(), TIFFTAG_TILELENGTH, blockHeight);
+    } else {
+        TIFFSetField(block.get(), TIFFTAG_ROWSPERSTRIP, blockHeight);
+    }
+
+    // NOTE: the predictor modifies the raw data in place
+    const tmsize_t written = tiled ?
+        TIFFWriteEncodedTile(block.get(), 0, rawData.data(), rawData.size()) :
+        TIFFWriteEncodedStrip(block.get(), 0, rawData.data(), rawData.size());
+
+    if (written < 0) return QByteArray();
+
+    uint64_t *offsets = nullptr;
+    uint64_t *byteCounts = nullptr;
+
+    if (!TIFFGetField(block.get(), tiled ? TIFFTAG_TILEOFFSETS : TIFFTAG_STRIPOFFSETS, &offsets)
+        || !TIFFGetField(block.get(), tiled ? TIFFTAG_TILEBYTECOUNTS : TIFFTAG_STRIPBYTECOUNTS, &byteCounts)
+        || !offsets || !byteCounts
+        || offsets[0] + byteCounts[0] > static_cast<uint64_t>(stream.data.size())) {
+
+        return QByteArray();
+    }
+
+    return stream.data.mid(static_cast<int>(offsets[0]), static_cast<int>(byteCounts[0]));
+}
+
+}
+
 KisTIFFBaseWriter::KisTIFFBaseWriter(TIFF *image, KisTIFFOptions *options)
     : m_image(image)
     , m_options(options)
@@ -151,3 +417,171 @@ bool KisTIFFBaseWriter::copyDataToStrips(KisHLineConstIteratorSP it,
     }
     return false;
 }
+
+bool KisTIFFBaseWriter::writeImageData(KisPaintDeviceSP dev,
+                                       qint32 width,
+                                       qint32 height,
+                                       uint16_t color_type,
+                                       uint32_t depth,
+                                       uint16_t sample_format)
+{
+    uint8_t nbcolorssamples = 0;
+    const std::array<quint8, 5> poses = samplePositions(color_type, sample_format, nbcolorssamples);
+    KIS_SAFE_ASSERT_RECOVER_RETURN_VALUE(nbcolorssamples > 0, false);
+
+    // JPEG strips are written by libtiff itself, since the size of
+    // the strips must be compatible with the JPEG encoder
+    if (!m_options->tiled && m_options->compressionType == COMPRESSION_JPEG) {
+        return writeScanlines(dev, width, height, depth, sample_format, nbcolorssamples, poses);
+    }
+
+    return writeBlocks(dev, width, height, depth, sample_format, nbcolorssamples, poses);
+}
+
+bool KisTIFFBaseWriter::writeScanlines(KisPaintDeviceSP dev,
+                                       qint32 width,
+                                       qint32 height,
+                                       uint32_t depth,
+                                       uint16_t sample_format,
+                                       uint8_t nbcolorssamples,
+                                       const std::array<quint8, 5> &poses)
+{
+    tsize_t stripsize = TIFFStripSize(image());
+    std::unique_ptr<std::remove_pointer_t<tdata_t>, decltype(&_TIFFfree)> buff(
+        _TIFFmalloc(stripsize),
+        &_TIFFfree);
+    KIS_ASSERT_RECOVER_RETURN_VALUE(
+        buff && "Unable to allocate buffer for TIFF!",
+        false);
+
+    for (qint32 y = 0; y < height; y++) {
+        KisHLineConstIteratorSP it = dev->createHLineConstIteratorNG(0, y, width);
+        if (!copyDataToStrips(it, buff.get(), depth, sample_format, nbcolorssamples, poses)) {
+            return false;
+        }
+        if (TIFFWriteScanline(image(),
+                              buff.get(),
+                              static_cast<uint32_t>(y),
+                              (tsample_t)-1) < 0) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool KisTIFFBaseWriter::writeBlocks(KisPaintDeviceSP dev,
+                                    qint32 width,
+                                    qint32 height,
+                                    uint32_t depth,
+                                    uint16_t sample_format,
+                                    uint8_t nbcolorssamples,
+                                    const std::array<quint8, 5> &poses)
+{
+    const bool tiled = m_options->tiled;
+
+    // JPEG tiles reference the tables stored in the directory
+    // of the file, so they cannot be compressed separately
+    const bool encodeConcurrently = m_options->compressionType != COMPRESSION_JPEG;
+
+    const int samplesPerPixel = nbcolorssamples + (m_options->alpha ? 1 : 0);
+    const qint64 bytesPerPixel = samplesPerPixel * static_cast<qint64>(depth) / 8;
+
+    uint32_t blockWidth = 0;
+    uint32_t blockHeight = 0;
+
+    if (tiled) {
+        blockWidth = tiffTileSize;
+        blockHeight = tiffTileSize;
+        TIFFSetField(image(), TIFFTAG_TILEWIDTH, blockWidth);
+        TIFFSetField(image(), TIFFTAG_TILELENGTH, blockHeight);
+    } else {
+        blockWidth = static_cast<uint32_t>(width);
+        blockHeight = static_cast<uint32_t>(qBound<qint64>(1, tiffStripDataSize / (width * bytesPerPixel), height));
+        TIFFSetField(image(), TIFFTAG_ROWSPERSTRIP, blockHeight);
+    }
+
+    TIFFEncodingFields encodingFields;
+    if (encodeConcurrently) {
+        encodingFields.fetch(image());
+    }
+
+    QVector<QRect> blocks;
+    for (qint32 y = 0; y < height; y += blockHeight) {
+        if (tiled) {
+            // tiles are always written in full, the pixels outside
+            // the image are ignored by the readers
+            for (qint32 x = 0; x < width; x += blockWidth) {
+                blocks << QRect(x, y, blockWidth, blockHeight);
+            }
+        } else {
+            blocks << QRect(0, y, width, qMin<qint32>(blockHeight, height - y));
+        }
+    }
+
+    const qint64 rowSize = blockWidth * bytesPerPixel;
+    const int numThreads = qMax(1, QThreadPool::globalInstance()->maxThreadCount());
+    const int batchSize =
+        static_cast<int>(qMax<qint64>(2 * numThreads, tiffBatchDataSize / (rowSize * blockHeight)));
+
+    for (int batchStart = 0; batchStart < blocks.size(); batchStart += batchSize) {
+        const int batchEnd = qMin(blocks.size(), batchStart + batchSize);
+
+        QVector<QByteArray> blockData(batchEnd - batchStart);
+        QVector<char> blockSuccess(batchEnd - batchStart, false);
+
+        KritaUtils::processRangeConcurrently(batchEnd - batchStart, 1,
+            [&] (int begin, int end) {
+                for (int i = begin; i < end; i++) {
+                    const QRect &rc = blocks[batchStart + i];
+
+                    QByteArray rawData(static_cast<int>(rowSize * rc.height()), 0);
+
+                    bool result = true;
+                    for (int row = 0; row < rc.height() && result; row++) {
+                        KisHLineConstIteratorSP it = dev->createHLineConstIteratorNG(rc.x(), rc.y() + row, rc.width());
+                        result = copyDataToStrips(it, rawData.data() + row * rowSize,
+                                                  depth, sample_format, nbcolorssamples, poses);
+                    }
+
+                    if (result && encodeConcurrently) {
+                        blockData[i] = encodeBlock(encodingFields, tiled, rawData, blockWidth, static_cast<uint32_t>(rc.height()));
+                        result = !blockData[i].isEmpty();
+                    } else {
+                        blockData[i] = rawData;
+                    }
+
+                    blockSuccess[i] = result;
+                }
+            });
+
+        // the blocks are written into the file in order
+        for (int i = 0; i < blockData.size(); i++) {
+            if (!blockSuccess[i]) {
+                return false;
+            }
+
+            const uint32_t index = static_cast<uint32_t>(batchStart + i);
+            QByteArray &data = blockData[i];
+
+            tmsize_t written = -1;
+            if (encodeConcurrently) {
+                written = tiled ?
+                    TIFFWriteRawTile(image(), index, data.data(), data.size()) :
+                    TIFFWriteRawStrip(image(), index, data.data(), data.size());
+            } else {
+                written = tiled ?
+                    TIFFWriteEncodedTile(image(), index, data.data(), data.size()) :
+                    TIFFWriteEncodedStrip(image(), index, data.data(), data.size());
+            }
+
+            if (written < 0) {
+                return false;
+            }
+
+            data.clear();
+        }
+    }
+
+    return true;
+}
@@ -42,6 +42,43 @@ protected:
                           uint8_t nbcolorssamples,
                           const std::array<quint8, 5> &poses);
 
+    /**
+     * Writes the pixel data of \p dev into the current directory of the
+     * image. All the fields of the directory, except for the layout of the
+     * data, should be already set.
+     *
+     * The data is written in strips or in tiles, depending on the options.
+     * The blocks of the image are read from the device and compressed
+     * concurrently in batches, so the memory consumption doesn't depend on
+     * the size of the image. The only exception is JPEG compression of
+     * a striped image, which is written line by line by libtiff itself.
+     */
+    bool writeImageData(KisPaintDeviceSP dev,
+                        qint32 width,
+                        qint32 height,
+                        uint16_t color_type,
+                        uint32_t depth,
+                        uint16_t sample_format);
+
+private:
+    bool writeScanlines(KisPaintDeviceSP dev,
+                        qint32 width,
+                        qint32 height,
+                        uint32_t depth,
+                        uint16_t sample_format,
+                        uint8_t nbcolorssamples,
+                        const std::array<quint8, 5> &poses);
+
+    bool writeBlocks(KisPaintDeviceSP dev,
+                     qint32 width,
+                     qint32 height,
+                     uint32_t depth,
+                     uint16_t sample_format,
+                     uint8_t nbcolorssamples,
+                     const std::array<quint8, 5> &poses);
+
+protected:
+
     TIFF *m_image;
     KisTIFFOptions *m_options;
 };
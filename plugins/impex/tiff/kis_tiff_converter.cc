@@ -20,6 +20,9 @@ KisPropertiesConfigurationSP KisTIFFOptions::toProperties() const
     compToIndex[COMPRESSION_ADOBE_DEFLATE] = 2;
     compToIndex[COMPRESSION_LZW] = 3;
     compToIndex[COMPRESSION_PIXARLOG] = 8;
+#ifdef COMPRESSION_ZSTD
+    compToIndex[COMPRESSION_ZSTD] = 5;
+#endif
 
     const QHash<quint16, int> psdCompToIndex = {
         {psd_compression_type::RLE, 0},
@@ -39,6 +42,8 @@ KisPropertiesConfigurationSP KisTIFFOptions::toProperties() const
     cfg->setProperty("deflate", deflateCompress);
     cfg->setProperty("pixarlog", pixarLogCompress);
     cfg->setProperty("saveProfile", saveProfile);
+    cfg->setProperty("tiled", tiled);
+    cfg->setProperty("bigTiff", bigTiff);
 
     return cfg;
 }
@@ -51,6 +56,9 @@ void KisTIFFOptions::fromProperties(KisPropertiesConfigurationSP cfg)
     indexToComp[2] = COMPRESSION_ADOBE_DEFLATE;
     indexToComp[3] = COMPRESSION_LZW;
     indexToComp[4] = COMPRESSION_PIXARLOG;
+#ifdef COMPRESSION_ZSTD
+    indexToComp[5] = COMPRESSION_ZSTD;
+#endif
 
     // old value that might be still stored in a config (remove after Krita 5.0
     // :) )
@@ -75,4 +83,6 @@ void KisTIFFOptions::fromProperties(KisPropertiesConfigurationSP cfg)
     deflateCompress = static_cast<quint16>(cfg->getInt("deflate", 6));
     pixarLogCompress = static_cast<quint16>(cfg->getInt("pixarlog", 6));
     saveProfile = cfg->getBool("saveProfile", true);
+    tiled = cfg->getBool("tiled", false);
+    bigTiff = cfg->getBool("bigTiff", false);
 }
@@ -22,6 +22,7 @@
 #include <KisDocument.h>
 #include <KisExportCheckRegistry.h>
 #include <KoColorModelStandardIds.h>
+#include <KoColorSpace.h>
 #include <KoDocumentInfo.h>
 #include <KoUnit.h>
 #include <kis_assert.h>
@@ -121,8 +122,30 @@ KisImportExportErrorCode KisTIFFExport::convert(KisDocument *document, QIODevice
     const int handle = file.handle();
 #endif
 
+    /**
+     * Classic TIFF files cannot be larger than 4 GiB. If the uncompressed
+     * data may not fit, switch to BigTIFF automatically, since we cannot
+     * predict how well the data is going to be compressed.
+     */
+    const bool useBigTiff = [&]() {
+        if (options.bigTiff) return true;
+
+        const qint64 imageSize =
+            qint64(kisimage->width()) * kisimage->height() * kisimage->colorSpace()->pixelSize();
+        int numImages = options.flatten ? 1 : kisimage->root()->childCount();
+        if (options.saveAsPhotoshop) {
+            // the layers are stored once again in the Photoshop data
+            numImages *= 2;
+        }
+
+        const qint64 classicTiffSizeLimit = 0xF0000000LL;
+        return imageSize * numImages > classicTiffSizeLimit;
+    }();
+
+    dbgFile << "Using BigTIFF:" << useBigTiff;
+
     // NOLINTNEXTLINE(bugprone-narrowing-conversions, cppcoreguidelines-narrowing-conversions)
-    std::unique_ptr<TIFF, decltype(&TIFFCleanup)> image(TIFFFdOpen(handle, encodedFilename.data(), "w"), &TIFFCleanup);
+    std::unique_ptr<TIFF, decltype(&TIFFCleanup)> image(TIFFFdOpen(handle, encodedFilename.data(), useBigTiff ? "w8" : "w"), &TIFFCleanup);
 
     if (!image) {
         dbgFile << "Could not open the file for writing" << filename();
@@ -18,11 +18,15 @@
 struct KisCageTransformStrategy::Private
 {
     Private(KisCageTransformStrategy *_q)
-        : q(_q)
+        : q(_q),
+          gridCache(KisCageTransformWorker::createGridCache())
     {
     }
 
     KisCageTransformStrategy * const q;
+
+    /// the grids are reused while the user drags the handles of the cage
+    KisCageTransformWorker::GridCacheSP gridCache;
 };
 
 
@@ -44,6 +48,11 @@ KisCageTransformStrategy::~KisCageTransformStrategy()
 {
 }
 
+void KisCageTransformStrategy::clearGridCache()
+{
+    KisCageTransformWorker::clearGridCache(m_d->gridCache);
+}
+
 void KisCageTransformStrategy::drawConnectionLines(QPainter &gc,
                                                    const QVector<QPointF> &origPoints,
                                                    const QVector<QPointF> &transfPoints,
@@ -84,6 +93,7 @@ QImage KisCageTransformStrategy::calculateTransformedImage(ToolTransformArgs &cu
                                   origPoints,
                                   0,
                                   currentArgs.previewPixelPrecision());
+    worker.setGridCache(m_d->gridCache);
     worker.prepareTransform();
     worker.setTransformedCage(transfPoints);
     return worker.runOnQImage(dstOffset);
@@ -29,6 +29,12 @@ public:
                              TransformTransactionProperties &transaction);
     ~KisCageTransformStrategy() override;
 
+    /**
+     * Releases the precalculated grids used for the preview,
+     * should be called when the transformation is finished
+     */
+    void clearGridCache();
+
 protected:
     void drawConnectionLines(QPainter &gc,
                              const QVector<QPointF> &origPoints,
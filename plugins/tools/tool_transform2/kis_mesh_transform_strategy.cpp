@@ -82,6 +82,9 @@ struct KisMeshTransformStrategy::Private
 
     KisSignalCompressor recalculateSignalCompressor;
 
+    /// the patches are resampled only when they change
+    KisBezierTransformMesh::SampledGridCacheSP gridCache {KisBezierTransformMesh::createSampledGridCache()};
+
     QTransform paintingTransform;
     QPointF paintingOffset;
     QImage transformedImage;
@@ -111,6 +114,11 @@ KisMeshTransformStrategy::~KisMeshTransformStrategy()
 {
 }
 
+void KisMeshTransformStrategy::clearGridCache()
+{
+    m_d->gridCache = KisBezierTransformMesh::createSampledGridCache();
+}
+
 void KisMeshTransformStrategy::setTransformFunction(const QPointF &mousePos, bool perspectiveModifierActive, bool shiftModifierActive, bool altModifierActive)
 {
     const qreal grabRadius = KisTransformUtils::effectiveHandleGrabRadius(m_d->converter);
@@ -844,7 +852,8 @@ void KisMeshTransformStrategy::Private::recalculateTransformations()
         dstImage.fill(0);
 
         mesh.transformMesh(origTLInFlake.toPoint(), transformedImage,
-                           dstImageRect.topLeft(), &dstImage);
+                           dstImageRect.topLeft(), &dstImage,
+                           gridCache);
 
         transformedImage = dstImage;
         paintingOffset = dstImageRect.topLeft();
@@ -30,6 +30,12 @@ public:
                              TransformTransactionProperties &transaction);
     ~KisMeshTransformStrategy() override;
 
+    /**
+     * Releases the sampled patches used for the preview,
+     * should be called when the transformation is finished
+     */
+    void clearGridCache();
+
 
     void setTransformFunction(const QPointF &mousePos, bool perspectiveModifierActive, bool shiftModifierActive, bool altModifierActive) override;
     QPointF handleSnapPoint(const QPointF &imagePos) override;
@@ -1011,6 +1011,8 @@ void KisToolTransform::endStroke()
     }
 
     image()->endStroke(m_strokeId);
+    m_cageStrategy->clearGridCache();
+    m_meshStrategy->clearGridCache();
 
     m_strokeStrategyCookie = 0;
     m_strokeId.clear();
@@ -1089,6 +1091,8 @@ void KisToolTransform::cancelStroke()
     }
 
     image()->cancelStroke(m_strokeId);
+    m_cageStrategy->clearGridCache();
+    m_meshStrategy->clearGridCache();
     m_strokeStrategyCookie = 0;
     m_strokeId.clear();
     m_changesTracker.reset();